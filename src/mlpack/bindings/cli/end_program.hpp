@@ -9,6 +9,7 @@
 #define MLPACK_BINDINGS_CLI_END_PROGRAM_HPP
 
 #include <mlpack/core/util/cli.hpp>
+#include "write_profile.hpp"
 
 namespace mlpack {
 namespace bindings {
@@ -23,6 +24,10 @@ inline void EndProgram()
   // Stop the CLI timers.
   CLI::GetSingleton().timer.StopAllTimers();
 
+  // Save the timers and counters, if requested.
+  if (CLI::HasParam("profile_file"))
+    WriteProfile(CLI::GetParam<std::string>("profile_file"));
+
   // Print any output.
   const std::map<std::string, util::ParamData>& parameters = CLI::Parameters();
   std::map<std::string, util::ParamData>::const_iterator it =
@@ -66,6 +71,15 @@ inline void EndProgram()
       Log::Info << "  " << it2.first << ": ";
       CLI::GetSingleton().timer.PrintTimer(it2.first);
     }
+
+    const std::map<std::string, size_t> counters =
+        CLI::GetSingleton().counters.GetAllCounters();
+    if (!counters.empty())
+    {
+      Log::Info << "Program counters:" << std::endl;
+      for (auto it2 : counters)
+        Log::Info << "  " << it2.first << ": " << it2.second << std::endl;
+    }
   }
 }
 
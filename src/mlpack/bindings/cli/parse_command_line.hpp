@@ -22,6 +22,8 @@ PARAM_STRING_IN("info", "Get help on a specific module or option.", "", "");
 PARAM_FLAG("verbose", "Display informational messages and the full list of "
     "parameters and timers at the end of execution.", "v");
 PARAM_FLAG("version", "Display the version of mlpack.", "V");
+PARAM_STRING_IN("profile_file", "If specified, the timers and counters of the "
+    "program are saved to this file in JSON format.", "", "");
 
 /**
  * Parse the command line, setting all of the options inside of the CLI object
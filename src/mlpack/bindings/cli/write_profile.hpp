@@ -0,0 +1,102 @@
+/**
+ * @file write_profile.hpp
+ *
+ * Save the timers and counters of a program to a JSON file, for the
+ * --profile_file option.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_BINDINGS_CLI_WRITE_PROFILE_HPP
+#define MLPACK_BINDINGS_CLI_WRITE_PROFILE_HPP
+
+#include <mlpack/core/util/cli.hpp>
+#include <fstream>
+#include <iomanip>
+
+namespace mlpack {
+namespace bindings {
+namespace cli {
+
+/**
+ * Return the given string as a JSON string literal, with quotes.
+ */
+inline std::string JSONString(const std::string& str)
+{
+  std::ostringstream oss;
+  oss << '"';
+  for (size_t i = 0; i < str.size(); ++i)
+  {
+    const unsigned char c = str[i];
+    if (c == '"' || c == '\\')
+      oss << '\\' << c;
+    else if (c < 0x20)
+      oss << "\\u" << std::hex << std::setw(4) << std::setfill('0') << (int) c
+          << std::dec;
+    else
+      oss << c;
+  }
+  oss << '"';
+  return oss.str();
+}
+
+/**
+ * Save the timers (in seconds) and the counters of the program to the given
+ * file, as a JSON object of the form
+ *
+ * @code
+ * {
+ *   "program": "mlpack_knn",
+ *   "timers": { "total_time": 0.125000, ... },
+ *   "counters": { "neighbor_search/base_cases": 123456, ... }
+ * }
+ * @endcode
+ *
+ * The timers must be stopped before this is called.
+ *
+ * @param filename Name of the file to save to.
+ */
+inline void WriteProfile(const std::string& filename)
+{
+  std::ofstream stream(filename.c_str());
+  if (!stream.is_open())
+  {
+    Log::Fatal << "Cannot open file '" << filename << "' to save the profile "
+        << "to." << std::endl;
+  }
+
+  stream << "{" << std::endl;
+  stream << "  \"program\": " << JSONString(CLI::GetSingleton().programName)
+      << "," << std::endl;
+
+  stream << "  \"timers\": {";
+  bool first = true;
+  for (auto& it : CLI::GetSingleton().timer.GetAllTimers())
+  {
+    const std::chrono::microseconds::rep us = it.second.count();
+    stream << (first ? "" : ",") << std::endl << "    "
+        << JSONString(it.first) << ": " << (us / 1000000) << "."
+        << std::setw(6) << std::setfill('0') << (us % 1000000);
+    first = false;
+  }
+  stream << std::endl << "  }," << std::endl;
+
+  stream << "  \"counters\": {";
+  first = true;
+  for (auto& it : CLI::GetSingleton().counters.GetAllCounters())
+  {
+    stream << (first ? "" : ",") << std::endl << "    "
+        << JSONString(it.first) << ": " << it.second;
+    first = false;
+  }
+  stream << std::endl << "  }" << std::endl;
+  stream << "}" << std::endl;
+}
+
+} // namespace cli
+} // namespace bindings
+} // namespace mlpack
+
+#endif
@@ -121,8 +121,9 @@ inline void DisableBacktrace()
  */
 inline void ResetTimers()
 {
-  // Just get a new object---removes all old timers.
+  // Just get a new object---removes all old timers and counters.
   CLI::GetSingleton().timer.Reset();
+  CLI::GetSingleton().counters.Reset();
 }
 
 /**
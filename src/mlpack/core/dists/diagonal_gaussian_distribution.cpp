@@ -0,0 +1,133 @@
+/**
+ * @file diagonal_gaussian_distribution.cpp
+ *
+ * Implementation of the Gaussian distribution with diagonal covariance.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "diagonal_gaussian_distribution.hpp"
+#include <mlpack/methods/gmm/positive_definite_constraint.hpp>
+
+using namespace mlpack;
+using namespace mlpack::distribution;
+
+DiagonalGaussianDistribution::DiagonalGaussianDistribution(
+    const arma::vec& mean,
+    const arma::vec& covariance) :
+    mean(mean)
+{
+  Covariance(covariance);
+}
+
+void DiagonalGaussianDistribution::Covariance(const arma::vec& covariance)
+{
+  this->covariance = covariance;
+  ComputeCachedValues();
+}
+
+void DiagonalGaussianDistribution::Covariance(arma::vec&& covariance)
+{
+  this->covariance = std::move(covariance);
+  ComputeCachedValues();
+}
+
+void DiagonalGaussianDistribution::ComputeCachedValues()
+{
+  // The inverse of a diagonal matrix is the elementwise reciprocal, and the
+  // determinant is the product of the diagonal.
+  invCov = 1.0 / covariance;
+  logDetCov = arma::accu(arma::log(covariance));
+}
+
+double DiagonalGaussianDistribution::LogProbability(
+    const arma::vec& observation) const
+{
+  const size_t k = observation.n_elem;
+  const arma::vec diff = mean - observation;
+  const double v = arma::dot(arma::square(diff), invCov);
+  return -0.5 * k * log2pi - 0.5 * logDetCov - 0.5 * v;
+}
+
+arma::vec DiagonalGaussianDistribution::Random() const
+{
+  return arma::sqrt(covariance) % arma::randn<arma::vec>(mean.n_elem) + mean;
+}
+
+/**
+ * Estimate the Gaussian distribution directly from the given observations.
+ *
+ * @param observations List of observations.
+ */
+void DiagonalGaussianDistribution::Train(const arma::mat& observations)
+{
+  if (observations.n_cols == 0)
+  {
+    // This will end up just being empty, as with GaussianDistribution.
+    mean.zeros(0);
+    covariance.zeros(0);
+    return;
+  }
+
+  // Calculate the mean.
+  mean = arma::mean(observations, 1);
+
+  // Now calculate the variances, with the (1 / (n - 1)) so that they are
+  // unbiased estimators.
+  const arma::mat diffs = observations.each_col() - mean;
+  covariance = arma::sum(arma::square(diffs), 1);
+  if (observations.n_cols > 1)
+    covariance /= (observations.n_cols - 1);
+
+  // Ensure that the covariance is positive definite.
+  gmm::PositiveDefiniteConstraint::ApplyConstraint(covariance);
+
+  ComputeCachedValues();
+}
+
+/**
+ * Estimate the Gaussian distribution from the given observations, taking into
+ * account the probability of each observation actually being from this
+ * distribution.
+ */
+void DiagonalGaussianDistribution::Train(const arma::mat& observations,
+                                         const arma::vec& probabilities)
+{
+  if (observations.n_cols > 0)
+  {
+    mean.zeros(observations.n_rows);
+    covariance.zeros(observations.n_rows);
+  }
+  else // This will end up just being empty.
+  {
+    mean.zeros(0);
+    covariance.zeros(0);
+    return;
+  }
+
+  // Save the sum of all the probabilities for later normalization.
+  const double sumProb = arma::accu(probabilities);
+
+  if (sumProb == 0)
+  {
+    // Nothing in this Gaussian!  At least set the covariance so that it's
+    // invertible.
+    covariance.fill(1e-50);
+    ComputeCachedValues();
+    return;
+  }
+
+  // Calculate the weighted mean.
+  mean = (observations * probabilities) / sumProb;
+
+  // Now find the weighted variances.
+  const arma::mat diffs = observations.each_col() - mean;
+  covariance = (arma::square(diffs) * probabilities) / sumProb;
+
+  // Ensure that the covariance is positive definite.
+  gmm::PositiveDefiniteConstraint::ApplyConstraint(covariance);
+
+  ComputeCachedValues();
+}
@@ -0,0 +1,97 @@
+/**
+ * @file log_add.hpp
+ *
+ * Functions for adding numbers that are stored in log space, without leaving
+ * log space (which could underflow).
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_MATH_LOG_ADD_HPP
+#define MLPACK_CORE_MATH_LOG_ADD_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace math {
+
+/**
+ * Internal log-addition.  Given x = log(a) and y = log(b), return
+ * log(a + b).
+ *
+ * @param x log(a).
+ * @param y log(b).
+ * @return log(a + b).
+ */
+template<typename T>
+T LogAdd(T x, T y)
+{
+  T d, r;
+  if (x > y)
+  {
+    d = y - x;
+    r = x;
+  }
+  else
+  {
+    d = x - y;
+    r = y;
+  }
+
+  if (r == -std::numeric_limits<T>::infinity() ||
+      d == -std::numeric_limits<T>::infinity())
+    return r;
+
+  return r + std::log1p(std::exp(d));
+}
+
+/**
+ * Sum a vector of log values.  Given a vector x whose elements are log(a_i),
+ * return log(sum_i a_i).
+ *
+ * @param x Vector of log values.
+ * @return log(sum_i exp(x_i)).
+ */
+template<typename T>
+typename T::elem_type AccuLog(const T& x)
+{
+  typedef typename T::elem_type ElemType;
+
+  const ElemType maxVal = x.max();
+  if (maxVal == -std::numeric_limits<ElemType>::infinity())
+    return maxVal;
+
+  return maxVal + std::log(arma::accu(arma::exp(x - maxVal)));
+}
+
+/**
+ * Compute the log-sum-exp of each column of a matrix of log values; that is,
+ * y(j) = log(sum_i exp(x(i, j))).  The maximum of each column is subtracted
+ * before exponentiation, so the computation does not underflow.
+ *
+ * @param x Matrix of log values.
+ * @param y Vector to store the log-sum-exp of each column of x in.
+ */
+template<typename T>
+void LogSumExp(const T& x, arma::Col<typename T::elem_type>& y)
+{
+  typedef typename T::elem_type ElemType;
+
+  const arma::Row<ElemType> maxVals = arma::max(x, 0);
+  y.set_size(x.n_cols);
+  for (size_t j = 0; j < x.n_cols; ++j)
+  {
+    if (maxVals[j] == -std::numeric_limits<ElemType>::infinity())
+      y[j] = maxVals[j];
+    else
+      y[j] = maxVals[j] + std::log(arma::accu(arma::exp(x.col(j) -
+          maxVals[j])));
+  }
+}
+
+} // namespace math
+} // namespace mlpack
+
+#endif
@@ -38,6 +38,15 @@ class IPMetric
   //! Create the IPMetric with an instantiated kernel.
   IPMetric(KernelType& kernel);
 
+  /**
+   * Copy the given IPMetric.  If the given metric owns its kernel, the kernel
+   * is copied too; otherwise both metrics use the same kernel.
+   */
+  IPMetric(const IPMetric& other);
+
+  //! Copy the given IPMetric; see the copy constructor.
+  IPMetric& operator=(const IPMetric& other);
+
   //! Destroy the IPMetric object.
   ~IPMetric();
 
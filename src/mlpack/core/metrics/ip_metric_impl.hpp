@@ -39,6 +39,31 @@ IPMetric<KernelType>::IPMetric(KernelType& kernel) :
   // Nothing to do.
 }
 
+// Copy constructor.
+template<typename KernelType>
+IPMetric<KernelType>::IPMetric(const IPMetric& other) :
+    kernel(other.kernelOwner ? new KernelType(*other.kernel) : other.kernel),
+    kernelOwner(other.kernelOwner)
+{
+  // Nothing to do.
+}
+
+// Copy operator.
+template<typename KernelType>
+IPMetric<KernelType>& IPMetric<KernelType>::operator=(const IPMetric& other)
+{
+  if (this != &other)
+  {
+    if (kernelOwner)
+      delete kernel;
+
+    kernel = other.kernelOwner ? new KernelType(*other.kernel) : other.kernel;
+    kernelOwner = other.kernelOwner;
+  }
+
+  return *this;
+}
+
 // Destructor for the IPMetric.
 template<typename KernelType>
 IPMetric<KernelType>::~IPMetric()
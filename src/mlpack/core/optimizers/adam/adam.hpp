@@ -28,6 +28,7 @@
 #include "adam_update.hpp"
 #include "adamax_update.hpp"
 #include "amsgrad_update.hpp"
+#include "lazy_adam_update.hpp"
 #include "nadam_update.hpp"
 #include "nadamax_update.hpp"
 
@@ -40,7 +41,8 @@ namespace optimization {
  * gradients. AdaMax is a variant of Adam based on the infinity norm as given
  * in the section 7 of the following paper. Nadam is an optimizer that
  * combines the Adam and NAG. NadaMax is an variant of Nadam based on Infinity
- * form.
+ * form.  LazyAdam is a variant of Adam that, for functions with sparse
+ * gradients, only updates the parameters with a non-zero gradient.
  *
  * For more information, see the following.
  *
@@ -186,6 +188,8 @@ using Nadam = AdamType<NadamUpdate>;
 
 using NadaMax = AdamType<NadaMaxUpdate>;
 
+using LazyAdam = AdamType<LazyAdamUpdate>;
+
 } // namespace optimization
 } // namespace mlpack
 
@@ -0,0 +1,168 @@
+/**
+ * @file lazy_adam_update.hpp
+ *
+ * Lazy Adam update policy, which only updates the moment estimates of the
+ * parameters that have a non-zero gradient.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_OPTIMIZERS_ADAM_LAZY_ADAM_UPDATE_HPP
+#define MLPACK_CORE_OPTIMIZERS_ADAM_LAZY_ADAM_UPDATE_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace optimization {
+
+/**
+ * Lazy Adam is a variant of Adam for sparse gradients.  Given a dense gradient
+ * it performs exactly the Adam update (see AdamUpdate).  Given a sparse
+ * gradient, only the first and second moment estimates of the non-zero entries
+ * of the gradient are updated, and only those parameters are moved; the
+ * moments of all other parameters are left as they are, instead of being
+ * decayed.  This makes each step proportional to the number of non-zero
+ * entries in the gradient, which is useful for models with large embedding
+ * tables of which each batch only uses a few columns (see ann::Lookup).
+ *
+ * When the optimized function can compute sparse gradients, SGD passes them to
+ * this update policy (see UseSparseGradient).
+ */
+class LazyAdamUpdate
+{
+ public:
+  /**
+   * Construct the lazy Adam update policy with the given parameters.
+   *
+   * @param epsilon The epsilon value used to initialise the squared gradient
+   *        parameter.
+   * @param beta1 The smoothing parameter.
+   * @param beta2 The second moment coefficient.
+   */
+  LazyAdamUpdate(const double epsilon = 1e-8,
+                 const double beta1 = 0.9,
+                 const double beta2 = 0.999) :
+    epsilon(epsilon),
+    beta1(beta1),
+    beta2(beta2),
+    iteration(0)
+  {
+    // Nothing to do.
+  }
+
+  /**
+   * The Initialize method is called by SGD Optimizer method before the start of
+   * the iteration update process.
+   *
+   * @param rows Number of rows in the gradient matrix.
+   * @param cols Number of columns in the gradient matrix.
+   */
+  void Initialize(const size_t rows, const size_t cols)
+  {
+    m = arma::zeros<arma::mat>(rows, cols);
+    v = arma::zeros<arma::mat>(rows, cols);
+  }
+
+  /**
+   * Update step for Adam with a dense gradient.
+   *
+   * @param iterate Parameters that minimize the function.
+   * @param stepSize Step size to be used for the given iteration.
+   * @param gradient The gradient matrix.
+   */
+  void Update(arma::mat& iterate,
+              const double stepSize,
+              const arma::mat& gradient)
+  {
+    // Increment the iteration counter variable.
+    ++iteration;
+
+    // And update the iterate.
+    m *= beta1;
+    m += (1 - beta1) * gradient;
+
+    v *= beta2;
+    v += (1 - beta2) * (gradient % gradient);
+
+    const double biasCorrection1 = 1.0 - std::pow(beta1, iteration);
+    const double biasCorrection2 = 1.0 - std::pow(beta2, iteration);
+
+    iterate -= (stepSize * std::sqrt(biasCorrection2) / biasCorrection1) *
+        m / (arma::sqrt(v) + epsilon);
+  }
+
+  /**
+   * Update step for Adam with a sparse gradient.  Only the parameters with a
+   * non-zero gradient are updated.
+   *
+   * @param iterate Parameters that minimize the function.
+   * @param stepSize Step size to be used for the given iteration.
+   * @param gradient The sparse gradient matrix.
+   */
+  void Update(arma::mat& iterate,
+              const double stepSize,
+              const arma::sp_mat& gradient)
+  {
+    // Increment the iteration counter variable.
+    ++iteration;
+
+    const double biasCorrection1 = 1.0 - std::pow(beta1, iteration);
+    const double biasCorrection2 = 1.0 - std::pow(beta2, iteration);
+    const double step = stepSize * std::sqrt(biasCorrection2) /
+        biasCorrection1;
+
+    for (arma::sp_mat::const_iterator it = gradient.begin();
+         it != gradient.end(); ++it)
+    {
+      const size_t row = it.row();
+      const size_t col = it.col();
+      const double g = (*it);
+
+      m(row, col) = beta1 * m(row, col) + (1 - beta1) * g;
+      v(row, col) = beta2 * v(row, col) + (1 - beta2) * g * g;
+      iterate(row, col) -= step * m(row, col) /
+          (std::sqrt(v(row, col)) + epsilon);
+    }
+  }
+
+  //! Get the value used to initialise the squared gradient parameter.
+  double Epsilon() const { return epsilon; }
+  //! Modify the value used to initialise the squared gradient parameter.
+  double& Epsilon() { return epsilon; }
+
+  //! Get the smoothing parameter.
+  double Beta1() const { return beta1; }
+  //! Modify the smoothing parameter.
+  double& Beta1() { return beta1; }
+
+  //! Get the second moment coefficient.
+  double Beta2() const { return beta2; }
+  //! Modify the second moment coefficient.
+  double& Beta2() { return beta2; }
+
+ private:
+  // The epsilon value used to initialise the squared gradient parameter.
+  double epsilon;
+
+  // The smoothing parameter.
+  double beta1;
+
+  // The second moment coefficient.
+  double beta2;
+
+  // The exponential moving average of gradient values.
+  arma::mat m;
+
+  // The exponential moving average of squared gradient values.
+  arma::mat v;
+
+  // The number of iterations.
+  double iteration;
+};
+
+} // namespace optimization
+} // namespace mlpack
+
+#endif
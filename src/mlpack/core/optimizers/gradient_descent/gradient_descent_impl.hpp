@@ -40,6 +40,7 @@ double GradientDescent::Optimize(
       Log::Warn << "Gradient Descent: converged to " << overallObjective
           << "; terminating" << " with failure.  Try a smaller step size?"
           << std::endl;
+      Counter::Add("gradient_descent/iterations", i - 1);
       return overallObjective;
     }
 
@@ -47,6 +48,7 @@ double GradientDescent::Optimize(
     {
       Log::Info << "Gradient Descent: minimized within tolerance "
           << tolerance << "; " << "terminating optimization." << std::endl;
+      Counter::Add("gradient_descent/iterations", i - 1);
       return overallObjective;
     }
 
@@ -64,6 +66,7 @@ double GradientDescent::Optimize(
 
   Log::Info << "Gradient Descent: maximum iterations (" << maxIterations
       << ") reached; " << "terminating optimization." << std::endl;
+  Counter::Add("gradient_descent/iterations", maxIterations - 1);
   return overallObjective;
 }
 
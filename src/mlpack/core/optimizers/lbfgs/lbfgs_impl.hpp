@@ -209,8 +209,8 @@ double L_BFGS::Optimize(FunctionType& function, arma::mat& iterate)
   function.Gradient(iterate, gradient);
 
   // The main optimization loop.
-  for (size_t itNum = 0; optimizeUntilConvergence || (itNum != maxIterations);
-       ++itNum)
+  size_t itNum = 0;
+  for (; optimizeUntilConvergence || (itNum != maxIterations); ++itNum)
   {
     Log::Debug << "L-BFGS iteration " << itNum << "; objective " <<
         function.Evaluate(iterate) << ", gradient norm "
@@ -285,6 +285,8 @@ double L_BFGS::Optimize(FunctionType& function, arma::mat& iterate)
     UpdateBasisSet(itNum, iterate, oldIterate, gradient, oldGradient, s, y);
   } // End of the optimization loop.
 
+  Counter::Add("lbfgs/iterations", itNum);
+
   return function.Evaluate(iterate);
 }
 
@@ -42,6 +42,21 @@ class NoDecay
   {
     // Nothing to do here.
   }
+
+  /**
+   * This function is called in each iteration after the policy update, when
+   * the function is optimized with sparse gradients.
+   *
+   * @param iterate Parameters that minimize the function.
+   * @param stepSize Step size to be used for the given iteration.
+   * @param gradient The sparse gradient matrix.
+   */
+  void Update(arma::mat& /* iterate */,
+              double& /* stepSize */,
+              const arma::sp_mat& /* gradient */)
+  {
+    // Nothing to do here.
+  }
 };
 
 } // namespace optimization
@@ -18,6 +18,7 @@
 #include "update_policies/vanilla_update.hpp"
 #include "update_policies/momentum_update.hpp"
 #include "decay_policies/no_decay.hpp"
+#include "sparse_gradient_traits.hpp"
 
 namespace mlpack {
 namespace optimization {
@@ -72,6 +73,11 @@ namespace optimization {
  * objective function on the first point in the dataset (presumably, the dataset
  * is held internally in the DecomposableFunctionType).
  *
+ * If the function can also compute the gradient of a batch as an arma::sp_mat,
+ * and the update and decay policies accept sparse gradients (see
+ * UseSparseGradient), the sparse gradients are used instead; then only the
+ * parameters touched by each batch are updated.
+ *
  * @tparam UpdatePolicyType update policy used by SGD during the iterative update
  *     process. By default vanilla update policy (see
  *     mlpack::optimization::VanillaUpdate) is used.
@@ -66,8 +66,11 @@ double SGD<UpdatePolicyType, DecayPolicyType>::Optimize(
   if (resetPolicy)
     updatePolicy.Initialize(iterate.n_rows, iterate.n_cols);
 
-  // Now iterate!
-  arma::mat gradient(iterate.n_rows, iterate.n_cols);
+  // Now iterate!  The gradient is sparse if the function and the policies
+  // support it.
+  typename std::conditional<UseSparseGradient<DecomposableFunctionType,
+      UpdatePolicyType, DecayPolicyType>::value, arma::sp_mat,
+      arma::mat>::type gradient(iterate.n_rows, iterate.n_cols);
   const size_t actualMaxIterations = (maxIterations == 0) ?
       std::numeric_limits<size_t>::max() : maxIterations;
   for (size_t i = 0; i < actualMaxIterations; /* incrementing done manually */)
@@ -83,6 +86,7 @@ double SGD<UpdatePolicyType, DecayPolicyType>::Optimize(
       {
         Log::Warn << "SGD: converged to " << overallObjective << "; terminating"
             << " with failure.  Try a smaller step size?" << std::endl;
+        Counter::Add("sgd/iterations", i);
         return overallObjective;
       }
 
@@ -90,6 +94,7 @@ double SGD<UpdatePolicyType, DecayPolicyType>::Optimize(
       {
         Log::Info << "SGD: minimized within tolerance " << tolerance << "; "
             << "terminating optimization." << std::endl;
+        Counter::Add("sgd/iterations", i);
         return overallObjective;
       }
 
@@ -129,6 +134,7 @@ double SGD<UpdatePolicyType, DecayPolicyType>::Optimize(
 
   Log::Info << "SGD: maximum iterations (" << maxIterations << ") reached; "
       << "terminating optimization." << std::endl;
+  Counter::Add("sgd/iterations", actualMaxIterations);
 
   // Calculate final objective.
   overallObjective = 0;
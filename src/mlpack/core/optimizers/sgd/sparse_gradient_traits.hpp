@@ -0,0 +1,65 @@
+/**
+ * @file sparse_gradient_traits.hpp
+ *
+ * Traits that determine whether SGD can optimize a function with sparse
+ * gradients.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_OPTIMIZERS_SGD_SPARSE_GRADIENT_TRAITS_HPP
+#define MLPACK_CORE_OPTIMIZERS_SGD_SPARSE_GRADIENT_TRAITS_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/util/sfinae_utility.hpp>
+
+namespace mlpack {
+namespace optimization {
+
+HAS_MEM_FUNC(Gradient, HasGradientSignature);
+HAS_MEM_FUNC(Update, HasUpdateSignature);
+
+/**
+ * UseSparseGradient::value is true if SGD should optimize the given function
+ * with sparse gradients.  This is the case when the function can compute the
+ * gradient of a batch as a sparse matrix,
+ *
+ *   void Gradient(const arma::mat& coordinates,
+ *                 const size_t i,
+ *                 arma::sp_mat& gradient,
+ *                 const size_t batchSize);
+ *
+ * and both the update policy and the decay policy accept sparse gradients:
+ *
+ *   void Update(arma::mat& iterate,
+ *               const double stepSize,
+ *               const arma::sp_mat& gradient);    // Update policy.
+ *   void Update(arma::mat& iterate,
+ *               double& stepSize,
+ *               const arma::sp_mat& gradient);    // Decay policy.
+ *
+ * Only the non-zero entries of a sparse gradient have to be visited by the
+ * update policy, so functions whose gradients touch few parameters per batch
+ * (like networks with embedding tables) are optimized in time proportional to
+ * the batch size.
+ */
+template<typename FunctionType,
+         typename UpdatePolicyType,
+         typename DecayPolicyType>
+struct UseSparseGradient
+{
+  static const bool value =
+      HasGradientSignature<FunctionType, void(FunctionType::*)(
+          const arma::mat&, const size_t, arma::sp_mat&, const size_t)>::value &&
+      HasUpdateSignature<UpdatePolicyType, void(UpdatePolicyType::*)(
+          arma::mat&, const double, const arma::sp_mat&)>::value &&
+      HasUpdateSignature<DecayPolicyType, void(DecayPolicyType::*)(
+          arma::mat&, double&, const arma::sp_mat&)>::value;
+};
+
+} // namespace optimization
+} // namespace mlpack
+
+#endif
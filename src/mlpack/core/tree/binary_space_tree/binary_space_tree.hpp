@@ -14,7 +14,9 @@
 #include <mlpack/prereqs.hpp>
 
 #include "../statistic.hpp"
+#include "../node_layout.hpp"
 #include "midpoint_split.hpp"
+#include "split_traits.hpp"
 
 namespace mlpack {
 namespace tree /** Trees and tree-building procedures. */ {
@@ -88,6 +90,14 @@ class BinarySpaceTree
   //! The dataset.  If we are the root of the tree, we own the dataset and must
   //! delete it.
   MatType* dataset;
+  //! Whether this node is stored in the node pool of the root, in which case
+  //! it is not deleted on its own.
+  bool pooled;
+  //! If we are the root of a packed tree, the block of memory holding all
+  //! descendants (see PackNodes()); otherwise NULL.
+  BinarySpaceTree* nodePool;
+  //! The layout of the nodes of the tree (only meaningful for the root).
+  NodeLayout nodeLayout;
 
  public:
   //! A single-tree traverser for binary space trees; see
@@ -300,6 +310,25 @@ class BinarySpaceTree
    */
   ~BinarySpaceTree();
 
+  /**
+   * Move the descendants of this node into one contiguous block of memory, in
+   * the order of the given layout.  Traversals then touch nearby memory, and
+   * the tree is destroyed without freeing every node on its own.  With
+   * SEPARATE_LAYOUT, every node is allocated on its own again.  This can only
+   * be called on the root of the tree.
+   *
+   * Pointers to the descendants of the root are invalidated, and the
+   * statistics of all nodes are rebuilt.  The layout is kept when the tree is
+   * copied or serialized.  Nodes of a packed tree must not be deleted on their
+   * own.
+   *
+   * @param layout Layout of the nodes.
+   */
+  void PackNodes(const NodeLayout layout = BREADTH_FIRST_LAYOUT);
+
+  //! Get the layout of the nodes of the tree (only meaningful for the root).
+  NodeLayout Layout() const { return nodeLayout; }
+
   //! Return the bound object for this node.
   const BoundType<MetricType>& Bound() const { return bound; }
   //! Return the bound object for this node.
@@ -514,6 +543,26 @@ class BinarySpaceTree
                  const size_t maxLeafSize,
                  SplitType<BoundType<MetricType>, MatType>& splitter);
 
+  /**
+   * Create the children of the current node, which hold the points in
+   * [begin, splitCol) and [splitCol, begin + count).  If the split policy
+   * allows it (see SplitTraits) and the node holds at least
+   * ParallelBuildMinCount points, the two subtrees are built in parallel.
+   *
+   * @param splitCol Index of the first point of the right child.
+   * @param oldFromNew Vector holding permuted indices, or NULL if the indices
+   *     are not tracked.
+   * @param maxLeafSize Maximum number of points held in a leaf.
+   * @param splitter Instantiated SplitType object.
+   */
+  void CreateChildren(const size_t splitCol,
+                      std::vector<size_t>* oldFromNew,
+                      const size_t maxLeafSize,
+                      SplitType<BoundType<MetricType>, MatType>& splitter);
+
+  //! Nodes with at least this many points build their subtrees in parallel.
+  static const size_t ParallelBuildMinCount = 10000;
+
   /**
    * Update the bound of the current node. This method does not take into
    * account bound-specific properties.
@@ -554,6 +603,29 @@ class BinarySpaceTree
 } // namespace tree
 } // namespace mlpack
 
+//! Set the serialization version of the BinarySpaceTree class.  This is
+//! BOOST_TEMPLATE_CLASS_VERSION() written out, since the template signature
+//! has too many commas to be passed to the macro.
+namespace boost {
+namespace serialization {
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+struct version<mlpack::tree::BinarySpaceTree<MetricType, StatisticType,
+    MatType, BoundType, SplitType>>
+{
+  typedef mpl::int_<1> type;
+  typedef mpl::integral_c_tag tag;
+  BOOST_STATIC_CONSTANT(int, value = version::type::value);
+};
+
+} // namespace serialization
+} // namespace boost
+
 // Include implementation.
 #include "binary_space_tree_impl.hpp"
 
@@ -17,6 +17,11 @@
 #include <mlpack/core/util/cli.hpp>
 #include <mlpack/core/util/log.hpp>
 #include <queue>
+#include <unordered_map>
+
+#ifdef HAS_OPENMP
+  #include <omp.h>
+#endif
 
 namespace mlpack {
 namespace tree {
@@ -40,7 +45,10 @@ BinarySpaceTree(
     count(data.n_cols), /* and spans all of the dataset. */
     bound(data.n_rows),
     parentDistance(0), // Parent distance for the root is 0: it has no parent.
-    dataset(new MatType(data)) // Copies the dataset.
+    dataset(new MatType(data)), // Copies the dataset.
+    pooled(false),
+    nodePool(NULL),
+    nodeLayout(SEPARATE_LAYOUT)
 {
   // Do the actual splitting of this node.
   SplitType<BoundType<MetricType>, MatType> splitter;
@@ -68,7 +76,10 @@ BinarySpaceTree(
     count(data.n_cols),
     bound(data.n_rows),
     parentDistance(0), // Parent distance for the root is 0: it has no parent.
-    dataset(new MatType(data)) // Copies the dataset.
+    dataset(new MatType(data)), // Copies the dataset.
+    pooled(false),
+    nodePool(NULL),
+    nodeLayout(SEPARATE_LAYOUT)
 {
   // Initialize oldFromNew correctly.
   oldFromNew.resize(data.n_cols);
@@ -102,7 +113,10 @@ BinarySpaceTree(
     count(data.n_cols),
     bound(data.n_rows),
     parentDistance(0), // Parent distance for the root is 0: it has no parent.
-    dataset(new MatType(data)) // Copies the dataset.
+    dataset(new MatType(data)), // Copies the dataset.
+    pooled(false),
+    nodePool(NULL),
+    nodeLayout(SEPARATE_LAYOUT)
 {
   // Initialize the oldFromNew vector correctly.
   oldFromNew.resize(data.n_cols);
@@ -137,7 +151,10 @@ BinarySpaceTree(MatType&& data, const size_t maxLeafSize) :
     count(data.n_cols),
     bound(data.n_rows),
     parentDistance(0), // Parent distance for the root is 0: it has no parent.
-    dataset(new MatType(std::move(data)))
+    dataset(new MatType(std::move(data))),
+    pooled(false),
+    nodePool(NULL),
+    nodeLayout(SEPARATE_LAYOUT)
 {
   // Do the actual splitting of this node.
   SplitType<BoundType<MetricType>, MatType> splitter;
@@ -165,7 +182,10 @@ BinarySpaceTree(
     count(data.n_cols),
     bound(data.n_rows),
     parentDistance(0), // Parent distance for the root is 0: it has no parent.
-    dataset(new MatType(std::move(data)))
+    dataset(new MatType(std::move(data))),
+    pooled(false),
+    nodePool(NULL),
+    nodeLayout(SEPARATE_LAYOUT)
 {
   // Initialize oldFromNew correctly.
   oldFromNew.resize(dataset->n_cols);
@@ -199,7 +219,10 @@ BinarySpaceTree(
     count(data.n_cols),
     bound(data.n_rows),
     parentDistance(0), // Parent distance for the root is 0: it has no parent.
-    dataset(new MatType(std::move(data)))
+    dataset(new MatType(std::move(data))),
+    pooled(false),
+    nodePool(NULL),
+    nodeLayout(SEPARATE_LAYOUT)
 {
   // Initialize the oldFromNew vector correctly.
   oldFromNew.resize(dataset->n_cols);
@@ -238,7 +261,10 @@ BinarySpaceTree(
     begin(begin),
     count(count),
     bound(parent->Dataset().n_rows),
-    dataset(&parent->Dataset()) // Point to the parent's dataset.
+    dataset(&parent->Dataset()), // Point to the parent's dataset.
+    pooled(false),
+    nodePool(NULL),
+    nodeLayout(SEPARATE_LAYOUT)
 {
   // Perform the actual splitting.
   SplitNode(maxLeafSize, splitter);
@@ -267,7 +293,10 @@ BinarySpaceTree(
     begin(begin),
     count(count),
     bound(parent->Dataset().n_rows),
-    dataset(&parent->Dataset())
+    dataset(&parent->Dataset()),
+    pooled(false),
+    nodePool(NULL),
+    nodeLayout(SEPARATE_LAYOUT)
 {
   // Hopefully the vector is initialized correctly!  We can't check that
   // entirely but we can do a minor sanity check.
@@ -301,7 +330,10 @@ BinarySpaceTree(
     begin(begin),
     count(count),
     bound(parent->Dataset()->n_rows),
-    dataset(&parent->Dataset())
+    dataset(&parent->Dataset()),
+    pooled(false),
+    nodePool(NULL),
+    nodeLayout(SEPARATE_LAYOUT)
 {
   // Hopefully the vector is initialized correctly!  We can't check that
   // entirely but we can do a minor sanity check.
@@ -342,7 +374,10 @@ BinarySpaceTree(
     parentDistance(other.parentDistance),
     furthestDescendantDistance(other.furthestDescendantDistance),
     // Copy matrix, but only if we are the root.
-    dataset((other.parent == NULL) ? new MatType(*other.dataset) : NULL)
+    dataset((other.parent == NULL) ? new MatType(*other.dataset) : NULL),
+    pooled(false),
+    nodePool(NULL),
+    nodeLayout(SEPARATE_LAYOUT)
 {
   // Create left and right children (if any).
   if (other.Left())
@@ -376,6 +411,10 @@ BinarySpaceTree(
       if (node->right)
         queue.push(node->right);
     }
+
+    // Lay the copied nodes out like the nodes of the other tree.
+    if (other.nodeLayout != SEPARATE_LAYOUT)
+      PackNodes(other.nodeLayout);
   }
 }
 
@@ -400,7 +439,10 @@ BinarySpaceTree(BinarySpaceTree&& other) :
     parentDistance(other.parentDistance),
     furthestDescendantDistance(other.furthestDescendantDistance),
     minimumBoundDistance(other.minimumBoundDistance),
-    dataset(other.dataset)
+    dataset(other.dataset),
+    pooled(false),
+    nodePool(other.nodePool),
+    nodeLayout(other.nodeLayout)
 {
   // Now we are a clone of the other tree.  But we must also clear the other
   // tree's contents, so it doesn't delete anything when it is destructed.
@@ -412,6 +454,8 @@ BinarySpaceTree(BinarySpaceTree&& other) :
   other.furthestDescendantDistance = 0.0;
   other.minimumBoundDistance = 0.0;
   other.dataset = NULL;
+  other.nodePool = NULL;
+  other.nodeLayout = SEPARATE_LAYOUT;
 
   // Set new parent.
   if (left)
@@ -455,12 +499,97 @@ template<typename MetricType,
 BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
     ~BinarySpaceTree()
 {
-  delete left;
-  delete right;
+  // Children in the node pool are only destructed here; the pool itself is
+  // freed by the root.
+  if (left && left->pooled)
+    left->~BinarySpaceTree();
+  else
+    delete left;
 
-  // If we're the root, delete the matrix.
+  if (right && right->pooled)
+    right->~BinarySpaceTree();
+  else
+    delete right;
+
+  // If we're the root, delete the matrix and the node pool.
   if (!parent)
+  {
     delete dataset;
+    ::operator delete(nodePool);
+  }
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+PackNodes(const NodeLayout layout)
+{
+  if (parent != NULL)
+  {
+    throw std::invalid_argument("BinarySpaceTree::PackNodes(): only the root "
+        "of a tree can be packed!");
+  }
+
+  // Find the order of the nodes.  The root stays where it is.
+  std::vector<BinarySpaceTree*> nodes;
+  LayoutNodes(*this, layout, nodes);
+
+  BinarySpaceTree* oldPool = nodePool;
+  nodePool = NULL;
+  if (layout != SEPARATE_LAYOUT && nodes.size() > 1)
+  {
+    nodePool = static_cast<BinarySpaceTree*>(::operator new(
+        (nodes.size() - 1) * sizeof(BinarySpaceTree)));
+  }
+
+  // Move every node to its new place, and release the old one.  The move
+  // constructor leaves the old node without children, so destroying it
+  // doesn't touch the rest of the tree.
+  std::unordered_map<BinarySpaceTree*, BinarySpaceTree*> newNodes;
+  newNodes[this] = this;
+  for (size_t i = 1; i < nodes.size(); ++i)
+  {
+    BinarySpaceTree* node = nodes[i];
+    BinarySpaceTree* newNode = (nodePool == NULL) ?
+        new BinarySpaceTree(std::move(*node)) :
+        new (nodePool + (i - 1)) BinarySpaceTree(std::move(*node));
+    newNode->pooled = (nodePool != NULL);
+    newNodes[node] = newNode;
+
+    if (node->pooled)
+      node->~BinarySpaceTree();
+    else
+      delete node;
+  }
+  ::operator delete(oldPool);
+
+  // Now point every node to the new places of its children, and the children
+  // back to it.  Parents come before their children in every layout, so the
+  // child pointers of a node are not updated yet when it is visited.
+  for (size_t i = 0; i < nodes.size(); ++i)
+  {
+    BinarySpaceTree* node = newNodes[nodes[i]];
+    if (node->left)
+    {
+      node->left = newNodes[node->left];
+      node->left->parent = node;
+    }
+    if (node->right)
+    {
+      node->right = newNodes[node->right];
+      node->right->parent = node;
+    }
+  }
+  nodeLayout = layout;
+
+  // Statistics may hold pointers to nodes, so rebuild them, children first.
+  LayoutNodes(*this, BREADTH_FIRST_LAYOUT, nodes);
+  for (size_t i = nodes.size(); i > 0; --i)
+    nodes[i - 1]->stat = StatisticType(*nodes[i - 1]);
 }
 
 template<typename MetricType,
@@ -783,10 +912,7 @@ void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
 
   // Now that we know the split column, we will recursively split the children
   // by calling their constructors (which perform this splitting process).
-  left = new BinarySpaceTree(this, begin, splitCol - begin, splitter,
-      maxLeafSize);
-  right = new BinarySpaceTree(this, splitCol, begin + count - splitCol,
-      splitter, maxLeafSize);
+  CreateChildren(splitCol, NULL, maxLeafSize, splitter);
 
   // Calculate parent distances for those two nodes.
   arma::vec center, leftCenter, rightCenter;
@@ -850,10 +976,7 @@ SplitNode(std::vector<size_t>& oldFromNew,
 
   // Now that we know the split column, we will recursively split the children
   // by calling their constructors (which perform this splitting process).
-  left = new BinarySpaceTree(this, begin, splitCol - begin, oldFromNew,
-      splitter, maxLeafSize);
-  right = new BinarySpaceTree(this, splitCol, begin + count - splitCol,
-      oldFromNew, splitter, maxLeafSize);
+  CreateChildren(splitCol, &oldFromNew, maxLeafSize, splitter);
 
   // Calculate parent distances for those two nodes.
   arma::vec center, leftCenter, rightCenter;
@@ -869,6 +992,81 @@ SplitNode(std::vector<size_t>& oldFromNew,
   right->ParentDistance() = rightParentDistance;
 }
 
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+CreateChildren(const size_t splitCol,
+               std::vector<size_t>* oldFromNew,
+               const size_t maxLeafSize,
+               SplitType<BoundType<MetricType>, MatType>& splitter)
+{
+  // The two subtrees hold different columns of the dataset (and different
+  // entries of oldFromNew), so they can be built at the same time.  The split
+  // policy has to allow that, since both subtrees use the same splitter.  The
+  // tree is then exactly the same as the one that is built serially.  (Tasks
+  // are only available since OpenMP 3.0.)
+#if defined(HAS_OPENMP) && (_OPENMP >= 200805)
+  if (SplitTraits<Split>::ParallelSplit && count >= ParallelBuildMinCount)
+  {
+    if (omp_get_level() == 0)
+    {
+      if (omp_get_max_threads() > 1)
+      {
+        // Start the threads that the subtrees below will be built with.
+        #pragma omp parallel
+        {
+          #pragma omp single
+          CreateChildren(splitCol, oldFromNew, maxLeafSize, splitter);
+        }
+        return;
+      }
+    }
+    else
+    {
+      Split* splitterPtr = &splitter;
+
+      // Build the left subtree in a task, and the right one in this thread.
+      #pragma omp task
+      {
+        left = (oldFromNew == NULL) ?
+            new BinarySpaceTree(this, begin, splitCol - begin, *splitterPtr,
+                maxLeafSize) :
+            new BinarySpaceTree(this, begin, splitCol - begin, *oldFromNew,
+                *splitterPtr, maxLeafSize);
+      }
+
+      right = (oldFromNew == NULL) ?
+          new BinarySpaceTree(this, splitCol, begin + count - splitCol,
+              splitter, maxLeafSize) :
+          new BinarySpaceTree(this, splitCol, begin + count - splitCol,
+              *oldFromNew, splitter, maxLeafSize);
+
+      #pragma omp taskwait
+      return;
+    }
+  }
+#endif
+
+  if (oldFromNew == NULL)
+  {
+    left = new BinarySpaceTree(this, begin, splitCol - begin, splitter,
+        maxLeafSize);
+    right = new BinarySpaceTree(this, splitCol, begin + count - splitCol,
+        splitter, maxLeafSize);
+  }
+  else
+  {
+    left = new BinarySpaceTree(this, begin, splitCol - begin, *oldFromNew,
+        splitter, maxLeafSize);
+    right = new BinarySpaceTree(this, splitCol, begin + count - splitCol,
+        *oldFromNew, splitter, maxLeafSize);
+  }
+}
+
 template<typename MetricType,
          typename StatisticType,
          typename MatType,
@@ -926,7 +1124,10 @@ BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
     stat(*this),
     parentDistance(0),
     furthestDescendantDistance(0),
-    dataset(NULL)
+    dataset(NULL),
+    pooled(false),
+    nodePool(NULL),
+    nodeLayout(SEPARATE_LAYOUT)
 {
   // Nothing to do.
 }
@@ -942,17 +1143,25 @@ template<typename MetricType,
              class SplitType>
 template<typename Archive>
 void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
-    serialize(Archive& ar, const unsigned int /* version */)
+    serialize(Archive& ar, const unsigned int version)
 {
   // If we're loading, and we have children, they need to be deleted.
   if (Archive::is_loading::value)
   {
-    if (left)
+    if (left && left->pooled)
+      left->~BinarySpaceTree();
+    else if (left)
       delete left;
-    if (right)
+    if (right && right->pooled)
+      right->~BinarySpaceTree();
+    else if (right)
       delete right;
     if (!parent)
+    {
       delete dataset;
+      ::operator delete(nodePool);
+      nodePool = NULL;
+    }
   }
 
   ar & BOOST_SERIALIZATION_NVP(begin);
@@ -964,9 +1173,20 @@ void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
   ar & BOOST_SERIALIZATION_NVP(furthestDescendantDistance);
   ar & BOOST_SERIALIZATION_NVP(dataset);
 
+  // Older versions did not store the layout of the nodes.
+  if (version > 0)
+    ar & BOOST_SERIALIZATION_NVP(nodeLayout);
+  else if (Archive::is_loading::value)
+    nodeLayout = SEPARATE_LAYOUT;
+
   // Save children last; otherwise boost::serialization gets confused.
   ar & BOOST_SERIALIZATION_NVP(left);
   ar & BOOST_SERIALIZATION_NVP(right);
+
+  // The loaded nodes are allocated on their own, so pack them again.
+  if (Archive::is_loading::value && !parent &&
+      nodeLayout != SEPARATE_LAYOUT)
+    PackNodes(nodeLayout);
 }
 
 } // namespace tree
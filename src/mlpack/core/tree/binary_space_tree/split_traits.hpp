@@ -0,0 +1,61 @@
+/**
+ * @file split_traits.hpp
+ *
+ * The SplitTraits class, which describes the properties of a split policy for
+ * the BinarySpaceTree, and its specializations for the split policies that
+ * allow the subtrees to be built in parallel.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_BINARY_SPACE_TREE_SPLIT_TRAITS_HPP
+#define MLPACK_CORE_TREE_BINARY_SPACE_TREE_SPLIT_TRAITS_HPP
+
+#include "midpoint_split.hpp"
+#include "mean_split.hpp"
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * The SplitTraits class describes a split policy of the BinarySpaceTree.  By
+ * default nothing is assumed about the split policy; specialize this class to
+ * declare the properties of a new split policy.
+ */
+template<typename SplitType>
+class SplitTraits
+{
+ public:
+  /**
+   * This is true if SplitNode() may be called for several nodes at the same
+   * time, and if the split of a node does not depend on the order in which the
+   * other nodes were split.  Only then are the two subtrees of a large node
+   * built in parallel.  This is false for split policies that draw random
+   * numbers (the random number generator is shared) or that keep state between
+   * calls.
+   */
+  static const bool ParallelSplit = false;
+};
+
+//! MidpointSplit only depends on the points of the node.
+template<typename BoundType, typename MatType>
+class SplitTraits<MidpointSplit<BoundType, MatType>>
+{
+ public:
+  static const bool ParallelSplit = true;
+};
+
+//! MeanSplit only depends on the points of the node.
+template<typename BoundType, typename MatType>
+class SplitTraits<MeanSplit<BoundType, MatType>>
+{
+ public:
+  static const bool ParallelSplit = true;
+};
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
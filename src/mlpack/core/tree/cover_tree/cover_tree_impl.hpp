@@ -1241,12 +1241,32 @@ void CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::
                      const size_t pointSetSize)
 {
   // For each point, rebuild the distances.  The indices do not need to be
-  // modified.
+  // modified.  Near the top of the tree the point sets are large and these
+  // distances dominate the construction time, so they are computed in
+  // parallel; the small point sets further down are not worth the overhead.
   distanceComps += pointSetSize;
-  for (size_t i = 0; i < pointSetSize; ++i)
+  if (pointSetSize < 1000)
   {
-    distances[i] = metric->Evaluate(dataset->col(pointIndex),
-        dataset->col(indices[i]));
+    for (size_t i = 0; i < pointSetSize; ++i)
+    {
+      distances[i] = metric->Evaluate(dataset->col(pointIndex),
+          dataset->col(indices[i]));
+    }
+
+    return;
+  }
+
+  #pragma omp parallel
+  {
+    // Some metrics are not safe to evaluate concurrently.
+    MetricType threadMetric(*metric);
+
+    #pragma omp for
+    for (omp_size_t i = 0; i < (omp_size_t) pointSetSize; ++i)
+    {
+      distances[i] = threadMetric.Evaluate(dataset->col(pointIndex),
+          dataset->col(indices[i]));
+    }
   }
 }
 
@@ -14,6 +14,7 @@
 
 #include <mlpack/prereqs.hpp>
 #include <queue>
+#include <algorithm>
 
 namespace mlpack {
 namespace tree {
@@ -83,23 +84,72 @@ class CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::
     }
   };
 
+  /**
+   * The reference nodes under consideration for a query node, grouped by
+   * scale.  Only a few distinct scales are alive at any time, so the scales
+   * and their entries are kept in two vectors sorted by increasing scale.
+   * This is cheaper to build, search and destroy than a std::map, which is
+   * done once for every query node.
+   */
+  class ScaleMap
+  {
+   public:
+    //! Return whether there are no scales in the map.
+    bool Empty() const { return scales.empty(); }
+    //! Return the number of scales in the map.
+    size_t NumScales() const { return scales.size(); }
+
+    //! Get the i'th smallest scale.
+    int Scale(const size_t i) const { return scales[i]; }
+    //! Modify the entries of the i'th smallest scale.
+    std::vector<DualCoverTreeMapEntry>& Entries(const size_t i)
+    { return entries[i]; }
+
+    //! Get the smallest scale.
+    int MinScale() const { return scales.front(); }
+    //! Get the largest scale.
+    int MaxScale() const { return scales.back(); }
+
+    //! Get the entries at the given scale, adding the scale if necessary.
+    std::vector<DualCoverTreeMapEntry>& operator[](const int scale)
+    {
+      const size_t i = std::lower_bound(scales.begin(), scales.end(), scale) -
+          scales.begin();
+      if (i == scales.size() || scales[i] != scale)
+      {
+        scales.insert(scales.begin() + i, scale);
+        entries.insert(entries.begin() + i,
+            std::vector<DualCoverTreeMapEntry>());
+      }
+
+      return entries[i];
+    }
+
+    //! Remove the i'th smallest scale.
+    void Erase(const size_t i)
+    {
+      scales.erase(scales.begin() + i);
+      entries.erase(entries.begin() + i);
+    }
+
+   private:
+    //! The scales, in increasing order.
+    std::vector<int> scales;
+    //! The entries of each scale.
+    std::vector<std::vector<DualCoverTreeMapEntry>> entries;
+  };
+
   /**
    * Helper function for traversal of the two trees.
    */
-  void Traverse(CoverTree& queryNode,
-                std::map<int, std::vector<DualCoverTreeMapEntry> >&
-                    referenceMap);
+  void Traverse(CoverTree& queryNode, ScaleMap& referenceMap);
 
   //! Prepare map for recursion.
   void PruneMap(CoverTree& queryNode,
-                std::map<int, std::vector<DualCoverTreeMapEntry> >&
-                    referenceMap,
-                std::map<int, std::vector<DualCoverTreeMapEntry> >&
-                    childMap);
-
-  void ReferenceRecursion(CoverTree& queryNode,
-                          std::map<int, std::vector<DualCoverTreeMapEntry> >&
-                              referenceMap);
+                ScaleMap& referenceMap,
+                ScaleMap& childMap);
+
+  void ReferenceRecursion(CoverTree& queryNode, ScaleMap& referenceMap);
 };
 
 } // namespace tree
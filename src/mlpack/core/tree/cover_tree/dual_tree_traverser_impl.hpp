@@ -43,7 +43,7 @@ DualTreeTraverser<RuleType>::Traverse(CoverTree& queryNode,
                                       CoverTree& referenceNode)
 {
   // Start by creating a map and adding the reference root node to it.
-  std::map<int, std::vector<DualCoverTreeMapEntry> > refMap;
+  ScaleMap refMap;
 
   DualCoverTreeMapEntry rootRefEntry;
 
@@ -68,24 +68,23 @@ template<
 >
 template<typename RuleType>
 void CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::
-DualTreeTraverser<RuleType>::Traverse(
-    CoverTree& queryNode,
-    std::map<int, std::vector<DualCoverTreeMapEntry> >& referenceMap)
+DualTreeTraverser<RuleType>::Traverse(CoverTree& queryNode,
+                                      ScaleMap& referenceMap)
 {
-  if (referenceMap.size() == 0)
+  if (referenceMap.Empty())
     return; // Nothing to do!
 
   // First recurse down the reference nodes as necessary.
   ReferenceRecursion(queryNode, referenceMap);
 
   // Did the map get emptied?
-  if (referenceMap.size() == 0)
+  if (referenceMap.Empty())
     return; // Nothing to do!
 
   // Now, reduce the scale of the query node by recursing.  But we can't recurse
   // if the query node is a leaf node.
   if ((queryNode.Scale() != INT_MIN) &&
-      (queryNode.Scale() >= (*referenceMap.rbegin()).first))
+      (queryNode.Scale() >= referenceMap.MaxScale()))
   {
     // Recurse into the non-self-children first.  The recursion order cannot
     // affect the runtime of the algorithm, because each query child recursion's
@@ -95,11 +94,11 @@ DualTreeTraverser<RuleType>::Traverse(
     for (size_t i = 1; i < queryNode.NumChildren(); ++i)
     {
       // We need a copy of the map for this child.
-      std::map<int, std::vector<DualCoverTreeMapEntry> > childMap;
+      ScaleMap childMap;
       PruneMap(queryNode.Child(i), referenceMap, childMap);
       Traverse(queryNode.Child(i), childMap);
     }
-    std::map<int, std::vector<DualCoverTreeMapEntry> > selfChildMap;
+    ScaleMap selfChildMap;
     PruneMap(queryNode.Child(0), referenceMap, selfChildMap);
     Traverse(queryNode.Child(0), selfChildMap);
   }
@@ -109,10 +108,9 @@ DualTreeTraverser<RuleType>::Traverse(
 
   // If we have made it this far, all we have is a bunch of base case
   // evaluations to do.
-  Log::Assert((*referenceMap.begin()).first == INT_MIN);
+  Log::Assert(referenceMap.MinScale() == INT_MIN);
   Log::Assert(queryNode.Scale() == INT_MIN);
-  std::vector<DualCoverTreeMapEntry>& pointVector =
-      (*referenceMap.begin()).second;
+  std::vector<DualCoverTreeMapEntry>& pointVector = referenceMap.Entries(0);
 
   for (size_t i = 0; i < pointVector.size(); ++i)
   {
@@ -156,78 +154,29 @@ template<typename RuleType>
 void CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::
 DualTreeTraverser<RuleType>::PruneMap(
     CoverTree& queryNode,
-    std::map<int, std::vector<DualCoverTreeMapEntry> >& referenceMap,
-    std::map<int, std::vector<DualCoverTreeMapEntry> >& childMap)
+    ScaleMap& referenceMap,
+    ScaleMap& childMap)
 {
-  if (referenceMap.empty())
+  if (referenceMap.Empty())
     return; // Nothing to do.
 
-  // Copy the zero set first.
-  if ((*referenceMap.begin()).first == INT_MIN)
-  {
-    // Get a reference to the vector representing the entries at this scale.
-    std::vector<DualCoverTreeMapEntry>& scaleVector =
-        (*referenceMap.begin()).second;
-
-    // Before traversing all the points in this scale, sort by score.
-    std::sort(scaleVector.begin(), scaleVector.end());
-
-    const int thisScale = (*referenceMap.begin()).first;
-    childMap[thisScale].reserve(scaleVector.size());
-    std::vector<DualCoverTreeMapEntry>& newScaleVector = childMap[thisScale];
-
-    // Loop over each entry in the vector.
-    for (size_t j = 0; j < scaleVector.size(); ++j)
-    {
-      const DualCoverTreeMapEntry& frame = scaleVector[j];
-
-      // First evaluate if we can prune without performing the base case.
-      CoverTree* refNode = frame.referenceNode;
-
-      // Perform the actual scoring, after restoring the traversal info.
-      rule.TraversalInfo() = frame.traversalInfo;
-      double score = rule.Score(queryNode, *refNode);
-
-      if (score == DBL_MAX)
-      {
-        // Pruned.  Move on.
-        ++numPrunes;
-        continue;
-      }
-
-      // If it isn't pruned, we must evaluate the base case.
-      const double baseCase = rule.BaseCase(queryNode.Point(),
-          refNode->Point());
-
-      // Add to child map.
-      newScaleVector.push_back(frame);
-      newScaleVector.back().score = score;
-      newScaleVector.back().baseCase = baseCase;
-      newScaleVector.back().traversalInfo = rule.TraversalInfo();
-    }
-
-    // If we didn't add anything, then strike this vector from the map.
-    if (newScaleVector.size() == 0)
-      childMap.erase((*referenceMap.begin()).first);
-  }
-
-  typename std::map<int, std::vector<DualCoverTreeMapEntry> >::reverse_iterator
-      it = referenceMap.rbegin();
-
-  while ((it != referenceMap.rend()))
+  // Copy the zero set first, and then the other scales from the largest to the
+  // smallest.
+  const size_t numScales = referenceMap.NumScales();
+  const size_t firstScale = (referenceMap.MinScale() == INT_MIN) ? 1 : 0;
+  for (size_t k = 0; k < numScales; ++k)
   {
-    const int thisScale = (*it).first;
-    if (thisScale == INT_MIN) // We already did it.
-      break;
+    const size_t i = (k < firstScale) ? 0 : numScales - 1 - (k - firstScale);
+    const int thisScale = referenceMap.Scale(i);
 
     // Get a reference to the vector representing the entries at this scale.
-    std::vector<DualCoverTreeMapEntry>& scaleVector = (*it).second;
+    std::vector<DualCoverTreeMapEntry>& scaleVector = referenceMap.Entries(i);
 
     // Before traversing all the points in this scale, sort by score.
     std::sort(scaleVector.begin(), scaleVector.end());
 
-    childMap[thisScale].reserve(scaleVector.size());
-    std::vector<DualCoverTreeMapEntry>& newScaleVector = childMap[thisScale];
+    std::vector<DualCoverTreeMapEntry> newScaleVector;
+    newScaleVector.reserve(scaleVector.size());
 
     // Loop over each entry in the vector.
     for (size_t j = 0; j < scaleVector.size(); ++j)
@@ -259,11 +208,9 @@ DualTreeTraverser<RuleType>::PruneMap(
       newScaleVector.back().traversalInfo = rule.TraversalInfo();
     }
 
-    // If we didn't add anything, then strike this vector from the map.
-    if (newScaleVector.size() == 0)
-      childMap.erase((*it).first);
-
-    ++it; // Advance to next scale.
+    // Only add this scale to the child map if anything is left in it.
+    if (!newScaleVector.empty())
+      childMap[thisScale] = std::move(newScaleVector);
   }
 }
 
@@ -275,30 +222,33 @@ template<
 >
 template<typename RuleType>
 void CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::
-DualTreeTraverser<RuleType>::ReferenceRecursion(
-    CoverTree& queryNode,
-    std::map<int, std::vector<DualCoverTreeMapEntry> >& referenceMap)
+DualTreeTraverser<RuleType>::ReferenceRecursion(CoverTree& queryNode,
+                                                ScaleMap& referenceMap)
 {
   // First, reduce the maximum scale in the reference map down to the scale of
   // the query node.
-  while (!referenceMap.empty())
+  while (!referenceMap.Empty())
   {
     // Hacky bullshit to imitate jl cover tree.
-    if (queryNode.Parent() == NULL && (*referenceMap.rbegin()).first <
+    if (queryNode.Parent() == NULL && referenceMap.MaxScale() <
         queryNode.Scale())
       break;
-    if (queryNode.Parent() != NULL && (*referenceMap.rbegin()).first <=
+    if (queryNode.Parent() != NULL && referenceMap.MaxScale() <=
         queryNode.Scale())
       break;
     // If the query node's scale is INT_MIN and the reference map's maximum
     // scale is INT_MIN, don't try to recurse...
     if ((queryNode.Scale() == INT_MIN) &&
-       ((*referenceMap.rbegin()).first == INT_MIN))
+       (referenceMap.MaxScale() == INT_MIN))
       break;
 
-    // Get a reference to the current largest scale.
-    std::vector<DualCoverTreeMapEntry>& scaleVector =
-        (*referenceMap.rbegin()).second;
+    // Take the entries of the current largest scale out of the map; the
+    // children added below have smaller scales, and adding them may move the
+    // entries of the map around.
+    const size_t maxIndex = referenceMap.NumScales() - 1;
+    std::vector<DualCoverTreeMapEntry> scaleVector(
+        std::move(referenceMap.Entries(maxIndex)));
+    referenceMap.Erase(maxIndex);
 
     // Before traversing all the points in this scale, sort by score.
     std::sort(scaleVector.begin(), scaleVector.end());
@@ -348,9 +298,6 @@ DualTreeTraverser<RuleType>::ReferenceRecursion(
         referenceMap[newFrame.referenceNode->Scale()].push_back(newFrame);
       }
     }
-
-    // Now clear the memory for this scale; it isn't needed anymore.
-    referenceMap.erase((*referenceMap.rbegin()).first);
   }
 }
 
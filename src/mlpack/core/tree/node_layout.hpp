@@ -0,0 +1,54 @@
+/**
+ * @file node_layout.hpp
+ *
+ * The NodeLayout enum, which describes how the nodes of a tree are laid out in
+ * memory, and the LayoutNodes() function, which puts the nodes of a tree in the
+ * order of a given layout.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_NODE_LAYOUT_HPP
+#define MLPACK_CORE_TREE_NODE_LAYOUT_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace tree /** Trees and tree-building procedures. */ {
+
+//! NodeLayout represents the ways the nodes of a tree can be stored in memory.
+enum NodeLayout
+{
+  //! Every node is allocated on its own.
+  SEPARATE_LAYOUT,
+  //! The nodes are stored in one block, level by level from the root down.
+  BREADTH_FIRST_LAYOUT,
+  //! The nodes are stored in one block in van Emde Boas order: the top half of
+  //! the levels of the tree comes first, followed by each of the subtrees below
+  //! it, and each of these parts is laid out the same way recursively.
+  VAN_EMDE_BOAS_LAYOUT
+};
+
+/**
+ * Put the nodes of the tree in the order they are stored in with the given
+ * layout.  The root is always the first node.  SEPARATE_LAYOUT gives the
+ * breadth-first order.
+ *
+ * @param root Root of the tree.
+ * @param layout Layout of the nodes.
+ * @param nodes Vector to store the nodes in.
+ */
+template<typename TreeType>
+void LayoutNodes(TreeType& root,
+                 const NodeLayout layout,
+                 std::vector<TreeType*>& nodes);
+
+} // namespace tree
+} // namespace mlpack
+
+// Include implementation.
+#include "node_layout_impl.hpp"
+
+#endif
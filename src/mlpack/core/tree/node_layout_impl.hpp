@@ -0,0 +1,90 @@
+/**
+ * @file node_layout_impl.hpp
+ *
+ * Implementation of LayoutNodes(), which puts the nodes of a tree in the order
+ * of a given layout.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_NODE_LAYOUT_IMPL_HPP
+#define MLPACK_CORE_TREE_NODE_LAYOUT_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "node_layout.hpp"
+
+namespace mlpack {
+namespace tree {
+
+//! Return the number of levels of the subtree rooted at the given node.
+template<typename TreeType>
+size_t NumLevels(TreeType& node)
+{
+  size_t levels = 0;
+  for (size_t i = 0; i < node.NumChildren(); ++i)
+    levels = std::max(levels, NumLevels(node.Child(i)));
+
+  return levels + 1;
+}
+
+//! Append the first given number of levels of the subtree rooted at the given
+//! node in van Emde Boas order.
+template<typename TreeType>
+void VanEmdeBoasOrder(TreeType& node,
+                      const size_t levels,
+                      std::vector<TreeType*>& nodes)
+{
+  if (levels == 1)
+  {
+    nodes.push_back(&node);
+    return;
+  }
+
+  // First the top tree, which holds half of the levels.
+  const size_t topLevels = levels / 2;
+  VanEmdeBoasOrder(node, topLevels, nodes);
+
+  // Then each of the bottom trees, from left to right.  Their roots are the
+  // nodes just below the top tree.
+  std::vector<TreeType*> bottomRoots(1, &node);
+  for (size_t level = 0; level < topLevels; ++level)
+  {
+    std::vector<TreeType*> nextRoots;
+    for (size_t i = 0; i < bottomRoots.size(); ++i)
+      for (size_t j = 0; j < bottomRoots[i]->NumChildren(); ++j)
+        nextRoots.push_back(&bottomRoots[i]->Child(j));
+
+    bottomRoots.swap(nextRoots);
+  }
+
+  for (size_t i = 0; i < bottomRoots.size(); ++i)
+    VanEmdeBoasOrder(*bottomRoots[i], levels - topLevels, nodes);
+}
+
+template<typename TreeType>
+void LayoutNodes(TreeType& root,
+                 const NodeLayout layout,
+                 std::vector<TreeType*>& nodes)
+{
+  nodes.clear();
+
+  if (layout == VAN_EMDE_BOAS_LAYOUT)
+  {
+    VanEmdeBoasOrder(root, NumLevels(root), nodes);
+    return;
+  }
+
+  // The nodes of each level follow the nodes of the previous level, so the
+  // vector itself can be used as the queue.
+  nodes.push_back(&root);
+  for (size_t i = 0; i < nodes.size(); ++i)
+    for (size_t j = 0; j < nodes[i]->NumChildren(); ++j)
+      nodes.push_back(&nodes[i]->Child(j));
+}
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
@@ -425,6 +425,28 @@ class Octree
                  std::vector<size_t>& oldFromNew,
                  const size_t maxLeafSize);
 
+  /**
+   * Create the children of the node once its points have been reordered.  If
+   * the node holds at least ParallelBuildMinCount points, the children are
+   * built in parallel.
+   *
+   * @param childBegins Index of the first point of each child (and one past
+   *     the last point of the node).
+   * @param center Center of the node.
+   * @param width Width of the current node.
+   * @param oldFromNew Mappings from old to new, or NULL if the mappings are not
+   *     tracked.
+   * @param maxLeafSize Maximum number of points allowed in a leaf.
+   */
+  void CreateChildren(const arma::Col<size_t>& childBegins,
+                      const arma::vec& center,
+                      const double width,
+                      std::vector<size_t>* oldFromNew,
+                      const size_t maxLeafSize);
+
+  //! Nodes with at least this many points build their children in parallel.
+  static const size_t ParallelBuildMinCount = 10000;
+
   /**
    * This is used for sorting points while splitting.
    */
@@ -16,6 +16,10 @@
 #include <mlpack/core/tree/perform_split.hpp>
 #include <stack>
 
+#ifdef HAS_OPENMP
+  #include <omp.h>
+#endif
+
 namespace mlpack {
 namespace tree {
 
@@ -735,28 +739,7 @@ void Octree<MetricType, StatisticType, MatType>::SplitNode(
   }
 
   // Now that the dataset is reordered, we can create the children.
-  arma::vec childCenter(center.n_elem);
-  const double childWidth = width / 2.0;
-  for (size_t i = 0; i < childBegins.n_elem - 1; ++i)
-  {
-    // If the child has no points, don't create it.
-    if (childBegins[i + 1] - childBegins[i] == 0)
-      continue;
-
-    // Create the correct center.
-    for (size_t d = 0; d < center.n_elem; ++d)
-    {
-      // Is the dimension "right" (1) or "left" (0)?
-      if (((i >> d) & 1) == 0)
-        childCenter[d] = center[d] - childWidth;
-      else
-        childCenter[d] = center[d] + childWidth;
-    }
-
-    children.push_back(new Octree(this, childBegins[i],
-        childBegins[i + 1] - childBegins[i], childCenter, childWidth,
-        maxLeafSize));
-  }
+  CreateChildren(childBegins, center, width, NULL, maxLeafSize);
 }
 
 //! Split the node, and store mappings.
@@ -837,7 +820,39 @@ void Octree<MetricType, StatisticType, MatType>::SplitNode(
   }
 
   // Now that the dataset is reordered, we can create the children.
-  arma::vec childCenter(center.n_elem);
+  CreateChildren(childBegins, center, width, &oldFromNew, maxLeafSize);
+}
+
+//! Create the children of the node.
+template<typename MetricType, typename StatisticType, typename MatType>
+void Octree<MetricType, StatisticType, MatType>::CreateChildren(
+    const arma::Col<size_t>& childBegins,
+    const arma::vec& center,
+    const double width,
+    std::vector<size_t>* oldFromNew,
+    const size_t maxLeafSize)
+{
+  // The children hold different columns of the dataset (and different entries
+  // of oldFromNew), so the children of a large node can be built at the same
+  // time.  They are added in the same order either way, so the tree is exactly
+  // the same as the one that is built serially.  (Tasks are only available
+  // since OpenMP 3.0.)
+#if defined(HAS_OPENMP) && (_OPENMP >= 200805)
+  const bool parallel = (count >= ParallelBuildMinCount);
+  if (parallel && omp_get_level() == 0 && omp_get_max_threads() > 1)
+  {
+    // Start the threads that the subtrees below will be built with.
+    #pragma omp parallel
+    {
+      #pragma omp single
+      CreateChildren(childBegins, center, width, oldFromNew, maxLeafSize);
+    }
+    return;
+  }
+  const bool useTasks = parallel && (omp_get_level() > 0);
+#endif
+
+  std::vector<Octree*> newChildren(childBegins.n_elem - 1, NULL);
   const double childWidth = width / 2.0;
   for (size_t i = 0; i < childBegins.n_elem - 1; ++i)
   {
@@ -846,6 +861,7 @@ void Octree<MetricType, StatisticType, MatType>::SplitNode(
       continue;
 
     // Create the correct center.
+    arma::vec childCenter(center.n_elem);
     for (size_t d = 0; d < center.n_elem; ++d)
     {
       // Is the dimension "right" (1) or "left" (0)?
@@ -855,10 +871,41 @@ void Octree<MetricType, StatisticType, MatType>::SplitNode(
         childCenter[d] = center[d] + childWidth;
     }
 
-    children.push_back(new Octree(this, childBegins[i],
-        childBegins[i + 1] - childBegins[i], oldFromNew, childCenter,
-        childWidth, maxLeafSize));
+    const size_t childBegin = childBegins[i];
+    const size_t childCount = childBegins[i + 1] - childBegins[i];
+
+#if defined(HAS_OPENMP) && (_OPENMP >= 200805)
+    if (useTasks)
+    {
+      #pragma omp task shared(newChildren) firstprivate(childCenter)
+      {
+        newChildren[i] = (oldFromNew == NULL) ?
+            new Octree(this, childBegin, childCount, childCenter, childWidth,
+                maxLeafSize) :
+            new Octree(this, childBegin, childCount, *oldFromNew,
+                childCenter, childWidth, maxLeafSize);
+      }
+      continue;
+    }
+#endif
+
+    newChildren[i] = (oldFromNew == NULL) ?
+        new Octree(this, childBegin, childCount, childCenter, childWidth,
+            maxLeafSize) :
+        new Octree(this, childBegin, childCount, *oldFromNew, childCenter,
+            childWidth, maxLeafSize);
   }
+
+#if defined(HAS_OPENMP) && (_OPENMP >= 200805)
+  if (useTasks)
+  {
+    #pragma omp taskwait
+  }
+#endif
+
+  for (size_t i = 0; i < newChildren.size(); ++i)
+    if (newChildren[i] != NULL)
+      children.push_back(newChildren[i]);
 }
 
 } // namespace tree
@@ -16,10 +16,94 @@
 #ifndef MLPACK_CORE_TREE_PERFORM_SPLIT_HPP
 #define MLPACK_CORE_TREE_PERFORM_SPLIT_HPP
 
+#ifdef HAS_OPENMP
+  #include <omp.h>
+#endif
+
 namespace mlpack {
 namespace tree /** Trees and tree-building procedures. */ {
 namespace split {
 
+//! Nodes with at least this many points are rearranged in parallel.
+const size_t ParallelSplitMinCount = 50000;
+
+/**
+ * Decide whether PerformSplit() should rearrange a node of the given size in
+ * parallel.  This is only done for dense matrices (sparse matrices can't be
+ * modified from several threads at once) and when we are not already inside a
+ * parallel region, i.e. for the few largest nodes at the top of the tree.
+ *
+ * @param count Number of points in the node.
+ */
+#ifdef HAS_OPENMP
+template<typename MatType>
+inline bool UseParallelSplit(const size_t count)
+{
+  return !arma::is_SpMat<MatType>::value && count >= ParallelSplitMinCount &&
+      omp_get_max_threads() > 1 && !omp_in_parallel();
+}
+#else
+template<typename MatType>
+inline bool UseParallelSplit(const size_t /* count */) { return false; }
+#endif
+
+/**
+ * Rearrange the points of a node in parallel.  The side of every point is
+ * computed in parallel; then the i-th point from the left that belongs to the
+ * right child is swapped with the i-th point from the right that belongs to the
+ * left child.  These are exactly the swaps made by the serial loop below, so
+ * the order of the dataset (and of oldFromNew) is the same as for a serial
+ * split, whatever the number of threads.
+ *
+ * @param data The dataset used by the tree.
+ * @param begin Index of the starting point in the dataset that belongs to
+ *    this node.
+ * @param count Number of points in this node.
+ * @param splitInfo The information about the split.
+ * @param oldFromNew If not NULL, the mappings to update with every swap.
+ */
+template<typename MatType, typename SplitType>
+size_t ParallelPerformSplit(MatType& data,
+                            const size_t begin,
+                            const size_t count,
+                            const typename SplitType::SplitInfo& splitInfo,
+                            std::vector<size_t>* oldFromNew)
+{
+  // Find the side of every point.
+  std::vector<char> assignLeft(count);
+  size_t numLeft = 0;
+
+  #pragma omp parallel for schedule(static) reduction(+:numLeft)
+  for (omp_size_t i = 0; i < (omp_size_t) count; ++i)
+  {
+    assignLeft[i] = SplitType::AssignToLeftNode(data.col(begin + i),
+        splitInfo) ? 1 : 0;
+    numLeft += assignLeft[i];
+  }
+
+  // Collect the points that are on the wrong side of the split column.  There
+  // are as many of them on the left as there are on the right.
+  std::vector<size_t> wrongLeft, wrongRight;
+  for (size_t i = 0; i < numLeft; ++i)
+    if (!assignLeft[i])
+      wrongLeft.push_back(begin + i);
+  for (size_t i = count; i > numLeft; --i)
+    if (assignLeft[i - 1])
+      wrongRight.push_back(begin + i - 1);
+
+  // Every swap touches a different pair of columns.
+  #pragma omp parallel for schedule(static)
+  for (omp_size_t i = 0; i < (omp_size_t) wrongLeft.size(); ++i)
+  {
+    data.swap_cols(wrongLeft[i], wrongRight[i]);
+
+    if (oldFromNew)
+      std::swap((*oldFromNew)[wrongLeft[i]], (*oldFromNew)[wrongRight[i]]);
+  }
+
+  return begin + numLeft;
+}
+
 /**
  * This function implements the default split behavior i.e. it rearranges
  * points according to the split information. The SplitType::AssignToLeftNode()
@@ -38,6 +122,12 @@ size_t PerformSplit(MatType& data,
                     const size_t count,
                     const typename SplitType::SplitInfo& splitInfo)
 {
+  if (UseParallelSplit<MatType>(count))
+  {
+    return ParallelPerformSplit<MatType, SplitType>(data, begin, count,
+        splitInfo, NULL);
+  }
+
   // This method modifies the input dataset.  We loop both from the left and
   // right sides of the points contained in this node.
   size_t left = begin;
@@ -104,6 +194,12 @@ size_t PerformSplit(MatType& data,
                     const typename SplitType::SplitInfo& splitInfo,
                     std::vector<size_t>& oldFromNew)
 {
+  if (UseParallelSplit<MatType>(count))
+  {
+    return ParallelPerformSplit<MatType, SplitType>(data, begin, count,
+        splitInfo, &oldFromNew);
+  }
+
   // This method modifies the input dataset.  We loop both from the left and
   // right sides of the points contained in this node.
   size_t left = begin;
@@ -50,12 +50,15 @@ DiscreteHilbertValue<TreeElemType>::DiscreteHilbertValue(const TreeType* tree) :
   // Calculate the Hilbert value for all points.
   if (!tree->Parent()) // This is the root node.
     ownsLocalHilbertValues = true;
-  else if (tree->Parent()->Child(0).IsLeaf())
+  else if (tree->Parent()->NumChildren() > 0 &&
+           tree->Parent()->Child(0).IsLeaf())
   {
     // This is a leaf node.
-    assert(tree->Parent()->NumChildren() > 0);
     ownsLocalHilbertValues = true;
   }
+  // Otherwise this is either an intermediate node, or the first child of its
+  // parent (which happens when the tree is bulk-loaded).  In the latter case
+  // the local dataset is allocated when the first point is inserted.
 
   if (ownsLocalHilbertValues)
   {
@@ -354,6 +357,13 @@ InsertPoint(TreeType *node,
     *valueToInsert = CalculateValue(pt);
   if (node->IsLeaf())
   {
+    if (!localHilbertValues)
+    {
+      localHilbertValues = new arma::Mat<HilbertElemType>(
+          node->Dataset().n_rows, node->MaxLeafSize() + 1);
+      ownsLocalHilbertValues = true;
+    }
+
     // Find an appropriate place.
     for (i = 0; i < numValues; i++)
       if (CompareValues(localHilbertValues->col(i), *valueToInsert) > 0)
@@ -456,6 +466,14 @@ void DiscreteHilbertValue<TreeElemType>::UpdateLargestValue(TreeType* node)
 {
   if (!node->IsLeaf())
   {
+    // Only leaf nodes own a local dataset.  A bulk-loaded root still owns the
+    // one it was constructed with.
+    if (ownsLocalHilbertValues)
+    {
+      delete localHilbertValues;
+      ownsLocalHilbertValues = false;
+    }
+
     // Update the largest Hilbert value
     localHilbertValues = node->Child(node->NumChildren() -
         1).AuxiliaryInfo().HilbertValue().LocalHilbertValues();
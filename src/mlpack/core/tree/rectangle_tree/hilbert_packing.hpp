@@ -0,0 +1,78 @@
+/**
+ * @file hilbert_packing.hpp
+ *
+ * Definition of the HilbertPacking class, a policy for bulk-loading rectangle
+ * trees by sorting the points along the Hilbert curve.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_RECTANGLE_TREE_HILBERT_PACKING_HPP
+#define MLPACK_CORE_TREE_RECTANGLE_TREE_HILBERT_PACKING_HPP
+
+#include <mlpack/prereqs.hpp>
+#include "discrete_hilbert_value.hpp"
+
+namespace mlpack {
+namespace tree /** Trees and tree-building procedures. */ {
+
+/**
+ * The Hilbert packing policy for bulk-loading a RectangleTree.  All points are
+ * sorted once by their DiscreteHilbertValue, and each node then holds a
+ * contiguous run of the sorted points.  This is the packing that keeps a
+ * HilbertRTree valid: the points of each leaf and the children of each node
+ * are ordered by their Hilbert values.
+ *
+ * For more information, see the following paper.
+ *
+ * @code
+ * @inproceedings{kamel1993packing,
+ *   title={On packing R-trees},
+ *   author={Kamel, Ibrahim and Faloutsos, Christos},
+ *   booktitle={Proceedings of the Second International Conference on
+ *       Information and Knowledge Management},
+ *   pages={490--499},
+ *   year={1993},
+ *   organization={ACM}
+ * }
+ * @endcode
+ */
+class HilbertPacking
+{
+ public:
+  /**
+   * Sort the points by their Hilbert values.
+   *
+   * @param data Dataset the tree is built on.
+   * @param indices Indices of the points in the dataset.
+   */
+  template<typename MatType>
+  static void Order(const MatType& data, std::vector<size_t>& indices);
+
+  /**
+   * The points are already in Hilbert order, so every contiguous group of them
+   * is a run along the curve and nothing needs to be done.
+   *
+   * @param data Dataset the tree is built on.
+   * @param indices Indices of the points in the dataset.
+   * @param begin First position of the range to reorder.
+   * @param count Number of positions in the range.
+   * @param numGroups Number of groups the range will be cut into.
+   */
+  template<typename MatType>
+  static void Partition(const MatType& /* data */,
+                        std::vector<size_t>& /* indices */,
+                        const size_t /* begin */,
+                        const size_t /* count */,
+                        const size_t /* numGroups */) { }
+};
+
+} // namespace tree
+} // namespace mlpack
+
+// Include implementation.
+#include "hilbert_packing_impl.hpp"
+
+#endif
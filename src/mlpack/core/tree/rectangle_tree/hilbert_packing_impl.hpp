@@ -0,0 +1,47 @@
+/**
+ * @file hilbert_packing_impl.hpp
+ *
+ * Implementation of the HilbertPacking class, a policy for bulk-loading
+ * rectangle trees by sorting the points along the Hilbert curve.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_RECTANGLE_TREE_HILBERT_PACKING_IMPL_HPP
+#define MLPACK_CORE_TREE_RECTANGLE_TREE_HILBERT_PACKING_IMPL_HPP
+
+#include "hilbert_packing.hpp"
+
+namespace mlpack {
+namespace tree {
+
+template<typename MatType>
+void HilbertPacking::Order(const MatType& data, std::vector<size_t>& indices)
+{
+  typedef DiscreteHilbertValue<typename MatType::elem_type> HilbertValue;
+  typedef typename HilbertValue::HilbertElemType HilbertElemType;
+
+  // Compute the Hilbert value of every point once, so that the sort does not
+  // have to recompute them.
+  arma::Mat<HilbertElemType> values(data.n_rows, data.n_cols);
+  for (size_t i = 0; i < indices.size(); ++i)
+    values.col(indices[i]) = HilbertValue::CalculateValue(
+        data.col(indices[i]));
+
+  // Hilbert values are compared element by element, as in
+  // DiscreteHilbertValue::CompareValues().
+  const size_t dim = data.n_rows;
+  std::stable_sort(indices.begin(), indices.end(),
+      [&values, dim](const size_t a, const size_t b)
+      {
+        return std::lexicographical_compare(values.colptr(a),
+            values.colptr(a) + dim, values.colptr(b), values.colptr(b) + dim);
+      });
+}
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
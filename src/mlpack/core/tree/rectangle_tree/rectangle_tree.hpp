@@ -156,6 +156,61 @@ class RectangleTree
                 const size_t minNumChildren = 2,
                 const size_t firstDataIndex = 0);
 
+  /**
+   * Construct this as the root node of a rectangle type tree by bulk-loading
+   * the given dataset, instead of inserting the points one at a time.  The
+   * PackingType policy (STRPacking or HilbertPacking) decides how the points
+   * are grouped into nodes; the tree is built from the top down in
+   * O(n log n) time, every leaf is on the same level, and each node is filled
+   * as close to its capacity as the number of points allows.  Points can be
+   * inserted into and deleted from the tree afterwards as usual.
+   *
+   * Use HilbertPacking to bulk-load a HilbertRTree, since it keeps the points
+   * and the children of each node in Hilbert order.
+   *
+   * @param data Dataset from which to create the tree.
+   * @param packing Instance of the packing policy (only its type is used).
+   * @param maxLeafSize Maximum size of each leaf in the tree.
+   * @param minLeafSize Minimum size of each leaf in the tree.
+   * @param maxNumChildren The maximum number of child nodes a non-leaf node may
+   *      have.
+   * @param minNumChildren The minimum number of child nodes a non-leaf node may
+   *      have.
+   */
+  template<typename PackingType>
+  RectangleTree(const MatType& data,
+                const PackingType& packing,
+                const size_t maxLeafSize = 20,
+                const size_t minLeafSize = 8,
+                const size_t maxNumChildren = 5,
+                const size_t minNumChildren = 2,
+                typename std::enable_if_t<
+                    !std::is_arithmetic<PackingType>::value>* = 0);
+
+  /**
+   * Construct this as the root node of a rectangle type tree by bulk-loading
+   * the given dataset, and taking ownership of the given dataset.  See the
+   * constructor above for details.
+   *
+   * @param data Dataset from which to create the tree.
+   * @param packing Instance of the packing policy (only its type is used).
+   * @param maxLeafSize Maximum size of each leaf in the tree.
+   * @param minLeafSize Minimum size of each leaf in the tree.
+   * @param maxNumChildren The maximum number of child nodes a non-leaf node may
+   *      have.
+   * @param minNumChildren The minimum number of child nodes a non-leaf node may
+   *      have.
+   */
+  template<typename PackingType>
+  RectangleTree(MatType&& data,
+                const PackingType& packing,
+                const size_t maxLeafSize = 20,
+                const size_t minLeafSize = 8,
+                const size_t maxNumChildren = 5,
+                const size_t minNumChildren = 2,
+                typename std::enable_if_t<
+                    !std::is_arithmetic<PackingType>::value>* = 0);
+
   /**
    * Construct this as an empty node with the specified parent.  Copying the
    * parameters (maxLeafSize, minLeafSize, maxNumChildren, minNumChildren,
@@ -542,6 +597,31 @@ class RectangleTree
    */
   void SplitNode(std::vector<bool>& relevels);
 
+  /**
+   * Bulk-load all the points of the dataset into this (empty) root node.
+   */
+  template<typename PackingType>
+  void BulkLoad();
+
+  /**
+   * Pack the points indices[first, first + numPoints) into this node.  If
+   * height is 0 this node is a leaf; otherwise the points are split among
+   * children whose subtrees are height - 1 levels deep and hold at most
+   * childCapacity points each.
+   *
+   * @param indices Indices of the points, as ordered by the packing policy.
+   * @param first First position of the points of this node in indices.
+   * @param numPoints Number of points in this node.
+   * @param height Number of levels below this node.
+   * @param childCapacity Maximum number of points in each child subtree.
+   */
+  template<typename PackingType>
+  void PackNode(std::vector<size_t>& indices,
+                const size_t first,
+                const size_t numPoints,
+                const size_t height,
+                const size_t childCapacity);
+
  protected:
   /**
    * A default constructor.  This is meant to only be used with
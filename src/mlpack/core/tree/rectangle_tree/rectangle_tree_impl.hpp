@@ -101,6 +101,80 @@ RectangleTree(MatType&& data,
     root->InsertPoint(i);
 }
 
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         typename SplitType,
+         typename DescentType,
+         template<typename> class AuxiliaryInformationType>
+template<typename PackingType>
+RectangleTree<MetricType, StatisticType, MatType, SplitType, DescentType,
+              AuxiliaryInformationType>::
+RectangleTree(const MatType& data,
+              const PackingType& /* packing */,
+              const size_t maxLeafSize,
+              const size_t minLeafSize,
+              const size_t maxNumChildren,
+              const size_t minNumChildren,
+              typename std::enable_if_t<
+                  !std::is_arithmetic<PackingType>::value>*) :
+    maxNumChildren(maxNumChildren),
+    minNumChildren(minNumChildren),
+    numChildren(0),
+    children(maxNumChildren + 1), // Add one to make splitting the node simpler.
+    parent(NULL),
+    begin(0),
+    count(0),
+    numDescendants(0),
+    maxLeafSize(maxLeafSize),
+    minLeafSize(minLeafSize),
+    bound(data.n_rows),
+    parentDistance(0),
+    dataset(new MatType(data)),
+    ownsDataset(true),
+    points(maxLeafSize + 1), // Add one to make splitting the node simpler.
+    auxiliaryInfo(this)
+{
+  BulkLoad<PackingType>();
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         typename SplitType,
+         typename DescentType,
+         template<typename> class AuxiliaryInformationType>
+template<typename PackingType>
+RectangleTree<MetricType, StatisticType, MatType, SplitType, DescentType,
+              AuxiliaryInformationType>::
+RectangleTree(MatType&& data,
+              const PackingType& /* packing */,
+              const size_t maxLeafSize,
+              const size_t minLeafSize,
+              const size_t maxNumChildren,
+              const size_t minNumChildren,
+              typename std::enable_if_t<
+                  !std::is_arithmetic<PackingType>::value>*) :
+    maxNumChildren(maxNumChildren),
+    minNumChildren(minNumChildren),
+    numChildren(0),
+    children(maxNumChildren + 1), // Add one to make splitting the node simpler.
+    parent(NULL),
+    begin(0),
+    count(0),
+    numDescendants(0),
+    maxLeafSize(maxLeafSize),
+    minLeafSize(minLeafSize),
+    bound(data.n_rows),
+    parentDistance(0),
+    dataset(new MatType(std::move(data))),
+    ownsDataset(true),
+    points(maxLeafSize + 1), // Add one to make splitting the node simpler.
+    auxiliaryInfo(this)
+{
+  BulkLoad<PackingType>();
+}
+
 template<typename MetricType,
          typename StatisticType,
          typename MatType,
@@ -893,6 +967,107 @@ void RectangleTree<MetricType, StatisticType, MatType, SplitType, DescentType,
   }
 }
 
+/**
+ * Bulk-load the dataset.  The tree gets the smallest height whose leaves can
+ * hold all of the points.
+ */
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         typename SplitType,
+         typename DescentType,
+         template<typename> class AuxiliaryInformationType>
+template<typename PackingType>
+void RectangleTree<MetricType, StatisticType, MatType, SplitType, DescentType,
+                   AuxiliaryInformationType>::BulkLoad()
+{
+  std::vector<size_t> indices(dataset->n_cols);
+  for (size_t i = 0; i < indices.size(); ++i)
+    indices[i] = i;
+
+  PackingType::Order(*dataset, indices);
+
+  size_t height = 0;
+  size_t capacity = maxLeafSize;
+  while (capacity < indices.size())
+  {
+    capacity *= maxNumChildren;
+    ++height;
+  }
+
+  PackNode<PackingType>(indices, 0, indices.size(), height,
+      capacity / maxNumChildren);
+}
+
+/**
+ * Pack the given points into this node, recursing into the children.  Each
+ * child is the last child of its parent while it is being packed, so the
+ * auxiliary information sees the same tree as it does during InsertPoint().
+ */
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         typename SplitType,
+         typename DescentType,
+         template<typename> class AuxiliaryInformationType>
+template<typename PackingType>
+void RectangleTree<MetricType, StatisticType, MatType, SplitType, DescentType,
+                   AuxiliaryInformationType>::
+    PackNode(std::vector<size_t>& indices,
+             const size_t first,
+             const size_t numPoints,
+             const size_t height,
+             const size_t childCapacity)
+{
+  if (height == 0)
+  {
+    std::vector<RectangleTree*> ancestors;
+    for (RectangleTree* node = parent; node != NULL; node = node->Parent())
+      ancestors.push_back(node);
+
+    for (size_t i = first; i < first + numPoints; ++i)
+    {
+      const size_t point = indices[i];
+      bound |= dataset->col(point);
+      numDescendants++;
+
+      // Pass the point down from the root, as InsertPoint() does.
+      for (size_t j = ancestors.size(); j > 0; --j)
+      {
+        ancestors[j - 1]->AuxiliaryInfo().HandlePointInsertion(
+            ancestors[j - 1], point);
+      }
+
+      if (!auxiliaryInfo.HandlePointInsertion(this, point))
+        points[count++] = point;
+    }
+  }
+  else
+  {
+    // Spread the points as evenly as possible over the fewest children that
+    // can hold them.
+    const size_t numGroups = (numPoints + childCapacity - 1) / childCapacity;
+    PackingType::Partition(*dataset, indices, first, numPoints, numGroups);
+
+    for (size_t i = 0; i < numGroups; ++i)
+    {
+      const size_t childFirst = first + i * numPoints / numGroups;
+      const size_t childEnd = first + (i + 1) * numPoints / numGroups;
+
+      RectangleTree* child = new RectangleTree(this);
+      children[numChildren++] = child;
+      child->PackNode<PackingType>(indices, childFirst, childEnd - childFirst,
+          height - 1, childCapacity / maxNumChildren);
+
+      bound |= child->Bound();
+      numDescendants += child->NumDescendants();
+    }
+  }
+
+  // Now that the subtree is complete, the statistic can be built.
+  stat = StatisticType(*this);
+}
+
 //! Default constructor for boost::serialization.
 template<typename MetricType,
          typename StatisticType,
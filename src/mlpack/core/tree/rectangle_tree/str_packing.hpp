@@ -0,0 +1,97 @@
+/**
+ * @file str_packing.hpp
+ *
+ * Definition of the STRPacking class, a policy for bulk-loading rectangle
+ * trees with the Sort-Tile-Recursive algorithm.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_RECTANGLE_TREE_STR_PACKING_HPP
+#define MLPACK_CORE_TREE_RECTANGLE_TREE_STR_PACKING_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace tree /** Trees and tree-building procedures. */ {
+
+/**
+ * The Sort-Tile-Recursive (STR) packing policy for bulk-loading a
+ * RectangleTree.  When a node is packed, the points that it holds are cut into
+ * slabs along the first dimension, each slab is cut into slabs along the second
+ * dimension, and so on, until each tile holds the points of exactly one child.
+ * Because every cut is a hyperplane, the children of a node cover disjoint
+ * parts of the space.
+ *
+ * For more information, see the following paper.
+ *
+ * @code
+ * @inproceedings{leutenegger1997str,
+ *   title={STR: A simple and efficient algorithm for R-tree packing},
+ *   author={Leutenegger, Scott T. and Lopez, Mario A. and Edgington, Jeffrey},
+ *   booktitle={Proceedings of the 13th International Conference on Data
+ *       Engineering},
+ *   pages={497--506},
+ *   year={1997},
+ *   organization={IEEE}
+ * }
+ * @endcode
+ */
+class STRPacking
+{
+ public:
+  /**
+   * Order the points before the tree is packed.  STR does all of its work
+   * while the nodes are packed, so this does nothing.
+   *
+   * @param data Dataset the tree is built on.
+   * @param indices Indices of the points in the dataset.
+   */
+  template<typename MatType>
+  static void Order(const MatType& /* data */,
+                    std::vector<size_t>& /* indices */) { }
+
+  /**
+   * Reorder the points in indices[begin, begin + count) so that, if the range
+   * is cut into numGroups groups where group i holds the positions
+   * [begin + i * count / numGroups, begin + (i + 1) * count / numGroups),
+   * every group is a tile of the space.
+   *
+   * @param data Dataset the tree is built on.
+   * @param indices Indices of the points in the dataset.
+   * @param begin First position of the range to reorder.
+   * @param count Number of positions in the range.
+   * @param numGroups Number of groups the range will be cut into.
+   */
+  template<typename MatType>
+  static void Partition(const MatType& data,
+                        std::vector<size_t>& indices,
+                        const size_t begin,
+                        const size_t count,
+                        const size_t numGroups);
+
+ private:
+  /**
+   * Tile the points of groups [firstGroup, lastGroup) along the given
+   * dimension and recurse into each slab along the next dimension.
+   */
+  template<typename MatType>
+  static void Tile(const MatType& data,
+                   std::vector<size_t>& indices,
+                   const size_t begin,
+                   const size_t count,
+                   const size_t numGroups,
+                   const size_t firstGroup,
+                   const size_t lastGroup,
+                   const size_t dim);
+};
+
+} // namespace tree
+} // namespace mlpack
+
+// Include implementation.
+#include "str_packing_impl.hpp"
+
+#endif
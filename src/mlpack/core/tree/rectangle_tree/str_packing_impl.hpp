@@ -0,0 +1,82 @@
+/**
+ * @file str_packing_impl.hpp
+ *
+ * Implementation of the STRPacking class, a policy for bulk-loading rectangle
+ * trees with the Sort-Tile-Recursive algorithm.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_RECTANGLE_TREE_STR_PACKING_IMPL_HPP
+#define MLPACK_CORE_TREE_RECTANGLE_TREE_STR_PACKING_IMPL_HPP
+
+#include "str_packing.hpp"
+
+namespace mlpack {
+namespace tree {
+
+template<typename MatType>
+void STRPacking::Partition(const MatType& data,
+                           std::vector<size_t>& indices,
+                           const size_t begin,
+                           const size_t count,
+                           const size_t numGroups)
+{
+  Tile(data, indices, begin, count, numGroups, 0, numGroups, 0);
+}
+
+template<typename MatType>
+void STRPacking::Tile(const MatType& data,
+                      std::vector<size_t>& indices,
+                      const size_t begin,
+                      const size_t count,
+                      const size_t numGroups,
+                      const size_t firstGroup,
+                      const size_t lastGroup,
+                      const size_t dim)
+{
+  const size_t groups = lastGroup - firstGroup;
+  if (groups <= 1 || dim >= data.n_rows)
+    return;
+
+  // Cut the groups into about groups^(1 / d) slabs, where d is the number of
+  // dimensions that are left.  In the last dimension every group gets its own
+  // slab.
+  const size_t remainingDims = data.n_rows - dim;
+  size_t numSlabs = (size_t) std::ceil(std::pow((double) groups,
+      1.0 / remainingDims));
+  numSlabs = std::min(std::max(numSlabs, (size_t) 2), groups);
+
+  auto compare = [&data, dim](const size_t a, const size_t b)
+  {
+    return data(dim, a) < data(dim, b);
+  };
+
+  // Move the boundary of each slab into place.  Only the order between the
+  // slabs matters, so a selection is enough.
+  const size_t end = begin + lastGroup * count / numGroups;
+  size_t slabBegin = begin + firstGroup * count / numGroups;
+  for (size_t i = 1; i < numSlabs; ++i)
+  {
+    const size_t group = firstGroup + i * groups / numSlabs;
+    const size_t slabEnd = begin + group * count / numGroups;
+    std::nth_element(indices.begin() + slabBegin, indices.begin() + slabEnd,
+        indices.begin() + end, compare);
+    slabBegin = slabEnd;
+  }
+
+  // Tile each slab along the next dimension.
+  for (size_t i = 0; i < numSlabs; ++i)
+  {
+    Tile(data, indices, begin, count, numGroups,
+        firstGroup + i * groups / numSlabs,
+        firstGroup + (i + 1) * groups / numSlabs, dim + 1);
+  }
+}
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
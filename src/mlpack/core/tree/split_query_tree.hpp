@@ -0,0 +1,87 @@
+/**
+ * @file split_query_tree.hpp
+ *
+ * Split a query tree into disjoint subtrees that can be traversed in
+ * parallel.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_SPLIT_QUERY_TREE_HPP
+#define MLPACK_CORE_TREE_SPLIT_QUERY_TREE_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace tree /** Trees and tree-building procedures. */ {
+
+/**
+ * The default node reset of SplitQueryTree(), which leaves the split nodes
+ * alone.
+ */
+class NoNodeReset
+{
+ public:
+  //! Do nothing to the given node.
+  template<typename TreeType>
+  void operator()(TreeType& /* node */) const { }
+};
+
+/**
+ * Split the given tree into at least the given number of disjoint subtrees
+ * (if the tree is large enough), by repeatedly replacing the subtree with the
+ * most descendants by its children.  Every point held in the tree is held in
+ * exactly one of the returned subtrees, so each subtree can be used as the
+ * query node of an independent dual-tree traversal.
+ *
+ * The nodes that are split are not visited by these traversals.  If their
+ * statistics are read during the traversals (for instance, when the subtrees
+ * use the bounds of their parents for pruning), the given reset is called on
+ * each of them first, e.g. to clear the bounds of a previous search.
+ *
+ * @param root The tree to split.
+ * @param minSubtrees The number of subtrees to split the tree into.
+ * @param subtrees Vector to store the subtrees in.
+ * @param reset Callable that is given each node that is split.
+ */
+template<typename TreeType, typename NodeResetType = NoNodeReset>
+void SplitQueryTree(TreeType& root,
+                    const size_t minSubtrees,
+                    std::vector<TreeType*>& subtrees,
+                    NodeResetType reset = NodeResetType())
+{
+  subtrees.clear();
+  subtrees.push_back(&root);
+
+  while (subtrees.size() < minSubtrees)
+  {
+    // Find the largest subtree that can be split.
+    size_t largest = subtrees.size();
+    for (size_t i = 0; i < subtrees.size(); ++i)
+    {
+      if (subtrees[i]->NumChildren() == 0)
+        continue;
+
+      if (largest == subtrees.size() || subtrees[i]->NumDescendants() >
+          subtrees[largest]->NumDescendants())
+        largest = i;
+    }
+
+    // Every subtree is a leaf.
+    if (largest == subtrees.size())
+      break;
+
+    TreeType* node = subtrees[largest];
+    reset(*node);
+    subtrees[largest] = &node->Child(0);
+    for (size_t i = 1; i < node->NumChildren(); ++i)
+      subtrees.push_back(&node->Child(i));
+  }
+}
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
@@ -24,6 +24,7 @@
 #include <mlpack/prereqs.hpp>
 
 #include "timers.hpp"
+#include "counters.hpp"
 #include "program_doc.hpp"
 #include "cli_deleter.hpp" // To make sure we can delete the singleton.
 #include "version.hpp"
@@ -318,6 +319,9 @@ class CLI
   //! Holds the timer objects.
   Timers timer;
 
+  //! Holds the counter objects.
+  Counters counters;
+
   //! So that Timer::Start() and Timer::Stop() can access the timer variable.
   friend class Timer;
 
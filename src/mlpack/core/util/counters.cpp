@@ -0,0 +1,67 @@
+/**
+ * @file counters.cpp
+ *
+ * Implementation of counters.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "counters.hpp"
+#include "cli.hpp"
+
+using namespace mlpack;
+using namespace std;
+
+/**
+ * Add to the given counter.
+ */
+void Counter::Add(const string& name, const size_t value)
+{
+  // Don't do anything if we aren't timing.
+  if (!CLI::GetSingleton().timer.Enabled())
+    return;
+
+  CLI::GetSingleton().counters.AddCounter(name, value);
+}
+
+/**
+ * Get the given counter.
+ */
+size_t Counter::Get(const string& name)
+{
+  return CLI::GetSingleton().counters.GetCounter(name);
+}
+
+// Reset all counters.
+void Counter::ResetAll()
+{
+  CLI::GetSingleton().counters.Reset();
+}
+
+map<string, size_t> Counters::GetAllCounters()
+{
+  // Make a copy of the counters.
+  lock_guard<mutex> lock(countersMutex);
+  return counters;
+}
+
+void Counters::Reset()
+{
+  lock_guard<mutex> lock(countersMutex);
+  counters.clear();
+}
+
+void Counters::AddCounter(const string& counterName, const size_t value)
+{
+  lock_guard<mutex> lock(countersMutex);
+  counters[counterName] += value;
+}
+
+size_t Counters::GetCounter(const string& counterName)
+{
+  lock_guard<mutex> lock(countersMutex);
+  map<string, size_t>::const_iterator it = counters.find(counterName);
+  return (it == counters.end()) ? 0 : it->second;
+}
@@ -0,0 +1,94 @@
+/**
+ * @file counters.hpp
+ *
+ * Counters for mlpack.  These record how much work an algorithm did (for
+ * instance the number of base cases of a tree traversal, or the number of
+ * iterations of an optimizer) next to the timers.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_UTILITIES_COUNTERS_HPP
+#define MLPACK_CORE_UTILITIES_COUNTERS_HPP
+
+#include <map>
+#include <string>
+#include <mutex>
+
+namespace mlpack {
+
+/**
+ * The counter class provides a way for mlpack methods to report how much work
+ * they did.  A named counter is the sum of all the values added to it, from
+ * any thread.  Counters are only recorded while timing is enabled (see
+ * Timer::EnableTiming()), so they cost nothing otherwise.  Counters should be
+ * added once per call of a method (for instance once per search), not inside
+ * inner loops.
+ *
+ * By convention, the name of a counter is prefixed with the name of the
+ * method, as in "neighbor_search/base_cases".
+ */
+class Counter
+{
+ public:
+  /**
+   * Add the given value to the given counter.
+   *
+   * @param name Name of the counter.
+   * @param value Value to add to the counter.
+   */
+  static void Add(const std::string& name, const size_t value = 1);
+
+  /**
+   * Get the value of the given counter.
+   *
+   * @param name Name of the counter.
+   */
+  static size_t Get(const std::string& name);
+
+  /**
+   * Reset all counters.  This removes all knowledge of any existing counters.
+   */
+  static void ResetAll();
+};
+
+class Counters
+{
+ public:
+  /**
+   * Returns a copy of all the counters used via this interface.
+   */
+  std::map<std::string, size_t> GetAllCounters();
+
+  /**
+   * Reset the counters, removing them.
+   */
+  void Reset();
+
+  /**
+   * Add the given value to the given counter.
+   *
+   * @param counterName The name of the counter in question.
+   * @param value Value to add to the counter.
+   */
+  void AddCounter(const std::string& counterName, const size_t value);
+
+  /**
+   * Returns the value of the given counter, or 0 if it was never added to.
+   *
+   * @param counterName The name of the counter in question.
+   */
+  size_t GetCounter(const std::string& counterName);
+
+ private:
+  //! A map of all the counters that are being tracked.
+  std::map<std::string, size_t> counters;
+  //! A mutex for modifying the counters.
+  std::mutex countersMutex;
+};
+
+} // namespace mlpack
+
+#endif // MLPACK_CORE_UTILITIES_COUNTERS_HPP
@@ -17,11 +17,125 @@
 
 #include <map>
 #include <string>
+#include <vector>
 
 using namespace mlpack;
 using namespace std;
 using namespace chrono;
 
+const size_t Timer::MaxHandles;
+
+namespace {
+
+//! The state of one registered timer on one thread.  Only the owning thread
+//! writes to it; the total is atomic so that it can be read while the thread
+//! runs.
+struct HandleSlot
+{
+  //! Total time, in ticks of steady_clock.
+  atomic<steady_clock::rep> total;
+  //! Whether or not the timer is running.
+  atomic<bool> running;
+  //! The time at which the timer was started.
+  steady_clock::time_point start;
+};
+
+//! The registered timers of one thread.
+struct ThreadSlots
+{
+  ThreadSlots();
+  ~ThreadSlots();
+
+  HandleSlot slots[Timer::MaxHandles];
+};
+
+//! The names of the registered timers, and the timers of all threads.
+struct HandleRegistry
+{
+  HandleRegistry()
+  {
+    for (size_t i = 0; i < Timer::MaxHandles; ++i)
+    {
+      retired[i] = 0;
+      resetOffset[i] = 0;
+    }
+  }
+
+  //! A mutex for registering timers and threads.
+  mutex registryMutex;
+  //! The names of the registered timers, by index.
+  vector<string> names;
+  //! The index of each registered timer.
+  map<string, size_t> ids;
+  //! The timers of the running threads.
+  list<ThreadSlots*> threads;
+  //! The total times of the threads that have exited.
+  steady_clock::rep retired[Timer::MaxHandles];
+  //! The total times of the running threads at the last reset, which are
+  //! subtracted when the timers are read.
+  steady_clock::rep resetOffset[Timer::MaxHandles];
+};
+
+/**
+ * Return the registry.  It is allocated on first use and never freed, since the
+ * timers of a thread are merged into it when the thread exits, which may happen
+ * after the CLI singleton and other static objects are destroyed.
+ */
+HandleRegistry& Registry()
+{
+  static HandleRegistry* registry = new HandleRegistry();
+  return *registry;
+}
+
+//! Return the registered timers of the calling thread.
+ThreadSlots& LocalSlots()
+{
+  static thread_local ThreadSlots slots;
+  return slots;
+}
+
+ThreadSlots::ThreadSlots()
+{
+  for (size_t i = 0; i < Timer::MaxHandles; ++i)
+  {
+    slots[i].total = 0;
+    slots[i].running = false;
+  }
+
+  HandleRegistry& registry = Registry();
+  lock_guard<mutex> lock(registry.registryMutex);
+  registry.threads.push_back(this);
+}
+
+ThreadSlots::~ThreadSlots()
+{
+  HandleRegistry& registry = Registry();
+  lock_guard<mutex> lock(registry.registryMutex);
+  for (size_t i = 0; i < Timer::MaxHandles; ++i)
+    registry.retired[i] += slots[i].total.load(memory_order_relaxed);
+  registry.threads.remove(this);
+}
+
+//! Return the name of the registered timer with the given index.
+string HandleName(const size_t id)
+{
+  HandleRegistry& registry = Registry();
+  lock_guard<mutex> lock(registry.registryMutex);
+  return (id < registry.names.size()) ? registry.names[id] : string();
+}
+
+//! Return the slot of the given handle on the calling thread.
+HandleSlot& Slot(const TimerHandle& handle)
+{
+  if (handle.Id() >= Timer::MaxHandles)
+    throw invalid_argument("Timer: the timer handle was not returned by "
+        "Timer::Register()");
+
+  return LocalSlots().slots[handle.Id()];
+}
+
+} // anonymous namespace
+
 /**
  * Start the given timer.
  */
@@ -46,6 +160,88 @@ microseconds Timer::Get(const string& name)
   return CLI::GetSingleton().timer.GetTimer(name);
 }
 
+/**
+ * Register the given timer.
+ */
+TimerHandle Timer::Register(const string& name)
+{
+  HandleRegistry& registry = Registry();
+  lock_guard<mutex> lock(registry.registryMutex);
+
+  map<string, size_t>::const_iterator it = registry.ids.find(name);
+  if (it != registry.ids.end())
+    return TimerHandle(it->second);
+
+  if (registry.names.size() >= MaxHandles)
+  {
+    ostringstream error;
+    error << "Timer::Register(): cannot register timer '" << name << "'; "
+        << "the maximum of " << MaxHandles << " timers are already registered";
+    throw runtime_error(error.str());
+  }
+
+  const size_t id = registry.names.size();
+  registry.names.push_back(name);
+  registry.ids[name] = id;
+  return TimerHandle(id);
+}
+
+/**
+ * Start the given registered timer.
+ */
+void Timer::Start(const TimerHandle& handle)
+{
+  // Don't do anything if we aren't timing.
+  if (!CLI::GetSingleton().timer.Enabled())
+    return;
+
+  HandleSlot& slot = Slot(handle);
+  if (slot.running.load(memory_order_relaxed))
+  {
+    ostringstream error;
+    error << "Timer::Start(): timer '" << HandleName(handle.Id())
+        << "' has already been started";
+    throw runtime_error(error.str());
+  }
+
+  slot.running.store(true, memory_order_relaxed);
+  slot.start = steady_clock::now();
+}
+
+/**
+ * Stop the given registered timer.
+ */
+void Timer::Stop(const TimerHandle& handle)
+{
+  const steady_clock::time_point currTime = steady_clock::now();
+
+  // Don't do anything if we aren't timing.
+  if (!CLI::GetSingleton().timer.Enabled())
+    return;
+
+  HandleSlot& slot = Slot(handle);
+  if (!slot.running.load(memory_order_relaxed))
+  {
+    ostringstream error;
+    error << "Timer::Stop(): no timer with name '" << HandleName(handle.Id())
+        << "' currently running";
+    throw runtime_error(error.str());
+  }
+
+  // Only this thread writes to the total, so no atomic addition is needed.
+  slot.total.store(slot.total.load(memory_order_relaxed) +
+      (currTime - slot.start).count(), memory_order_relaxed);
+  slot.running.store(false, memory_order_relaxed);
+}
+
+/**
+ * Return whether the given registered timer is running.
+ */
+bool Timer::Running(const TimerHandle& handle)
+{
+  return Slot(handle).running.load(memory_order_relaxed);
+}
+
 // Enable timing.
 void Timer::EnableTiming()
 {
@@ -64,19 +260,73 @@ void Timer::ResetAll()
   CLI::GetSingleton().timer.Reset();
 }
 
+// The registered timers outlive the Timers object, so reset them with it.
+Timers::~Timers()
+{
+  Reset();
+}
+
 // Reset a Timers object.
 void Timers::Reset()
 {
-  lock_guard<mutex> lock(timersMutex);
-  timers.clear();
-  timerStartTime.clear();
+  {
+    lock_guard<mutex> lock(timersMutex);
+    timers.clear();
+    timerStartTime.clear();
+  }
+
+  // Registered timers stay registered, but their times are cleared.  The slots
+  // of the other threads may only be written by their owners, so the current
+  // totals are recorded and subtracted when the timers are read.
+  HandleRegistry& registry = Registry();
+  lock_guard<mutex> lock(registry.registryMutex);
+  for (size_t i = 0; i < Timer::MaxHandles; ++i)
+  {
+    registry.retired[i] = 0;
+    registry.resetOffset[i] = 0;
+    for (ThreadSlots* thread : registry.threads)
+      registry.resetOffset[i] += thread->slots[i].total.load(
+          memory_order_relaxed);
+  }
+}
+
+map<string, microseconds> Timers::GetRegisteredTimers()
+{
+  map<string, microseconds> result;
+
+  HandleRegistry& registry = Registry();
+  lock_guard<mutex> lock(registry.registryMutex);
+  for (size_t i = 0; i < registry.names.size(); ++i)
+  {
+    // When a thread exits its totals move to the retired times, so the offset
+    // recorded at the last reset still applies.
+    steady_clock::rep total = registry.retired[i] - registry.resetOffset[i];
+    for (ThreadSlots* thread : registry.threads)
+      total += thread->slots[i].total.load(memory_order_relaxed);
+
+    if (total > 0)
+    {
+      result[registry.names[i]] = duration_cast<microseconds>(
+          steady_clock::duration(total));
+    }
+  }
+
+  return result;
 }
 
 map<string, microseconds> Timers::GetAllTimers()
 {
-  // Make a copy of the timer.
-  lock_guard<mutex> lock(timersMutex);
-  return timers;
+  // Make a copy of the timer, and add the registered timers.
+  map<string, microseconds> result;
+  {
+    lock_guard<mutex> lock(timersMutex);
+    result = timers;
+  }
+
+  for (auto& it : GetRegisteredTimers())
+    result[it.first] += it.second;
+
+  return result;
 }
 
 microseconds Timers::GetTimer(const string& timerName)
@@ -84,8 +334,18 @@ microseconds Timers::GetTimer(const string& timerName)
   if (!enabled)
     return microseconds(0);
 
-  lock_guard<mutex> lock(timersMutex);
-  return timers[timerName];
+  microseconds result;
+  {
+    lock_guard<mutex> lock(timersMutex);
+    result = timers[timerName];
+  }
+
+  const map<string, microseconds> registered = GetRegisteredTimers();
+  map<string, microseconds>::const_iterator it = registered.find(timerName);
+  if (it != registered.end())
+    result += it->second;
+
+  return result;
 }
 
 bool Timers::GetState(const string& timerName,
@@ -170,6 +430,19 @@ void Timers::StopAllTimers()
 
   // If all timers are stopped, we can clear the maps.
   timerStartTime.clear();
+
+  // The registered timers of other threads can't be stopped from here.
+  ThreadSlots& local = LocalSlots();
+  for (size_t i = 0; i < Timer::MaxHandles; ++i)
+  {
+    HandleSlot& slot = local.slots[i];
+    if (slot.running.load(memory_order_relaxed))
+    {
+      slot.total.store(slot.total.load(memory_order_relaxed) +
+          (steady_clock::now() - slot.start).count(), memory_order_relaxed);
+      slot.running.store(false, memory_order_relaxed);
+    }
+  }
 }
 
 void Timers::StartTimer(const string& timerName,
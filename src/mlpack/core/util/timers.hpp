@@ -35,16 +35,99 @@
 
 namespace mlpack {
 
+/**
+ * A TimerHandle refers to a timer registered with Timer::Register().  Starting
+ * and stopping a timer through its handle does not look up the name of the
+ * timer and does not take any lock, so handles can be used for fine-grained
+ * timing, for instance inside parallel loops.  Register the handle once and
+ * reuse it:
+ *
+ * @code
+ * static const TimerHandle traversal = Timer::Register("tree_traversal");
+ *
+ * Timer::Start(traversal);
+ * // ...
+ * Timer::Stop(traversal);
+ * @endcode
+ */
+class TimerHandle
+{
+ public:
+  //! Create an invalid handle; starting or stopping it throws an exception.
+  TimerHandle() : id(size_t(-1)) { }
+
+  //! Get the index of the timer.
+  size_t Id() const { return id; }
+
+ private:
+  //! Create a handle to the timer with the given index.
+  explicit TimerHandle(const size_t id) : id(id) { }
+
+  //! The index of the timer.
+  size_t id;
+
+  friend class Timer;
+};
+
 /**
  * The timer class provides a way for mlpack methods to be timed.  The three
  * methods contained in this class allow a named timer to be started and
  * stopped, and its value to be obtained.  A named timer is specific to the
  * thread it is running on, so if you start a timer in one thread, it cannot be
  * stopped from a different thread.
+ *
+ * Timers that are started and stopped very often should be registered with
+ * Register() and used through the returned TimerHandle.  Each thread then
+ * accumulates the time of the timer on its own, and the times of all threads
+ * are only added up when the timer is read.
  */
 class Timer
 {
  public:
+  //! The maximum number of timers that can be registered with Register().
+  static const size_t MaxHandles = 256;
+
+  /**
+   * Register the timer with the given name and return a handle to it.  If the
+   * timer is already registered, the same handle is returned.  The time
+   * measured through the handle is reported under the given name (and added to
+   * the time of the named timer, if it is also used by name).
+   *
+   * @note A std::runtime_error exception will be thrown if MaxHandles timers
+   * are already registered.
+   *
+   * @param name Name of the timer.
+   */
+  static TimerHandle Register(const std::string& name);
+
+  /**
+   * Start the timer with the given handle on the calling thread.
+   *
+   * @note A std::runtime_error exception will be thrown if the timer is already
+   * running on the calling thread.
+   *
+   * @param handle Handle of the timer, returned by Register().
+   */
+  static void Start(const TimerHandle& handle);
+
+  /**
+   * Stop the timer with the given handle on the calling thread.
+   *
+   * @note A std::runtime_error exception will be thrown if the timer is not
+   * running on the calling thread.
+   *
+   * @param handle Handle of the timer, returned by Register().
+   */
+  static void Stop(const TimerHandle& handle);
+
+  /**
+   * Return true if the timer with the given handle is running on the calling
+   * thread.
+   *
+   * @param handle Handle of the timer, returned by Register().
+   */
+  static bool Running(const TimerHandle& handle);
+
   /**
    * Start the given timer.  If a timer is started, then stopped, then
    * re-started, then re-stopped, the final value of the timer is the length of
@@ -94,12 +177,41 @@ class Timer
   static void ResetAll();
 };
 
+/**
+ * ScopedTimer starts the timer with the given handle when it is constructed and
+ * stops it when it is destroyed.
+ */
+class ScopedTimer
+{
+ public:
+  //! Start the timer with the given handle.
+  explicit ScopedTimer(const TimerHandle& handle) : handle(handle)
+  {
+    Timer::Start(handle);
+  }
+
+  //! Stop the timer, if it is still running (timing may have been enabled in
+  //! the meantime).
+  ~ScopedTimer()
+  {
+    if (Timer::Running(handle))
+      Timer::Stop(handle);
+  }
+
+ private:
+  //! The handle of the timer.
+  TimerHandle handle;
+};
+
 class Timers
 {
  public:
   //! Default to disabled.
   Timers() : enabled(false) { }
 
+  //! Reset the times of the registered timers.
+  ~Timers();
+
   /**
    * Returns a copy of all the timers used via this interface.
    */
@@ -108,6 +220,10 @@ class Timers
   /**
    * Reset the timers.  This stops all running timers and removes them.  Whether
    * or not timing is enabled will not be changed.
+   *
+   * Registered timers stay registered and their times are cleared, but they are
+   * not stopped: a registered timer that is running on any thread during the
+   * reset keeps running, and its whole interval is counted when it is stopped.
    */
   void Reset();
 
@@ -158,7 +274,9 @@ class Timers
                 const std::thread::id& threadId = std::thread::id());
 
   /**
-   * Stop all timers.
+   * Stop all timers.  Registered timers can only be stopped on the calling
+   * thread; the time of the registered timers that are still running on other
+   * threads is not counted.
    */
   void StopAllTimers();
 
@@ -178,6 +296,10 @@ class Timers
 
   //! Whether or not timing is enabled.
   std::atomic<bool> enabled;
+
+  //! Return the times of the registered timers, added up over all threads.
+  //! Timers that were never run are left out.
+  std::map<std::string, std::chrono::microseconds> GetRegisteredTimers();
 };
 
 } // namespace mlpack
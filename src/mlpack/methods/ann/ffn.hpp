@@ -195,6 +195,26 @@ class FFN
                 arma::mat& gradient,
                 const size_t batchSize);
 
+  /**
+   * Evaluate the gradient of the feedforward network with the given parameters
+   * and store it as a sparse matrix.  Only the entries that the layers wrote
+   * to are stored; for a Lookup layer these are the columns of the looked-up
+   * tokens, so the cost of the update does not depend on the vocabulary size.
+   * The dense gradient is kept in a workspace, of which only the previously
+   * written entries are cleared between calls.
+   *
+   * @param parameters Matrix of the model parameters to be optimized.
+   * @param begin Index of the starting point to use for objective function
+   *        gradient evaluation.
+   * @param gradient Sparse matrix to output gradient into.
+   * @param batchSize Number of points to be processed as a batch for objective
+   *        function gradient evaluation.
+   */
+  void Gradient(const arma::mat& parameters,
+                const size_t begin,
+                arma::sp_mat& gradient,
+                const size_t batchSize);
+
   /**
    * Shuffle the order of function visitation. This may be called by the
    * optimizer.
@@ -224,6 +244,24 @@ class FFN
   //! Modify the initial point for the optimization.
   arma::mat& Parameters() { return parameter; }
 
+  //! Get the layers of the network.
+  const std::vector<LayerTypes>& Model() const { return network; }
+
+  //! Get the number of worker networks used for training.
+  size_t Workers() const { return workers; }
+  /**
+   * Modify the number of worker networks used for training.  If this is larger
+   * than one, Train() clones the network once for each worker, and every call
+   * to Gradient() splits the batch across the clones, which run in parallel
+   * when OpenMP is available.  The clones share the parameters of this network
+   * and their gradients are summed, so the optimizer takes the same steps as
+   * with a single network; this holds for the dense and the sparse gradient.
+   * Layer state that is not part of the parameters is only updated in the
+   * clones, so at the end of Train() the layers of the first clone replace
+   * the layers of this network.
+   */
+  size_t& Workers() { return workers; }
+
   /**
    * Reset the module infomration (weights/parameters).
    */
@@ -300,6 +338,78 @@ class FFN
    */
   void ResetGradients(arma::mat& gradient);
 
+  /**
+   * Let the weights of all layers use the memory of the parameters of this
+   * network.  This is needed whenever the parameters were copied or moved,
+   * since small matrices are copied into their local memory even when moved.
+   */
+  void ResetLayerWeights();
+
+  /**
+   * Create the worker networks used by Gradient(), if more than one worker was
+   * requested.  Each worker is a copy of this network whose layers use the
+   * memory of the parameters of this network.
+   */
+  void ResetWorkers();
+
+  //! Delete the worker networks.
+  void DeleteWorkers();
+
+  /**
+   * Compute the gradient of this worker network for the given batch and store
+   * it in the gradient member.
+   *
+   * @param input The predictors of the batch.
+   * @param target The responses of the batch.
+   */
+  void WorkerGradient(arma::mat&& input, arma::mat&& target);
+
+  /**
+   * Compute the gradient of this worker network for the given batch and store
+   * it in the gradient member; only the entries given by gradientIndices are
+   * written.
+   *
+   * @param input The predictors of the batch.
+   * @param target The responses of the batch.
+   */
+  void WorkerSparseGradient(arma::mat&& input, arma::mat&& target);
+
+  /**
+   * Replace the layers of this network with the layers of the first worker
+   * network, so that layer state that is not part of the parameters and that
+   * was updated during training is kept.
+   */
+  void LoadWorkerState();
+
+  //! Store the entries of the gradient written by the last pass.
+  void ResetGradientIndices();
+
+  /**
+   * Get the given batch of predictors.  The returned matrix uses the memory of
+   * the predictors, so no copy is made.
+   *
+   * @param begin Index of the first point of the batch.
+   * @param batchSize Number of points in the batch.
+   */
+  arma::mat PredictorBatch(const size_t begin, const size_t batchSize)
+  {
+    return arma::mat(predictors.colptr(begin), predictors.n_rows, batchSize,
+        false, true);
+  }
+
+  /**
+   * Get the given batch of responses.  The returned matrix uses the memory of
+   * the responses, so no copy is made.
+   *
+   * @param begin Index of the first point of the batch.
+   * @param batchSize Number of points in the batch.
+   */
+  arma::mat ResponseBatch(const size_t begin, const size_t batchSize)
+  {
+    return arma::mat(responses.colptr(begin), responses.n_rows, batchSize,
+        false, true);
+  }
+
   /**
    * Swap the content of this network with given network.
    *
@@ -377,11 +487,22 @@ class FFN
   //! Locally-stored output parameter object.
   arma::mat outputParameter;
 
-  //! Locally-stored gradient parameter.
+  //! Locally-stored gradient parameter; the workspace of the sparse
+  //! Gradient().
   arma::mat gradient;
 
+  //! The indices of the gradient entries written by the last sparse
+  //! Gradient() call.
+  arma::uvec gradientIndices;
+
   //! Locally-stored copy visitor
   CopyVisitor copyVisitor;
+
+  //! The number of worker networks used for training.
+  size_t workers;
+
+  //! The worker networks that share the batches of Gradient().
+  std::vector<NetworkType*> workerNetworks;
 }; // class FFN
 
 } // namespace ann
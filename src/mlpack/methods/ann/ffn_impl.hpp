@@ -22,6 +22,7 @@
 #include "visitor/gradient_visitor.hpp"
 #include "visitor/set_input_height_visitor.hpp"
 #include "visitor/set_input_width_visitor.hpp"
+#include "visitor/sparse_gradient_visitor.hpp"
 
 #include <boost/serialization/variant.hpp>
 
@@ -38,7 +39,8 @@ FFN<OutputLayerType, InitializationRuleType>::FFN(
     height(0),
     reset(false),
     numFunctions(0),
-    deterministic(true)
+    deterministic(true),
+    workers(1)
 {
   /* Nothing to do here */
 }
@@ -56,7 +58,8 @@ FFN<OutputLayerType, InitializationRuleType>::FFN(
     reset(false),
     predictors(std::move(predictors)),
     responses(std::move(responses)),
-    deterministic(true)
+    deterministic(true),
+    workers(1)
 {
   numFunctions = this->responses.n_cols;
 }
@@ -64,6 +67,7 @@ FFN<OutputLayerType, InitializationRuleType>::FFN(
 template<typename OutputLayerType, typename InitializationRuleType>
 FFN<OutputLayerType, InitializationRuleType>::~FFN()
 {
+  DeleteWorkers();
   std::for_each(network.begin(), network.end(),
       boost::apply_visitor(deleteVisitor));
 }
@@ -91,11 +95,16 @@ void FFN<OutputLayerType, InitializationRuleType>::Train(
 {
   ResetData(std::move(predictors), std::move(responses));
 
+  ResetWorkers();
+
   // Train the model.
   Timer::Start("ffn_optimization");
   const double out = optimizer.Optimize(*this, parameter);
   Timer::Stop("ffn_optimization");
 
+  LoadWorkerState();
+  DeleteWorkers();
+
   Log::Info << "FFN::FFN(): final objective of trained model is " << out
       << "." << std::endl;
 }
@@ -118,11 +127,16 @@ void FFN<OutputLayerType, InitializationRuleType>::Train(
 
   OptimizerType optimizer;
 
+  ResetWorkers();
+
   // Train the model.
   Timer::Start("ffn_optimization");
   const double out = optimizer.Optimize(*this, parameter);
   Timer::Stop("ffn_optimization");
 
+  LoadWorkerState();
+  DeleteWorkers();
+
   Log::Info << "FFN::FFN(): final objective of trained model is " << out
       << "." << std::endl;
 }
@@ -224,10 +238,10 @@ double FFN<OutputLayerType, InitializationRuleType>::Evaluate(
     ResetDeterministic();
   }
 
-  Forward(std::move(predictors.cols(begin, begin + batchSize - 1)));
+  Forward(PredictorBatch(begin, batchSize));
   double res = outputLayer.Forward(
       std::move(boost::apply_visitor(outputParameterVisitor, network.back())),
-      std::move(responses.cols(begin, begin + batchSize - 1)));
+      ResponseBatch(begin, batchSize));
 
   return res;
 }
@@ -239,6 +253,28 @@ void FFN<OutputLayerType, InitializationRuleType>::Gradient(
     arma::mat& gradient,
     const size_t batchSize)
 {
+  // Split the batch across the worker networks and sum their gradients.
+  if (!workerNetworks.empty())
+  {
+    const size_t numWorkers = std::min(workerNetworks.size(), batchSize);
+
+    #pragma omp parallel for schedule(static)
+    for (omp_size_t w = 0; w < (omp_size_t) numWorkers; ++w)
+    {
+      const size_t workerBegin = begin + w * batchSize / numWorkers;
+      const size_t workerEnd = begin + (w + 1) * batchSize / numWorkers;
+      workerNetworks[w]->WorkerGradient(
+          PredictorBatch(workerBegin, workerEnd - workerBegin),
+          ResponseBatch(workerBegin, workerEnd - workerBegin));
+    }
+
+    gradient = workerNetworks[0]->gradient;
+    for (size_t w = 1; w < numWorkers; ++w)
+      gradient += workerNetworks[w]->gradient;
+
+    return;
+  }
+
   if (gradient.is_empty())
   {
     if (parameter.is_empty())
@@ -255,12 +291,85 @@ void FFN<OutputLayerType, InitializationRuleType>::Gradient(
 
   outputLayer.Backward(
       std::move(boost::apply_visitor(outputParameterVisitor, network.back())),
-      std::move(responses.cols(begin, begin + batchSize - 1)),
+      ResponseBatch(begin, batchSize),
       std::move(error));
 
   Backward();
   ResetGradients(gradient);
-  Gradient(std::move(predictors.cols(begin, begin + batchSize - 1)));
+  Gradient(PredictorBatch(begin, batchSize));
+}
+
+template<typename OutputLayerType, typename InitializationRuleType>
+void FFN<OutputLayerType, InitializationRuleType>::Gradient(
+    const arma::mat& parameters,
+    const size_t begin,
+    arma::sp_mat& gradient,
+    const size_t batchSize)
+{
+  if (parameter.is_empty())
+    ResetParameters();
+
+  arma::uvec indices;
+  arma::vec values;
+  if (!workerNetworks.empty())
+  {
+    // Split the batch across the worker networks and sum their gradients over
+    // the entries that any of them wrote to.
+    const size_t numWorkers = std::min(workerNetworks.size(), batchSize);
+
+    #pragma omp parallel for schedule(static)
+    for (omp_size_t w = 0; w < (omp_size_t) numWorkers; ++w)
+    {
+      const size_t workerBegin = begin + w * batchSize / numWorkers;
+      const size_t workerEnd = begin + (w + 1) * batchSize / numWorkers;
+      workerNetworks[w]->WorkerSparseGradient(
+          PredictorBatch(workerBegin, workerEnd - workerBegin),
+          ResponseBatch(workerBegin, workerEnd - workerBegin));
+    }
+
+    std::vector<arma::uword> workerIndices;
+    for (size_t w = 0; w < numWorkers; ++w)
+    {
+      workerIndices.insert(workerIndices.end(),
+          workerNetworks[w]->gradientIndices.begin(),
+          workerNetworks[w]->gradientIndices.end());
+    }
+    indices = arma::unique(arma::uvec(workerIndices));
+
+    values.zeros(indices.n_elem);
+    for (size_t w = 0; w < numWorkers; ++w)
+      values += workerNetworks[w]->gradient.elem(indices);
+  }
+  else
+  {
+    // Only the entries written by the last call can be non-zero.
+    if (this->gradient.n_rows != parameter.n_rows ||
+        this->gradient.n_cols != parameter.n_cols)
+      this->gradient.zeros(parameter.n_rows, parameter.n_cols);
+    else
+      this->gradient.elem(gradientIndices).zeros();
+
+    Evaluate(parameters, begin, batchSize, false);
+
+    outputLayer.Backward(
+        std::move(boost::apply_visitor(outputParameterVisitor,
+        network.back())), ResponseBatch(begin, batchSize), std::move(error));
+
+    Backward();
+    ResetGradients(this->gradient);
+    Gradient(PredictorBatch(begin, batchSize));
+
+    ResetGradientIndices();
+    indices = gradientIndices;
+    values = this->gradient.elem(gradientIndices);
+  }
+
+  // The parameters are stored in a single column, so the flat indices are the
+  // row indices of the sparse gradient.
+  arma::umat locations(2, indices.n_elem, arma::fill::zeros);
+  locations.row(0) = indices.t();
+  gradient = arma::sp_mat(locations, values, parameter.n_rows,
+      parameter.n_cols, true, false);
 }
 
 template<typename OutputLayerType, typename InitializationRuleType>
@@ -279,6 +388,133 @@ void FFN<OutputLayerType, InitializationRuleType>::ResetParameters()
   networkInit.Initialize(network, parameter);
 }
 
+template<typename OutputLayerType, typename InitializationRuleType>
+void FFN<OutputLayerType, InitializationRuleType>::ResetWorkers()
+{
+  DeleteWorkers();
+  if (workers <= 1)
+    return;
+
+  if (parameter.is_empty())
+    ResetParameters();
+
+  for (size_t w = 0; w < workers; ++w)
+  {
+    NetworkType* worker = new NetworkType(outputLayer, initializeRule);
+    for (size_t i = 0; i < network.size(); ++i)
+    {
+      worker->network.push_back(boost::apply_visitor(copyVisitor,
+          network[i]));
+    }
+
+    // Use the parameters of this network, so that the steps of the optimizer
+    // are seen by all workers.
+    worker->parameter = arma::mat(parameter.memptr(), parameter.n_rows,
+        parameter.n_cols, false, false);
+
+    size_t offset = 0;
+    for (size_t i = 0; i < worker->network.size(); ++i)
+    {
+      offset += boost::apply_visitor(WeightSetVisitor(
+          std::move(worker->parameter), offset), worker->network[i]);
+
+      boost::apply_visitor(resetVisitor, worker->network[i]);
+    }
+
+    worker->deterministic = false;
+    worker->ResetDeterministic();
+    worker->gradient.zeros(parameter.n_rows, parameter.n_cols);
+
+    workerNetworks.push_back(worker);
+  }
+}
+
+template<typename OutputLayerType, typename InitializationRuleType>
+void FFN<OutputLayerType, InitializationRuleType>::DeleteWorkers()
+{
+  for (size_t w = 0; w < workerNetworks.size(); ++w)
+    delete workerNetworks[w];
+
+  workerNetworks.clear();
+}
+
+template<typename OutputLayerType, typename InitializationRuleType>
+void FFN<OutputLayerType, InitializationRuleType>::WorkerGradient(
+    arma::mat&& input, arma::mat&& target)
+{
+  gradient.zeros();
+
+  Forward(std::move(input));
+
+  outputLayer.Backward(
+      std::move(boost::apply_visitor(outputParameterVisitor, network.back())),
+      std::move(target),
+      std::move(error));
+
+  Backward();
+  ResetGradients(gradient);
+  Gradient(std::move(input));
+}
+
+template<typename OutputLayerType, typename InitializationRuleType>
+void FFN<OutputLayerType, InitializationRuleType>::WorkerSparseGradient(
+    arma::mat&& input, arma::mat&& target)
+{
+  // Only the entries written by the last call can be non-zero.
+  gradient.elem(gradientIndices).zeros();
+
+  Forward(std::move(input));
+
+  outputLayer.Backward(
+      std::move(boost::apply_visitor(outputParameterVisitor, network.back())),
+      std::move(target),
+      std::move(error));
+
+  Backward();
+  ResetGradients(gradient);
+  Gradient(std::move(input));
+
+  ResetGradientIndices();
+}
+
+template<typename OutputLayerType, typename InitializationRuleType>
+void FFN<OutputLayerType, InitializationRuleType>::LoadWorkerState()
+{
+  if (workerNetworks.empty())
+    return;
+
+  // All training passes ran on the workers, so layer state that is not part
+  // of the parameters was only updated there.  Take the layers of the first
+  // worker and let them use the parameters of this network.
+  size_t offset = 0;
+  for (size_t i = 0; i < network.size(); ++i)
+  {
+    boost::apply_visitor(deleteVisitor, network[i]);
+    network[i] = boost::apply_visitor(copyVisitor,
+        workerNetworks[0]->network[i]);
+
+    offset += boost::apply_visitor(WeightSetVisitor(std::move(parameter),
+        offset), network[i]);
+
+    boost::apply_visitor(resetVisitor, network[i]);
+  }
+
+  ResetDeterministic();
+}
+
+template<typename OutputLayerType, typename InitializationRuleType>
+void FFN<OutputLayerType, InitializationRuleType>::ResetGradientIndices()
+{
+  std::vector<arma::uword> indices;
+  size_t offset = 0;
+  for (size_t i = 0; i < network.size(); ++i)
+  {
+    offset += boost::apply_visitor(SparseGradientVisitor(indices, offset),
+        network[i]);
+  }
+  gradientIndices = arma::uvec(indices);
+}
+
 template<typename OutputLayerType, typename InitializationRuleType>
 void FFN<OutputLayerType, InitializationRuleType>::ResetDeterministic()
 {
@@ -299,6 +535,19 @@ void FFN<OutputLayerType, InitializationRuleType>::ResetGradients(
   }
 }
 
+template<typename OutputLayerType, typename InitializationRuleType>
+void FFN<OutputLayerType, InitializationRuleType>::ResetLayerWeights()
+{
+  size_t offset = 0;
+  for (size_t i = 0; i < network.size(); ++i)
+  {
+    offset += boost::apply_visitor(WeightSetVisitor(std::move(parameter),
+        offset), network[i]);
+
+    boost::apply_visitor(resetVisitor, network[i]);
+  }
+}
+
 template<typename OutputLayerType, typename InitializationRuleType>
 void FFN<OutputLayerType, InitializationRuleType>::Forward(arma::mat&& input)
 {
@@ -448,6 +697,9 @@ void FFN<OutputLayerType, InitializationRuleType>::Swap(FFN& network)
   std::swap(inputParameter, network.inputParameter);
   std::swap(outputParameter, network.outputParameter);
   std::swap(gradient, network.gradient);
+  std::swap(gradientIndices, network.gradientIndices);
+  std::swap(workers, network.workers);
+  std::swap(workerNetworks, network.workerNetworks);
 };
 
 template<typename OutputLayerType, typename InitializationRuleType>
@@ -468,7 +720,9 @@ FFN<OutputLayerType, InitializationRuleType>::FFN(
     delta(network.delta),
     inputParameter(network.inputParameter),
     outputParameter(network.outputParameter),
-    gradient(network.gradient)
+    gradient(network.gradient),
+    gradientIndices(network.gradientIndices),
+    workers(network.workers)
 {
   // Build new layers according to source network
   for (size_t i = 0; i < network.network.size(); ++i)
@@ -476,6 +730,11 @@ FFN<OutputLayerType, InitializationRuleType>::FFN(
     this->network.push_back(boost::apply_visitor(copyVisitor,
         network.network[i]));
   }
+
+  // The copied layers hold copies of the weights; let them use the copied
+  // parameters instead, so that modifying Parameters() changes the copy.
+  if (!parameter.is_empty())
+    ResetLayerWeights();
 };
 
 template<typename OutputLayerType, typename InitializationRuleType>
@@ -496,9 +755,20 @@ FFN<OutputLayerType, InitializationRuleType>::FFN(
     delta(std::move(network.delta)),
     inputParameter(std::move(network.inputParameter)),
     outputParameter(std::move(network.outputParameter)),
-    gradient(std::move(network.gradient))
+    gradient(std::move(network.gradient)),
+    gradientIndices(std::move(network.gradientIndices)),
+    workers(network.workers)
 {
+  // The worker networks use the memory of the parameters of the source
+  // network; they are only needed during Train(), so drop them.
+  network.DeleteWorkers();
+
   this->network = std::move(network.network);
+
+  // Small parameter matrices are copied instead of moved, and the layers would
+  // still use the memory of the source network.
+  if (!parameter.is_empty())
+    ResetLayerWeights();
 };
 
 template<typename OutputLayerType, typename InitializationRuleType>
@@ -506,6 +776,12 @@ FFN<OutputLayerType, InitializationRuleType>&
 FFN<OutputLayerType, InitializationRuleType>::operator = (FFN network)
 {
   Swap(network);
+
+  // Small parameter matrices are copied by the swap instead of exchanged, and
+  // the layers would still use the memory of the temporary network.
+  if (!parameter.is_empty())
+    ResetLayerWeights();
+
   return *this;
 };
 
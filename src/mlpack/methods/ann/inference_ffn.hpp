@@ -0,0 +1,248 @@
+/**
+ * @file inference_ffn.hpp
+ *
+ * Definition of the InferenceFFN class, a frozen, prediction-only copy of a
+ * trained feed forward network.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_INFERENCE_FFN_HPP
+#define MLPACK_METHODS_ANN_INFERENCE_FFN_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#include "ffn.hpp"
+#include "layer/layer.hpp"
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+/**
+ * An InferenceFFN is exported from a trained FFN and can only be used to
+ * predict.  It holds nothing but the weights the predictions depend on:
+ *
+ *  - Dropout and DropConnect layers are dropped; what they do in
+ *    deterministic mode (a constant scale, or the inner Linear layer) is kept.
+ *  - Every Linear or LinearNoBias layer is folded together with the
+ *    MultiplyConstant layers and the activation that follow it into a single
+ *    layer, so that a chain such as Linear, MultiplyConstant, ReLULayer needs
+ *    one output matrix and no intermediate copies.  A constant scale after
+ *    the activation is folded into the weights of the next layer.
+ *  - Training state such as the deltas, gradients, dropout masks and the
+ *    training data is not exported.
+ *
+ * Predict() is const and only uses local memory, so a single InferenceFFN
+ * can be used by many threads at the same time.  The model can be saved and
+ * loaded with data::Save() and data::Load(); the binary format only stores
+ * the folded weights.
+ *
+ * @code
+ * FFN<NegativeLogLikelihood<> > model;
+ * // ... add layers and train the model ...
+ *
+ * InferenceFFN inferenceModel(model);
+ * data::Save("model.bin", "model", inferenceModel);
+ *
+ * arma::mat predictions;
+ * inferenceModel.Predict(testData, predictions);
+ * @endcode
+ *
+ * The supported layers are Linear, LinearNoBias, the BaseLayer activations
+ * (except SoftPlus, SoftSign and Swish), LeakyReLU, HardTanH, ELU,
+ * MultiplyConstant, Dropout, DropConnect and LogSoftMax; exporting a network
+ * with any other layer throws std::invalid_argument.
+ */
+class InferenceFFN
+{
+ public:
+  /**
+   * Create an empty InferenceFFN, e.g. to load a saved model into.
+   */
+  InferenceFFN();
+
+  /**
+   * Export the given trained network.
+   *
+   * @param network The network to export; its parameters must be set.
+   */
+  template<typename OutputLayerType, typename InitializationRuleType>
+  InferenceFFN(const FFN<OutputLayerType, InitializationRuleType>& network);
+
+  /**
+   * Predict the responses to a given set of predictors. The responses are the
+   * same as the ones FFN::Predict() gives for the exported network.  This
+   * function can be called by several threads at the same time.
+   *
+   * @param predictors Input predictors.
+   * @param results Matrix to put output predictions of responses into.
+   */
+  void Predict(const arma::mat& predictors, arma::mat& results) const;
+
+  //! Get the number of layers left after folding.
+  size_t NumLayers() const { return layers.size(); }
+
+  //! Serialize the model.
+  template<typename Archive>
+  void serialize(Archive& ar, const unsigned int /* version */);
+
+ private:
+  //! The activation functions a folded layer can apply.
+  enum ActivationType
+  {
+    IDENTITY,
+    LOGISTIC,
+    TANH,
+    RECTIFIER,
+    LEAKY_RECTIFIER,
+    HARD_TANH,
+    ELU_FUNCTION,
+    LOG_SOFTMAX
+  };
+
+  /**
+   * A folded layer, which computes scale * f(weights * input + bias).  The
+   * weights (and bias) can be empty, in which case the input is used.
+   */
+  class FoldedLayer
+  {
+   public:
+    //! Create an identity layer.
+    FoldedLayer();
+
+    /**
+     * Compute the output of the layer for the given input.
+     *
+     * @param input Input data used for evaluating the layer.
+     * @param output Resulting output activation.
+     */
+    void Forward(const arma::mat& input, arma::mat& output) const;
+
+    //! Serialize the layer.
+    template<typename Archive>
+    void serialize(Archive& ar, const unsigned int /* version */);
+
+    //! The weights, or an empty matrix.
+    arma::mat weights;
+
+    //! The bias, or an empty vector.
+    arma::vec bias;
+
+    //! The activation function applied after the affine transformation.
+    ActivationType activation;
+
+    //! The parameter of the LeakyReLU and ELU activation.
+    double alpha;
+
+    //! The minimum value of the HardTanH activation.
+    double minValue;
+
+    //! The maximum value of the HardTanH activation.
+    double maxValue;
+
+    //! The scale applied after the activation.
+    double scale;
+  };
+
+  /**
+   * ExportVisitor adds the layers of the exported network to the
+   * InferenceFFN.
+   */
+  class ExportVisitor : public boost::static_visitor<void>
+  {
+   public:
+    //! Add the layers to the given network.
+    ExportVisitor(InferenceFFN& network) : network(network) { }
+
+    //! Add a Linear layer.
+    void operator()(Linear<>* layer) const;
+
+    //! Add a LinearNoBias layer.
+    void operator()(LinearNoBias<>* layer) const;
+
+    //! Add a sigmoid layer.
+    void operator()(SigmoidLayer<>* layer) const;
+
+    //! Identity layers do not change the input.
+    void operator()(IdentityLayer<>* /* layer */) const { }
+
+    //! Add a tanh layer.
+    void operator()(TanHLayer<>* layer) const;
+
+    //! Add a ReLU layer.
+    void operator()(ReLULayer<>* layer) const;
+
+    //! Add a LeakyReLU layer.
+    void operator()(LeakyReLU<>* layer) const;
+
+    //! Add a HardTanH layer.
+    void operator()(HardTanH<>* layer) const;
+
+    //! Add an ELU layer.
+    void operator()(ELU<>* layer) const;
+
+    //! Add a MultiplyConstant layer.
+    void operator()(MultiplyConstant<>* layer) const;
+
+    //! Add what a Dropout layer does in deterministic mode.
+    void operator()(Dropout<>* layer) const;
+
+    //! Add the Linear layer of a DropConnect layer.
+    void operator()(DropConnect<>* layer) const;
+
+    //! Add a LogSoftMax layer.
+    void operator()(LogSoftMax<>* layer) const;
+
+    //! Reject all other layers.
+    template<typename LayerType>
+    void operator()(LayerType* layer) const;
+
+   private:
+    //! The network the layers are added to.
+    InferenceFFN& network;
+  };
+
+  /**
+   * Add an affine transformation; the scale of the preceding layer is folded
+   * into the weights.
+   *
+   * @param weights The weights of the transformation.
+   * @param bias The bias of the transformation, or an empty vector.
+   */
+  void AddLinear(arma::mat weights, arma::vec bias);
+
+  /**
+   * Add a constant scale; it is folded into the weights of a preceding
+   * affine transformation without an activation.
+   *
+   * @param scale The constant scale.
+   */
+  void AddScale(const double scale);
+
+  /**
+   * Add an activation function; it is folded into a preceding affine
+   * transformation without an activation.
+   *
+   * @param activation The activation function.
+   * @param alpha The parameter of the LeakyReLU and ELU activation.
+   * @param minValue The minimum value of the HardTanH activation.
+   * @param maxValue The maximum value of the HardTanH activation.
+   */
+  void AddActivation(const ActivationType activation,
+                     const double alpha = 0,
+                     const double minValue = 0,
+                     const double maxValue = 0);
+
+  //! The folded layers.
+  std::vector<FoldedLayer> layers;
+}; // class InferenceFFN
+
+} // namespace ann
+} // namespace mlpack
+
+// Include implementation.
+#include "inference_ffn_impl.hpp"
+
+#endif
@@ -0,0 +1,289 @@
+/**
+ * @file inference_ffn_impl.hpp
+ *
+ * Implementation of the InferenceFFN class, a frozen, prediction-only copy of
+ * a trained feed forward network.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_INFERENCE_FFN_IMPL_HPP
+#define MLPACK_METHODS_ANN_INFERENCE_FFN_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "inference_ffn.hpp"
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+inline InferenceFFN::InferenceFFN()
+{
+  /* Nothing to do here */
+}
+
+template<typename OutputLayerType, typename InitializationRuleType>
+InferenceFFN::InferenceFFN(
+    const FFN<OutputLayerType, InitializationRuleType>& network)
+{
+  if (network.Parameters().is_empty())
+  {
+    throw std::invalid_argument("InferenceFFN::InferenceFFN(): the "
+        "parameters of the network are not initialized");
+  }
+
+  for (size_t i = 0; i < network.Model().size(); ++i)
+    boost::apply_visitor(ExportVisitor(*this), network.Model()[i]);
+}
+
+inline void InferenceFFN::Predict(const arma::mat& predictors,
+                                  arma::mat& results) const
+{
+  // Each layer only reads the output of the preceding layer, so two buffers
+  // are enough.
+  arma::mat buffers[2];
+  const arma::mat* input = &predictors;
+  for (size_t i = 0; i < layers.size(); ++i)
+  {
+    layers[i].Forward(*input, buffers[i % 2]);
+    input = &buffers[i % 2];
+  }
+
+  if (layers.empty())
+    results = predictors;
+  else
+    results = std::move(buffers[(layers.size() - 1) % 2]);
+}
+
+template<typename Archive>
+void InferenceFFN::serialize(Archive& ar, const unsigned int /* version */)
+{
+  ar & BOOST_SERIALIZATION_NVP(layers);
+}
+
+inline void InferenceFFN::AddLinear(arma::mat weights, arma::vec bias)
+{
+  if (!layers.empty())
+  {
+    // The scale of the preceding layer is applied right before the weights,
+    // so it can be folded into them.
+    weights *= layers.back().scale;
+    layers.back().scale = 1.0;
+
+    // A preceding layer that only scaled its input is not needed anymore.
+    if (layers.back().weights.is_empty() &&
+        layers.back().activation == IDENTITY)
+      layers.pop_back();
+  }
+
+  layers.push_back(FoldedLayer());
+  layers.back().weights = std::move(weights);
+  layers.back().bias = std::move(bias);
+}
+
+inline void InferenceFFN::AddScale(const double scale)
+{
+  if (layers.empty())
+  {
+    layers.push_back(FoldedLayer());
+    layers.back().scale = scale;
+  }
+  else if (layers.back().activation == IDENTITY &&
+      !layers.back().weights.is_empty())
+  {
+    layers.back().weights *= scale;
+    layers.back().bias *= scale;
+  }
+  else
+  {
+    layers.back().scale *= scale;
+  }
+}
+
+inline void InferenceFFN::AddActivation(const ActivationType activation,
+                                        const double alpha,
+                                        const double minValue,
+                                        const double maxValue)
+{
+  // The activation has to be applied before the scale of the preceding layer,
+  // so it can't be folded into a layer that already scales its output.
+  if (layers.empty() || layers.back().activation != IDENTITY ||
+      layers.back().scale != 1.0)
+  {
+    layers.push_back(FoldedLayer());
+  }
+
+  layers.back().activation = activation;
+  layers.back().alpha = alpha;
+  layers.back().minValue = minValue;
+  layers.back().maxValue = maxValue;
+}
+
+inline InferenceFFN::FoldedLayer::FoldedLayer() :
+    activation(IDENTITY),
+    alpha(0),
+    minValue(0),
+    maxValue(0),
+    scale(1.0)
+{
+  /* Nothing to do here */
+}
+
+inline void InferenceFFN::FoldedLayer::Forward(const arma::mat& input,
+                                               arma::mat& output) const
+{
+  if (weights.is_empty())
+  {
+    output = input;
+  }
+  else
+  {
+    output = weights * input;
+    if (!bias.is_empty())
+      output.each_col() += bias;
+  }
+
+  // The activations are computed in place, as the layers do it.
+  switch (activation)
+  {
+    case IDENTITY:
+      break;
+    case LOGISTIC:
+      LogisticFunction::Fn(output, output);
+      break;
+    case TANH:
+      TanhFunction::Fn(output, output);
+      break;
+    case RECTIFIER:
+      RectifierFunction::Fn(output, output);
+      break;
+    case LEAKY_RECTIFIER:
+      output = arma::max(output, alpha * output);
+      break;
+    case HARD_TANH:
+      output = arma::clamp(output, minValue, maxValue);
+      break;
+    case ELU_FUNCTION:
+      output.transform([this](double x) -> double
+      {
+        if (x < DBL_MAX)
+          return (x > 0) ? x : alpha * (std::exp(x) - 1);
+        return 1.0;
+      });
+      break;
+    case LOG_SOFTMAX:
+    {
+      // The layer only reads its input; it is created here so that no state
+      // is shared between threads.
+      LogSoftMax<> logSoftMax;
+      arma::mat logProbabilities;
+      logSoftMax.Forward(std::move(output), std::move(logProbabilities));
+      output = std::move(logProbabilities);
+      break;
+    }
+  }
+
+  if (scale != 1.0)
+    output *= scale;
+}
+
+template<typename Archive>
+void InferenceFFN::FoldedLayer::serialize(
+    Archive& ar, const unsigned int /* version */)
+{
+  ar & BOOST_SERIALIZATION_NVP(weights);
+  ar & BOOST_SERIALIZATION_NVP(bias);
+  ar & BOOST_SERIALIZATION_NVP(activation);
+  ar & BOOST_SERIALIZATION_NVP(alpha);
+  ar & BOOST_SERIALIZATION_NVP(minValue);
+  ar & BOOST_SERIALIZATION_NVP(maxValue);
+  ar & BOOST_SERIALIZATION_NVP(scale);
+}
+
+inline void InferenceFFN::ExportVisitor::operator()(Linear<>* layer) const
+{
+  const arma::mat& parameters = layer->Parameters();
+  const size_t weightSize = layer->OutputSize() * layer->InputSize();
+  network.AddLinear(arma::mat(parameters.memptr(), layer->OutputSize(),
+      layer->InputSize()), arma::vec(parameters.memptr() + weightSize,
+      layer->OutputSize()));
+}
+
+inline void InferenceFFN::ExportVisitor::operator()(
+    LinearNoBias<>* layer) const
+{
+  network.AddLinear(arma::mat(layer->Parameters().memptr(),
+      layer->OutputSize(), layer->InputSize()), arma::vec());
+}
+
+inline void InferenceFFN::ExportVisitor::operator()(
+    SigmoidLayer<>* /* layer */) const
+{
+  network.AddActivation(LOGISTIC);
+}
+
+inline void InferenceFFN::ExportVisitor::operator()(
+    TanHLayer<>* /* layer */) const
+{
+  network.AddActivation(TANH);
+}
+
+inline void InferenceFFN::ExportVisitor::operator()(
+    ReLULayer<>* /* layer */) const
+{
+  network.AddActivation(RECTIFIER);
+}
+
+inline void InferenceFFN::ExportVisitor::operator()(LeakyReLU<>* layer) const
+{
+  network.AddActivation(LEAKY_RECTIFIER, layer->Alpha());
+}
+
+inline void InferenceFFN::ExportVisitor::operator()(HardTanH<>* layer) const
+{
+  network.AddActivation(HARD_TANH, 0, layer->MinValue(), layer->MaxValue());
+}
+
+inline void InferenceFFN::ExportVisitor::operator()(ELU<>* layer) const
+{
+  network.AddActivation(ELU_FUNCTION, layer->Alpha());
+}
+
+inline void InferenceFFN::ExportVisitor::operator()(
+    MultiplyConstant<>* layer) const
+{
+  network.AddScale(layer->Scalar());
+}
+
+inline void InferenceFFN::ExportVisitor::operator()(Dropout<>* layer) const
+{
+  // In deterministic mode the input is only rescaled.
+  if (layer->Rescale())
+    network.AddScale(1.0 / (1.0 - layer->Ratio()));
+}
+
+inline void InferenceFFN::ExportVisitor::operator()(
+    DropConnect<>* layer) const
+{
+  // In deterministic mode the inner Linear layer is used as it is.
+  boost::apply_visitor(*this, layer->Model().front());
+}
+
+inline void InferenceFFN::ExportVisitor::operator()(
+    LogSoftMax<>* /* layer */) const
+{
+  network.AddActivation(LOG_SOFTMAX);
+}
+
+template<typename LayerType>
+void InferenceFFN::ExportVisitor::operator()(LayerType* /* layer */) const
+{
+  throw std::invalid_argument("InferenceFFN::InferenceFFN(): the network "
+      "contains a layer that can't be exported");
+}
+
+} // namespace ann
+} // namespace mlpack
+
+#endif
@@ -14,6 +14,7 @@
 #define MLPACK_METHODS_ANN_LAYER_BASE_LAYER_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <mlpack/methods/ann/layer/layer_traits.hpp>
 #include <mlpack/methods/ann/activation_functions/logistic_function.hpp>
 #include <mlpack/methods/ann/activation_functions/identity_function.hpp>
 #include <mlpack/methods/ann/activation_functions/rectifier_function.hpp>
@@ -122,6 +123,23 @@ class BaseLayer
   OutputDataType outputParameter;
 }; // class BaseLayer
 
+//! The activation functions of the BaseLayer are applied elementwise.
+template<
+    class ActivationFunction,
+    typename InputDataType,
+    typename OutputDataType
+>
+class LayerTraits<BaseLayer<ActivationFunction, InputDataType, OutputDataType> >
+{
+ public:
+  static const bool IsBinary = false;
+  static const bool IsOutputLayer = false;
+  static const bool IsBiasLayer = false;
+  static const bool IsLSTMLayer = false;
+  static const bool IsConnection = false;
+  static const bool IsElementwise = true;
+};
+
 // Convenience typedefs.
 
 /**
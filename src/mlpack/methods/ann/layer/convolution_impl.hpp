@@ -91,9 +91,9 @@ void Convolution<
     OutputDataType
 >::Reset()
 {
-    weight = arma::cube(weights.memptr(), kW, kH,
-        outSize * inSize, false, false);
-    bias = arma::mat(weights.memptr() + weight.n_elem,
+    weight = arma::Cube<typename OutputDataType::elem_type>(weights.memptr(),
+        kW, kH, outSize * inSize, false, false);
+    bias = OutputDataType(weights.memptr() + weight.n_elem,
         outSize, 1, false, false);
 }
 
@@ -113,7 +113,9 @@ void Convolution<
     OutputDataType
 >::Forward(const arma::Mat<eT>&& input, arma::Mat<eT>&& output)
 {
-  inputTemp = arma::cube(input.memptr(), inputWidth, inputHeight, inSize);
+  // The input is only read, so the cube shares its memory.
+  inputTemp = arma::Cube<eT>(const_cast<arma::Mat<eT>&>(input).memptr(),
+      inputWidth, inputHeight, inSize, false, false);
 
   if (padW != 0 || padH != 0)
   {
@@ -123,14 +125,18 @@ void Convolution<
   size_t wConv = ConvOutSize(inputWidth, kW, dW, padW);
   size_t hConv = ConvOutSize(inputHeight, kH, dH, padH);
 
-  outputTemp = arma::zeros<arma::Cube<eT> >(wConv, hConv, outSize);
+  // The output maps are written directly into the output matrix; its memory
+  // is reused as long as the output size does not change.
+  output.set_size(wConv * hConv * outSize, 1);
+  outputTemp = arma::Cube<eT>(output.memptr(), wConv, hConv, outSize, false,
+      false);
+  outputTemp.zeros();
 
+  arma::Mat<eT> convOutput;
   for (size_t outMap = 0, outMapIdx = 0; outMap < outSize; outMap++)
   {
     for (size_t inMap = 0; inMap < inSize; inMap++, outMapIdx++)
     {
-      arma::Mat<eT> convOutput;
-
       if (padW != 0 || padH != 0)
       {
         ForwardConvolutionRule::Convolution(inputPaddedTemp.slice(inMap),
@@ -148,8 +154,6 @@ void Convolution<
     outputTemp.slice(outMap) += bias(outMap);
   }
 
-  output = arma::Mat<eT>(outputTemp.memptr(), outputTemp.n_elem, 1);
-
   outputWidth = outputTemp.n_rows;
   outputHeight = outputTemp.n_cols;
 }
@@ -171,19 +175,22 @@ void Convolution<
 >::Backward(
     const arma::Mat<eT>&& /* input */, arma::Mat<eT>&& gy, arma::Mat<eT>&& g)
 {
-  arma::cube mappedError = arma::cube(gy.memptr(),
-        outputWidth, outputHeight, outSize);
-  gTemp = arma::zeros<arma::Cube<eT> >(inputTemp.n_rows,
-      inputTemp.n_cols, inputTemp.n_slices);
+  arma::Cube<eT> mappedError(gy.memptr(), outputWidth, outputHeight, outSize,
+      false, false);
+
+  // The error maps are written directly into g.
+  g.set_size(inputTemp.n_elem, 1);
+  gTemp = arma::Cube<eT>(g.memptr(), inputTemp.n_rows, inputTemp.n_cols,
+      inputTemp.n_slices, false, false);
+  gTemp.zeros();
 
+  arma::Mat<eT> rotatedFilter, output;
   for (size_t outMap = 0, outMapIdx = 0; outMap < outSize; outMap++)
   {
     for (size_t inMap = 0; inMap < inSize; inMap++, outMapIdx++)
     {
-      arma::Mat<eT> rotatedFilter;
       Rotate180(weight.slice(outMapIdx), rotatedFilter);
 
-      arma::Mat<eT> output;
       BackwardConvolutionRule::Convolution(mappedError.slice(outMap),
           rotatedFilter, output, dW, dH);
 
@@ -200,8 +207,6 @@ void Convolution<
       }
     }
   }
-
-  g = arma::mat(gTemp.memptr(), gTemp.n_elem, 1);
 }
 
 template<
@@ -223,20 +228,22 @@ void Convolution<
     arma::Mat<eT>&& error,
     arma::Mat<eT>&& gradient)
 {
-  arma::cube mappedError;
+  arma::Cube<eT> mappedError;
   if (padW != 0 && padH != 0)
   {
-    mappedError = arma::cube(error.memptr(), outputWidth / padW,
-        outputHeight / padH, outSize);
+    mappedError = arma::Cube<eT>(error.memptr(), outputWidth / padW,
+        outputHeight / padH, outSize, false, false);
   }
   else
   {
-    mappedError = arma::cube(error.memptr(), outputWidth,
-        outputHeight, outSize);
+    mappedError = arma::Cube<eT>(error.memptr(), outputWidth,
+        outputHeight, outSize, false, false);
   }
 
-  gradientTemp = arma::zeros<arma::Cube<eT> >(weight.n_rows, weight.n_cols,
-      weight.n_slices);
+  // The weight gradient is accumulated directly into the gradient.
+  gradientTemp = arma::Cube<eT>(gradient.memptr(), weight.n_rows,
+      weight.n_cols, weight.n_slices, false, false);
+  gradientTemp.zeros();
 
   for (size_t outMap = 0, outMapIdx = 0; outMap < outSize; outMap++)
   {
@@ -265,7 +272,7 @@ void Convolution<
       {
         for (size_t i = 0; i < output.n_slices; i++)
         {
-          arma::mat subOutput = output.slice(i);
+          arma::Mat<eT> subOutput = output.slice(i);
 
           gradientTemp.slice(s) += subOutput.submat(subOutput.n_rows / 2,
               subOutput.n_cols / 2,
@@ -286,9 +293,6 @@ void Convolution<
         weight.n_elem + outMap, 0) = arma::accu(mappedError.slices(
         outMap, outMap));
   }
-
-  gradient.submat(0, 0, weight.n_elem - 1, 0) = arma::Mat<eT>(
-      gradientTemp.memptr(), gradientTemp.n_elem, 1, false, false);
 }
 
 template<
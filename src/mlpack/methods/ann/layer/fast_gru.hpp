@@ -0,0 +1,265 @@
+/**
+ * @file fast_gru.hpp
+ *
+ * Definition of the FastGRU class, which implements a GRU network layer whose
+ * gates are computed with fused products and elementwise passes.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_LAYER_FAST_GRU_HPP
+#define MLPACK_METHODS_ANN_LAYER_FAST_GRU_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <limits>
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+/**
+ * An implementation of a faster version of the GRU network layer.  The input
+ * products of the update gate, the reset gate and the hidden state are
+ * computed in a single product, as are the products of the previous output
+ * with the update and reset gates:
+ *
+ * @f{eqnarray}{
+ * z &=& sigmoid(W_z \cdot x + U_z \cdot h + b_z) \\
+ * r &=& sigmoid(W_r \cdot x + U_r \cdot h + b_r) \\
+ * o &=& tanh(W_o \cdot x + U_o \cdot (r \cdot h) + b_o) \\
+ * h &=& z \cdot h + (1 - z) \cdot o
+ * @f}
+ *
+ * Since the reset gate has to be applied to the previous output before the
+ * product with U_o, each time step needs three products and two elementwise
+ * passes instead of the one of FastLSTM.
+ *
+ * The parameters are laid out as W (3 * outSize x inSize), b (3 * outSize),
+ * U_zr (2 * outSize x outSize) and U_o (outSize x outSize), which is the same
+ * layout as the parameters of the GRU layer.
+ *
+ * \see GRU for the implementation that is built from other layers.
+ *
+ * @tparam InputDataType Type of the input data (arma::colvec, arma::mat,
+ *         arma::sp_mat or arma::cube).
+ * @tparam OutputDataType Type of the output data (arma::colvec, arma::mat,
+ *         arma::sp_mat or arma::cube).
+ */
+template <
+    typename InputDataType = arma::mat,
+    typename OutputDataType = arma::mat
+>
+class FastGRU
+{
+ public:
+  // Convenience typedefs.
+  typedef typename InputDataType::elem_type InputElemType;
+  typedef typename OutputDataType::elem_type ElemType;
+
+  //! Create the FastGRU object.
+  FastGRU();
+
+  /**
+   * Create the FastGRU layer object using the specified parameters.
+   *
+   * @param inSize The number of input units.
+   * @param outSize The number of output units.
+   * @param rho Maximum number of steps to backpropagate through time (BPTT).
+   */
+  FastGRU(const size_t inSize,
+          const size_t outSize,
+          const size_t rho = std::numeric_limits<size_t>::max());
+
+  /**
+   * Ordinary feed forward pass of a neural network, evaluating the function
+   * f(x) by propagating the activity forward through f.
+   *
+   * @param input Input data used for evaluating the specified function.
+   * @param output Resulting output activation.
+   */
+  template<typename InputType, typename OutputType>
+  void Forward(InputType&& input, OutputType&& output);
+
+  /**
+   * Ordinary feed backward pass of a neural network, calculating the function
+   * f(x) by propagating x backwards trough f. Using the results from the feed
+   * forward pass.
+   *
+   * @param input The propagated input activation.
+   * @param gy The backpropagated error.
+   * @param g The calculated gradient.
+   */
+  template<typename InputType, typename ErrorType, typename GradientType>
+  void Backward(const InputType&& input,
+                ErrorType&& gy,
+                GradientType&& g);
+
+  /*
+   * Reset the layer parameter.
+   */
+  void Reset();
+
+  /*
+   * Resets the cell to accept a new input. This breaks the BPTT chain starts a
+   * new one.
+   *
+   * @param size The current maximum number of steps through time.
+   */
+  void ResetCell(const size_t size);
+
+  /*
+   * Calculate the gradient using the output delta and the input activation.
+   *
+   * @param input The input parameter used for calculating the gradient.
+   * @param error The calculated error.
+   * @param gradient The calculated gradient.
+   */
+  template<typename InputType, typename ErrorType, typename GradientType>
+  void Gradient(InputType&& input,
+                ErrorType&& error,
+                GradientType&& gradient);
+
+  //! Get the maximum number of steps to backpropagate through time (BPTT).
+  size_t Rho() const { return rho; }
+  //! Modify the maximum number of steps to backpropagate through time (BPTT).
+  size_t& Rho() { return rho; }
+
+  //! Get the parameters.
+  OutputDataType const& Parameters() const { return weights; }
+  //! Modify the parameters.
+  OutputDataType& Parameters() { return weights; }
+
+  //! Get the input parameter.
+  InputDataType const& InputParameter() const { return inputParameter; }
+  //! Modify the input parameter.
+  InputDataType& InputParameter() { return inputParameter; }
+
+  //! Get the output parameter.
+  OutputDataType const& OutputParameter() const { return outputParameter; }
+  //! Modify the output parameter.
+  OutputDataType& OutputParameter() { return outputParameter; }
+
+  //! Get the delta.
+  OutputDataType const& Delta() const { return delta; }
+  //! Modify the delta.
+  OutputDataType& Delta() { return delta; }
+
+  //! Get the gradient.
+  OutputDataType const& Gradient() const { return grad; }
+  //! Modify the gradient.
+  OutputDataType& Gradient() { return grad; }
+
+  /**
+   * Serialize the layer
+   */
+  template<typename Archive>
+  void serialize(Archive& ar, const unsigned int /* version */);
+
+ private:
+  //! Compute the logistic function of the given value.
+  static ElemType Sigmoid(const ElemType x)
+  {
+    return 1.0 / (1.0 + std::exp(-x));
+  }
+
+  //! Locally-stored number of input units.
+  size_t inSize;
+
+  //! Locally-stored number of output units.
+  size_t outSize;
+
+  //! Number of steps to backpropagate through time (BPTT).
+  size_t rho;
+
+  //! Locally-stored number of forward steps.
+  size_t forwardStep;
+
+  //! Locally-stored number of backward steps.
+  size_t backwardStep;
+
+  //! Locally-stored number of gradient steps.
+  size_t gradientStep;
+
+  //! Locally-stored weight object.
+  OutputDataType weights;
+
+  //! Locally-stored batch size.
+  size_t batchSize;
+
+  //! Current batch step, alias for batchSize - 1.
+  size_t batchStep;
+
+  //! Current gradient step to keep track of the backpropagate through time
+  //! step.
+  size_t gradientStepIdx;
+
+  //! Locally-stored delta object.
+  OutputDataType delta;
+
+  //! Locally-stored gradient object.
+  OutputDataType grad;
+
+  //! Locally-stored input parameter object.
+  InputDataType inputParameter;
+
+  //! Locally-stored output parameter object.
+  OutputDataType outputParameter;
+
+  //! Weights between the input and gate.
+  OutputDataType input2GateWeight;
+
+  //! Bias between the input and gate.
+  OutputDataType input2GateBias;
+
+  //! Weights between the output and the update and reset gates.
+  OutputDataType output2GateWeight;
+
+  //! Weights between the reset output and the hidden state.
+  OutputDataType outputHidden2GateWeight;
+
+  //! Locally-stored activations of the update gate, the reset gate and the
+  //! hidden state.
+  OutputDataType gate;
+
+  //! Locally-stored previous output multiplied by the reset gate.
+  OutputDataType resetOutput;
+
+  //! Locally-stored product of the previous output and output2GateWeight.
+  OutputDataType outputGate;
+
+  //! Locally-stored product of the reset output and outputHidden2GateWeight.
+  OutputDataType hiddenGate;
+
+  //! Locally-stored error of the update and reset gates.
+  OutputDataType outputGateError;
+
+  //! Locally-stored error of the hidden state.
+  OutputDataType hiddenGateError;
+
+  //! Locally-stored error of the reset output.
+  OutputDataType resetError;
+
+  //! Locally-stored error of the previous output.
+  OutputDataType hiddenError;
+
+  //! Locally-stored error of all three gates.
+  OutputDataType prevError;
+
+  //! Locally-stored output parameters.
+  OutputDataType outParameter;
+
+  //! Locally-stored current rho size.
+  size_t rhoSize;
+
+  //! Current backpropagate through time steps.
+  size_t bpttSteps;
+}; // class FastGRU
+
+} // namespace ann
+} // namespace mlpack
+
+// Include implementation.
+#include "fast_gru_impl.hpp"
+
+#endif
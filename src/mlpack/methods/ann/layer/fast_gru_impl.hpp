@@ -0,0 +1,327 @@
+/**
+ * @file fast_gru_impl.hpp
+ *
+ * Implementation of the FastGRU class, which implements a GRU network layer
+ * whose gates are computed with fused products and elementwise passes.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_LAYER_FAST_GRU_IMPL_HPP
+#define MLPACK_METHODS_ANN_LAYER_FAST_GRU_IMPL_HPP
+
+// In case it hasn't yet been included.
+#include "fast_gru.hpp"
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+template<typename InputDataType, typename OutputDataType>
+FastGRU<InputDataType, OutputDataType>::FastGRU()
+{
+  // Nothing to do here.
+}
+
+template <typename InputDataType, typename OutputDataType>
+FastGRU<InputDataType, OutputDataType>::FastGRU(
+    const size_t inSize, const size_t outSize, const size_t rho) :
+    inSize(inSize),
+    outSize(outSize),
+    rho(rho),
+    forwardStep(0),
+    backwardStep(0),
+    gradientStep(0),
+    batchSize(0),
+    batchStep(0),
+    gradientStepIdx(0),
+    rhoSize(rho),
+    bpttSteps(0)
+{
+  // Weights for: input to gate layer (3 * outSize * inSize + 3 * outSize),
+  // output to the update and reset gates (2 * outSize * outSize) and reset
+  // output to the hidden state (outSize * outSize).
+  weights.set_size(
+      3 * outSize * inSize + 3 * outSize + 3 * outSize * outSize, 1);
+}
+
+template<typename InputDataType, typename OutputDataType>
+void FastGRU<InputDataType, OutputDataType>::Reset()
+{
+  // Set the weight parameter for the input to gate layer (linear layer) using
+  // the overall layer parameter matrix.
+  input2GateWeight = OutputDataType(weights.memptr(),
+      3 * outSize, inSize, false, false);
+  input2GateBias = OutputDataType(weights.memptr() + input2GateWeight.n_elem,
+      3 * outSize, 1, false, false);
+  size_t offset = input2GateWeight.n_elem + input2GateBias.n_elem;
+
+  // Set the weight parameter for the output to the update and reset gates
+  // (linear no bias layer).
+  output2GateWeight = OutputDataType(weights.memptr() + offset,
+      2 * outSize, outSize, false, false);
+  offset += output2GateWeight.n_elem;
+
+  // Set the weight parameter for the reset output to the hidden state (linear
+  // no bias layer).
+  outputHidden2GateWeight = OutputDataType(weights.memptr() + offset,
+      outSize, outSize, false, false);
+}
+
+template<typename InputDataType, typename OutputDataType>
+void FastGRU<InputDataType, OutputDataType>::ResetCell(const size_t size)
+{
+  if (size == std::numeric_limits<size_t>::max())
+    return;
+
+  rhoSize = size;
+
+  if (batchSize == 0)
+    return;
+
+  bpttSteps = std::min(rho, rhoSize);
+  forwardStep = 0;
+  gradientStepIdx = 0;
+  backwardStep = batchSize * size - 1;
+  gradientStep = batchSize * size - 1;
+
+  // set_size() does not reallocate if the size did not change.
+  const size_t rhoBatchSize = size * batchSize;
+  gate.set_size(3 * outSize, rhoBatchSize);
+  resetOutput.set_size(outSize, rhoBatchSize);
+  outputGate.set_size(2 * outSize, batchSize);
+  hiddenGate.set_size(outSize, batchSize);
+  outputGateError.set_size(2 * outSize, batchSize);
+  hiddenGateError.set_size(outSize, batchSize);
+  resetError.set_size(outSize, batchSize);
+  hiddenError.set_size(outSize, batchSize);
+  prevError.set_size(3 * outSize, batchSize);
+
+  // Every sequence starts from a zero state.
+  if (outParameter.n_rows != outSize ||
+      outParameter.n_cols != (size + 1) * batchSize)
+  {
+    outParameter.zeros(outSize, (size + 1) * batchSize);
+  }
+  else
+  {
+    outParameter.cols(0, batchSize - 1).zeros();
+  }
+}
+
+template<typename InputDataType, typename OutputDataType>
+template<typename InputType, typename OutputType>
+void FastGRU<InputDataType, OutputDataType>::Forward(
+    InputType&& input, OutputType&& output)
+{
+  // Check if the batch size changed, the number of cols is defines the input
+  // batch size.
+  if (input.n_cols != batchSize)
+  {
+    batchSize = input.n_cols;
+    batchStep = batchSize - 1;
+    ResetCell(rhoSize);
+  }
+
+  // The input products of all three gates are computed at once; so are the
+  // products of the previous output with the update and reset gates.
+  arma::Mat<ElemType> gateStep(gate.colptr(forwardStep), 3 * outSize,
+      batchSize, false, true);
+  const arma::Mat<ElemType> prevHidden(outParameter.colptr(forwardStep),
+      outSize, batchSize, false, true);
+  gateStep = input2GateWeight * input;
+  outputGate = output2GateWeight * prevHidden;
+
+  // The first pass computes the update and reset gates and the reset output.
+  // The rows of the gates are ordered as update gate, reset gate and hidden
+  // state.
+  const ElemType* bias = input2GateBias.memptr();
+  for (size_t j = 0; j < batchSize; ++j)
+  {
+    const size_t col = forwardStep + j;
+    ElemType* g = gate.colptr(col);
+    ElemType* rh = resetOutput.colptr(col);
+    const ElemType* og = outputGate.colptr(j);
+    const ElemType* hPrev = outParameter.colptr(col);
+
+    for (size_t k = 0; k < 2 * outSize; ++k)
+      g[k] = Sigmoid(g[k] + bias[k] + og[k]);
+
+    for (size_t k = 0; k < outSize; ++k)
+      rh[k] = g[outSize + k] * hPrev[k];
+  }
+
+  // The hidden state depends on the reset output, so its recurrent product
+  // can only be computed now.
+  const arma::Mat<ElemType> resetStep(resetOutput.colptr(forwardStep),
+      outSize, batchSize, false, true);
+  hiddenGate = outputHidden2GateWeight * resetStep;
+
+  // The second pass computes the hidden state and the output.
+  for (size_t j = 0; j < batchSize; ++j)
+  {
+    const size_t col = forwardStep + j;
+    ElemType* g = gate.colptr(col);
+    const ElemType* hg = hiddenGate.colptr(j);
+    const ElemType* hPrev = outParameter.colptr(col);
+    ElemType* h = outParameter.colptr(col + batchSize);
+
+    for (size_t k = 0; k < outSize; ++k)
+    {
+      const ElemType state = std::tanh(g[2 * outSize + k] +
+          bias[2 * outSize + k] + hg[k]);
+      g[2 * outSize + k] = state;
+      h[k] = g[k] * (hPrev[k] - state) + state;
+    }
+  }
+
+  output = OutputType(outParameter.memptr() +
+      (forwardStep + batchSize) * outSize, outSize, batchSize, false, false);
+
+  forwardStep += batchSize;
+  if ((forwardStep / batchSize) == bpttSteps)
+  {
+    forwardStep = 0;
+  }
+}
+
+template<typename InputDataType, typename OutputDataType>
+template<typename InputType, typename ErrorType, typename GradientType>
+void FastGRU<InputDataType, OutputDataType>::Backward(
+  const InputType&& /* input */, ErrorType&& gy, GradientType&& g)
+{
+  if (gradientStepIdx > 0)
+  {
+    gy += hiddenError;
+  }
+
+  // The first pass computes the error of the hidden state.
+  const size_t stepBegin = backwardStep - batchStep;
+  for (size_t j = 0; j < batchSize; ++j)
+  {
+    const ElemType* ga = gate.colptr(stepBegin + j);
+    ElemType* hge = hiddenGateError.colptr(j);
+
+    for (size_t k = 0; k < outSize; ++k)
+    {
+      const ElemType state = ga[2 * outSize + k];
+      hge[k] = gy(k, j) * (1 - ga[k]) * (1 - state * state);
+    }
+  }
+
+  resetError = outputHidden2GateWeight.t() * hiddenGateError;
+
+  // The second pass computes the error of the update and reset gates and the
+  // part of the error of the previous output that does not pass through
+  // output2GateWeight.
+  for (size_t j = 0; j < batchSize; ++j)
+  {
+    const size_t col = stepBegin + j;
+    const ElemType* ga = gate.colptr(col);
+    const ElemType* hPrev = outParameter.colptr(col);
+    const ElemType* re = resetError.colptr(j);
+    const ElemType* hge = hiddenGateError.colptr(j);
+    ElemType* oge = outputGateError.colptr(j);
+    ElemType* he = hiddenError.colptr(j);
+    ElemType* e = prevError.colptr(j);
+
+    for (size_t k = 0; k < outSize; ++k)
+    {
+      const ElemType updateGate = ga[k];
+      const ElemType resetGate = ga[outSize + k];
+      const ElemType error = gy(k, j);
+
+      oge[k] = error * (hPrev[k] - ga[2 * outSize + k]) * updateGate *
+          (1 - updateGate);
+      oge[outSize + k] = re[k] * hPrev[k] * resetGate * (1 - resetGate);
+      he[k] = error * updateGate + re[k] * resetGate;
+
+      e[k] = oge[k];
+      e[outSize + k] = oge[outSize + k];
+      e[2 * outSize + k] = hge[k];
+    }
+  }
+
+  hiddenError += output2GateWeight.t() * outputGateError;
+  g = input2GateWeight.t() * prevError;
+
+  backwardStep -= batchSize;
+  gradientStepIdx++;
+  if (gradientStepIdx == bpttSteps)
+  {
+    backwardStep = bpttSteps - 1;
+    gradientStepIdx = 0;
+  }
+}
+
+template<typename InputDataType, typename OutputDataType>
+template<typename InputType, typename ErrorType, typename GradientType>
+void FastGRU<InputDataType, OutputDataType>::Gradient(
+    InputType&& input, ErrorType&& /* error */, GradientType&& gradient)
+{
+  // The products are written directly into the gradient.
+  arma::Mat<ElemType> input2GateGradient(gradient.memptr(), 3 * outSize,
+      inSize, false, true);
+  input2GateGradient = prevError * input.t();
+  size_t offset = input2GateWeight.n_elem;
+
+  arma::Mat<ElemType> input2GateBiasGradient(gradient.memptr() + offset,
+      3 * outSize, 1, false, true);
+  input2GateBiasGradient = arma::sum(prevError, 1);
+  offset += input2GateBias.n_elem;
+
+  arma::Mat<ElemType> output2GateGradient(gradient.memptr() + offset,
+      2 * outSize, outSize, false, true);
+  const arma::Mat<ElemType> prevHidden(
+      outParameter.colptr(gradientStep - batchStep), outSize, batchSize, false,
+      true);
+  output2GateGradient = outputGateError * prevHidden.t();
+  offset += output2GateWeight.n_elem;
+
+  arma::Mat<ElemType> outputHidden2GateGradient(gradient.memptr() + offset,
+      outSize, outSize, false, true);
+  const arma::Mat<ElemType> resetStep(
+      resetOutput.colptr(gradientStep - batchStep), outSize, batchSize, false,
+      true);
+  outputHidden2GateGradient = hiddenGateError * resetStep.t();
+
+  if (gradientStep > batchStep)
+  {
+    gradientStep -= batchSize;
+  }
+  else
+  {
+    gradientStep = batchSize * bpttSteps - 1;
+  }
+}
+
+template<typename InputDataType, typename OutputDataType>
+template<typename Archive>
+void FastGRU<InputDataType, OutputDataType>::serialize(
+    Archive& ar, const unsigned int /* version */)
+{
+  ar & BOOST_SERIALIZATION_NVP(weights);
+  ar & BOOST_SERIALIZATION_NVP(inSize);
+  ar & BOOST_SERIALIZATION_NVP(outSize);
+  ar & BOOST_SERIALIZATION_NVP(rho);
+  ar & BOOST_SERIALIZATION_NVP(bpttSteps);
+  ar & BOOST_SERIALIZATION_NVP(batchSize);
+  ar & BOOST_SERIALIZATION_NVP(batchStep);
+  ar & BOOST_SERIALIZATION_NVP(forwardStep);
+  ar & BOOST_SERIALIZATION_NVP(backwardStep);
+  ar & BOOST_SERIALIZATION_NVP(gradientStep);
+  ar & BOOST_SERIALIZATION_NVP(gradientStepIdx);
+  ar & BOOST_SERIALIZATION_NVP(gate);
+  ar & BOOST_SERIALIZATION_NVP(resetOutput);
+  ar & BOOST_SERIALIZATION_NVP(outputGateError);
+  ar & BOOST_SERIALIZATION_NVP(hiddenGateError);
+  ar & BOOST_SERIALIZATION_NVP(hiddenError);
+  ar & BOOST_SERIALIZATION_NVP(prevError);
+  ar & BOOST_SERIALIZATION_NVP(outParameter);
+}
+
+} // namespace ann
+} // namespace mlpack
+
+#endif
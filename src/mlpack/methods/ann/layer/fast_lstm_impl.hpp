@@ -107,6 +107,10 @@ void FastLSTM<InputDataType, OutputDataType>::ResetCell(const size_t size)
       outParameter.resize(outSize, (size + 1) * batchSize);
     }
   }
+
+  // Every sequence starts from a zero state; after the batch size changed these
+  // columns may still hold the outputs of an earlier batch.
+  outParameter.cols(0, batchSize - 1).zeros();
 }
 
 template<typename InputDataType, typename OutputDataType>
@@ -123,48 +127,51 @@ void FastLSTM<InputDataType, OutputDataType>::Forward(
     ResetCell(rhoSize);
   }
 
-  gate.cols(forwardStep, forwardStep + batchStep) = input2GateWeight * input +
-      output2GateWeight * outParameter.cols(
-      forwardStep, forwardStep + batchStep);
-  gate.cols(forwardStep, forwardStep + batchStep).each_col() += input2GateBias;
-
-  FastSigmoid(std::move(
-      gate.submat(0, forwardStep, 3 * outSize - 1, forwardStep + batchStep)),
-      std::move(gateActivation.cols(forwardStep, forwardStep + batchStep)));
-
-  stateActivation.cols(forwardStep, forwardStep + batchStep) = arma::tanh(
-      gate.submat(3 * outSize, forwardStep, 4 * outSize - 1,
-      forwardStep + batchStep));
-
-  // Update the cell: cmul1 + cmul2
-  // where cmul1 is input gate * hidden state and
-  // cmul2 is forget gate * cell (prevCell).
-  if (forwardStep == 0)
+  // All four gates are computed by accumulating both products into the same
+  // block of the gate matrix, which avoids any temporaries.
+  arma::Mat<ElemType> gateStep(gate.colptr(forwardStep), 4 * outSize,
+      batchSize, false, true);
+  const arma::Mat<ElemType> prevHidden(outParameter.colptr(forwardStep),
+      outSize, batchSize, false, true);
+  gateStep = input2GateWeight * input;
+  gateStep += output2GateWeight * prevHidden;
+
+  // A single pass computes the activations, the cell update and the output.
+  // The rows of the gates are ordered as input gate, output gate, forget gate
+  // and hidden state.
+  const ElemType* bias = input2GateBias.memptr();
+  for (size_t j = 0; j < batchSize; ++j)
   {
-    cell.cols(forwardStep, forwardStep + batchStep) =
-        gateActivation.submat(0, forwardStep, outSize - 1,
-        forwardStep + batchStep) %
-        stateActivation.cols(forwardStep, forwardStep + batchStep);
-  }
-  else
-  {
-    cell.cols(forwardStep, forwardStep + batchStep) =
-        gateActivation.submat(0, forwardStep, outSize - 1,
-        forwardStep + batchStep) %
-        stateActivation.cols(forwardStep, forwardStep + batchStep) +
-        gateActivation.submat(2 * outSize, forwardStep, 3 * outSize - 1,
-        forwardStep + batchStep) %
-        cell.cols(forwardStep - batchSize, forwardStep - batchSize + batchStep);
+    const size_t col = forwardStep + j;
+    ElemType* g = gate.colptr(col);
+    ElemType* ga = gateActivation.colptr(col);
+    ElemType* state = stateActivation.colptr(col);
+    ElemType* c = cell.colptr(col);
+    ElemType* ca = cellActivation.colptr(col);
+    ElemType* h = outParameter.colptr(col + batchSize);
+    const ElemType* prevCell = (forwardStep == 0) ? NULL :
+        cell.colptr(col - batchSize);
+
+    for (size_t k = 0; k < 4 * outSize; ++k)
+      g[k] += bias[k];
+
+    for (size_t k = 0; k < outSize; ++k)
+    {
+      ga[k] = FastSigmoid(g[k]);
+      ga[outSize + k] = FastSigmoid(g[outSize + k]);
+      ga[2 * outSize + k] = FastSigmoid(g[2 * outSize + k]);
+      state[k] = std::tanh(g[3 * outSize + k]);
+
+      // Update the cell: input gate * hidden state + forget gate * prevCell.
+      c[k] = ga[k] * state[k];
+      if (prevCell)
+        c[k] += ga[2 * outSize + k] * prevCell[k];
+
+      ca[k] = std::tanh(c[k]);
+      h[k] = ca[k] * ga[outSize + k];
+    }
   }
 
-  cellActivation.cols(forwardStep, forwardStep + batchStep) =
-      arma::tanh(cell.cols(forwardStep, forwardStep + batchStep));
-
-  outParameter.cols(forwardStep + batchSize,
-      forwardStep + batchSize + batchStep) = cellActivation.cols(
-      forwardStep, forwardStep + batchStep) % gateActivation.submat(
-      outSize, forwardStep, 2 * outSize - 1, forwardStep + batchStep);
-
   output = OutputType(outParameter.memptr() +
       (forwardStep + batchSize) * outSize, outSize, batchSize, false, false);
 
@@ -185,51 +192,46 @@ void FastLSTM<InputDataType, OutputDataType>::Backward(
     gy += output2GateWeight.t() * prevError;
   }
 
-  cellActivationError = gy % gateActivation.submat(outSize,
-      backwardStep - batchStep, 2 * outSize - 1, backwardStep) %
-      (1 - arma::pow(cellActivation.cols(backwardStep - batchStep,
-      backwardStep), 2));
+  cellActivationError.set_size(outSize, batchSize);
+  forgetGateError.set_size(outSize, batchSize);
 
-  if (gradientStepIdx > 0)
-    cellActivationError += forgetGateError;
-
-  forgetGateError = gateActivation.submat(2 * outSize,
-      backwardStep - batchStep, 3 * outSize - 1, backwardStep) %
-      cellActivationError;
-
-  if (backwardStep > batchStep)
-  {
-    prevError.submat(2 * outSize, 0, 3 * outSize - 1, batchStep) =
-        cell.cols((backwardStep - batchSize) - batchStep,
-        (backwardStep - batchSize)) % cellActivationError %
-        gateActivation.submat(2 * outSize, backwardStep - batchStep,
-        3 * outSize - 1, backwardStep) % (1.0 - gateActivation.submat(
-        2 * outSize, backwardStep - batchStep, 3 * outSize - 1, backwardStep));
-  }
-  else
+  // A single pass computes the error of the cell and of all four gates for
+  // the current time step.
+  const size_t stepBegin = backwardStep - batchStep;
+  for (size_t j = 0; j < batchSize; ++j)
   {
-    prevError.submat(2 * outSize, 0, 3 * outSize - 1, batchStep).zeros();
+    const size_t col = stepBegin + j;
+    const ElemType* ga = gateActivation.colptr(col);
+    const ElemType* state = stateActivation.colptr(col);
+    const ElemType* ca = cellActivation.colptr(col);
+    const ElemType* prevCell = (backwardStep > batchStep) ?
+        cell.colptr(col - batchSize) : NULL;
+    ElemType* cellError = cellActivationError.colptr(j);
+    ElemType* forgetError = forgetGateError.colptr(j);
+    ElemType* e = prevError.colptr(j);
+
+    for (size_t k = 0; k < outSize; ++k)
+    {
+      const ElemType inGate = ga[k];
+      const ElemType outGate = ga[outSize + k];
+      const ElemType forgetGate = ga[2 * outSize + k];
+      const ElemType error = gy(k, j);
+
+      ElemType dc = error * outGate * (1 - ca[k] * ca[k]);
+      if (gradientStepIdx > 0)
+        dc += forgetError[k];
+
+      cellError[k] = dc;
+      forgetError[k] = forgetGate * dc;
+
+      e[k] = state[k] * dc * inGate * (1 - inGate);
+      e[outSize + k] = ca[k] * error * outGate * (1 - outGate);
+      e[2 * outSize + k] = prevCell ?
+          prevCell[k] * dc * forgetGate * (1 - forgetGate) : 0;
+      e[3 * outSize + k] = inGate * dc * (1 - state[k] * state[k]);
+    }
   }
 
-  prevError.submat(0, 0, outSize - 1, batchStep) =
-      stateActivation.cols(backwardStep - batchStep,
-      backwardStep) % cellActivationError % gateActivation.submat(
-      0, backwardStep - batchStep, outSize - 1, backwardStep) %
-      (1.0 - gateActivation.submat(
-      0, backwardStep - batchStep, outSize - 1, backwardStep));
-
-  prevError.submat(3 * outSize, 0, 4 * outSize - 1, batchStep) =
-      gateActivation.submat(0, backwardStep - batchStep,
-      outSize - 1, backwardStep) % cellActivationError % (1 - arma::pow(
-      stateActivation.cols(backwardStep - batchStep, backwardStep), 2));
-
-  prevError.submat(outSize, 0, 2 * outSize - 1, batchStep) =
-      cellActivation.cols(backwardStep - batchStep,
-      backwardStep) % gy % gateActivation.submat(
-       outSize, backwardStep - batchStep, 2 * outSize - 1, backwardStep) %
-      (1.0 - gateActivation.submat(
-      outSize, backwardStep - batchStep, 2 * outSize - 1, backwardStep));
-
   g = input2GateWeight.t() * prevError;
 
   backwardStep -= batchSize;
@@ -246,17 +248,22 @@ template<typename InputType, typename ErrorType, typename GradientType>
 void FastLSTM<InputDataType, OutputDataType>::Gradient(
     InputType&& input, ErrorType&& /* error */, GradientType&& gradient)
 {
-  // Gradient of the input to gate layer.
-  gradient.submat(0, 0, input2GateWeight.n_elem - 1, 0) =
-      arma::vectorise(prevError * input.t());
-
-  gradient.submat(input2GateWeight.n_elem, 0, input2GateWeight.n_elem +
-      input2GateBias.n_elem - 1, 0) = arma::sum(prevError, 1);
-
-  // Gradient of the output to gate layer.
-  gradient.submat(input2GateWeight.n_elem + input2GateBias.n_elem, 0,
-      gradient.n_elem - 1, 0) = arma::vectorise(prevError *
-      outParameter.cols(gradientStep - batchStep, gradientStep).t());
+  // The products are written directly into the gradient.
+  arma::Mat<ElemType> input2GateGradient(gradient.memptr(), 4 * outSize,
+      inSize, false, true);
+  input2GateGradient = prevError * input.t();
+
+  arma::Mat<ElemType> input2GateBiasGradient(gradient.memptr() +
+      input2GateWeight.n_elem, 4 * outSize, 1, false, true);
+  input2GateBiasGradient = arma::sum(prevError, 1);
+
+  arma::Mat<ElemType> output2GateGradient(gradient.memptr() +
+      input2GateWeight.n_elem + input2GateBias.n_elem, 4 * outSize, outSize,
+      false, true);
+  const arma::Mat<ElemType> prevHidden(
+      outParameter.colptr(gradientStep - batchStep), outSize, batchSize, false,
+      true);
+  output2GateGradient = prevError * prevHidden.t();
 
   if (gradientStep > batchStep)
   {
@@ -0,0 +1,257 @@
+/**
+ * @file fast_peephole_lstm.hpp
+ *
+ * Definition of the FastPeepholeLSTM class, which implements an LSTM network
+ * layer with peephole connections whose gates are computed with fused products
+ * and a single elementwise pass.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_LAYER_FAST_PEEPHOLE_LSTM_HPP
+#define MLPACK_METHODS_ANN_LAYER_FAST_PEEPHOLE_LSTM_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <limits>
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+/**
+ * An implementation of a faster version of the LSTM network layer with
+ * peephole connections.  It computes the same function as the LSTM layer:
+ *
+ * @f{eqnarray}{
+ * i &=& sigmoid(W \cdot x + W \cdot h + p_i \cdot c + b) \\
+ * f &=& sigmoid(W  \cdot x + W \cdot h + p_f \cdot c + b) \\
+ * z &=& tanh(W \cdot x + W \cdot h + b) \\
+ * c &=& f \cdot c + i \cdot z \\
+ * o &=& sigmoid(W \cdot x + W \cdot h + p_o \cdot c + b) \\
+ * h &=& o \cdot tanh(c)
+ * @f}
+ *
+ * The peephole connections are diagonal, so they only add elementwise terms;
+ * like FastLSTM, the input and output products of all four gates are computed
+ * at once and the peepholes, the activations, the cell update and the output
+ * are computed in a single pass.
+ *
+ * The parameters are laid out as W (4 * outSize x inSize), b (4 * outSize),
+ * U (4 * outSize x outSize) and the peephole weights (3 * outSize), where the
+ * rows of the gates are ordered as input gate, output gate, forget gate and
+ * hidden state, and the peephole weights as input gate, output gate and forget
+ * gate.
+ *
+ * \see LSTM for the standard implementation of the LSTM layer and FastLSTM for
+ * the faster version without peephole connections.
+ *
+ * @tparam InputDataType Type of the input data (arma::colvec, arma::mat,
+ *         arma::sp_mat or arma::cube).
+ * @tparam OutputDataType Type of the output data (arma::colvec, arma::mat,
+ *         arma::sp_mat or arma::cube).
+ */
+template <
+    typename InputDataType = arma::mat,
+    typename OutputDataType = arma::mat
+>
+class FastPeepholeLSTM
+{
+ public:
+  // Convenience typedefs.
+  typedef typename InputDataType::elem_type InputElemType;
+  typedef typename OutputDataType::elem_type ElemType;
+
+  //! Create the FastPeepholeLSTM object.
+  FastPeepholeLSTM();
+
+  /**
+   * Create the FastPeepholeLSTM layer object using the specified parameters.
+   *
+   * @param inSize The number of input units.
+   * @param outSize The number of output units.
+   * @param rho Maximum number of steps to backpropagate through time (BPTT).
+   */
+  FastPeepholeLSTM(const size_t inSize,
+                   const size_t outSize,
+                   const size_t rho = std::numeric_limits<size_t>::max());
+
+  /**
+   * Ordinary feed forward pass of a neural network, evaluating the function
+   * f(x) by propagating the activity forward through f.
+   *
+   * @param input Input data used for evaluating the specified function.
+   * @param output Resulting output activation.
+   */
+  template<typename InputType, typename OutputType>
+  void Forward(InputType&& input, OutputType&& output);
+
+  /**
+   * Ordinary feed backward pass of a neural network, calculating the function
+   * f(x) by propagating x backwards trough f. Using the results from the feed
+   * forward pass.
+   *
+   * @param input The propagated input activation.
+   * @param gy The backpropagated error.
+   * @param g The calculated gradient.
+   */
+  template<typename InputType, typename ErrorType, typename GradientType>
+  void Backward(const InputType&& input,
+                ErrorType&& gy,
+                GradientType&& g);
+
+  /*
+   * Reset the layer parameter.
+   */
+  void Reset();
+
+  /*
+   * Resets the cell to accept a new input. This breaks the BPTT chain starts a
+   * new one.
+   *
+   * @param size The current maximum number of steps through time.
+   */
+  void ResetCell(const size_t size);
+
+  /*
+   * Calculate the gradient using the output delta and the input activation.
+   *
+   * @param input The input parameter used for calculating the gradient.
+   * @param error The calculated error.
+   * @param gradient The calculated gradient.
+   */
+  template<typename InputType, typename ErrorType, typename GradientType>
+  void Gradient(InputType&& input,
+                ErrorType&& error,
+                GradientType&& gradient);
+
+  //! Get the maximum number of steps to backpropagate through time (BPTT).
+  size_t Rho() const { return rho; }
+  //! Modify the maximum number of steps to backpropagate through time (BPTT).
+  size_t& Rho() { return rho; }
+
+  //! Get the parameters.
+  OutputDataType const& Parameters() const { return weights; }
+  //! Modify the parameters.
+  OutputDataType& Parameters() { return weights; }
+
+  //! Get the input parameter.
+  InputDataType const& InputParameter() const { return inputParameter; }
+  //! Modify the input parameter.
+  InputDataType& InputParameter() { return inputParameter; }
+
+  //! Get the output parameter.
+  OutputDataType const& OutputParameter() const { return outputParameter; }
+  //! Modify the output parameter.
+  OutputDataType& OutputParameter() { return outputParameter; }
+
+  //! Get the delta.
+  OutputDataType const& Delta() const { return delta; }
+  //! Modify the delta.
+  OutputDataType& Delta() { return delta; }
+
+  //! Get the gradient.
+  OutputDataType const& Gradient() const { return grad; }
+  //! Modify the gradient.
+  OutputDataType& Gradient() { return grad; }
+
+  /**
+   * Serialize the layer
+   */
+  template<typename Archive>
+  void serialize(Archive& ar, const unsigned int /* version */);
+
+ private:
+  //! Compute the logistic function of the given value.
+  static ElemType Sigmoid(const ElemType x)
+  {
+    return 1.0 / (1.0 + std::exp(-x));
+  }
+
+  //! Locally-stored number of input units.
+  size_t inSize;
+
+  //! Locally-stored number of output units.
+  size_t outSize;
+
+  //! Number of steps to backpropagate through time (BPTT).
+  size_t rho;
+
+  //! Locally-stored number of forward steps.
+  size_t forwardStep;
+
+  //! Locally-stored number of backward steps.
+  size_t backwardStep;
+
+  //! Locally-stored number of gradient steps.
+  size_t gradientStep;
+
+  //! Locally-stored weight object.
+  OutputDataType weights;
+
+  //! Locally-stored batch size.
+  size_t batchSize;
+
+  //! Current batch step, alias for batchSize - 1.
+  size_t batchStep;
+
+  //! Current gradient step to keep track of the backpropagate through time
+  //! step.
+  size_t gradientStepIdx;
+
+  //! Locally-stored delta object.
+  OutputDataType delta;
+
+  //! Locally-stored gradient object.
+  OutputDataType grad;
+
+  //! Locally-stored input parameter object.
+  InputDataType inputParameter;
+
+  //! Locally-stored output parameter object.
+  OutputDataType outputParameter;
+
+  //! Weights between the output and gate.
+  OutputDataType output2GateWeight;
+
+  //! Weights between the input and gate.
+  OutputDataType input2GateWeight;
+
+  //! Bias between the input and gate.
+  OutputDataType input2GateBias;
+
+  //! Peephole weights between the cell and the input, output and forget gates.
+  OutputDataType cell2GateWeight;
+
+  //! Locally-stored gate activations.
+  OutputDataType gate;
+
+  //! Locally-stored cell parameter.
+  OutputDataType cell;
+
+  //! Locally-stored cell activation.
+  OutputDataType cellActivation;
+
+  //! Locally-stored error of the previous cell.
+  OutputDataType cellError;
+
+  //! Locally-stored previous error.
+  OutputDataType prevError;
+
+  //! Locally-stored output parameters.
+  OutputDataType outParameter;
+
+  //! Locally-stored current rho size.
+  size_t rhoSize;
+
+  //! Current backpropagate through time steps.
+  size_t bpttSteps;
+}; // class FastPeepholeLSTM
+
+} // namespace ann
+} // namespace mlpack
+
+// Include implementation.
+#include "fast_peephole_lstm_impl.hpp"
+
+#endif
@@ -0,0 +1,337 @@
+/**
+ * @file fast_peephole_lstm_impl.hpp
+ *
+ * Implementation of the FastPeepholeLSTM class, which implements an LSTM
+ * network layer with peephole connections whose gates are computed with fused
+ * products and a single elementwise pass.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_LAYER_FAST_PEEPHOLE_LSTM_IMPL_HPP
+#define MLPACK_METHODS_ANN_LAYER_FAST_PEEPHOLE_LSTM_IMPL_HPP
+
+// In case it hasn't yet been included.
+#include "fast_peephole_lstm.hpp"
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+template<typename InputDataType, typename OutputDataType>
+FastPeepholeLSTM<InputDataType, OutputDataType>::FastPeepholeLSTM()
+{
+  // Nothing to do here.
+}
+
+template <typename InputDataType, typename OutputDataType>
+FastPeepholeLSTM<InputDataType, OutputDataType>::FastPeepholeLSTM(
+    const size_t inSize, const size_t outSize, const size_t rho) :
+    inSize(inSize),
+    outSize(outSize),
+    rho(rho),
+    forwardStep(0),
+    backwardStep(0),
+    gradientStep(0),
+    batchSize(0),
+    batchStep(0),
+    gradientStepIdx(0),
+    rhoSize(rho),
+    bpttSteps(0)
+{
+  // Weights for: input to gate layer (4 * outsize * inSize + 4 * outsize),
+  // output to gate (4 * outSize * outSize) and the peepholes (3 * outSize).
+  weights.set_size(
+      4 * outSize * inSize + 7 * outSize + 4 * outSize * outSize, 1);
+}
+
+template<typename InputDataType, typename OutputDataType>
+void FastPeepholeLSTM<InputDataType, OutputDataType>::Reset()
+{
+  // Set the weight parameter for the input to gate layer (linear layer) using
+  // the overall layer parameter matrix.
+  input2GateWeight = OutputDataType(weights.memptr(),
+      4 * outSize, inSize, false, false);
+  input2GateBias = OutputDataType(weights.memptr() + input2GateWeight.n_elem,
+      4 * outSize, 1, false, false);
+  size_t offset = input2GateWeight.n_elem + input2GateBias.n_elem;
+
+  // Set the weight parameter for the output to gate layer
+  // (linear no bias layer) using the overall layer parameter matrix.
+  output2GateWeight = OutputDataType(weights.memptr() + offset,
+      4 * outSize, outSize, false, false);
+  offset += output2GateWeight.n_elem;
+
+  // Set the peephole weights of the input, output and forget gates.
+  cell2GateWeight = OutputDataType(weights.memptr() + offset,
+      3 * outSize, 1, false, false);
+}
+
+template<typename InputDataType, typename OutputDataType>
+void FastPeepholeLSTM<InputDataType, OutputDataType>::ResetCell(
+    const size_t size)
+{
+  if (size == std::numeric_limits<size_t>::max())
+    return;
+
+  rhoSize = size;
+
+  if (batchSize == 0)
+    return;
+
+  bpttSteps = std::min(rho, rhoSize);
+  forwardStep = 0;
+  gradientStepIdx = 0;
+  backwardStep = batchSize * size - 1;
+  gradientStep = batchSize * size - 1;
+
+  // set_size() does not reallocate if the size did not change.
+  const size_t rhoBatchSize = size * batchSize;
+  gate.set_size(4 * outSize, rhoBatchSize);
+  cell.set_size(outSize, rhoBatchSize);
+  cellActivation.set_size(outSize, rhoBatchSize);
+  cellError.set_size(outSize, batchSize);
+  prevError.set_size(4 * outSize, batchSize);
+
+  // Every sequence starts from a zero state.
+  if (outParameter.n_rows != outSize ||
+      outParameter.n_cols != (size + 1) * batchSize)
+  {
+    outParameter.zeros(outSize, (size + 1) * batchSize);
+  }
+  else
+  {
+    outParameter.cols(0, batchSize - 1).zeros();
+  }
+}
+
+template<typename InputDataType, typename OutputDataType>
+template<typename InputType, typename OutputType>
+void FastPeepholeLSTM<InputDataType, OutputDataType>::Forward(
+    InputType&& input, OutputType&& output)
+{
+  // Check if the batch size changed, the number of cols is defines the input
+  // batch size.
+  if (input.n_cols != batchSize)
+  {
+    batchSize = input.n_cols;
+    batchStep = batchSize - 1;
+    ResetCell(rhoSize);
+  }
+
+  // All four gates are computed by accumulating both products into the same
+  // block of the gate matrix, which avoids any temporaries.
+  arma::Mat<ElemType> gateStep(gate.colptr(forwardStep), 4 * outSize,
+      batchSize, false, true);
+  const arma::Mat<ElemType> prevHidden(outParameter.colptr(forwardStep),
+      outSize, batchSize, false, true);
+  gateStep = input2GateWeight * input;
+  gateStep += output2GateWeight * prevHidden;
+
+  // A single pass adds the peepholes and computes the activations, the cell
+  // update and the output; the activations overwrite the gates.  The input and
+  // forget gates see the previous cell, the output gate the updated cell.
+  const ElemType* bias = input2GateBias.memptr();
+  const ElemType* peephole = cell2GateWeight.memptr();
+  for (size_t j = 0; j < batchSize; ++j)
+  {
+    const size_t col = forwardStep + j;
+    ElemType* g = gate.colptr(col);
+    ElemType* c = cell.colptr(col);
+    ElemType* ca = cellActivation.colptr(col);
+    ElemType* h = outParameter.colptr(col + batchSize);
+    const ElemType* prevCell = (forwardStep == 0) ? NULL :
+        cell.colptr(col - batchSize);
+
+    for (size_t k = 0; k < outSize; ++k)
+    {
+      ElemType inGate = g[k] + bias[k];
+      ElemType forgetGate = g[2 * outSize + k] + bias[2 * outSize + k];
+      if (prevCell)
+      {
+        inGate += peephole[k] * prevCell[k];
+        forgetGate += peephole[2 * outSize + k] * prevCell[k];
+      }
+
+      inGate = Sigmoid(inGate);
+      forgetGate = Sigmoid(forgetGate);
+      const ElemType state = std::tanh(g[3 * outSize + k] +
+          bias[3 * outSize + k]);
+
+      // Update the cell: input gate * hidden state + forget gate * prevCell.
+      c[k] = inGate * state;
+      if (prevCell)
+        c[k] += forgetGate * prevCell[k];
+
+      const ElemType outGate = Sigmoid(g[outSize + k] + bias[outSize + k] +
+          peephole[outSize + k] * c[k]);
+
+      ca[k] = std::tanh(c[k]);
+      h[k] = ca[k] * outGate;
+
+      g[k] = inGate;
+      g[outSize + k] = outGate;
+      g[2 * outSize + k] = forgetGate;
+      g[3 * outSize + k] = state;
+    }
+  }
+
+  output = OutputType(outParameter.memptr() +
+      (forwardStep + batchSize) * outSize, outSize, batchSize, false, false);
+
+  forwardStep += batchSize;
+  if ((forwardStep / batchSize) == bpttSteps)
+  {
+    forwardStep = 0;
+  }
+}
+
+template<typename InputDataType, typename OutputDataType>
+template<typename InputType, typename ErrorType, typename GradientType>
+void FastPeepholeLSTM<InputDataType, OutputDataType>::Backward(
+  const InputType&& /* input */, ErrorType&& gy, GradientType&& g)
+{
+  if (gradientStepIdx > 0)
+  {
+    gy += output2GateWeight.t() * prevError;
+  }
+
+  // A single pass computes the error of the cell and of all four gates for
+  // the current time step, and the error passed on to the previous cell.
+  const ElemType* peephole = cell2GateWeight.memptr();
+  const size_t stepBegin = backwardStep - batchStep;
+  for (size_t j = 0; j < batchSize; ++j)
+  {
+    const size_t col = stepBegin + j;
+    const ElemType* ga = gate.colptr(col);
+    const ElemType* ca = cellActivation.colptr(col);
+    const ElemType* prevCell = (backwardStep > batchStep) ?
+        cell.colptr(col - batchSize) : NULL;
+    ElemType* ce = cellError.colptr(j);
+    ElemType* e = prevError.colptr(j);
+
+    for (size_t k = 0; k < outSize; ++k)
+    {
+      const ElemType inGate = ga[k];
+      const ElemType outGate = ga[outSize + k];
+      const ElemType forgetGate = ga[2 * outSize + k];
+      const ElemType state = ga[3 * outSize + k];
+      const ElemType error = gy(k, j);
+
+      const ElemType outError = ca[k] * error * outGate * (1 - outGate);
+      ElemType dc = error * outGate * (1 - ca[k] * ca[k]) +
+          outError * peephole[outSize + k];
+      if (gradientStepIdx > 0)
+        dc += ce[k];
+
+      const ElemType inError = state * dc * inGate * (1 - inGate);
+      const ElemType forgetError = prevCell ?
+          prevCell[k] * dc * forgetGate * (1 - forgetGate) : 0;
+
+      e[k] = inError;
+      e[outSize + k] = outError;
+      e[2 * outSize + k] = forgetError;
+      e[3 * outSize + k] = inGate * dc * (1 - state * state);
+
+      ce[k] = forgetGate * dc + forgetError * peephole[2 * outSize + k] +
+          inError * peephole[k];
+    }
+  }
+
+  g = input2GateWeight.t() * prevError;
+
+  backwardStep -= batchSize;
+  gradientStepIdx++;
+  if (gradientStepIdx == bpttSteps)
+  {
+    backwardStep = bpttSteps - 1;
+    gradientStepIdx = 0;
+  }
+}
+
+template<typename InputDataType, typename OutputDataType>
+template<typename InputType, typename ErrorType, typename GradientType>
+void FastPeepholeLSTM<InputDataType, OutputDataType>::Gradient(
+    InputType&& input, ErrorType&& /* error */, GradientType&& gradient)
+{
+  // The products are written directly into the gradient.
+  arma::Mat<ElemType> input2GateGradient(gradient.memptr(), 4 * outSize,
+      inSize, false, true);
+  input2GateGradient = prevError * input.t();
+  size_t offset = input2GateWeight.n_elem;
+
+  arma::Mat<ElemType> input2GateBiasGradient(gradient.memptr() + offset,
+      4 * outSize, 1, false, true);
+  input2GateBiasGradient = arma::sum(prevError, 1);
+  offset += input2GateBias.n_elem;
+
+  arma::Mat<ElemType> output2GateGradient(gradient.memptr() + offset,
+      4 * outSize, outSize, false, true);
+  const arma::Mat<ElemType> prevHidden(
+      outParameter.colptr(gradientStep - batchStep), outSize, batchSize, false,
+      true);
+  output2GateGradient = prevError * prevHidden.t();
+  offset += output2GateWeight.n_elem;
+
+  // The input and forget peepholes see the previous cell, which is zero for
+  // the first time step.
+  ElemType* peepholeGradient = gradient.memptr() + offset;
+  std::fill(peepholeGradient, peepholeGradient + 3 * outSize, ElemType(0));
+  for (size_t j = 0; j < batchSize; ++j)
+  {
+    const size_t col = gradientStep - batchStep + j;
+    const ElemType* e = prevError.colptr(j);
+    const ElemType* c = cell.colptr(col);
+    const ElemType* prevCell = (gradientStep > batchStep) ?
+        cell.colptr(col - batchSize) : NULL;
+
+    for (size_t k = 0; k < outSize; ++k)
+    {
+      peepholeGradient[outSize + k] += e[outSize + k] * c[k];
+      if (prevCell)
+      {
+        peepholeGradient[k] += e[k] * prevCell[k];
+        peepholeGradient[2 * outSize + k] += e[2 * outSize + k] * prevCell[k];
+      }
+    }
+  }
+
+  if (gradientStep > batchStep)
+  {
+    gradientStep -= batchSize;
+  }
+  else
+  {
+    gradientStep = batchSize * bpttSteps - 1;
+  }
+}
+
+template<typename InputDataType, typename OutputDataType>
+template<typename Archive>
+void FastPeepholeLSTM<InputDataType, OutputDataType>::serialize(
+    Archive& ar, const unsigned int /* version */)
+{
+  ar & BOOST_SERIALIZATION_NVP(weights);
+  ar & BOOST_SERIALIZATION_NVP(inSize);
+  ar & BOOST_SERIALIZATION_NVP(outSize);
+  ar & BOOST_SERIALIZATION_NVP(rho);
+  ar & BOOST_SERIALIZATION_NVP(bpttSteps);
+  ar & BOOST_SERIALIZATION_NVP(batchSize);
+  ar & BOOST_SERIALIZATION_NVP(batchStep);
+  ar & BOOST_SERIALIZATION_NVP(forwardStep);
+  ar & BOOST_SERIALIZATION_NVP(backwardStep);
+  ar & BOOST_SERIALIZATION_NVP(gradientStep);
+  ar & BOOST_SERIALIZATION_NVP(gradientStepIdx);
+  ar & BOOST_SERIALIZATION_NVP(gate);
+  ar & BOOST_SERIALIZATION_NVP(cell);
+  ar & BOOST_SERIALIZATION_NVP(cellActivation);
+  ar & BOOST_SERIALIZATION_NVP(cellError);
+  ar & BOOST_SERIALIZATION_NVP(prevError);
+  ar & BOOST_SERIALIZATION_NVP(outParameter);
+}
+
+} // namespace ann
+} // namespace mlpack
+
+#endif
@@ -14,6 +14,8 @@
 
 #include <mlpack/prereqs.hpp>
 
+#include "layer_traits.hpp"
+
 namespace mlpack {
 namespace ann /** Artificial Neural Network. */ {
 
@@ -131,6 +133,19 @@ class HardTanH
   double minValue;
 }; // class HardTanH
 
+//! The HardTanH layer is applied elementwise.
+template<typename InputDataType, typename OutputDataType>
+class LayerTraits<HardTanH<InputDataType, OutputDataType> >
+{
+ public:
+  static const bool IsBinary = false;
+  static const bool IsOutputLayer = false;
+  static const bool IsBiasLayer = false;
+  static const bool IsLSTMLayer = false;
+  static const bool IsConnection = false;
+  static const bool IsElementwise = true;
+};
+
 } // namespace ann
 } // namespace mlpack
 
@@ -23,6 +23,8 @@
 #include "lstm.hpp"
 #include "gru.hpp"
 #include "fast_lstm.hpp"
+#include "fast_gru.hpp"
+#include "fast_peephole_lstm.hpp"
 #include "recurrent.hpp"
 #include "recurrent_attention.hpp"
 #include "sequential.hpp"
@@ -53,6 +53,13 @@ class LayerTraits
    * This is true if the layer is a connection layer.
    **/
   static const bool IsConnection = false;
+
+  /**
+   * This is true if each output element of the layer only depends on the input
+   * element at the same position, so that the forward pass may be computed in
+   * place (with the same matrix as input and output).
+   */
+  static const bool IsElementwise = false;
 };
 
 // This gives us a HasGradientCheck<T, U> type (where U is a function pointer)
@@ -104,6 +111,11 @@ HAS_MEM_FUNC(InputHeight, HasInputHeight);
 // can use with SFINAE to catch when a type has a Rho() function.
 HAS_MEM_FUNC(Rho, HasRho);
 
+// This gives us a HasGradientColumnsCheck<T, U> type (where U is a function
+// pointer) we can use with SFINAE to catch when a type has a GradientColumns()
+// function.
+HAS_MEM_FUNC(GradientColumns, HasGradientColumnsCheck);
+
 } // namespace ann
 } // namespace mlpack
 
@@ -52,6 +52,9 @@ template<typename InputDataType, typename OutputDataType> class LinearNoBias;
 template<typename InputDataType, typename OutputDataType> class LSTM;
 template<typename InputDataType, typename OutputDataType> class GRU;
 template<typename InputDataType, typename OutputDataType> class FastLSTM;
+template<typename InputDataType, typename OutputDataType> class FastGRU;
+template<typename InputDataType, typename OutputDataType>
+class FastPeepholeLSTM;
 template<typename InputDataType, typename OutputDataType> class Recurrent;
 template<typename InputDataType, typename OutputDataType> class Sequential;
 template<typename InputDataType, typename OutputDataType> class VRClassReward;
@@ -78,6 +81,8 @@ template<
 >
 class RecurrentAttention;
 
+// A layer is serialized by its index in this variant, so new layer types have
+// to be added at the end to keep earlier models loadable.
 using LayerTypes = boost::variant<
     Add<arma::mat, arma::mat>*,
     AddMerge<arma::mat, arma::mat>*,
@@ -118,7 +123,9 @@ using LayerTypes = boost::variant<
     ReinforceNormal<arma::mat, arma::mat>*,
     Select<arma::mat, arma::mat>*,
     Sequential<arma::mat, arma::mat>*,
-    VRClassReward<arma::mat, arma::mat>*
+    VRClassReward<arma::mat, arma::mat>*,
+    FastGRU<arma::mat, arma::mat>*,
+    FastPeepholeLSTM<arma::mat, arma::mat>*
 >;
 
 } // namespace ann
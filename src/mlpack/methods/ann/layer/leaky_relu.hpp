@@ -16,6 +16,8 @@
 
 #include <mlpack/prereqs.hpp>
 
+#include "layer_traits.hpp"
+
 namespace mlpack {
 namespace ann /** Artificial Neural Network. */ {
 
@@ -167,6 +169,19 @@ class LeakyReLU
   double alpha;
 }; // class LeakyReLU
 
+//! The LeakyReLU layer is applied elementwise.
+template<typename InputDataType, typename OutputDataType>
+class LayerTraits<LeakyReLU<InputDataType, OutputDataType> >
+{
+ public:
+  static const bool IsBinary = false;
+  static const bool IsOutputLayer = false;
+  static const bool IsBiasLayer = false;
+  static const bool IsLSTMLayer = false;
+  static const bool IsConnection = false;
+  static const bool IsElementwise = true;
+};
+
 } // namespace ann
 } // namespace mlpack
 
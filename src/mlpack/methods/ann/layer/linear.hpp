@@ -88,6 +88,12 @@ class Linear
                 arma::Mat<eT>&& error,
                 arma::Mat<eT>&& gradient);
 
+  //! Get the number of input units.
+  size_t InputSize() const { return inSize; }
+
+  //! Get the number of output units.
+  size_t OutputSize() const { return outSize; }
+
   //! Get the parameters.
   OutputDataType const& Parameters() const { return weights; }
   //! Modify the parameters.
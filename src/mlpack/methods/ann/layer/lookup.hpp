@@ -70,6 +70,11 @@ class Lookup
 
   /*
    * Calculate the gradient using the output delta and the input activation.
+   * Only the columns of the looked-up tokens are non-zero; a token that occurs
+   * several times in the input accumulates the error of each occurrence.  If
+   * the given gradient already has the size of the weights, it is assumed to
+   * hold the result of the last call, and only the columns written by that
+   * call are cleared.
    *
    * @param input The input parameter used for calculating the gradient.
    * @param error The calculated error.
@@ -105,6 +110,9 @@ class Lookup
   //! Modify the gradient.
   OutputDataType& Gradient() { return gradient; }
 
+  //! Get the (sorted) columns of the weights touched by the last Gradient().
+  const arma::uvec& GradientColumns() const { return gradientColumns; }
+
   /**
    * Serialize the layer
    */
@@ -127,6 +135,9 @@ class Lookup
   //! Locally-stored gradient object.
   OutputDataType gradient;
 
+  //! Locally-stored columns touched by the last Gradient() call.
+  arma::uvec gradientColumns;
+
   //! Locally-stored input parameter object.
   InputDataType inputParameter;
 
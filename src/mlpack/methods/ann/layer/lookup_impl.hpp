@@ -54,8 +54,18 @@ void Lookup<InputDataType, OutputDataType>::Gradient(
     arma::Mat<eT>&& error,
     arma::Mat<eT>&& gradient)
 {
-  gradient = arma::zeros<arma::Mat<eT> >(weights.n_rows, weights.n_cols);
-  gradient.cols(arma::conv_to<arma::uvec>::from(input) - 1) = error;
+  if (gradient.n_rows != weights.n_rows || gradient.n_cols != weights.n_cols)
+    gradient.zeros(weights.n_rows, weights.n_cols);
+  else if (!gradientColumns.is_empty())
+    gradient.cols(gradientColumns).zeros();
+
+  // Accumulate instead of assigning, so that repeated tokens contribute the
+  // error of every occurrence.
+  const arma::uvec columns = arma::conv_to<arma::uvec>::from(input) - 1;
+  for (size_t i = 0; i < columns.n_elem; ++i)
+    gradient.col(columns[i]) += error.col(i);
+
+  gradientColumns = arma::unique(columns);
 }
 
 template<typename InputDataType, typename OutputDataType>
@@ -91,6 +91,10 @@ void LSTM<InputDataType, OutputDataType>::ResetCell(const size_t size)
       outParameter.resize(outSize, (size + 1) * batchSize);
     }
   }
+
+  // Every sequence starts from a zero state; after the batch size changed these
+  // columns may still hold the outputs of an earlier batch.
+  outParameter.cols(0, batchSize - 1).zeros();
 }
 
 template<typename InputDataType, typename OutputDataType>
@@ -141,55 +141,80 @@ class MaxPooling
   void serialize(Archive& ar, const unsigned int /* version */);
 
  private:
- /**
-   * Apply pooling to the input and store the results.
+  /**
+   * Apply max pooling to all slices of the input and store the results.  The
+   * elements of each window are visited column by column, so the inner loop
+   * runs over contiguous memory; windows that extend past the input are
+   * clipped.
    *
    * @param input The input to be apply the pooling rule.
    * @param output The pooled result.
-   * @param poolingIndices The pooled indices.
+   * @param poolingIndices If not NULL, the index of the maximum of each window
+   *        in the input is stored here.
    */
   template<typename eT>
-  void PoolingOperation(const arma::Mat<eT>& input,
-                        arma::Mat<eT>& output,
-                        arma::Mat<eT>& poolingIndices)
+  void PoolingOperation(const eT* input,
+                        eT* output,
+                        arma::u32* poolingIndices)
   {
-    for (size_t j = 0, colidx = 0; j < output.n_cols; ++j, colidx += dW)
+    const size_t sliceSize = inputWidth * inputHeight;
+    const size_t rStep = kW - offset;
+    const size_t cStep = kH - offset;
+
+    // The common case of 2x2 windows with a stride of 2 needs no bounds checks
+    // and, if no indices are needed, no branches.
+    if (rStep == 2 && cStep == 2 && dW == 2 && dH == 2 && !poolingIndices &&
+        2 * outputWidth <= inputWidth && 2 * outputHeight <= inputHeight)
     {
-      for (size_t i = 0, rowidx = 0; i < output.n_rows; ++i, rowidx += dH)
+      for (size_t s = 0; s < outSize; ++s)
       {
-        arma::mat subInput = input(arma::span(rowidx, rowidx + kW - 1 - offset),
-            arma::span(colidx, colidx + kH - 1 - offset));
-
-        const size_t idx = pooling.Pooling(subInput);
-        output(i, j) = subInput(idx);
-
-        if (!deterministic)
+        for (size_t j = 0; j < outputHeight; ++j)
         {
-          arma::Mat<size_t> subIndices = indices(arma::span(rowidx,
-              rowidx + kW - 1 - offset),
-              arma::span(colidx, colidx + kH - 1 - offset));
-
-          poolingIndices(i, j) = subIndices(idx);
+          const eT* col0 = input + s * sliceSize + 2 * j * inputWidth;
+          const eT* col1 = col0 + inputWidth;
+          for (size_t i = 0; i < outputWidth; ++i)
+          {
+            output[i] = std::max(std::max(col0[2 * i], col0[2 * i + 1]),
+                std::max(col1[2 * i], col1[2 * i + 1]));
+          }
+
+          output += outputWidth;
         }
       }
+
+      return;
     }
-  }
 
-  /**
-   * Apply unpooling to the input and store the results.
-   *
-   * @param error The backward error.
-   * @param output The pooled result.
-   * @param poolingIndices The pooled indices.
-   */
-  template<typename eT>
-  void Unpooling(const arma::Mat<eT>& error,
-                 arma::Mat<eT>& output,
-                 arma::Mat<eT>& poolingIndices)
-  {
-    for (size_t i = 0; i < poolingIndices.n_elem; ++i)
+    for (size_t s = 0, o = 0; s < outSize; ++s)
     {
-      output(poolingIndices(i)) += error(i);
+      for (size_t j = 0, colidx = 0; j < outputHeight; ++j, colidx += dH)
+      {
+        const size_t cols = std::min(cStep, inputHeight - colidx);
+        for (size_t i = 0, rowidx = 0; i < outputWidth; ++i, rowidx += dW, ++o)
+        {
+          const size_t rows = std::min(rStep, inputWidth - rowidx);
+
+          size_t maxIndex = s * sliceSize + colidx * inputWidth + rowidx;
+          eT maxValue = input[maxIndex];
+          for (size_t c = 0; c < cols; ++c)
+          {
+            const size_t colIndex = maxIndex + c * inputWidth;
+            for (size_t r = 0; r < rows; ++r)
+            {
+              // Keep the first of several equal maxima.
+              if (input[colIndex + r] > maxValue)
+              {
+                maxValue = input[colIndex + r];
+                maxIndex = colIndex + r;
+              }
+            }
+          }
+
+          output[o] = maxValue;
+          if (poolingIndices)
+            poolingIndices[o] = maxIndex;
+        }
+      }
     }
   }
 
@@ -211,9 +236,6 @@ class MaxPooling
   //! Locally-stored height of the stride operation.
   size_t dH;
 
-  //! Locally-stored reset parameter used to initialize the module once.
-  bool reset;
-
   //! Rounding operation used.
   bool floor;
 
@@ -235,18 +257,6 @@ class MaxPooling
   //! If true use maximum a posteriori during the forward pass.
   bool deterministic;
 
-  //! Locally-stored output parameter.
-  arma::cube outputTemp;
-
-  //! Locally-stored transformed input parameter.
-  arma::cube inputTemp;
-
-  //! Locally-stored transformed output parameter.
-  arma::cube gTemp;
-
-  //! Locally-stored pooling strategy.
-  MaxPoolingRule pooling;
-
   //! Locally-stored delta object.
   OutputDataType delta;
 
@@ -259,14 +269,12 @@ class MaxPooling
   //! Locally-stored output parameter object.
   OutputDataType outputParameter;
 
-  //! Locally-stored indices matrix parameter.
-  arma::Mat<size_t> indices;
-
-  //! Locally-stored indices column parameter.
-  arma::Col<size_t> indicesCol;
+  //! Locally-stored indices of the maxima of the forward passes in training
+  //! mode, used as a stack by the backward passes.
+  std::vector<arma::Col<arma::u32> > poolingIndices;
 
-  //! Locally-stored pooling indicies.
-  std::vector<arma::cube> poolingIndices;
+  //! The number of forward passes whose indices are stored.
+  size_t poolingIndicesSize;
 }; // class MaxPooling
 
 } // namespace ann
@@ -20,7 +20,8 @@ namespace mlpack {
 namespace ann /** Artificial Neural Network. */ {
 
 template<typename InputDataType, typename OutputDataType>
-MaxPooling<InputDataType, OutputDataType>::MaxPooling()
+MaxPooling<InputDataType, OutputDataType>::MaxPooling() :
+    poolingIndicesSize(0)
 {
   // Nothing to do here.
 }
@@ -36,14 +37,14 @@ MaxPooling<InputDataType, OutputDataType>::MaxPooling(
     kH(kH),
     dW(dW),
     dH(dH),
-    reset(false),
     floor(floor),
     offset(0),
     inputWidth(0),
     inputHeight(0),
     outputWidth(0),
     outputHeight(0),
-    deterministic(false)
+    deterministic(false),
+    poolingIndicesSize(0)
 {
   // Nothing to do here.
 }
@@ -53,8 +54,8 @@ template<typename eT>
 void MaxPooling<InputDataType, OutputDataType>::Forward(
   const arma::Mat<eT>&& input, arma::Mat<eT>&& output)
 {
-  const size_t slices = input.n_elem / (inputWidth * inputHeight);
-  inputTemp = arma::cube(input.memptr(), inputWidth, inputHeight, slices);
+  // All channels of all points in the batch are pooled in one pass.
+  outSize = input.n_elem / (inputWidth * inputHeight);
 
   if (floor)
   {
@@ -67,46 +68,31 @@ void MaxPooling<InputDataType, OutputDataType>::Forward(
     outputWidth = std::ceil((inputWidth - (double) kW) / (double) dW + 1);
     outputHeight = std::ceil((inputHeight - (double) kH) / (double) dH + 1);
     offset = 1;
+
+    // With a stride larger than the window the last window may start past the
+    // input; drop it.
+    if ((outputWidth - 1) * dW >= inputWidth)
+      --outputWidth;
+    if ((outputHeight - 1) * dH >= inputHeight)
+      --outputHeight;
   }
 
-  outputTemp = arma::zeros<arma::Cube<eT> >(outputWidth, outputHeight,
-      slices);
+  output.set_size(outputWidth * outputHeight * outSize, 1);
 
   if (!deterministic)
   {
-    poolingIndices.push_back(outputTemp);
-  }
-
-  if (!reset)
-  {
-    size_t elements = inputWidth * inputHeight;
-    indicesCol = arma::linspace<arma::Col<size_t> >(0, (elements - 1),
-        elements);
+    // Reuse the memory of the indices of earlier passes.
+    if (poolingIndicesSize == poolingIndices.size())
+      poolingIndices.push_back(arma::Col<arma::u32>());
 
-    indices = arma::Mat<size_t>(indicesCol.memptr(), inputWidth, inputHeight);
-
-    reset = true;
+    arma::Col<arma::u32>& indices = poolingIndices[poolingIndicesSize++];
+    indices.set_size(output.n_elem);
+    PoolingOperation(input.memptr(), output.memptr(), indices.memptr());
   }
-
-  for (size_t s = 0; s < inputTemp.n_slices; s++)
+  else
   {
-    if (!deterministic)
-    {
-      PoolingOperation(inputTemp.slice(s), outputTemp.slice(s),
-        poolingIndices.back().slice(s));
-    }
-    else
-    {
-      PoolingOperation(inputTemp.slice(s), outputTemp.slice(s),
-          inputTemp.slice(s));
-    }
+    PoolingOperation(input.memptr(), output.memptr(), (arma::u32*) NULL);
   }
-
-  output = arma::Mat<eT>(outputTemp.memptr(), outputTemp.n_elem, 1);
-
-  outputWidth = outputTemp.n_rows;
-  outputHeight = outputTemp.n_cols;
-  outSize = slices;
 }
 
 template<typename InputDataType, typename OutputDataType>
@@ -114,21 +100,11 @@ template<typename eT>
 void MaxPooling<InputDataType, OutputDataType>::Backward(
     const arma::Mat<eT>&& /* input */, arma::Mat<eT>&& gy, arma::Mat<eT>&& g)
 {
-  arma::cube mappedError = arma::cube(gy.memptr(), outputWidth,
-      outputHeight, outSize);
-
-  gTemp = arma::zeros<arma::cube>(inputTemp.n_rows,
-      inputTemp.n_cols, inputTemp.n_slices);
-
-  for (size_t s = 0; s < mappedError.n_slices; s++)
-  {
-    Unpooling(mappedError.slice(s), gTemp.slice(s),
-        poolingIndices.back().slice(s));
-  }
-
-  poolingIndices.pop_back();
+  const arma::Col<arma::u32>& indices = poolingIndices[--poolingIndicesSize];
 
-  g = arma::mat(gTemp.memptr(), gTemp.n_elem, 1);
+  g.zeros(inputWidth * inputHeight * outSize, 1);
+  for (size_t i = 0; i < indices.n_elem; ++i)
+    g[indices[i]] += gy[i];
 }
 
 template<typename InputDataType, typename OutputDataType>
@@ -122,57 +122,95 @@ class MeanPooling
 
  private:
   /**
-   * Apply pooling to the input and store the results.
+   * Apply mean pooling to all slices of the input and store the results.  The
+   * elements of each window are visited column by column, so the inner loop
+   * runs over contiguous memory; windows that extend past the input are
+   * clipped.
    *
    * @param input The input to be apply the pooling rule.
    * @param output The pooled result.
    */
   template<typename eT>
-  void Pooling(const arma::Mat<eT>& input, arma::Mat<eT>& output)
+  void Pooling(const eT* input, eT* output)
   {
-    const size_t rStep = kW;
-    const size_t cStep = kH;
+    const size_t sliceSize = inputWidth * inputHeight;
+    const size_t rStep = kW - offset;
+    const size_t cStep = kH - offset;
 
-    for (size_t j = 0, colidx = 0; j < output.n_cols; ++j, colidx += dH)
+    // The common case of 2x2 windows with a stride of 2 needs no bounds checks.
+    if (rStep == 2 && cStep == 2 && dW == 2 && dH == 2 &&
+        2 * outputWidth <= inputWidth && 2 * outputHeight <= inputHeight)
     {
-      for (size_t i = 0, rowidx = 0; i < output.n_rows; ++i, rowidx += dW)
+      for (size_t s = 0; s < outSize; ++s)
       {
-        arma::mat subInput = input(
-            arma::span(rowidx, rowidx + rStep - 1 - offset),
-            arma::span(colidx, colidx + cStep - 1 - offset));
+        for (size_t j = 0; j < outputHeight; ++j)
+        {
+          const eT* col0 = input + s * sliceSize + 2 * j * inputWidth;
+          const eT* col1 = col0 + inputWidth;
+          for (size_t i = 0; i < outputWidth; ++i)
+          {
+            output[i] = 0.25 * (col0[2 * i] + col0[2 * i + 1] + col1[2 * i] +
+                col1[2 * i + 1]);
+          }
+
+          output += outputWidth;
+        }
+      }
+
+      return;
+    }
 
-        output(i, j) = arma::mean(arma::mean(subInput));
+    for (size_t s = 0, o = 0; s < outSize; ++s)
+    {
+      for (size_t j = 0, colidx = 0; j < outputHeight; ++j, colidx += dH)
+      {
+        const size_t cols = std::min(cStep, inputHeight - colidx);
+        for (size_t i = 0, rowidx = 0; i < outputWidth; ++i, rowidx += dW, ++o)
+        {
+          const size_t rows = std::min(rStep, inputWidth - rowidx);
+          const eT* window = input + s * sliceSize + colidx * inputWidth +
+              rowidx;
+
+          eT sum = 0;
+          for (size_t c = 0; c < cols; ++c, window += inputWidth)
+            for (size_t r = 0; r < rows; ++r)
+              sum += window[r];
+
+          output[o] = sum / (rows * cols);
+        }
       }
     }
   }
 
   /**
-   * Apply unpooling to the input and store the results.
+   * Apply unpooling to the error and add the results to the output; the error
+   * of each window is spread evenly over the elements of the window.
    *
-   * @param input The input to be apply the unpooling rule.
-   * @param output The pooled result.
+   * @param error The backward error.
+   * @param output The unpooled result.
    */
   template<typename eT>
-  void Unpooling(const arma::Mat<eT>& input,
-                 const arma::Mat<eT>& error,
-                 arma::Mat<eT>& output)
+  void Unpooling(const eT* error, eT* output)
   {
-    const size_t rStep = input.n_rows / error.n_rows - offset;
-    const size_t cStep = input.n_cols / error.n_cols - offset;
+    const size_t sliceSize = inputWidth * inputHeight;
+    const size_t rStep = kW - offset;
+    const size_t cStep = kH - offset;
 
-    arma::Mat<eT> unpooledError;
-    for (size_t j = 0; j < input.n_cols - cStep; j += cStep)
+    for (size_t s = 0, o = 0; s < outSize; ++s)
     {
-      for (size_t i = 0; i < input.n_rows - rStep; i += rStep)
+      for (size_t j = 0, colidx = 0; j < outputHeight; ++j, colidx += dH)
       {
-        const arma::Mat<eT>& inputArea = input(arma::span(i, i + rStep - 1),
-            arma::span(j, j + cStep - 1));
-
-        unpooledError = arma::Mat<eT>(inputArea.n_rows, inputArea.n_cols);
-        unpooledError.fill(error(i / rStep, j / cStep) / inputArea.n_elem);
-
-        output(arma::span(i, i + rStep - 1 - offset),
-            arma::span(j, j + cStep - 1 - offset)) += unpooledError;
+        const size_t cols = std::min(cStep, inputHeight - colidx);
+        for (size_t i = 0, rowidx = 0; i < outputWidth; ++i, rowidx += dW, ++o)
+        {
+          const size_t rows = std::min(rStep, inputWidth - rowidx);
+          const eT value = error[o] / (rows * cols);
+          eT* window = output + s * sliceSize + colidx * inputWidth + rowidx;
+
+          for (size_t c = 0; c < cols; ++c, window += inputWidth)
+            for (size_t r = 0; r < rows; ++r)
+              window[r] += value;
+        }
       }
     }
   }
@@ -219,15 +257,6 @@ class MeanPooling
   //! Locally-stored stored rounding offset.
   size_t offset;
 
-  //! Locally-stored output parameter.
-  arma::cube outputTemp;
-
-  //! Locally-stored transformed input parameter.
-  arma::cube inputTemp;
-
-  //! Locally-stored transformed output parameter.
-  arma::cube gTemp;
-
   //! Locally-stored delta object.
   OutputDataType delta;
 
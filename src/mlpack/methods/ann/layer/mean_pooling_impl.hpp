@@ -53,8 +53,8 @@ template<typename eT>
 void MeanPooling<InputDataType, OutputDataType>::Forward(
     const arma::Mat<eT>&& input, arma::Mat<eT>&& output)
 {
-  size_t slices = input.n_elem / (inputWidth * inputHeight);
-  inputTemp = arma::cube(input.memptr(), inputWidth, inputHeight, slices);
+  // All channels of all points in the batch are pooled in one pass.
+  outSize = input.n_elem / (inputWidth * inputHeight);
 
   if (floor)
   {
@@ -69,19 +69,16 @@ void MeanPooling<InputDataType, OutputDataType>::Forward(
     outputHeight = std::ceil((inputHeight - (double) kH) / (double) dH + 1);
 
     offset = 1;
+    // With a stride larger than the window the last window may start past the
+    // input; drop it.
+    if ((outputWidth - 1) * dW >= inputWidth)
+      --outputWidth;
+    if ((outputHeight - 1) * dH >= inputHeight)
+      --outputHeight;
   }
 
-  outputTemp = arma::zeros<arma::Cube<eT> >(outputWidth, outputHeight,
-      slices);
-
-  for (size_t s = 0; s < inputTemp.n_slices; s++)
-    Pooling(inputTemp.slice(s), outputTemp.slice(s));
-
-  output = arma::Mat<eT>(outputTemp.memptr(), outputTemp.n_elem, 1);
-
-  outputWidth = outputTemp.n_rows;
-  outputHeight = outputTemp.n_cols;
-  outSize = slices;
+  output.set_size(outputWidth * outputHeight * outSize, 1);
+  Pooling(input.memptr(), output.memptr());
 }
 
 template<typename InputDataType, typename OutputDataType>
@@ -91,18 +88,8 @@ void MeanPooling<InputDataType, OutputDataType>::Backward(
   arma::Mat<eT>&& gy,
   arma::Mat<eT>&& g)
 {
-  arma::cube mappedError = arma::cube(gy.memptr(), outputWidth,
-      outputHeight, outSize);
-
-  gTemp = arma::zeros<arma::cube>(inputTemp.n_rows,
-      inputTemp.n_cols, inputTemp.n_slices);
-
-  for (size_t s = 0; s < mappedError.n_slices; s++)
-  {
-    Unpooling(inputTemp.slice(s), mappedError.slice(s), gTemp.slice(s));
-  }
-
-  g = arma::mat(gTemp.memptr(), gTemp.n_elem, 1);
+  g.zeros(inputWidth * inputHeight * outSize, 1);
+  Unpooling(gy.memptr(), g.memptr());
 }
 
 template<typename InputDataType, typename OutputDataType>
@@ -10,6 +10,8 @@
 
 #include <mlpack/prereqs.hpp>
 
+#include "layer_traits.hpp"
+
 namespace mlpack {
 namespace ann /** Artificial Neural Network. */ {
 
@@ -55,6 +57,11 @@ class MultiplyConstant
   template<typename DataType>
   void Backward(const DataType&& /* input */, DataType&& gy, DataType&& g);
 
+  //! Get the constant scalar value.
+  double Scalar() const { return scalar; }
+  //! Modify the constant scalar value.
+  double& Scalar() { return scalar; }
+
   //! Get the input parameter.
   InputDataType& InputParameter() const { return inputParameter; }
   //! Modify the input parameter.
@@ -90,6 +97,19 @@ class MultiplyConstant
   OutputDataType outputParameter;
 }; // class MultiplyConstant
 
+//! The MultiplyConstant layer is applied elementwise.
+template<typename InputDataType, typename OutputDataType>
+class LayerTraits<MultiplyConstant<InputDataType, OutputDataType> >
+{
+ public:
+  static const bool IsBinary = false;
+  static const bool IsOutputLayer = false;
+  static const bool IsBiasLayer = false;
+  static const bool IsLSTMLayer = false;
+  static const bool IsConnection = false;
+  static const bool IsElementwise = true;
+};
+
 } // namespace ann
 } // namespace mlpack
 
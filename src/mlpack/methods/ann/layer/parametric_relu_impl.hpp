@@ -62,10 +62,11 @@ void PReLU<InputDataType, OutputDataType>::Gradient(
 {
   if (gradient.n_elem == 0)
   {
-    gradient = arma::zeros<arma::mat>(1, 1);
+    gradient = arma::zeros<arma::Mat<eT> >(1, 1);
   }
 
-  arma::mat zeros = arma::zeros<arma::mat>(input.n_rows, input.n_cols);
+  arma::Mat<eT> zeros = arma::zeros<arma::Mat<eT> >(input.n_rows,
+      input.n_cols);
   gradient(0) = arma::accu(error % arma::min(zeros, input)) / input.n_cols;
 }
 
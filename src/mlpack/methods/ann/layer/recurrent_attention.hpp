@@ -219,6 +219,9 @@ class RecurrentAttention
   //! List of all module parameters for the backward pass (BBTT).
   std::vector<arma::mat> moduleOutputParameter;
 
+  //! The number of module parameters currently stored for the backward pass.
+  size_t moduleOutputSize;
+
   //! Locally-stored delta object.
   OutputDataType delta;
 
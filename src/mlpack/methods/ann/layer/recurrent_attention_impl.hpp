@@ -31,7 +31,8 @@ RecurrentAttention<InputDataType, OutputDataType>::RecurrentAttention() :
     rho(0),
     forwardStep(0),
     backwardStep(0),
-    deterministic(false)
+    deterministic(false),
+    moduleOutputSize(0)
 {
   // Nothing to do.
 }
@@ -49,7 +50,8 @@ RecurrentAttention<InputDataType, OutputDataType>::RecurrentAttention(
     rho(rho),
     forwardStep(0),
     backwardStep(0),
-    deterministic(false)
+    deterministic(false),
+    moduleOutputSize(0)
 {
   network.push_back(rnnModule);
   network.push_back(actionModule);
@@ -99,7 +101,8 @@ void RecurrentAttention<InputDataType, OutputDataType>::Forward(
       for (size_t l = 0; l < network.size(); ++l)
       {
         boost::apply_visitor(SaveOutputParameterVisitor(
-            std::move(moduleOutputParameter)), network[l]);
+            std::move(moduleOutputParameter), moduleOutputSize),
+            network[l]);
       }
     }
   }
@@ -159,7 +162,8 @@ void RecurrentAttention<InputDataType, OutputDataType>::Backward(
     for (size_t l = 0; l < network.size(); ++l)
     {
       boost::apply_visitor(LoadOutputParameterVisitor(
-         std::move(moduleOutputParameter)), network[network.size() - 1 - l]);
+         std::move(moduleOutputParameter), moduleOutputSize),
+         network[network.size() - 1 - l]);
     }
 
     if (backwardStep == (rho - 1))
@@ -139,10 +139,16 @@ class RNN
    * If you want to pass in a parameter and discard the original parameter
    * object, be sure to use std::move to avoid unnecessary copy.
    *
+   * The sequences are passed through the network in batches of the given
+   * size; larger batches make better use of matrix-matrix products.
+   *
    * @param predictors Input predictors.
    * @param results Matrix to put output predictions of responses into.
+   * @param batchSize Number of sequences to be predicted at once.
    */
-  void Predict(arma::mat predictors, arma::mat& results);
+  void Predict(arma::mat predictors,
+               arma::mat& results,
+               const size_t batchSize = 256);
 
   /**
    * Evaluate the recurrent neural network with the given parameters. This
@@ -179,6 +185,24 @@ class RNN
                 arma::mat& gradient,
                 const size_t batchSize);
 
+  /**
+   * Evaluate the gradient of the recurrent neural network with the given
+   * parameters and store it as a sparse matrix.  Only the entries that the
+   * layers wrote to in any of the time steps are stored; for a Lookup layer
+   * these are the columns of the looked-up tokens.
+   *
+   * @param parameters Matrix of the model parameters to be optimized.
+   * @param begin Index of the starting point to use for objective function
+   *        gradient evaluation.
+   * @param gradient Sparse matrix to output gradient into.
+   * @param batchSize Number of points to be processed as a batch for objective
+   *        function gradient evaluation.
+   */
+  void Gradient(const arma::mat& parameters,
+                const size_t begin,
+                arma::sp_mat& gradient,
+                const size_t batchSize);
+
   /**
    * Shuffle the order of function visitation. This may be called by the
    * optimizer.
@@ -265,10 +289,11 @@ class RNN
   void Gradient(InputType&& input);
 
   /*
-   * Predict the response of the given input sequence.
+   * Predict the response of the given batch of input sequences (one sequence
+   * per column).
    *
    * @param predictors Input predictors.
-   * @param results Vector to put output prediction of a response into.
+   * @param results Matrix to put output predictions of the responses into.
    */
   void SinglePredict(const arma::mat& predictors, arma::mat& results);
 
@@ -332,9 +357,13 @@ class RNN
   //! Locally-stored output parameter visitor.
   OutputParameterVisitor outputParameterVisitor;
 
-  //! List of all module parameters for the backward pass (BBTT).
+  //! List of all module parameters for the backward pass (BBTT).  The list is
+  //! reused as a stack by every training pass, so it never shrinks.
   std::vector<arma::mat> moduleOutputParameter;
 
+  //! The number of module parameters currently stored for the backward pass.
+  size_t moduleOutputSize;
+
   //! Locally-stored weight size visitor.
   WeightSizeVisitor weightSizeVisitor;
 
@@ -349,6 +378,18 @@ class RNN
 
   //! The current gradient for the gradient pass.
   arma::mat currentGradient;
+
+  //! The accumulated gradient of the sparse gradient pass.
+  arma::mat sparseGradient;
+
+  //! The gradient of a single time step of the sparse gradient pass.
+  arma::mat stepGradient;
+
+  //! The indices of sparseGradient written by the last sparse gradient pass.
+  arma::uvec gradientIndices;
+
+  //! The indices of stepGradient written by the last time step.
+  arma::uvec stepIndices;
 }; // class RNN
 
 } // namespace ann
@@ -23,6 +23,7 @@
 #include "visitor/deterministic_set_visitor.hpp"
 #include "visitor/gradient_set_visitor.hpp"
 #include "visitor/gradient_visitor.hpp"
+#include "visitor/sparse_gradient_visitor.hpp"
 #include "visitor/weight_set_visitor.hpp"
 
 #include <boost/serialization/variant.hpp>
@@ -45,6 +46,7 @@ RNN<OutputLayerType, InitializationRuleType>::RNN(
     reset(false),
     single(single),
     numFunctions(0),
+    moduleOutputSize(0),
     deterministic(true)
 {
   /* Nothing to do here */
@@ -69,6 +71,7 @@ RNN<OutputLayerType, InitializationRuleType>::RNN(
     predictors(std::move(predictors)),
     responses(std::move(responses)),
     numFunctions(0),
+    moduleOutputSize(0),
     deterministic(true)
 {
   numFunctions = this->responses.n_cols;
@@ -153,10 +156,8 @@ void RNN<OutputLayerType, InitializationRuleType>::Train(
 
 template<typename OutputLayerType, typename InitializationRuleType>
 void RNN<OutputLayerType, InitializationRuleType>::Predict(
-    arma::mat predictors, arma::mat& results)
+    arma::mat predictors, arma::mat& results, const size_t batchSize)
 {
-  ResetCells();
-
   if (parameter.is_empty())
   {
     ResetParameters();
@@ -169,15 +170,21 @@ void RNN<OutputLayerType, InitializationRuleType>::Predict(
   }
 
   results = arma::zeros<arma::mat>(outputSize * rho, predictors.n_cols);
-  arma::mat resultsTemp = results.col(0);
+  arma::mat resultsTemp;
 
-  for (size_t i = 0; i < predictors.n_cols; i++)
+  for (size_t i = 0; i < predictors.n_cols; i += batchSize)
   {
-    SinglePredict(
-        arma::mat(predictors.colptr(i), predictors.n_rows, 1, false, true),
-        resultsTemp);
+    const size_t effectiveBatchSize = std::min(batchSize,
+        size_t(predictors.n_cols - i));
+
+    // Every batch starts new sequences.
+    ResetCells();
+
+    resultsTemp.set_size(outputSize * rho, effectiveBatchSize);
+    SinglePredict(arma::mat(predictors.colptr(i), predictors.n_rows,
+        effectiveBatchSize, false, true), resultsTemp);
 
-    results.col(i) = resultsTemp;
+    results.cols(i, i + effectiveBatchSize - 1) = resultsTemp;
   }
 }
 
@@ -225,6 +232,9 @@ double RNN<OutputLayerType, InitializationRuleType>::Evaluate(
 
   ResetCells();
 
+  // Any parameters saved by an earlier pass without backward pass are stale.
+  moduleOutputSize = 0;
+
   double performance = 0;
 
   for (size_t seqNum = 0; seqNum < rho; ++seqNum)
@@ -237,7 +247,8 @@ double RNN<OutputLayerType, InitializationRuleType>::Evaluate(
       for (size_t l = 0; l < network.size(); ++l)
       {
         boost::apply_visitor(SaveOutputParameterVisitor(
-            std::move(moduleOutputParameter)), network[l]);
+            std::move(moduleOutputParameter), moduleOutputSize),
+            network[l]);
       }
     }
 
@@ -296,7 +307,8 @@ void RNN<OutputLayerType, InitializationRuleType>::Gradient(
     for (size_t l = 0; l < network.size(); ++l)
     {
       boost::apply_visitor(LoadOutputParameterVisitor(
-          std::move(moduleOutputParameter)), network[network.size() - 1 - l]);
+          std::move(moduleOutputParameter), moduleOutputSize),
+          network[network.size() - 1 - l]);
     }
 
     if (single && seqNum > 0)
@@ -319,6 +331,87 @@ void RNN<OutputLayerType, InitializationRuleType>::Gradient(
   }
 }
 
+template<typename OutputLayerType, typename InitializationRuleType>
+void RNN<OutputLayerType, InitializationRuleType>::Gradient(
+    const arma::mat& parameters,
+    const size_t begin,
+    arma::sp_mat& gradient,
+    const size_t batchSize)
+{
+  if (parameter.is_empty())
+    ResetParameters();
+
+  // Only the entries written by the last call can be non-zero, so only those
+  // have to be cleared.
+  if (sparseGradient.n_rows != parameter.n_rows ||
+      sparseGradient.n_cols != parameter.n_cols)
+  {
+    sparseGradient.zeros(parameter.n_rows, parameter.n_cols);
+    stepGradient.zeros(parameter.n_rows, parameter.n_cols);
+    gradientIndices.reset();
+    stepIndices.reset();
+  }
+  else
+  {
+    sparseGradient.elem(gradientIndices).zeros();
+  }
+
+  Evaluate(parameters, begin, batchSize, false);
+
+  ResetGradients(stepGradient);
+
+  std::vector<arma::uword> indices;
+  for (size_t seqNum = 0; seqNum < rho; ++seqNum)
+  {
+    stepGradient.elem(stepIndices).zeros();
+
+    for (size_t l = 0; l < network.size(); ++l)
+    {
+      boost::apply_visitor(LoadOutputParameterVisitor(
+          std::move(moduleOutputParameter), moduleOutputSize),
+          network[network.size() - 1 - l]);
+    }
+
+    if (single && seqNum > 0)
+    {
+      error.zeros();
+    }
+    else
+    {
+      outputLayer.Backward(std::move(boost::apply_visitor(
+          outputParameterVisitor, network.back())),
+          std::move(responses.submat((rho - seqNum - 1) * targetSize, begin,
+          (rho - seqNum) * targetSize - 1, begin + batchSize - 1)),
+          std::move(error));
+    }
+
+    Backward();
+    Gradient(std::move(predictors.submat((rho - seqNum - 1) * inputSize, begin,
+        (rho - seqNum) * inputSize - 1, begin + batchSize - 1)));
+
+    std::vector<arma::uword> step;
+    size_t offset = 0;
+    for (size_t i = 0; i < network.size(); ++i)
+    {
+      offset += boost::apply_visitor(SparseGradientVisitor(step, offset),
+          network[i]);
+    }
+    stepIndices = arma::uvec(step);
+
+    sparseGradient.elem(stepIndices) += stepGradient.elem(stepIndices);
+    indices.insert(indices.end(), step.begin(), step.end());
+  }
+
+  gradientIndices = arma::unique(arma::uvec(indices));
+
+  // The parameters are stored in a single column, so the flat indices are the
+  // row indices of the sparse gradient.
+  arma::umat locations(2, gradientIndices.n_elem, arma::fill::zeros);
+  locations.row(0) = gradientIndices.t();
+  gradient = arma::sp_mat(locations, sparseGradient.elem(gradientIndices),
+      parameter.n_rows, parameter.n_cols, true, false);
+}
+
 template<typename OutputLayerType, typename InitializationRuleType>
 void RNN<OutputLayerType, InitializationRuleType>::Shuffle()
 {
@@ -0,0 +1,523 @@
+/**
+ * @file static_ffn.hpp
+ *
+ * Definition of the StaticFFN class, which implements feed forward neural
+ * networks whose layers are given at compile time.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_STATIC_FFN_HPP
+#define MLPACK_METHODS_ANN_STATIC_FFN_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#include <numeric>
+
+#include "layer/layer_traits.hpp"
+#include "init_rules/init_rules_traits.hpp"
+
+#include <mlpack/core/optimizers/rmsprop/rmsprop.hpp>
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+/**
+ * Implementation of a feed forward network whose layers are given as template
+ * parameters.  The layers are stored by value and called directly instead of
+ * through the visitors of the LayerTypes variant, so the layer calls can be
+ * inlined; this matters for small networks and for predicting single points.
+ * When the network is used in deterministic mode (e.g. by Predict()), layers
+ * that are applied elementwise (see LayerTraits::IsElementwise) work in place
+ * on the output of the preceding layer, so a chain such as Linear, ReLU and
+ * MultiplyConstant uses a single output matrix.
+ *
+ * The precision of the network is given by the layers; for instance
+ * Linear<arma::fmat, arma::fmat> gives a single-precision network.  The
+ * parameters seen by the optimizer are always stored in double precision.  If
+ * the layers use another precision, the parameters are converted before each
+ * pass and the gradient is converted back, so the optimizer keeps the master
+ * weights (and its own state) in double precision while the layers compute in
+ * single precision.
+ *
+ * The parameters are laid out in the same order as those of an FFN with the
+ * same layers, so a trained (or deserialized) FFN model can be used by
+ * assigning its parameters:
+ *
+ * @code
+ * FFN<NegativeLogLikelihood<> > model;
+ * data::Load("model.xml", "model", model);
+ *
+ * StaticFFN<NegativeLogLikelihood<>, RandomInitialization, Linear<>,
+ *     SigmoidLayer<>, Linear<>, LogSoftMax<> > staticModel(Linear<>(10, 8),
+ *     SigmoidLayer<>(), Linear<>(8, 3), LogSoftMax<>());
+ * staticModel.Parameters() = model.Parameters();
+ * @endcode
+ *
+ * Only layers without inner modules (that is, without a Model() function) can
+ * be used.  Predict() passes all points to the layers at once, so layers that
+ * only take a single point (like Convolution) need one call per point.
+ *
+ * @tparam OutputLayerType The output layer type used to evaluate the network.
+ * @tparam InitializationRuleType Rule used to initialize the weight matrix.
+ * @tparam Layers The types of the layers of the network, in order.
+ */
+template<
+  typename OutputLayerType,
+  typename InitializationRuleType,
+  typename... Layers
+>
+class StaticFFN
+{
+ public:
+  //! The matrix type of the layers (e.g. arma::mat or arma::fmat).
+  typedef typename std::decay<decltype(std::get<0>(
+      std::declval<std::tuple<Layers...>&>()).OutputParameter())>::type
+      MatType;
+
+  /**
+   * Create the StaticFFN object with the given layers.
+   *
+   * @param layers The layers of the network.
+   */
+  StaticFFN(Layers... layers);
+
+  /**
+   * Create the StaticFFN object with the given output layer, initialization
+   * rule and layers.
+   *
+   * @param outputLayer Output layer used to evaluate the network.
+   * @param initializeRule Instantiated InitializationRule object for
+   *        initializing the network parameter.
+   * @param layers The layers of the network.
+   */
+  StaticFFN(OutputLayerType outputLayer,
+            InitializationRuleType initializeRule,
+            Layers... layers);
+
+  /**
+   * Train the network on the given input data using the given optimizer.
+   *
+   * This will use the existing model parameters as a starting point for the
+   * optimization. If this is not what you want, then you should access the
+   * parameters vector directly with Parameters() and modify it as desired.
+   *
+   * @tparam OptimizerType Type of optimizer to use to train the model.
+   * @param predictors Input training variables.
+   * @param responses Outputs results from input training variables.
+   * @param optimizer Instantiated optimizer used to train the model.
+   */
+  template<typename OptimizerType>
+  void Train(MatType predictors,
+             MatType responses,
+             OptimizerType& optimizer);
+
+  /**
+   * Train the network on the given input data. By default, the RMSProp
+   * optimization algorithm is used, but others can be specified (such as
+   * mlpack::optimization::SGD).
+   *
+   * @tparam OptimizerType Type of optimizer to use to train the model.
+   * @param predictors Input training variables.
+   * @param responses Outputs results from input training variables.
+   */
+  template<typename OptimizerType = mlpack::optimization::RMSProp>
+  void Train(MatType predictors, MatType responses);
+
+  /**
+   * Predict the responses to a given set of predictors. The responses will
+   * reflect the output of the last layer.
+   *
+   * @param predictors Input predictors.
+   * @param results Matrix to put output predictions of responses into.
+   */
+  void Predict(const MatType& predictors, MatType& results);
+
+  /**
+   * Evaluate the network with the given parameters on the whole dataset.
+   *
+   * @param parameters Matrix model parameters.
+   */
+  double Evaluate(const arma::mat& parameters);
+
+  /**
+   * Evaluate the network with the given parameters on the given batch of the
+   * dataset.
+   *
+   * @param parameters Matrix model parameters.
+   * @param begin Index of the starting point to use for objective function
+   *        evaluation.
+   * @param batchSize Number of points to be passed at a time to use for
+   *        objective function evaluation.
+   * @param deterministic Whether or not to train or test the model. Note some
+   *        layer act differently in training or testing mode.
+   */
+  double Evaluate(const arma::mat& parameters,
+                  const size_t begin,
+                  const size_t batchSize,
+                  const bool deterministic = true);
+
+  /**
+   * Evaluate the gradient of the network with the given parameters on the
+   * given batch of the dataset.
+   *
+   * @param parameters Matrix of the model parameters to be optimized.
+   * @param begin Index of the starting point to use for objective function
+   *        gradient evaluation.
+   * @param gradient Matrix to output gradient into.
+   * @param batchSize Number of points to be processed as a batch for objective
+   *        function gradient evaluation.
+   */
+  void Gradient(const arma::mat& parameters,
+                const size_t begin,
+                arma::mat& gradient,
+                const size_t batchSize);
+
+  /**
+   * Shuffle the order of function visitation. This may be called by the
+   * optimizer.
+   */
+  void Shuffle();
+
+  //! Return the number of separable functions (the number of predictor points).
+  size_t NumFunctions() const { return numFunctions; }
+
+  //! Return the initial point for the optimization.
+  const arma::mat& Parameters() const { return parameter; }
+  //! Modify the initial point for the optimization.
+  arma::mat& Parameters() { return parameter; }
+
+  //! Get the layers of the network.
+  const std::tuple<Layers...>& Network() const { return network; }
+  //! Modify the layers of the network.
+  std::tuple<Layers...>& Network() { return network; }
+
+  /**
+   * Reset the network parameters with the initialization rule.
+   */
+  void ResetParameters();
+
+  //! Serialize the model.
+  template<typename Archive>
+  void serialize(Archive& ar, const unsigned int /* version */);
+
+ private:
+  //! Whether the layers use the parameters directly.
+  typedef std::integral_constant<bool,
+      std::is_same<MatType, arma::mat>::value> SharedParameters;
+
+  //! The type of the layer with the given index.
+  template<size_t I>
+  using LayerType = typename std::tuple_element<I, std::tuple<Layers...>>::type;
+
+  //! Whether the layer with the given index can work in place on the output
+  //! of the preceding layer.
+  template<size_t I>
+  using InPlace = std::integral_constant<bool,
+      (I > 0) && LayerTraits<LayerType<I>>::IsElementwise>;
+
+  /**
+   * Make sure that the layers use the current parameters, and return the
+   * parameters in the precision of the layers.
+   */
+  MatType& LayerParameters();
+
+  //! Double-precision layers use the parameters directly.
+  MatType& ConvertParameters(std::true_type) { return parameter; }
+
+  //! Convert the parameters to the precision of the layers.
+  MatType& ConvertParameters(std::false_type);
+
+  //! Double-precision layers write into the given gradient directly.
+  MatType& GradientMemory(arma::mat& gradient, std::true_type);
+
+  //! Other layers write into the gradient in their own precision.
+  MatType& GradientMemory(arma::mat& gradient, std::false_type);
+
+  //! Nothing to convert for double-precision layers.
+  void StoreGradient(arma::mat& /* gradient */, std::true_type) { }
+
+  //! Convert the gradient of the layers to double precision.
+  void StoreGradient(arma::mat& gradient, std::false_type);
+
+  /**
+   * Run the forward pass for the given input.
+   *
+   * @param input The input of the first layer.
+   * @return The output of the last layer.
+   */
+  MatType& Forward(MatType& input);
+
+  /**
+   * Run the backward pass and compute the gradient for the given input and
+   * responses; the forward pass must have been run in training mode.
+   *
+   * @param input The input of the first layer.
+   * @param target The responses of the batch.
+   * @param gradient Matrix to output gradient into.
+   */
+  void Backward(MatType& input, MatType& target, arma::mat& gradient);
+
+  //! Forward pass through the layers with index I and higher.
+  template<size_t I>
+  typename std::enable_if<(I < sizeof...(Layers)), MatType&>::type
+  ForwardLayers(MatType& input);
+
+  //! Return the output of the last layer.
+  template<size_t I>
+  typename std::enable_if<I == sizeof...(Layers), MatType&>::type
+  ForwardLayers(MatType& input) { return input; }
+
+  //! Run the forward pass of a layer into its output parameter.
+  template<typename T>
+  MatType& LayerForward(T& layer, MatType& input, std::false_type);
+
+  //! Run the forward pass of an elementwise layer; in deterministic mode the
+  //! input is overwritten with the output.
+  template<typename T>
+  MatType& LayerForward(T& layer, MatType& input, std::true_type);
+
+  //! Backward pass through the layers with index I down to 1.
+  template<size_t I>
+  typename std::enable_if<(I > 0), void>::type
+  BackwardLayers(MatType& error);
+
+  //! The first layer computes no delta.
+  template<size_t I>
+  typename std::enable_if<I == 0, void>::type
+  BackwardLayers(MatType& /* error */) { }
+
+  //! Compute the gradients of the layers with index I and higher.
+  template<size_t I>
+  typename std::enable_if<(I + 1 < sizeof...(Layers)), void>::type
+  GradientLayers(MatType& input, MatType& error);
+
+  //! Compute the gradient of the last layer.
+  template<size_t I>
+  typename std::enable_if<I + 1 == sizeof...(Layers), void>::type
+  GradientLayers(MatType& input, MatType& error);
+
+  //! Let the layers with index I and higher use the given parameters.
+  template<size_t I>
+  typename std::enable_if<(I < sizeof...(Layers)), void>::type
+  SetWeights(MatType& weights, const size_t offset);
+
+  template<size_t I>
+  typename std::enable_if<I == sizeof...(Layers), void>::type
+  SetWeights(MatType& /* weights */, const size_t /* offset */) { }
+
+  //! Let the layers with index I and higher use the given gradient.
+  template<size_t I>
+  typename std::enable_if<(I < sizeof...(Layers)), void>::type
+  SetGradients(MatType& gradient, const size_t offset);
+
+  template<size_t I>
+  typename std::enable_if<I == sizeof...(Layers), void>::type
+  SetGradients(MatType& /* gradient */, const size_t /* offset */) { }
+
+  //! Set the deterministic parameter of the layers with index I and higher.
+  template<size_t I>
+  typename std::enable_if<(I < sizeof...(Layers)), void>::type
+  SetDeterministic();
+
+  template<size_t I>
+  typename std::enable_if<I == sizeof...(Layers), void>::type
+  SetDeterministic() { }
+
+  //! Return the number of parameters of all layers.
+  size_t WeightSize();
+
+  //! Append the number of parameters of the layers with index I and higher.
+  template<size_t I>
+  typename std::enable_if<(I < sizeof...(Layers)), void>::type
+  WeightSizes(std::vector<size_t>& sizes);
+
+  template<size_t I>
+  typename std::enable_if<I == sizeof...(Layers), void>::type
+  WeightSizes(std::vector<size_t>& /* sizes */) { }
+
+  //! Serialize the layers with index I and higher.
+  template<size_t I, typename Archive>
+  typename std::enable_if<(I < sizeof...(Layers)), void>::type
+  SerializeLayers(Archive& ar);
+
+  template<size_t I, typename Archive>
+  typename std::enable_if<I == sizeof...(Layers), void>::type
+  SerializeLayers(Archive& /* ar */) { }
+
+  //! Return the number of parameters of a layer that has parameters.
+  template<typename T>
+  typename std::enable_if<
+      HasParametersCheck<T, MatType&(T::*)()>::value, size_t>::type
+  LayerWeightSize(T& layer) { return layer.Parameters().n_elem; }
+
+  template<typename T>
+  typename std::enable_if<
+      !HasParametersCheck<T, MatType&(T::*)()>::value, size_t>::type
+  LayerWeightSize(T& /* layer */) { return 0; }
+
+  //! Let a layer with parameters use the given parameters.
+  template<typename T>
+  typename std::enable_if<
+      HasParametersCheck<T, MatType&(T::*)()>::value, size_t>::type
+  LayerWeights(T& layer, MatType& weights, const size_t offset);
+
+  template<typename T>
+  typename std::enable_if<
+      !HasParametersCheck<T, MatType&(T::*)()>::value, size_t>::type
+  LayerWeights(T& /* layer */, MatType& /* w */, const size_t /* o */)
+  { return 0; }
+
+  //! Let a layer with a gradient use the given gradient.
+  template<typename T>
+  typename std::enable_if<
+      HasGradientCheck<T, MatType&(T::*)()>::value, size_t>::type
+  LayerGradients(T& layer, MatType& gradient, const size_t offset);
+
+  template<typename T>
+  typename std::enable_if<
+      !HasGradientCheck<T, MatType&(T::*)()>::value, size_t>::type
+  LayerGradients(T& /* layer */, MatType& /* g */, const size_t /* o */)
+  { return 0; }
+
+  //! Compute the gradient of a layer that has a gradient.
+  template<typename T>
+  typename std::enable_if<
+      HasGradientCheck<T, MatType&(T::*)()>::value, void>::type
+  LayerGradient(T& layer, MatType& input, MatType& error)
+  {
+    layer.Gradient(std::move(input), std::move(error),
+        std::move(layer.Gradient()));
+  }
+
+  template<typename T>
+  typename std::enable_if<
+      !HasGradientCheck<T, MatType&(T::*)()>::value, void>::type
+  LayerGradient(T& /* layer */, MatType& /* input */, MatType& /* error */) { }
+
+  //! Reset a layer that implements Reset().
+  template<typename T>
+  typename std::enable_if<HasResetCheck<T, void(T::*)()>::value, void>::type
+  LayerReset(T& layer) { layer.Reset(); }
+
+  template<typename T>
+  typename std::enable_if<!HasResetCheck<T, void(T::*)()>::value, void>::type
+  LayerReset(T& /* layer */) { }
+
+  //! Set the deterministic parameter of a layer that has one.
+  template<typename T>
+  typename std::enable_if<
+      HasDeterministicCheck<T, bool&(T::*)(void)>::value, void>::type
+  LayerDeterministic(T& layer) { layer.Deterministic() = deterministic; }
+
+  template<typename T>
+  typename std::enable_if<
+      !HasDeterministicCheck<T, bool&(T::*)(void)>::value, void>::type
+  LayerDeterministic(T& /* layer */) { }
+
+  //! Pass the current width to a layer that takes the width of its input.
+  template<typename T>
+  typename std::enable_if<
+      HasInputWidth<T, size_t&(T::*)()>::value, void>::type
+  LayerInputWidth(T& layer);
+
+  template<typename T>
+  typename std::enable_if<
+      !HasInputWidth<T, size_t&(T::*)()>::value, void>::type
+  LayerInputWidth(T& /* layer */) { }
+
+  //! Pass the current height to a layer that takes the height of its input.
+  template<typename T>
+  typename std::enable_if<
+      HasInputHeight<T, size_t&(T::*)()>::value, void>::type
+  LayerInputHeight(T& layer);
+
+  template<typename T>
+  typename std::enable_if<
+      !HasInputHeight<T, size_t&(T::*)()>::value, void>::type
+  LayerInputHeight(T& /* layer */) { }
+
+  //! Get the output width of a layer that takes the width of its input.
+  template<typename T>
+  typename std::enable_if<
+      HasInputWidth<T, size_t&(T::*)()>::value, void>::type
+  LayerOutputWidth(T& layer);
+
+  template<typename T>
+  typename std::enable_if<
+      !HasInputWidth<T, size_t&(T::*)()>::value, void>::type
+  LayerOutputWidth(T& /* layer */) { }
+
+  //! Get the output height of a layer that takes the height of its input.
+  template<typename T>
+  typename std::enable_if<
+      HasInputHeight<T, size_t&(T::*)()>::value, void>::type
+  LayerOutputHeight(T& layer);
+
+  template<typename T>
+  typename std::enable_if<
+      !HasInputHeight<T, size_t&(T::*)()>::value, void>::type
+  LayerOutputHeight(T& /* layer */) { }
+
+  //! Instantiated outputlayer used to evaluate the network.
+  OutputLayerType outputLayer;
+
+  //! Instantiated InitializationRule object for initializing the network
+  //! parameter.
+  InitializationRuleType initializeRule;
+
+  //! The layers of the network.
+  std::tuple<Layers...> network;
+
+  //! The input width.
+  size_t width;
+
+  //! The input height.
+  size_t height;
+
+  //! Indicator if the input sizes of the layers are already set.
+  bool reset;
+
+  //! The current evaluation mode (training or testing).
+  bool deterministic;
+
+  //! The matrix of data points (predictors).
+  MatType predictors;
+
+  //! The matrix of responses to the input data points.
+  MatType responses;
+
+  //! The number of separable functions (the number of predictor points).
+  size_t numFunctions;
+
+  //! Matrix of (trained) parameters, always in double precision.
+  arma::mat parameter;
+
+  //! The parameters in the precision of the layers, if it is not double.
+  MatType layerParameter;
+
+  //! The gradient in the precision of the layers, if it is not double.
+  MatType layerGradient;
+
+  //! The memory of the parameters the layers currently use.
+  const typename MatType::elem_type* layerParameterMemory;
+
+  //! The number of parameters the layers currently use.
+  size_t layerParameterSize;
+
+  //! The number of parameters of all layers.
+  size_t weightSize;
+
+  //! The current error for the backward pass.
+  MatType error;
+}; // class StaticFFN
+
+} // namespace ann
+} // namespace mlpack
+
+// Include implementation.
+#include "static_ffn_impl.hpp"
+
+#endif
@@ -0,0 +1,619 @@
+/**
+ * @file static_ffn_impl.hpp
+ *
+ * Definition of the StaticFFN class, which implements feed forward neural
+ * networks whose layers are given at compile time.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_STATIC_FFN_IMPL_HPP
+#define MLPACK_METHODS_ANN_STATIC_FFN_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "static_ffn.hpp"
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+template<typename OutputLayerType,
+         typename InitializationRuleType,
+         typename... Layers>
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::StaticFFN(
+    Layers... layers) :
+    network(std::move(layers)...),
+    width(0),
+    height(0),
+    reset(false),
+    deterministic(true),
+    numFunctions(0),
+    layerParameterMemory(NULL),
+    layerParameterSize(0),
+    weightSize(WeightSize())
+{
+  /* Nothing to do here */
+}
+
+template<typename OutputLayerType,
+         typename InitializationRuleType,
+         typename... Layers>
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::StaticFFN(
+    OutputLayerType outputLayer,
+    InitializationRuleType initializeRule,
+    Layers... layers) :
+    outputLayer(std::move(outputLayer)),
+    initializeRule(std::move(initializeRule)),
+    network(std::move(layers)...),
+    width(0),
+    height(0),
+    reset(false),
+    deterministic(true),
+    numFunctions(0),
+    layerParameterMemory(NULL),
+    layerParameterSize(0),
+    weightSize(WeightSize())
+{
+  /* Nothing to do here */
+}
+
+template<typename OutputLayerType,
+         typename InitializationRuleType,
+         typename... Layers>
+template<typename OptimizerType>
+void StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::Train(
+    MatType predictors,
+    MatType responses,
+    OptimizerType& optimizer)
+{
+  numFunctions = responses.n_cols;
+
+  this->predictors = std::move(predictors);
+  this->responses = std::move(responses);
+
+  if (parameter.is_empty())
+    ResetParameters();
+
+  // Train the model.
+  Timer::Start("static_ffn_optimization");
+  const double out = optimizer.Optimize(*this, parameter);
+  Timer::Stop("static_ffn_optimization");
+
+  Log::Info << "StaticFFN::StaticFFN(): final objective of trained model is "
+      << out << "." << std::endl;
+}
+
+template<typename OutputLayerType,
+         typename InitializationRuleType,
+         typename... Layers>
+template<typename OptimizerType>
+void StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::Train(
+    MatType predictors, MatType responses)
+{
+  OptimizerType optimizer;
+  Train(std::move(predictors), std::move(responses), optimizer);
+}
+
+template<typename OutputLayerType,
+         typename InitializationRuleType,
+         typename... Layers>
+void StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::Predict(
+    const MatType& predictors, MatType& results)
+{
+  if (parameter.is_empty())
+    ResetParameters();
+
+  if (!deterministic)
+  {
+    deterministic = true;
+    SetDeterministic<0>();
+  }
+
+  // The first layer only reads its input, so the predictors are not copied.
+  MatType input(const_cast<MatType&>(predictors).memptr(), predictors.n_rows,
+      predictors.n_cols, false, true);
+  results = Forward(input);
+}
+
+template<typename OutputLayerType,
+         typename InitializationRuleType,
+         typename... Layers>
+double StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::Evaluate(
+    const arma::mat& parameters)
+{
+  double res = 0;
+  for (size_t i = 0; i < predictors.n_cols; ++i)
+    res += Evaluate(parameters, i, 1, true);
+
+  return res;
+}
+
+template<typename OutputLayerType,
+         typename InitializationRuleType,
+         typename... Layers>
+double StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::Evaluate(
+    const arma::mat& /* parameters */,
+    const size_t begin,
+    const size_t batchSize,
+    const bool deterministic)
+{
+  if (parameter.is_empty())
+    ResetParameters();
+
+  if (deterministic != this->deterministic)
+  {
+    this->deterministic = deterministic;
+    SetDeterministic<0>();
+  }
+
+  MatType input(predictors.colptr(begin), predictors.n_rows, batchSize,
+      false, true);
+  MatType& output = Forward(input);
+
+  return outputLayer.Forward(std::move(output), MatType(
+      responses.colptr(begin), responses.n_rows, batchSize, false, true));
+}
+
+template<typename OutputLayerType,
+         typename InitializationRuleType,
+         typename... Layers>
+void StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::Gradient(
+    const arma::mat& parameters,
+    const size_t begin,
+    arma::mat& gradient,
+    const size_t batchSize)
+{
+  Evaluate(parameters, begin, batchSize, false);
+
+  MatType input(predictors.colptr(begin), predictors.n_rows, batchSize,
+      false, true);
+  MatType target(responses.colptr(begin), responses.n_rows, batchSize,
+      false, true);
+  Backward(input, target, gradient);
+}
+
+template<typename OutputLayerType,
+         typename InitializationRuleType,
+         typename... Layers>
+void StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::Shuffle()
+{
+  math::ShuffleData(predictors, responses, predictors, responses);
+}
+
+template<typename OutputLayerType,
+         typename InitializationRuleType,
+         typename... Layers>
+void StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::
+ResetParameters()
+{
+  std::vector<size_t> sizes;
+  WeightSizes<0>(sizes);
+  parameter.set_size(std::accumulate(sizes.begin(), sizes.end(), size_t(0)),
+      1);
+
+  // Initialize the network layer by layer or the complete network.
+  if (ann::InitTraits<InitializationRuleType>::UseLayer)
+  {
+    for (size_t i = 0, offset = 0; i < sizes.size(); ++i)
+    {
+      arma::mat tmp = arma::mat(parameter.memptr() + offset, sizes[i], 1,
+          false, false);
+      initializeRule.Initialize(tmp, tmp.n_elem, 1);
+      offset += sizes[i];
+    }
+  }
+  else
+  {
+    initializeRule.Initialize(parameter, parameter.n_elem, 1);
+  }
+
+  // Make sure the layers are bound to the new parameters.
+  layerParameterMemory = NULL;
+  layerParameterSize = 0;
+  SetDeterministic<0>();
+}
+
+template<typename OutputLayerType,
+         typename InitializationRuleType,
+         typename... Layers>
+template<typename Archive>
+void StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::serialize(
+    Archive& ar, const unsigned int /* version */)
+{
+  ar & BOOST_SERIALIZATION_NVP(parameter);
+  ar & BOOST_SERIALIZATION_NVP(width);
+  ar & BOOST_SERIALIZATION_NVP(height);
+
+  SerializeLayers<0>(ar);
+
+  // If we are loading, the layers have to be bound to the parameters again.
+  if (Archive::is_loading::value)
+  {
+    reset = false;
+    layerParameterMemory = NULL;
+    layerParameterSize = 0;
+    weightSize = WeightSize();
+
+    deterministic = true;
+    SetDeterministic<0>();
+  }
+}
+
+template<typename OutputLayerType,
+         typename InitializationRuleType,
+         typename... Layers>
+typename StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::MatType&
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::
+LayerParameters()
+{
+  MatType& weights = ConvertParameters(SharedParameters());
+
+  // The size is checked on every pass; a matrix of the wrong size may reuse
+  // the memory the layers are bound to.
+  if (weights.n_elem != weightSize)
+  {
+    std::ostringstream oss;
+    oss << "StaticFFN::Parameters(): the layers have " << weightSize
+        << " parameters, but " << weights.n_elem << " are given";
+    throw std::invalid_argument(oss.str());
+  }
+
+  // The layers keep aliases of the parameters, so they only have to be bound
+  // again if the parameters were moved or resized.
+  if (weights.memptr() != layerParameterMemory ||
+      weights.n_elem != layerParameterSize)
+  {
+    SetWeights<0>(weights, 0);
+    layerParameterMemory = weights.memptr();
+    layerParameterSize = weights.n_elem;
+  }
+
+  return weights;
+}
+
+template<typename OutputLayerType,
+         typename InitializationRuleType,
+         typename... Layers>
+typename StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::MatType&
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::
+ConvertParameters(std::false_type)
+{
+  // set_size() keeps the memory if the size does not change, so the aliases
+  // held by the layers stay valid.
+  layerParameter.set_size(parameter.n_rows, parameter.n_cols);
+  std::copy(parameter.begin(), parameter.end(), layerParameter.begin());
+
+  return layerParameter;
+}
+
+template<typename OutputLayerType,
+         typename InitializationRuleType,
+         typename... Layers>
+typename StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::MatType&
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::GradientMemory(
+    arma::mat& gradient, std::true_type)
+{
+  gradient.zeros(parameter.n_rows, parameter.n_cols);
+  return gradient;
+}
+
+template<typename OutputLayerType,
+         typename InitializationRuleType,
+         typename... Layers>
+typename StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::MatType&
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::GradientMemory(
+    arma::mat& /* gradient */, std::false_type)
+{
+  layerGradient.zeros(parameter.n_rows, parameter.n_cols);
+  return layerGradient;
+}
+
+template<typename OutputLayerType,
+         typename InitializationRuleType,
+         typename... Layers>
+void StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::
+StoreGradient(arma::mat& gradient, std::false_type)
+{
+  gradient.set_size(layerGradient.n_rows, layerGradient.n_cols);
+  std::copy(layerGradient.begin(), layerGradient.end(), gradient.begin());
+}
+
+template<typename OutputLayerType,
+         typename InitializationRuleType,
+         typename... Layers>
+typename StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::MatType&
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::Forward(
+    MatType& input)
+{
+  LayerParameters();
+  MatType& output = ForwardLayers<0>(input);
+
+  if (!reset)
+    reset = true;
+
+  return output;
+}
+
+template<typename OutputLayerType,
+         typename InitializationRuleType,
+         typename... Layers>
+void StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::Backward(
+    MatType& input, MatType& target, arma::mat& gradient)
+{
+  outputLayer.Backward(std::move(std::get<sizeof...(Layers) - 1>(
+      network).OutputParameter()), std::move(target), std::move(error));
+
+  BackwardLayers<sizeof...(Layers) - 1>(error);
+
+  // The gradient is written by the layers, so they are bound to it for every
+  // batch; this is cheap compared to the pass itself.
+  MatType& layerGradients = GradientMemory(gradient, SharedParameters());
+  SetGradients<0>(layerGradients, 0);
+  GradientLayers<0>(input, error);
+
+  StoreGradient(gradient, SharedParameters());
+}
+
+template<typename OutputLayerType,
+         typename InitializationRuleType,
+         typename... Layers>
+template<size_t I>
+typename std::enable_if<(I < sizeof...(Layers)),
+    typename StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::
+    MatType&>::type
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::ForwardLayers(
+    MatType& input)
+{
+  LayerType<I>& layer = std::get<I>(network);
+
+  if (!reset && I > 0)
+  {
+    LayerInputWidth(layer);
+    LayerInputHeight(layer);
+  }
+
+  MatType& output = LayerForward(layer, input, InPlace<I>());
+
+  if (!reset)
+  {
+    LayerOutputWidth(layer);
+    LayerOutputHeight(layer);
+  }
+
+  return ForwardLayers<I + 1>(output);
+}
+
+template<typename OutputLayerType,
+         typename InitializationRuleType,
+         typename... Layers>
+template<typename T>
+typename StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::MatType&
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::LayerForward(
+    T& layer, MatType& input, std::false_type)
+{
+  layer.Forward(std::move(input), std::move(layer.OutputParameter()));
+  return layer.OutputParameter();
+}
+
+template<typename OutputLayerType,
+         typename InitializationRuleType,
+         typename... Layers>
+template<typename T>
+typename StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::MatType&
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::LayerForward(
+    T& layer, MatType& input, std::true_type)
+{
+  // The backward pass needs the outputs of all layers, so the output of the
+  // preceding layer can only be overwritten in deterministic mode.
+  if (!deterministic)
+    return LayerForward(layer, input, std::false_type());
+
+  layer.Forward(std::move(input), std::move(input));
+  return input;
+}
+
+template<typename OutputLayerType,
+         typename InitializationRuleType,
+         typename... Layers>
+template<size_t I>
+typename std::enable_if<(I > 0), void>::type
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::BackwardLayers(
+    MatType& error)
+{
+  LayerType<I>& layer = std::get<I>(network);
+  layer.Backward(std::move(layer.OutputParameter()), std::move(error),
+      std::move(layer.Delta()));
+
+  BackwardLayers<I - 1>(layer.Delta());
+}
+
+template<typename OutputLayerType,
+         typename InitializationRuleType,
+         typename... Layers>
+template<size_t I>
+typename std::enable_if<(I + 1 < sizeof...(Layers)), void>::type
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::GradientLayers(
+    MatType& input, MatType& error)
+{
+  LayerType<I>& layer = std::get<I>(network);
+  LayerGradient(layer, input, std::get<I + 1>(network).Delta());
+
+  GradientLayers<I + 1>(layer.OutputParameter(), error);
+}
+
+template<typename OutputLayerType,
+         typename InitializationRuleType,
+         typename... Layers>
+template<size_t I>
+typename std::enable_if<I + 1 == sizeof...(Layers), void>::type
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::GradientLayers(
+    MatType& input, MatType& error)
+{
+  LayerGradient(std::get<I>(network), input, error);
+}
+
+template<typename OutputLayerType,
+         typename InitializationRuleType,
+         typename... Layers>
+template<size_t I>
+typename std::enable_if<(I < sizeof...(Layers)), void>::type
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::SetWeights(
+    MatType& weights, const size_t offset)
+{
+  LayerType<I>& layer = std::get<I>(network);
+  const size_t weightSize = LayerWeights(layer, weights, offset);
+  LayerReset(layer);
+
+  SetWeights<I + 1>(weights, offset + weightSize);
+}
+
+template<typename OutputLayerType,
+         typename InitializationRuleType,
+         typename... Layers>
+template<size_t I>
+typename std::enable_if<(I < sizeof...(Layers)), void>::type
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::SetGradients(
+    MatType& gradient, const size_t offset)
+{
+  const size_t weightSize = LayerGradients(std::get<I>(network), gradient,
+      offset);
+
+  SetGradients<I + 1>(gradient, offset + weightSize);
+}
+
+template<typename OutputLayerType,
+         typename InitializationRuleType,
+         typename... Layers>
+template<size_t I>
+typename std::enable_if<(I < sizeof...(Layers)), void>::type
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::
+SetDeterministic()
+{
+  LayerDeterministic(std::get<I>(network));
+  SetDeterministic<I + 1>();
+}
+
+template<typename OutputLayerType,
+         typename InitializationRuleType,
+         typename... Layers>
+size_t StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::
+WeightSize()
+{
+  std::vector<size_t> sizes;
+  WeightSizes<0>(sizes);
+  return std::accumulate(sizes.begin(), sizes.end(), size_t(0));
+}
+
+template<typename OutputLayerType,
+         typename InitializationRuleType,
+         typename... Layers>
+template<size_t I>
+typename std::enable_if<(I < sizeof...(Layers)), void>::type
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::WeightSizes(
+    std::vector<size_t>& sizes)
+{
+  sizes.push_back(LayerWeightSize(std::get<I>(network)));
+  WeightSizes<I + 1>(sizes);
+}
+
+template<typename OutputLayerType,
+         typename InitializationRuleType,
+         typename... Layers>
+template<size_t I, typename Archive>
+typename std::enable_if<(I < sizeof...(Layers)), void>::type
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::SerializeLayers(
+    Archive& ar)
+{
+  ar & boost::serialization::make_nvp("layer", std::get<I>(network));
+  SerializeLayers<I + 1>(ar);
+}
+
+template<typename OutputLayerType,
+         typename InitializationRuleType,
+         typename... Layers>
+template<typename T>
+typename std::enable_if<HasParametersCheck<T,
+    typename StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::
+    MatType&(T::*)()>::value, size_t>::type
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::LayerWeights(
+    T& layer, MatType& weights, const size_t offset)
+{
+  layer.Parameters() = MatType(weights.memptr() + offset,
+      layer.Parameters().n_rows, layer.Parameters().n_cols, false, false);
+
+  return layer.Parameters().n_elem;
+}
+
+template<typename OutputLayerType,
+         typename InitializationRuleType,
+         typename... Layers>
+template<typename T>
+typename std::enable_if<HasGradientCheck<T,
+    typename StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::
+    MatType&(T::*)()>::value, size_t>::type
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::LayerGradients(
+    T& layer, MatType& gradient, const size_t offset)
+{
+  layer.Gradient() = MatType(gradient.memptr() + offset,
+      layer.Parameters().n_rows, layer.Parameters().n_cols, false, false);
+
+  return layer.Parameters().n_elem;
+}
+
+template<typename OutputLayerType,
+         typename InitializationRuleType,
+         typename... Layers>
+template<typename T>
+typename std::enable_if<
+    HasInputWidth<T, size_t&(T::*)()>::value, void>::type
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::
+LayerInputWidth(T& layer)
+{
+  if (layer.InputWidth() == 0)
+    layer.InputWidth() = width;
+}
+
+template<typename OutputLayerType,
+         typename InitializationRuleType,
+         typename... Layers>
+template<typename T>
+typename std::enable_if<
+    HasInputHeight<T, size_t&(T::*)()>::value, void>::type
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::
+LayerInputHeight(T& layer)
+{
+  if (layer.InputHeight() == 0)
+    layer.InputHeight() = height;
+}
+
+template<typename OutputLayerType,
+         typename InitializationRuleType,
+         typename... Layers>
+template<typename T>
+typename std::enable_if<
+    HasInputWidth<T, size_t&(T::*)()>::value, void>::type
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::
+LayerOutputWidth(T& layer)
+{
+  if (layer.OutputWidth() != 0)
+    width = layer.OutputWidth();
+}
+
+template<typename OutputLayerType,
+         typename InitializationRuleType,
+         typename... Layers>
+template<typename T>
+typename std::enable_if<
+    HasInputHeight<T, size_t&(T::*)()>::value, void>::type
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::
+LayerOutputHeight(T& layer)
+{
+  if (layer.OutputHeight() != 0)
+    height = layer.OutputHeight();
+}
+
+} // namespace ann
+} // namespace mlpack
+
+#endif
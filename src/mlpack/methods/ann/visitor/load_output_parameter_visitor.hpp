@@ -24,13 +24,15 @@ namespace ann {
 
 /**
  * LoadOutputParameterVisitor restores the output parameter using the given
- * parameter set.
+ * parameter set (see SaveOutputParameterVisitor).  The restored matrices are
+ * kept in the set, so that their memory can be reused.
  */
 class LoadOutputParameterVisitor : public boost::static_visitor<void>
 {
  public:
-  //! Restore the output parameter given a parameter set.
-  LoadOutputParameterVisitor(std::vector<arma::mat>&& parameter);
+  //! Restore the output parameter given a parameter set, which holds 'size'
+  //! saved parameters.
+  LoadOutputParameterVisitor(std::vector<arma::mat>&& parameter, size_t& size);
 
   //! Restore the output parameter.
   template<typename LayerType>
@@ -40,6 +42,9 @@ class LoadOutputParameterVisitor : public boost::static_visitor<void>
   //! The parameter set.
   std::vector<arma::mat>&& parameter;
 
+  //! The number of saved parameters in the parameter set.
+  size_t& size;
+
   //! Restore the output parameter for a module which doesn't implement the
   //! Model() function.
   template<typename T>
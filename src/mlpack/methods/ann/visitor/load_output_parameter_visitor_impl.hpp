@@ -20,7 +20,9 @@ namespace ann {
 
 //! LoadOutputParameterVisitor visitor class.
 inline LoadOutputParameterVisitor::LoadOutputParameterVisitor(
-    std::vector<arma::mat>&& parameter) : parameter(std::move(parameter))
+    std::vector<arma::mat>&& parameter, size_t& size) :
+    parameter(std::move(parameter)),
+    size(size)
 {
   /* Nothing to do here. */
 }
@@ -36,8 +38,7 @@ inline typename std::enable_if<
     !HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, void>::type
 LoadOutputParameterVisitor::OutputParameter(T* layer) const
 {
-  layer->OutputParameter() = parameter.back();
-  parameter.pop_back();
+  layer->OutputParameter() = parameter[--size];
 }
 
 template<typename T>
@@ -47,12 +48,11 @@ LoadOutputParameterVisitor::OutputParameter(T* layer) const
 {
   for (size_t i = 0; i < layer->Model().size(); ++i)
   {
-    boost::apply_visitor(LoadOutputParameterVisitor(std::move(parameter)),
-        layer->Model()[layer->Model().size() - i - 1]);
+    boost::apply_visitor(LoadOutputParameterVisitor(std::move(parameter),
+        size), layer->Model()[layer->Model().size() - i - 1]);
   }
 
-  layer->OutputParameter() = parameter.back();
-  parameter.pop_back();
+  layer->OutputParameter() = parameter[--size];
 }
 
 } // namespace ann
@@ -23,13 +23,16 @@ namespace ann {
 
 /**
  * SaveOutputParameterVisitor saves the output parameter into the given
- * parameter set.
+ * parameter set.  The parameter set is used as a stack whose current size is
+ * given separately, so that the matrices of the set (and their memory) are
+ * reused by the following forward passes instead of being reallocated.
  */
 class SaveOutputParameterVisitor : public boost::static_visitor<void>
 {
  public:
-  //! Save the output parameter into the given parameter set.
-  SaveOutputParameterVisitor(std::vector<arma::mat>&& parameter);
+  //! Save the output parameter into the given parameter set, which holds
+  //! 'size' saved parameters.
+  SaveOutputParameterVisitor(std::vector<arma::mat>&& parameter, size_t& size);
 
   //! Save the output parameter.
   template<typename LayerType>
@@ -39,6 +42,12 @@ class SaveOutputParameterVisitor : public boost::static_visitor<void>
   //! The parameter set.
   std::vector<arma::mat>&& parameter;
 
+  //! The number of saved parameters in the parameter set.
+  size_t& size;
+
+  //! Save the given output parameter into the next slot of the parameter set.
+  void Save(const arma::mat& output) const;
+
   //! Save the output parameter for a module which doesn't implement the
   //! Model() function.
   template<typename T>
@@ -20,7 +20,9 @@ namespace ann {
 
 //! SaveOutputParameterVisitor visitor class.
 inline SaveOutputParameterVisitor::SaveOutputParameterVisitor(
-    std::vector<arma::mat>&& parameter) : parameter(std::move(parameter))
+    std::vector<arma::mat>&& parameter, size_t& size) :
+    parameter(std::move(parameter)),
+    size(size)
 {
   /* Nothing to do here. */
 }
@@ -31,12 +33,23 @@ inline void SaveOutputParameterVisitor::operator()(LayerType* layer) const
   OutputParameter(layer);
 }
 
+inline void SaveOutputParameterVisitor::Save(const arma::mat& output) const
+{
+  // Assigning a matrix of the same size reuses the memory of the slot.
+  if (size < parameter.size())
+    parameter[size] = output;
+  else
+    parameter.push_back(output);
+
+  ++size;
+}
+
 template<typename T>
 inline typename std::enable_if<
     !HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, void>::type
 SaveOutputParameterVisitor::OutputParameter(T* layer) const
 {
-  parameter.push_back(layer->OutputParameter());
+  Save(layer->OutputParameter());
 }
 
 template<typename T>
@@ -44,12 +57,12 @@ inline typename std::enable_if<
     HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, void>::type
 SaveOutputParameterVisitor::OutputParameter(T* layer) const
 {
-  parameter.push_back(layer->OutputParameter());
+  Save(layer->OutputParameter());
 
   for (size_t i = 0; i < layer->Model().size(); ++i)
   {
-    boost::apply_visitor(SaveOutputParameterVisitor(std::move(parameter)),
-        layer->Model()[i]);
+    boost::apply_visitor(SaveOutputParameterVisitor(std::move(parameter),
+        size), layer->Model()[i]);
   }
 }
 
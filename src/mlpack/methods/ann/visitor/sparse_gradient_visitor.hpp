@@ -0,0 +1,98 @@
+/**
+ * @file sparse_gradient_visitor.hpp
+ *
+ * This file provides an abstraction that collects the indices of the gradient
+ * entries that may be non-zero for different layers.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_VISITOR_SPARSE_GRADIENT_VISITOR_HPP
+#define MLPACK_METHODS_ANN_VISITOR_SPARSE_GRADIENT_VISITOR_HPP
+
+#include <mlpack/methods/ann/layer/layer_traits.hpp>
+#include <mlpack/methods/ann/layer/layer_types.hpp>
+
+#include <boost/variant.hpp>
+
+namespace mlpack {
+namespace ann {
+
+/**
+ * SparseGradientVisitor appends the (flat) indices of the gradient entries that
+ * were written by the last Gradient() call of a layer, given the offset of the
+ * layer in the gradient set.  Layers that implement GradientColumns() (such as
+ * Lookup) only report the columns they touched; all other layers with a
+ * gradient report all of their entries.
+ */
+class SparseGradientVisitor : public boost::static_visitor<size_t>
+{
+ public:
+  //! Collect the gradient indices into the given vector.
+  SparseGradientVisitor(std::vector<arma::uword>& indices, size_t offset = 0);
+
+  //! Collect the gradient indices and return the number of parameters.
+  template<typename LayerType>
+  size_t operator()(LayerType* layer) const;
+
+ private:
+  //! The collected gradient indices.
+  std::vector<arma::uword>& indices;
+
+  //! The gradient offset.
+  size_t offset;
+
+  //! Collect the touched columns if the module implements the Gradient() and
+  //! GradientColumns() function.
+  template<typename T>
+  typename std::enable_if<
+      HasGradientCheck<T, arma::mat&(T::*)()>::value &&
+      HasGradientColumnsCheck<T, const arma::uvec&(T::*)() const>::value &&
+      !HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, size_t>::type
+  LayerIndices(T* layer, arma::mat& input) const;
+
+  //! Collect all entries if the module implements the Gradient() function.
+  template<typename T>
+  typename std::enable_if<
+      HasGradientCheck<T, arma::mat&(T::*)()>::value &&
+      !HasGradientColumnsCheck<T, const arma::uvec&(T::*)() const>::value &&
+      !HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, size_t>::type
+  LayerIndices(T* layer, arma::mat& input) const;
+
+  //! Collect the indices of the modules if the module implements the Model()
+  //! function.
+  template<typename T>
+  typename std::enable_if<
+      !HasGradientCheck<T, arma::mat&(T::*)()>::value &&
+      HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, size_t>::type
+  LayerIndices(T* layer, arma::mat& input) const;
+
+  //! Collect all entries and the indices of the modules if the module
+  //! implements the Gradient() and Model() function.
+  template<typename T>
+  typename std::enable_if<
+      HasGradientCheck<T, arma::mat&(T::*)()>::value &&
+      HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, size_t>::type
+  LayerIndices(T* layer, arma::mat& input) const;
+
+  //! Do not collect anything if the module doesn't implement the Gradient() or
+  //! Model() function.
+  template<typename T, typename P>
+  typename std::enable_if<
+      !HasGradientCheck<T, P&(T::*)()>::value &&
+      !HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, size_t>::type
+  LayerIndices(T* layer, P& input) const;
+
+  //! Append the indices [offset, offset + n).
+  void AppendRange(const size_t offset, const size_t n) const;
+};
+
+} // namespace ann
+} // namespace mlpack
+
+// Include implementation.
+#include "sparse_gradient_visitor_impl.hpp"
+
+#endif
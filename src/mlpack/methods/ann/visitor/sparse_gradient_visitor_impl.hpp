@@ -0,0 +1,116 @@
+/**
+ * @file sparse_gradient_visitor_impl.hpp
+ *
+ * Implementation of the SparseGradientVisitor, which collects the indices of
+ * the gradient entries that may be non-zero.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_VISITOR_SPARSE_GRADIENT_VISITOR_IMPL_HPP
+#define MLPACK_METHODS_ANN_VISITOR_SPARSE_GRADIENT_VISITOR_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "sparse_gradient_visitor.hpp"
+
+namespace mlpack {
+namespace ann {
+
+//! SparseGradientVisitor visitor class.
+inline SparseGradientVisitor::SparseGradientVisitor(
+    std::vector<arma::uword>& indices,
+    size_t offset) :
+    indices(indices),
+    offset(offset)
+{
+  /* Nothing to do here. */
+}
+
+template<typename LayerType>
+inline size_t SparseGradientVisitor::operator()(LayerType* layer) const
+{
+  return LayerIndices(layer, layer->OutputParameter());
+}
+
+inline void SparseGradientVisitor::AppendRange(const size_t offset,
+                                               const size_t n) const
+{
+  for (size_t i = 0; i < n; ++i)
+    indices.push_back(offset + i);
+}
+
+template<typename T>
+inline typename std::enable_if<
+    HasGradientCheck<T, arma::mat&(T::*)()>::value &&
+    HasGradientColumnsCheck<T, const arma::uvec&(T::*)() const>::value &&
+    !HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, size_t>::type
+SparseGradientVisitor::LayerIndices(T* layer, arma::mat& /* input */) const
+{
+  const size_t nRows = layer->Parameters().n_rows;
+  const arma::uvec& columns = layer->GradientColumns();
+  for (size_t i = 0; i < columns.n_elem; ++i)
+    AppendRange(offset + columns[i] * nRows, nRows);
+
+  return layer->Parameters().n_elem;
+}
+
+template<typename T>
+inline typename std::enable_if<
+    HasGradientCheck<T, arma::mat&(T::*)()>::value &&
+    !HasGradientColumnsCheck<T, const arma::uvec&(T::*)() const>::value &&
+    !HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, size_t>::type
+SparseGradientVisitor::LayerIndices(T* layer, arma::mat& /* input */) const
+{
+  AppendRange(offset, layer->Parameters().n_elem);
+  return layer->Parameters().n_elem;
+}
+
+template<typename T>
+inline typename std::enable_if<
+    !HasGradientCheck<T, arma::mat&(T::*)()>::value &&
+    HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, size_t>::type
+SparseGradientVisitor::LayerIndices(T* layer, arma::mat& /* input */) const
+{
+  size_t modelOffset = 0;
+  for (size_t i = 0; i < layer->Model().size(); ++i)
+  {
+    modelOffset += boost::apply_visitor(SparseGradientVisitor(indices,
+        modelOffset + offset), layer->Model()[i]);
+  }
+
+  return modelOffset;
+}
+
+template<typename T>
+inline typename std::enable_if<
+    HasGradientCheck<T, arma::mat&(T::*)()>::value &&
+    HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, size_t>::type
+SparseGradientVisitor::LayerIndices(T* layer, arma::mat& /* input */) const
+{
+  AppendRange(offset, layer->Parameters().n_elem);
+
+  size_t modelOffset = layer->Parameters().n_elem;
+  for (size_t i = 0; i < layer->Model().size(); ++i)
+  {
+    modelOffset += boost::apply_visitor(SparseGradientVisitor(indices,
+        modelOffset + offset), layer->Model()[i]);
+  }
+
+  return modelOffset;
+}
+
+template<typename T, typename P>
+inline typename std::enable_if<
+    !HasGradientCheck<T, P&(T::*)()>::value &&
+    !HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, size_t>::type
+SparseGradientVisitor::LayerIndices(T* /* layer */, P& /* input */) const
+{
+  return 0;
+}
+
+} // namespace ann
+} // namespace mlpack
+
+#endif
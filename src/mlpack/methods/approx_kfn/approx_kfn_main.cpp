@@ -16,6 +16,10 @@
 #include "drusilla_select.hpp"
 #include "qdafn.hpp"
 
+#ifdef HAS_OPENMP
+  #include <omp.h>
+#endif
+
 using namespace mlpack;
 using namespace mlpack::neighbor;
 using namespace mlpack::util;
@@ -97,6 +101,8 @@ PARAM_INT_IN("num_tables", "Number of hash tables to use.", "t", 5);
 PARAM_INT_IN("num_projections", "Number of projections to use in each hash "
     "table.", "p", 5);
 PARAM_STRING_IN("algorithm", "Algorithm to use: 'ds' or 'qdafn'.", "a", "ds");
+PARAM_INT_IN("threads", "Number of threads to use for training and search.  "
+    "If 0, the OpenMP default is used.", "T", 0);
 
 PARAM_UMATRIX_OUT("neighbors", "Matrix to save neighbor indices to.", "n");
 PARAM_MATRIX_OUT("distances", "Matrix to save furthest neighbor distances to.",
@@ -176,6 +182,19 @@ static void mlpackMain()
   RequireParamValue<int>("num_projections", [](int x) { return x > 0; }, true,
       "number of projections must be positive");
 
+  RequireParamValue<int>("threads", [](int x) { return x >= 0; }, true,
+      "number of threads must be nonnegative");
+  if (CLI::GetParam<int>("threads") > 0)
+  {
+    #ifdef HAS_OPENMP
+      omp_set_num_threads(CLI::GetParam<int>("threads"));
+    #else
+      if (CLI::GetParam<int>("threads") > 1)
+        Log::Warn << PRINT_PARAM_STRING("threads") << " ignored because mlpack "
+            << "was compiled without OpenMP support." << endl;
+    #endif
+  }
+
   ReportIgnoredParam({{ "input_model", true }}, "algorithm");
   ReportIgnoredParam({{ "input_model", true }}, "num_tables");
   ReportIgnoredParam({{ "input_model", true }}, "num_projections");
@@ -15,10 +15,7 @@
 // In case it hasn't been included yet.
 #include "drusilla_select.hpp"
 
-#include <queue>
-#include <mlpack/methods/neighbor_search/neighbor_search_rules.hpp>
-#include <mlpack/methods/neighbor_search/sort_policies/furthest_neighbor_sort.hpp>
-#include <mlpack/core/tree/binary_space_tree.hpp>
+#include <mlpack/core/metrics/lmetric.hpp>
 #include <algorithm>
 
 namespace mlpack {
@@ -82,14 +79,16 @@ void DrusillaSelect<MatType>::Train(
   candidateIndices.set_size(l * m);
 
   arma::vec dataMean(arma::mean(referenceSet, 1));
-  arma::vec norms(referenceSet.n_cols);
 
-  MatType refCopy(referenceSet.n_rows, referenceSet.n_cols);
-  for (size_t i = 0; i < refCopy.n_cols; ++i)
-  {
-    refCopy.col(i) = referenceSet.col(i) - dataMean;
-    norms[i] = arma::norm(refCopy.col(i));
-  }
+  // The centered data is dense even if the reference set is sparse.
+  arma::mat refCopy(referenceSet);
+  refCopy.each_col() -= dataMean;
+  const arma::vec sqNorms = arma::trans(arma::sum(arma::square(refCopy), 0));
+  arma::vec norms = arma::sqrt(sqNorms);
+
+  std::vector<size_t> indices(referenceSet.n_cols);
+  std::vector<char> closeAngle(referenceSet.n_cols);
+  arma::vec sums(referenceSet.n_cols);
 
   // Find the top m points for each of the l projections...
   for (size_t i = 0; i < l; ++i)
@@ -100,15 +99,20 @@ void DrusillaSelect<MatType>::Train(
 
     arma::vec line(refCopy.col(maxIndex) / arma::norm(refCopy.col(maxIndex)));
 
+    // Project every point onto the line at once.  Since the line has unit
+    // length, the squared distortion of a point is its squared norm minus its
+    // squared offset.
+    const arma::vec offsets = refCopy.t() * line;
+
     // Calculate distortion and offset and make scores.
-    std::vector<bool> closeAngle(referenceSet.n_cols, false);
-    arma::vec sums(referenceSet.n_cols);
-    for (size_t j = 0; j < referenceSet.n_cols; ++j)
+    #pragma omp parallel for
+    for (omp_size_t j = 0; j < (omp_size_t) referenceSet.n_cols; ++j)
     {
       if (norms[j] > 0.0)
       {
-        const double offset = arma::dot(refCopy.col(j), line);
-        const double distortion = arma::norm(refCopy.col(j) - offset * line);
+        const double offset = offsets[j];
+        const double distortion = std::sqrt(std::max(sqNorms[j] -
+            offset * offset, 0.0));
         sums[j] = std::abs(offset) - std::abs(distortion);
         closeAngle[j] =
             (std::atan(distortion / std::abs(offset)) < (M_PI / 8.0));
@@ -116,39 +120,26 @@ void DrusillaSelect<MatType>::Train(
       else
       {
         sums[j] = norms[j];
+        closeAngle[j] = false;
       }
     }
 
-    // Find the top m elements using a priority queue.
-    typedef std::pair<double, size_t> Candidate;
-    struct CandidateCmp
+    // Find the top m elements.  Ties are broken by index, so the selection
+    // does not depend on the order of the points.
+    for (size_t j = 0; j < indices.size(); ++j)
+      indices[j] = j;
+    auto better = [&sums](const size_t a, const size_t b)
     {
-      bool operator()(const Candidate& c1, const Candidate& c2)
-      {
-        return c2.first < c1.first;
-      }
+      return (sums[a] > sums[b]) || (sums[a] == sums[b] && a < b);
     };
-
-    std::vector<Candidate> clist(
-        m, std::make_pair(double(-DBL_MAX), size_t(-1)));
-    std::priority_queue<Candidate, std::vector<Candidate>, CandidateCmp>
-        pq(CandidateCmp(), std::move(clist));
-
-    for (size_t j = 0; j < sums.n_elem; ++j)
-    {
-      Candidate c = std::make_pair(sums[j], j);
-      if (CandidateCmp()(c, pq.top()))
-      {
-        pq.pop();
-        pq.push(c);
-      }
-    }
+    std::nth_element(indices.begin(), indices.begin() + (m - 1),
+        indices.end(), better);
+    std::sort(indices.begin(), indices.begin() + m, better);
 
     // Take the top m elements for this table.
     for (size_t j = 0; j < m; ++j)
     {
-      const size_t index = pq.top().second;
-      pq.pop();
+      const size_t index = indices[j];
       candidateSet.col(i * m + j) = referenceSet.col(index);
       candidateIndices[i * m + j] = index;
 
@@ -179,23 +170,55 @@ void DrusillaSelect<MatType>::Search(const MatType& querySet,
     throw std::invalid_argument("DrusillaSelect::Search(): requested k is "
         "greater than number of points in candidate set!  Increase l or m.");
 
-  // We'll use the NeighborSearchRules class to perform our brute-force search.
-  // Note that we aren't using trees for our search, so we can use 'int' as a
-  // TreeType.
-  metric::EuclideanDistance metric;
-  NeighborSearchRules<FurthestNeighborSort, metric::EuclideanDistance,
-      tree::KDTree<metric::EuclideanDistance, tree::EmptyStatistic, MatType>>
-      rules(candidateSet, querySet, k, metric, 0, false);
+  // The candidate set is small, so it is searched by brute force.  The squared
+  // distances between a block of query points and every candidate are
+  // computed with one matrix multiplication, and each block is handled by a
+  // different thread.
+  const arma::mat candidates(candidateSet);
+  const arma::vec candidateNorms =
+      arma::trans(arma::sum(arma::square(candidates), 0));
+
+  neighbors.set_size(k, querySet.n_cols);
+  distances.set_size(k, querySet.n_cols);
 
-  for (size_t q = 0; q < querySet.n_cols; ++q)
-    for (size_t r = 0; r < candidateSet.n_cols; ++r)
-      rules.BaseCase(q, r);
+  const size_t blockSize = 256;
+  const size_t numBlocks = (querySet.n_cols + blockSize - 1) / blockSize;
+
+  #pragma omp parallel for schedule(dynamic)
+  for (omp_size_t b = 0; b < (omp_size_t) numBlocks; ++b)
+  {
+    const size_t begin = (size_t) b * blockSize;
+    const size_t end = std::min(begin + blockSize, (size_t) querySet.n_cols);
 
-  rules.GetResults(neighbors, distances);
+    const arma::mat queries(querySet.cols(begin, end - 1));
+    arma::mat sqDistances = -2.0 * candidates.t() * queries;
+    sqDistances.each_col() += candidateNorms;
+    sqDistances.each_row() += arma::sum(arma::square(queries), 0);
 
-  // Map the neighbors back to their original indices in the reference set.
-  for (size_t i = 0; i < neighbors.n_elem; ++i)
-    neighbors[i] = candidateIndices[neighbors[i]];
+    std::vector<size_t> order(candidates.n_cols);
+    for (size_t q = 0; q < queries.n_cols; ++q)
+    {
+      // Find the k furthest candidates.  Ties are broken by index.
+      const double* d = sqDistances.colptr(q);
+      for (size_t r = 0; r < order.size(); ++r)
+        order[r] = r;
+      std::partial_sort(order.begin(), order.begin() + k, order.end(),
+          [d](const size_t a, const size_t b)
+          {
+            return (d[a] > d[b]) || (d[a] == d[b] && a < b);
+          });
+
+      // The distances are recomputed directly, since the expansion above
+      // loses precision.  Map the neighbors back to their original indices
+      // in the reference set.
+      for (size_t j = 0; j < k; ++j)
+      {
+        neighbors(j, begin + q) = candidateIndices[order[j]];
+        distances(j, begin + q) = metric::EuclideanDistance::Evaluate(
+            queries.col(q), candidates.col(order[j]));
+      }
+    }
+  }
 }
 
 //! Serialize the model.
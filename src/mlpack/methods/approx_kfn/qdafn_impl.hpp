@@ -16,7 +16,9 @@
 #include "qdafn.hpp"
 
 #include <queue>
-#include <mlpack/methods/neighbor_search/sort_policies/furthest_neighbor_sort.hpp>
+#include <algorithm>
+#include <functional>
+#include <mlpack/core/metrics/lmetric.hpp>
 
 namespace mlpack {
 namespace neighbor {
@@ -58,6 +60,10 @@ void QDAFN<MatType>::Train(const MatType& referenceSet,
   if (mIn != 0)
     m = mIn;
 
+  if (m > referenceSet.n_cols)
+    throw std::invalid_argument("QDAFN::Train(): m must not be greater than "
+        "the number of points in the reference set!");
+
   // Build tables.  This is done by drawing random points from a Gaussian
   // distribution as the vectors we project onto.  The Gaussian should have zero
   // mean and unit variance.
@@ -70,20 +76,33 @@ void QDAFN<MatType>::Train(const MatType& referenceSet,
   // top m elements.
   projections = referenceSet.t() * lines;
 
-  // Loop over each projection and find the top m elements.
+  // Loop over each projection and find the top m elements.  The projections
+  // are independent, so they are handled in parallel.
   sIndices.set_size(m, l);
   sValues.set_size(m, l);
   candidateSet.resize(l);
-  for (size_t i = 0; i < l; ++i)
+
+  #pragma omp parallel for
+  for (omp_size_t i = 0; i < (omp_size_t) l; ++i)
   {
     candidateSet[i].set_size(referenceSet.n_rows, m);
-    arma::uvec sortedIndices = arma::sort_index(projections.col(i), "descend");
+
+    // Only the top m elements need to be sorted.  Ties are broken by index.
+    const double* p = projections.colptr(i);
+    std::vector<size_t> sortedIndices(referenceSet.n_cols);
+    for (size_t j = 0; j < sortedIndices.size(); ++j)
+      sortedIndices[j] = j;
+    std::partial_sort(sortedIndices.begin(), sortedIndices.begin() + m,
+        sortedIndices.end(), [p](const size_t a, const size_t b)
+        {
+          return (p[a] > p[b]) || (p[a] == p[b] && a < b);
+        });
 
     // Grab the top m elements.
     for (size_t j = 0; j < m; ++j)
     {
       sIndices(j, i) = sortedIndices[j];
-      sValues(j, i) = projections(sortedIndices[j], i);
+      sValues(j, i) = p[sortedIndices[j]];
       candidateSet[i].col(j) = referenceSet.col(sortedIndices[j]);
     }
   }
@@ -104,8 +123,13 @@ void QDAFN<MatType>::Search(const MatType& querySet,
   neighbors.fill(size_t() - 1);
   distances.zeros(k, querySet.n_cols);
 
-  // Search for each point.
-  for (size_t q = 0; q < querySet.n_cols; ++q)
+  // Project every query point onto every line at once.
+  const arma::mat queryProjections = lines.t() * querySet;
+
+  // Search for each point.  Each query point has its own queues, so the query
+  // points are searched in parallel.
+  #pragma omp parallel for schedule(dynamic)
+  for (omp_size_t q = 0; q < (omp_size_t) querySet.n_cols; ++q)
   {
     // Initialize a priority queue.
     // The size_t represents the index of the table, and the double represents
@@ -113,8 +137,7 @@ void QDAFN<MatType>::Search(const MatType& querySet,
     std::priority_queue<std::pair<double, size_t>> queue;
     for (size_t i = 0; i < l; ++i)
     {
-      const double val = sValues(0, i) - arma::dot(querySet.col(q),
-          lines.col(i));
+      const double val = sValues(0, i) - queryProjections(i, q);
       queue.push(std::make_pair(val, i));
     }
 
@@ -122,14 +145,15 @@ void QDAFN<MatType>::Search(const MatType& querySet,
     // in each table (they start at 0).
     arma::Col<size_t> tableLocations = arma::zeros<arma::Col<size_t>>(l);
 
-    // Now that the queue is initialized, iterate over m elements.
-    std::vector<std::pair<double, size_t>> v(k, std::make_pair(-1.0,
-        size_t(-1)));
-    std::priority_queue<std::pair<double, size_t>>
-        resultsQueue(std::less<std::pair<double, size_t>>(), std::move(v));
+    // Now that the queue is initialized, iterate over m elements.  The results
+    // are kept in a min-heap, so the worst of the current k results is on top.
+    typedef std::pair<double, size_t> Result;
+    std::vector<Result> v(k, std::make_pair(-1.0, size_t(-1)));
+    std::priority_queue<Result, std::vector<Result>, std::greater<Result>>
+        resultsQueue(std::greater<Result>(), std::move(v));
     for (size_t i = 0; i < m; ++i)
     {
-      std::pair<size_t, double> p = queue.top();
+      const std::pair<double, size_t> p = queue.top();
       queue.pop();
 
       // Get index of reference point to look at.
@@ -152,21 +152,21 @@ void DBSCAN<RangeSearchType, PointSelectionPolicy>::PointwiseCluster(
     const MatType& data,
     emst::UnionFind& uf)
 {
-  std::vector<std::vector<size_t>> neighbors;
-  std::vector<std::vector<double>> distances;
-
   for (size_t i = 0; i < data.n_cols; ++i)
   {
     if (i % 10000 == 0 && i > 0)
       Log::Info << "DBSCAN clustering on point " << i << "..." << std::endl;
 
-    // Do the range search for only this point.
-    rangeSearch.Search(data.col(i), math::Range(0.0, epsilon), neighbors,
-        distances);
-
-    // Union to all neighbors.
-    for (size_t j = 0; j < neighbors[0].size(); ++j)
-      uf.Union(i, neighbors[0][j]);
+    // Do the range search for only this point, and union to all neighbors as
+    // they are found.
+    auto results = range::MakeCallbackResults(
+        [&uf, i](const size_t /* queryIndex */,
+                 const size_t referenceIndex,
+                 const double /* distance */)
+        {
+          uf.Union(i, referenceIndex);
+        });
+    rangeSearch.Search(data.col(i), math::Range(0.0, epsilon), results);
   }
 }
 
@@ -181,21 +181,20 @@ void DBSCAN<RangeSearchType, PointSelectionPolicy>::BatchCluster(
     const MatType& data,
     emst::UnionFind& uf)
 {
-  // For each point, find the points in epsilon-nighborhood and their distances.
-  std::vector<std::vector<size_t>> neighbors;
-  std::vector<std::vector<double>> distances;
+  // For each point, find the points in epsilon-neighborhood and union to
+  // them as they are found.  This avoids storing the neighborhoods, which may
+  // be quadratic in size for dense data.
+  auto results = range::MakeCallbackResults(
+      [&uf](const size_t queryIndex,
+            const size_t referenceIndex,
+            const double /* distance */)
+      {
+        uf.Union(queryIndex, referenceIndex);
+      });
   Log::Info << "Performing range search." << std::endl;
   rangeSearch.Train(data);
-  rangeSearch.Search(data, math::Range(0.0, epsilon), neighbors, distances);
+  rangeSearch.Search(data, math::Range(0.0, epsilon), results);
   Log::Info << "Range search complete." << std::endl;
-
-  // Now loop over all points.
-  for (size_t i = 0; i < data.n_cols; ++i)
-  {
-    // Union to all neighbors.
-    for (size_t j = 0; j < neighbors[i].size(); ++j)
-      uf.Union(i, neighbors[i][j]);
-  }
 }
 
 } // namespace dbscan
@@ -148,7 +148,11 @@ class DTree
 
   /**
    * Greedily expand the tree.  The points in the dataset will be reordered
-   * during tree growth.
+   * during tree growth.  When OpenMP is available (and this is not called from
+   * inside of a parallel region), the top of the tree is split one node at a
+   * time with the split search parallelized over the dimensions, and the
+   * subtrees below are then grown in parallel.  The resulting tree does not
+   * depend on the number of threads.
    *
    * @param data Dataset to build tree on.
    * @param oldFromNew Mappings from old points to new points.
@@ -181,6 +185,17 @@ class DTree
    */
   double ComputeValue(const VecType& query) const;
 
+  /**
+   * Compute the density estimates of a set of query points.  The tree is
+   * flattened into a contiguous array of nodes once, and the query points are
+   * then passed down that array in parallel.  This gives the same results as
+   * calling ComputeValue() on each point.
+   *
+   * @param queries Points to estimate the density of.
+   * @param values Vector to store the density estimates in.
+   */
+  void ComputeValues(const MatType& queries, arma::rowvec& values) const;
+
   /**
    * Index the buckets for possible usage later; this results in every leaf in
    * the tree having a specific tag (accessible with BucketTag()).  This
@@ -354,6 +369,35 @@ class DTree
 
   void  FillMinMax(const StatType& mins,
                    const StatType& maxs);
+
+  /**
+   * Grow the subtree rooted at this node recursively, returning the minimum
+   * value of g_k(t) in the subtree.
+   */
+  double GrowSubtree(MatType& data,
+                     arma::Col<size_t>& oldFromNew,
+                     const bool useVolReg,
+                     const size_t maxLeafSize,
+                     const size_t minLeafSize);
+
+  /**
+   * Split this node and create its children (without growing them), or make
+   * this node a leaf.  Returns true if the node was split.
+   */
+  bool SplitNode(MatType& data,
+                 arma::Col<size_t>& oldFromNew,
+                 const size_t maxLeafSize,
+                 const size_t minLeafSize);
+
+  /**
+   * Compute the subtree statistics of a node whose children have been grown,
+   * given the minimum values of g_k(t) of the subtrees of the children, and
+   * return the minimum value of g_k(t) in the subtree of this node.
+   */
+  double FinishGrow(const size_t totalPoints,
+                    const bool useVolReg,
+                    const double leftG,
+                    const double rightG);
 };
 
 } // namespace det
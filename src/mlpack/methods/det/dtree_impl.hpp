@@ -14,6 +14,12 @@
 #include "dtree.hpp"
 #include <stack>
 #include <vector>
+#include <deque>
+#include <map>
+
+#ifdef HAS_OPENMP
+  #include <omp.h>
+#endif
 
 using namespace mlpack;
 using namespace det;
@@ -450,17 +456,19 @@ bool DTree<MatType, TagType>::FindSplit(const MatType& data,
 
   const size_t points = end - start;
 
-  double minError = logNegError;
-  bool splitFound = false;
+  // The best split of each dimension is found in parallel.  The dimensions are
+  // then compared in order, so that the chosen split does not depend on the
+  // number of threads.
+  const size_t dims = maxVals.n_elem;
+  std::vector<char> dimSplitFound(dims, 0);
+  std::vector<double> dimErrors(dims);
+  std::vector<double> dimLeftErrors(dims);
+  std::vector<double> dimRightErrors(dims);
+  std::vector<ElemType> dimSplitValues(dims);
 
   // Loop through each dimension.
-#ifdef _WIN32
-  #pragma omp parallel for default(shared)
-  for (intmax_t dim = 0; dim < (intmax_t) maxVals.n_elem; ++dim)
-#else
-  #pragma omp parallel for default(shared)
-  for (size_t dim = 0; dim < maxVals.n_elem; ++dim)
-#endif
+  #pragma omp parallel for schedule(dynamic)
+  for (omp_size_t dim = 0; dim < (omp_size_t) dims; ++dim)
   {
     const ElemType min = minVals[dim];
     const ElemType max = maxVals[dim];
@@ -469,11 +477,8 @@ bool DTree<MatType, TagType>::FindSplit(const MatType& data,
     if (max - min == 0.0)
       continue; // Skip to next dimension.
 
-    // Find the log volume of all the other dimensions.
-    const double volumeWithoutDim = logVolume - std::log(max - min);
-
     // Initializing all other stuff for this dimension.
-    bool dimSplitFound = false;
+    bool dimSplitFoundHere = false;
     // Take an error estimate for this dimension.
     double minDimError = std::pow(points, 2.0) / (max - min);
     double dimLeftError = 0.0; // For -Wuninitialized.  These variables will
@@ -523,27 +528,44 @@ bool DTree<MatType, TagType>::FindSplit(const MatType& data,
           dimLeftError = negLeftError;
           dimRightError = negRightError;
           dimSplitValue = split;
-          dimSplitFound = true;
+          dimSplitFoundHere = true;
         }
       }
     }
 
-    const double actualMinDimError = std::log(minDimError)
+    dimSplitFound[dim] = dimSplitFoundHere;
+    dimErrors[dim] = minDimError;
+    dimLeftErrors[dim] = dimLeftError;
+    dimRightErrors[dim] = dimRightError;
+    dimSplitValues[dim] = dimSplitValue;
+  }
+
+  double minError = logNegError;
+  bool splitFound = false;
+  for (size_t dim = 0; dim < dims; ++dim)
+  {
+    if (!dimSplitFound[dim])
+      continue;
+
+    // Find the log volume of all the other dimensions.
+    const double volumeWithoutDim = logVolume -
+        std::log(maxVals[dim] - minVals[dim]);
+
+    const double actualMinDimError = std::log(dimErrors[dim])
       - 2 * std::log((double) data.n_cols)
       - volumeWithoutDim;
 
-#pragma omp critical(DTreeFindUpdate)
-    if ((actualMinDimError > minError) && dimSplitFound)
+    if (actualMinDimError > minError)
     {
       // Calculate actual error (in logspace) by adding terms back to our
       // estimate.
       minError = actualMinDimError;
       splitDim = dim;
-      splitValue = dimSplitValue;
-      leftError = std::log(dimLeftError) - 2 * std::log((double) data.n_cols)
-        - volumeWithoutDim;
-      rightError = std::log(dimRightError) - 2 * std::log((double) data.n_cols)
-        - volumeWithoutDim;
+      splitValue = dimSplitValues[dim];
+      leftError = std::log(dimLeftErrors[dim]) - 2 * std::log((double)
+          data.n_cols) - volumeWithoutDim;
+      rightError = std::log(dimRightErrors[dim]) - 2 * std::log((double)
+          data.n_cols) - volumeWithoutDim;
       splitFound = true;
     } // end if better split found in this dimension.
   }
@@ -596,8 +618,91 @@ double DTree<MatType, TagType>::Grow(MatType& data,
   Log::Assert(data.n_rows == maxVals.n_elem);
   Log::Assert(data.n_rows == minVals.n_elem);
 
-  double leftG, rightG;
+  // If we are already inside of a parallel region (like the cross-validation
+  // in Trainer()), the tree is grown serially.
+  size_t numThreads = 1;
+  #ifdef HAS_OPENMP
+    if (!omp_in_parallel())
+      numThreads = omp_get_max_threads();
+  #endif
+
+  if (numThreads == 1)
+    return GrowSubtree(data, oldFromNew, useVolReg, maxLeafSize, minLeafSize);
+
+  // Split the top of the tree breadth-first, until there are enough unsplit
+  // nodes to keep every thread busy.  Each of these splits searches the
+  // dimensions in parallel.
+  std::map<const DTree*, double> g;
+  std::vector<DTree*> splitNodes;
+  std::deque<DTree*> frontier(1, this);
+  while (!frontier.empty() && frontier.size() < 4 * numThreads)
+  {
+    DTree* node = frontier.front();
+    frontier.pop_front();
+
+    if (node->SplitNode(data, oldFromNew, maxLeafSize, minLeafSize))
+    {
+      splitNodes.push_back(node);
+      frontier.push_back(node->left);
+      frontier.push_back(node->right);
+    }
+    else
+    {
+      g[node] = std::numeric_limits<double>::max();
+    }
+  }
+
+  // The remaining nodes hold disjoint ranges of points, so their subtrees can
+  // be grown in parallel.
+  const std::vector<DTree*> subtrees(frontier.begin(), frontier.end());
+  std::vector<double> subtreeG(subtrees.size());
 
+  #pragma omp parallel for schedule(dynamic)
+  for (omp_size_t i = 0; i < (omp_size_t) subtrees.size(); ++i)
+  {
+    subtreeG[i] = subtrees[i]->GrowSubtree(data, oldFromNew, useVolReg,
+        maxLeafSize, minLeafSize);
+  }
+
+  for (size_t i = 0; i < subtrees.size(); ++i)
+    g[subtrees[i]] = subtreeG[i];
+
+  // Now finish the nodes that were split at the top, children first.
+  for (size_t i = splitNodes.size(); i > 0; --i)
+  {
+    DTree* node = splitNodes[i - 1];
+    g[node] = node->FinishGrow(data.n_cols, useVolReg, g[node->left],
+        g[node->right]);
+  }
+
+  return g[this];
+}
+
+template<typename MatType, typename TagType>
+double DTree<MatType, TagType>::GrowSubtree(MatType& data,
+                                            arma::Col<size_t>& oldFromNew,
+                                            const bool useVolReg,
+                                            const size_t maxLeafSize,
+                                            const size_t minLeafSize)
+{
+  if (!SplitNode(data, oldFromNew, maxLeafSize, minLeafSize))
+    return std::numeric_limits<double>::max();
+
+  // Recursively grow the children.
+  const double leftG = left->GrowSubtree(data, oldFromNew, useVolReg,
+      maxLeafSize, minLeafSize);
+  const double rightG = right->GrowSubtree(data, oldFromNew, useVolReg,
+      maxLeafSize, minLeafSize);
+
+  return FinishGrow(data.n_cols, useVolReg, leftG, rightG);
+}
+
+template<typename MatType, typename TagType>
+bool DTree<MatType, TagType>::SplitNode(MatType& data,
+                                        arma::Col<size_t>& oldFromNew,
+                                        const size_t maxLeafSize,
+                                        const size_t minLeafSize)
+{
   // Compute points ratio.
   ratio = (double) (end - start) / (double) oldFromNew.n_elem;
 
@@ -612,7 +717,7 @@ double DTree<MatType, TagType>::Grow(MatType& data,
   {
     // Find the split.
     size_t dim;
-    double splitValueTmp;
+    ElemType splitValueTmp;
     double leftError, rightError;
     if (FindSplit(data, dim, splitValueTmp, leftError, rightError, minLeafSize))
     {
@@ -633,105 +738,95 @@ double DTree<MatType, TagType>::Grow(MatType& data,
       splitValue = splitValueTmp;
       splitDim = dim;
 
-      // Recursively grow the children.
       left = new DTree(maxValsL, minValsL, start, splitIndex, leftError);
       right = new DTree(maxValsR, minValsR, splitIndex, end, rightError);
 
-      leftG = left->Grow(data, oldFromNew, useVolReg, maxLeafSize,
-                         minLeafSize);
-      rightG = right->Grow(data, oldFromNew, useVolReg, maxLeafSize,
-                           minLeafSize);
-
-      // Store values of R(T~) and |T~|.
-      subtreeLeaves = left->SubtreeLeaves() + right->SubtreeLeaves();
-
-      // Find the log negative error of the subtree leaves.  This is kind of an
-      // odd one because we don't want to represent the error in non-log-space,
-      // but we have to calculate log(E_l + E_r).  So we multiply E_l and E_r by
-      // V_t (remember E_l has an inverse relationship to the volume of the
-      // nodes) and then subtract log(V_t) at the end of the whole expression.
-      // As a result we do leave log-space, but the largest quantity we
-      // represent is on the order of (V_t / V_i) where V_i is the smallest leaf
-      // node below this node, which depends heavily on the depth of the tree.
-      subtreeLeavesLogNegError = std::log(
-          std::exp(logVolume + left->SubtreeLeavesLogNegError()) +
-          std::exp(logVolume + right->SubtreeLeavesLogNegError()))
-          - logVolume;
-    }
-    else
-    {
-      // No split found so make a leaf out of it.
-      subtreeLeaves = 1;
-      subtreeLeavesLogNegError = logNegError;
+      return true;
     }
   }
   else
   {
     // We can make this a leaf node.
     Log::Assert((size_t) (end - start) >= minLeafSize);
-    subtreeLeaves = 1;
-    subtreeLeavesLogNegError = logNegError;
   }
 
-  // If this is a leaf, do not compute g_k(t); otherwise compute, store, and
-  // propagate min(g_k(t_L), g_k(t_R), g_k(t)), unless t_L and/or t_R are
-  // leaves.
-  if (subtreeLeaves == 1)
-  {
-    return std::numeric_limits<double>::max();
-  }
-  else
-  {
-    const double range = maxVals[splitDim] - minVals[splitDim];
-    const double leftRatio = (splitValue - minVals[splitDim]) / range;
-    const double rightRatio = (maxVals[splitDim] - splitValue) / range;
+  // No split found (or the node is small enough), so make a leaf out of it.
+  subtreeLeaves = 1;
+  subtreeLeavesLogNegError = logNegError;
 
-    const size_t leftPow = std::pow((double) (left->End() - left->Start()), 2);
-    const size_t rightPow = std::pow((double) (right->End() - right->Start()),
-        2);
-    const size_t thisPow = std::pow((double) (end - start), 2);
+  return false;
+}
 
-    double tmpAlphaSum = leftPow / leftRatio + rightPow / rightRatio - thisPow;
+template<typename MatType, typename TagType>
+double DTree<MatType, TagType>::FinishGrow(const size_t totalPoints,
+                                           const bool useVolReg,
+                                           const double leftG,
+                                           const double rightG)
+{
+  // Store values of R(T~) and |T~|.
+  subtreeLeaves = left->SubtreeLeaves() + right->SubtreeLeaves();
+
+  // Find the log negative error of the subtree leaves.  This is kind of an odd
+  // one because we don't want to represent the error in non-log-space, but we
+  // have to calculate log(E_l + E_r).  So we multiply E_l and E_r by V_t
+  // (remember E_l has an inverse relationship to the volume of the nodes) and
+  // then subtract log(V_t) at the end of the whole expression.  As a result we
+  // do leave log-space, but the largest quantity we represent is on the order
+  // of (V_t / V_i) where V_i is the smallest leaf node below this node, which
+  // depends heavily on the depth of the tree.
+  subtreeLeavesLogNegError = std::log(
+      std::exp(logVolume + left->SubtreeLeavesLogNegError()) +
+      std::exp(logVolume + right->SubtreeLeavesLogNegError()))
+      - logVolume;
 
-    if (left->SubtreeLeaves() > 1)
-    {
-      const double exponent = 2 * std::log((double) data.n_cols) + logVolume +
-          left->AlphaUpper();
+  // Compute, store, and propagate min(g_k(t_L), g_k(t_R), g_k(t)).
+  const double range = maxVals[splitDim] - minVals[splitDim];
+  const double leftRatio = (splitValue - minVals[splitDim]) / range;
+  const double rightRatio = (maxVals[splitDim] - splitValue) / range;
 
-      // Whether or not this will overflow is highly dependent on the depth of
-      // the tree.
-      tmpAlphaSum += std::exp(exponent);
-    }
+  const size_t leftPow = std::pow((double) (left->End() - left->Start()), 2);
+  const size_t rightPow = std::pow((double) (right->End() - right->Start()), 2);
+  const size_t thisPow = std::pow((double) (end - start), 2);
 
-    if (right->SubtreeLeaves() > 1)
-    {
-      const double exponent = 2 * std::log((double) data.n_cols)
-        + logVolume
-        + right->AlphaUpper();
+  double tmpAlphaSum = leftPow / leftRatio + rightPow / rightRatio - thisPow;
 
-      tmpAlphaSum += std::exp(exponent);
-    }
+  if (left->SubtreeLeaves() > 1)
+  {
+    const double exponent = 2 * std::log((double) totalPoints) + logVolume +
+        left->AlphaUpper();
 
-    alphaUpper = std::log(tmpAlphaSum) - 2 * std::log((double) data.n_cols)
-      - logVolume;
+    // Whether or not this will overflow is highly dependent on the depth of
+    // the tree.
+    tmpAlphaSum += std::exp(exponent);
+  }
 
-    double gT;
-    if (useVolReg)
-    {
-      // This is wrong for now!
-      gT = alphaUpper; // / (subtreeLeavesVTInv - vTInv);
-    }
-    else
-    {
-      gT = alphaUpper - std::log((double) (subtreeLeaves - 1));
-    }
+  if (right->SubtreeLeaves() > 1)
+  {
+    const double exponent = 2 * std::log((double) totalPoints)
+      + logVolume
+      + right->AlphaUpper();
 
-    return std::min(gT, std::min(leftG, rightG));
+    tmpAlphaSum += std::exp(exponent);
+  }
+
+  alphaUpper = std::log(tmpAlphaSum) - 2 * std::log((double) totalPoints)
+    - logVolume;
+
+  double gT;
+  if (useVolReg)
+  {
+    // This is wrong for now!
+    gT = alphaUpper; // / (subtreeLeavesVTInv - vTInv);
+  }
+  else
+  {
+    gT = alphaUpper - std::log((double) (subtreeLeaves - 1));
   }
 
   // We need to compute (c_t^2) * r_t for all subtree leaves; this is equal to
   // n_t ^ 2 / r_t * n ^ 2 = -error.  Therefore the value we need is actually
   // -1.0 * subtreeLeavesError.
+  return std::min(gT, std::min(leftG, rightG));
 }
 
 
@@ -889,6 +984,86 @@ double DTree<MatType, TagType>::ComputeValue(const VecType& query) const
   return 0.0;
 }
 
+template<typename MatType, typename TagType>
+void DTree<MatType, TagType>::ComputeValues(const MatType& queries,
+                                            arma::rowvec& values) const
+{
+  Log::Assert(queries.n_rows == maxVals.n_elem);
+
+  // Flatten the tree breadth-first into one contiguous array, so that the two
+  // children of a node are next to each other and the top of the tree stays in
+  // cache.  Leaves are marked with a left child of 0 (the root is never a
+  // child) and store their density.
+  struct FlatNode
+  {
+    size_t splitDim;
+    ElemType splitValue;
+    size_t left;
+    double density;
+  };
+
+  std::vector<const DTree*> treeNodes(1, this);
+  std::vector<FlatNode> nodes;
+  for (size_t i = 0; i < treeNodes.size(); ++i)
+  {
+    const DTree& node = *treeNodes[i];
+
+    FlatNode flatNode;
+    flatNode.splitDim = node.splitDim;
+    flatNode.splitValue = node.splitValue;
+    if (node.subtreeLeaves == 1)
+    {
+      flatNode.left = 0;
+      flatNode.density = std::exp(std::log(node.ratio) - node.logVolume);
+    }
+    else
+    {
+      flatNode.left = treeNodes.size();
+      flatNode.density = 0.0;
+      treeNodes.push_back(node.left);
+      treeNodes.push_back(node.right);
+    }
+
+    nodes.push_back(flatNode);
+  }
+
+  values.set_size(queries.n_cols);
+
+  #pragma omp parallel for
+  for (omp_size_t i = 0; i < (omp_size_t) queries.n_cols; ++i)
+  {
+    // Points outside of the bounding box of the root have zero density.
+    bool withinRange = true;
+    if (root)
+    {
+      for (size_t d = 0; d < queries.n_rows; ++d)
+      {
+        const ElemType value = queries(d, i);
+        if ((value < minVals[d]) || (value > maxVals[d]))
+        {
+          withinRange = false;
+          break;
+        }
+      }
+    }
+
+    if (!withinRange)
+    {
+      values[i] = 0.0;
+      continue;
+    }
+
+    size_t n = 0;
+    while (nodes[n].left != 0)
+    {
+      const ElemType value = queries(nodes[n].splitDim, i);
+      n = (value <= nodes[n].splitValue) ? nodes[n].left : nodes[n].left + 1;
+    }
+
+    values[i] = nodes[n].density;
+  }
+}
+
 // Index the buckets for possible usage later.
 template<typename MatType, typename TagType>
 TagType DTree<MatType, TagType>::TagTree(const TagType& tag, bool every)
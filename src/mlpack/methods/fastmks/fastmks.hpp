@@ -17,7 +17,6 @@
 #include <mlpack/core/metrics/ip_metric.hpp>
 #include "fastmks_stat.hpp"
 #include <mlpack/core/tree/cover_tree.hpp>
-#include <queue>
 
 namespace mlpack {
 namespace fastmks /** Fast max-kernel search. */ {
@@ -178,6 +177,9 @@ class FastMKS
    * to use single-tree search, either by setting singleMode to false in the
    * constructor or with SingleMode().
    *
+   * If mlpack is compiled with OpenMP, naive and dual-tree search use all
+   * available threads; single-tree search is always single-threaded.
+   *
    * @param querySet Set of query points (can be a single point).
    * @param k The number of maximum kernels to find.
    * @param indices Matrix to store resulting indices of max-kernel search in.
@@ -282,9 +284,24 @@ class FastMKS
     };
   };
 
-  //! Use a priority queue to represent the list of candidate points.
-  typedef std::priority_queue<Candidate, std::vector<Candidate>,
-      CandidateCmp> CandidateList;
+  /**
+   * Perform brute-force search for the given query set.  The query points are
+   * split into blocks which are searched in parallel; the kernel values
+   * between a block of query points and a block of reference points are
+   * computed at once with BatchKernel().
+   *
+   * @param querySet Set of query points.
+   * @param k The number of maximum kernels to find.
+   * @param indices Matrix to store resulting indices of max-kernel search in.
+   * @param kernels Matrix to store resulting max-kernel values in.
+   * @param sameSet If true, the query set is the reference set, and a point
+   *      will not be returned as its own candidate.
+   */
+  void NaiveSearch(const MatType& querySet,
+                   const size_t k,
+                   arma::Mat<size_t>& indices,
+                   arma::mat& kernels,
+                   const bool sameSet);
 };
 
 } // namespace fastmks
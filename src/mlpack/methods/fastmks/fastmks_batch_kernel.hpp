@@ -0,0 +1,250 @@
+/**
+ * @file fastmks_batch_kernel.hpp
+ *
+ * Evaluate a kernel between every pair of points from two sets at once.  For
+ * kernels that are a function of the inner product (linear, polynomial,
+ * hyperbolic tangent, cosine) this is a single matrix multiplication followed
+ * by an elementwise transform; for kernels that are a function of the
+ * Euclidean distance (Gaussian, Epanechnikov, triangular) the squared
+ * distances are computed from the same matrix multiplication and the squared
+ * norms of the points.  Any other kernel is evaluated one pair at a time.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_FASTMKS_FASTMKS_BATCH_KERNEL_HPP
+#define MLPACK_METHODS_FASTMKS_FASTMKS_BATCH_KERNEL_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/kernels/linear_kernel.hpp>
+#include <mlpack/core/kernels/polynomial_kernel.hpp>
+#include <mlpack/core/kernels/cosine_distance.hpp>
+#include <mlpack/core/kernels/gaussian_kernel.hpp>
+#include <mlpack/core/kernels/epanechnikov_kernel.hpp>
+#include <mlpack/core/kernels/triangular_kernel.hpp>
+#include <mlpack/core/kernels/hyperbolic_tangent_kernel.hpp>
+
+namespace mlpack {
+namespace fastmks {
+
+/**
+ * Compute the squared norm of each column of the given matrix.
+ *
+ * @param data Matrix to compute the squared norms of.
+ * @param norms Vector to store the squared norms in.
+ */
+template<typename MatType>
+void SquaredNorms(const MatType& data, arma::vec& norms)
+{
+  norms.set_size(data.n_cols);
+  for (size_t i = 0; i < data.n_cols; ++i)
+    norms[i] = arma::dot(data.col(i), data.col(i));
+}
+
+/**
+ * Compute the inner products between every query point and every reference
+ * point; products(r, q) is the inner product of reference point r and query
+ * point q.
+ */
+template<typename ReferenceMatType, typename QueryMatType>
+void InnerProducts(const ReferenceMatType& referenceSet,
+                   const QueryMatType& querySet,
+                   arma::mat& products)
+{
+  products = arma::trans(referenceSet) * querySet;
+}
+
+/**
+ * Compute the squared Euclidean distances between every query point and every
+ * reference point; distances(r, q) is the squared distance between reference
+ * point r and query point q.
+ */
+template<typename ReferenceMatType, typename QueryMatType>
+void SquaredDistances(const ReferenceMatType& referenceSet,
+                      const QueryMatType& querySet,
+                      arma::mat& distances)
+{
+  arma::vec referenceNorms, queryNorms;
+  SquaredNorms(referenceSet, referenceNorms);
+  SquaredNorms(querySet, queryNorms);
+
+  // ||r - q||^2 = ||r||^2 + ||q||^2 - 2 r^T q.
+  InnerProducts(referenceSet, querySet, distances);
+  distances *= -2.0;
+  distances.each_col() += referenceNorms;
+  distances.each_row() += arma::trans(queryNorms);
+
+  // Cancellation may make some distances very slightly negative.
+  distances = arma::clamp(distances, 0.0, DBL_MAX);
+}
+
+/**
+ * Evaluate the kernel between every query point and every reference point, one
+ * pair at a time; kernels(r, q) will hold K(q, r).  This is used for kernels
+ * that do not have a batch overload below.
+ *
+ * @param kernel Kernel to evaluate.
+ * @param referenceSet Set of reference points.
+ * @param querySet Set of query points.
+ * @param kernels Matrix to store the kernel values in.
+ */
+template<typename KernelType,
+         typename ReferenceMatType,
+         typename QueryMatType>
+void BatchKernel(KernelType& kernel,
+                 const ReferenceMatType& referenceSet,
+                 const QueryMatType& querySet,
+                 arma::mat& kernels)
+{
+  kernels.set_size(referenceSet.n_cols, querySet.n_cols);
+  for (size_t q = 0; q < querySet.n_cols; ++q)
+    for (size_t r = 0; r < referenceSet.n_cols; ++r)
+      kernels(r, q) = kernel.Evaluate(querySet.col(q), referenceSet.col(r));
+}
+
+//! Evaluate the linear kernel with one matrix multiplication.
+template<typename ReferenceMatType, typename QueryMatType>
+void BatchKernel(kernel::LinearKernel& /* kernel */,
+                 const ReferenceMatType& referenceSet,
+                 const QueryMatType& querySet,
+                 arma::mat& kernels)
+{
+  InnerProducts(referenceSet, querySet, kernels);
+}
+
+//! Evaluate the polynomial kernel with one matrix multiplication.
+template<typename ReferenceMatType, typename QueryMatType>
+void BatchKernel(kernel::PolynomialKernel& kernel,
+                 const ReferenceMatType& referenceSet,
+                 const QueryMatType& querySet,
+                 arma::mat& kernels)
+{
+  InnerProducts(referenceSet, querySet, kernels);
+  kernels = arma::pow(kernels + kernel.Offset(), kernel.Degree());
+}
+
+//! Evaluate the hyperbolic tangent kernel with one matrix multiplication.
+template<typename ReferenceMatType, typename QueryMatType>
+void BatchKernel(kernel::HyperbolicTangentKernel& kernel,
+                 const ReferenceMatType& referenceSet,
+                 const QueryMatType& querySet,
+                 arma::mat& kernels)
+{
+  InnerProducts(referenceSet, querySet, kernels);
+  kernels = arma::tanh(kernel.Scale() * kernels + kernel.Offset());
+}
+
+//! Evaluate the cosine distance with one matrix multiplication.
+template<typename ReferenceMatType, typename QueryMatType>
+void BatchKernel(kernel::CosineDistance& /* kernel */,
+                 const ReferenceMatType& referenceSet,
+                 const QueryMatType& querySet,
+                 arma::mat& kernels)
+{
+  arma::vec referenceNorms, queryNorms;
+  SquaredNorms(referenceSet, referenceNorms);
+  SquaredNorms(querySet, queryNorms);
+  referenceNorms = arma::sqrt(referenceNorms);
+  queryNorms = arma::sqrt(queryNorms);
+
+  InnerProducts(referenceSet, querySet, kernels);
+  for (size_t q = 0; q < kernels.n_cols; ++q)
+  {
+    for (size_t r = 0; r < kernels.n_rows; ++r)
+    {
+      // As in CosineDistance::Evaluate(), the similarity of a zero vector to
+      // anything is 0.
+      const double denominator = referenceNorms[r] * queryNorms[q];
+      kernels(r, q) = (denominator == 0.0) ? 0.0 :
+          kernels(r, q) / denominator;
+    }
+  }
+}
+
+//! Evaluate the Gaussian kernel from the batch squared distances.
+template<typename ReferenceMatType, typename QueryMatType>
+void BatchKernel(kernel::GaussianKernel& kernel,
+                 const ReferenceMatType& referenceSet,
+                 const QueryMatType& querySet,
+                 arma::mat& kernels)
+{
+  SquaredDistances(referenceSet, querySet, kernels);
+  kernels = arma::exp(kernel.Gamma() * kernels);
+}
+
+//! Evaluate the Epanechnikov kernel from the batch squared distances.
+template<typename ReferenceMatType, typename QueryMatType>
+void BatchKernel(kernel::EpanechnikovKernel& kernel,
+                 const ReferenceMatType& referenceSet,
+                 const QueryMatType& querySet,
+                 arma::mat& kernels)
+{
+  SquaredDistances(referenceSet, querySet, kernels);
+  kernels.transform([&kernel](const double d)
+      { return kernel.Evaluate(std::sqrt(d)); });
+}
+
+//! Evaluate the triangular kernel from the batch squared distances.
+template<typename ReferenceMatType, typename QueryMatType>
+void BatchKernel(kernel::TriangularKernel& kernel,
+                 const ReferenceMatType& referenceSet,
+                 const QueryMatType& querySet,
+                 arma::mat& kernels)
+{
+  SquaredDistances(referenceSet, querySet, kernels);
+  kernels = arma::clamp(1.0 - arma::sqrt(kernels) / kernel.Bandwidth(), 0.0,
+      DBL_MAX);
+}
+
+/**
+ * Evaluate the kernel between each point and itself, one point at a time.
+ *
+ * @param kernel Kernel to evaluate.
+ * @param data Set of points.
+ * @param selfKernels Vector to store K(x, x) for each point x in.
+ */
+template<typename KernelType, typename MatType>
+void SelfKernels(KernelType& kernel,
+                 const MatType& data,
+                 arma::vec& selfKernels)
+{
+  selfKernels.set_size(data.n_cols);
+  for (size_t i = 0; i < data.n_cols; ++i)
+    selfKernels[i] = kernel.Evaluate(data.col(i), data.col(i));
+}
+
+//! The linear self-kernels are the squared norms of the points.
+template<typename MatType>
+void SelfKernels(kernel::LinearKernel& /* kernel */,
+                 const MatType& data,
+                 arma::vec& selfKernels)
+{
+  SquaredNorms(data, selfKernels);
+}
+
+//! The polynomial self-kernels are a function of the squared norms.
+template<typename MatType>
+void SelfKernels(kernel::PolynomialKernel& kernel,
+                 const MatType& data,
+                 arma::vec& selfKernels)
+{
+  SquaredNorms(data, selfKernels);
+  selfKernels = arma::pow(selfKernels + kernel.Offset(), kernel.Degree());
+}
+
+//! The hyperbolic tangent self-kernels are a function of the squared norms.
+template<typename MatType>
+void SelfKernels(kernel::HyperbolicTangentKernel& kernel,
+                 const MatType& data,
+                 arma::vec& selfKernels)
+{
+  SquaredNorms(data, selfKernels);
+  selfKernels = arma::tanh(kernel.Scale() * selfKernels + kernel.Offset());
+}
+
+} // namespace fastmks
+} // namespace mlpack
+
+#endif
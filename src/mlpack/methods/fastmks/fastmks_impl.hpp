@@ -18,6 +18,11 @@
 #include "fastmks_rules.hpp"
 
 #include <mlpack/core/kernels/gaussian_kernel.hpp>
+#include <mlpack/core/tree/split_query_tree.hpp>
+
+#ifdef HAS_OPENMP
+  #include <omp.h>
+#endif
 
 namespace mlpack {
 namespace fastmks {
@@ -304,33 +309,7 @@ void FastMKS<KernelType, MatType, TreeType>::Search(
   // Naive implementation.
   if (naive)
   {
-    // Simple double loop.  Stupid, slow, but a good benchmark.
-    for (size_t q = 0; q < querySet.n_cols; ++q)
-    {
-      const Candidate def = std::make_pair(-DBL_MAX, size_t() - 1);
-      std::vector<Candidate> cList(k, def);
-      CandidateList pqueue(CandidateCmp(), std::move(cList));
-
-      for (size_t r = 0; r < referenceSet->n_cols; ++r)
-      {
-        const double eval = metric.Kernel().Evaluate(querySet.col(q),
-                                                     referenceSet->col(r));
-
-        if (eval > pqueue.top().first)
-        {
-          Candidate c = std::make_pair(eval, r);
-          pqueue.pop();
-          pqueue.push(c);
-        }
-      }
-
-      for (size_t j = 1; j <= k; j++)
-      {
-        indices(k - j, q) = pqueue.top().second;
-        kernels(k - j, q) = pqueue.top().first;
-        pqueue.pop();
-      }
-    }
+    NaiveSearch(querySet, k, indices, kernels, false);
 
     Timer::Stop("computing_products");
 
@@ -403,12 +382,57 @@ void FastMKS<KernelType, MatType, TreeType>::Search(
   typedef FastMKSRules<KernelType, Tree> RuleType;
   RuleType rules(*referenceSet, queryTree->Dataset(), k, metric.Kernel());
 
-  typename Tree::template DualTreeTraverser<RuleType> traverser(rules);
+  #ifdef HAS_OPENMP
+    const size_t numThreads = omp_get_max_threads();
+  #else
+    const size_t numThreads = 1;
+  #endif
+
+  // Split the query tree into several times more subtrees than there are
+  // threads, so that the work is balanced even though some subtrees are much
+  // more expensive than others.
+  std::vector<Tree*> subtrees;
+  if (numThreads > 1)
+  {
+    // The subtrees use the bounds of their parents for pruning, but the nodes
+    // that are split are not visited during the search and may hold bounds
+    // from a previous search, so these are reset.
+    tree::SplitQueryTree(*queryTree, 4 * numThreads, subtrees,
+        [](Tree& node) { node.Stat().Bound() = -DBL_MAX; });
+  }
 
-  traverser.Traverse(*queryTree, *referenceTree);
+  size_t baseCases = 0;
+  size_t scores = 0;
+  if (subtrees.size() <= 1)
+  {
+    typename Tree::template DualTreeTraverser<RuleType> traverser(rules);
 
-  Log::Info << rules.BaseCases() << " base cases." << std::endl;
-  Log::Info << rules.Scores() << " scores." << std::endl;
+    traverser.Traverse(*queryTree, *referenceTree);
+
+    baseCases = rules.BaseCases();
+    scores = rules.Scores();
+  }
+  else
+  {
+    // Each query point is held in exactly one subtree, so each thread only
+    // modifies the candidates of its own query points.
+    #pragma omp parallel for schedule(dynamic) reduction(+:baseCases, scores)
+    for (omp_size_t i = 0; i < (omp_size_t) subtrees.size(); ++i)
+    {
+      KernelType threadKernel(metric.Kernel());
+      RuleType threadRules(rules, threadKernel);
+      typename Tree::template DualTreeTraverser<RuleType>
+          traverser(threadRules);
+
+      traverser.Traverse(*subtrees[i], *referenceTree);
+
+      baseCases += threadRules.BaseCases();
+      scores += threadRules.Scores();
+    }
+  }
+
+  Log::Info << baseCases << " base cases." << std::endl;
+  Log::Info << scores << " scores." << std::endl;
 
   rules.GetResults(indices, kernels);
 
@@ -433,36 +457,7 @@ void FastMKS<KernelType, MatType, TreeType>::Search(
   // Naive implementation.
   if (naive)
   {
-    // Simple double loop.  Stupid, slow, but a good benchmark.
-    for (size_t q = 0; q < referenceSet->n_cols; ++q)
-    {
-      const Candidate def = std::make_pair(-DBL_MAX, size_t() - 1);
-      std::vector<Candidate> cList(k, def);
-      CandidateList pqueue(CandidateCmp(), std::move(cList));
-
-      for (size_t r = 0; r < referenceSet->n_cols; ++r)
-      {
-        if (q == r)
-          continue; // Don't return the point as its own candidate.
-
-        const double eval = metric.Kernel().Evaluate(referenceSet->col(q),
-                                                     referenceSet->col(r));
-
-        if (eval > pqueue.top().first)
-        {
-          Candidate c = std::make_pair(eval, r);
-          pqueue.pop();
-          pqueue.push(c);
-        }
-      }
-
-      for (size_t j = 1; j <= k; j++)
-      {
-        indices(k - j, q) = pqueue.top().second;
-        kernels(k - j, q) = pqueue.top().first;
-        pqueue.pop();
-      }
-    }
+    NaiveSearch(*referenceSet, k, indices, kernels, true);
 
     Timer::Stop("computing_products");
 
@@ -502,6 +497,82 @@ void FastMKS<KernelType, MatType, TreeType>::Search(
   Search(referenceTree, k, indices, kernels);
 }
 
+template<typename KernelType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void FastMKS<KernelType, MatType, TreeType>::NaiveSearch(
+    const MatType& querySet,
+    const size_t k,
+    arma::Mat<size_t>& indices,
+    arma::mat& kernels,
+    const bool sameSet)
+{
+  // The blocks are small enough that a block of kernel values fits in cache.
+  const size_t queryBlockSize = 64;
+  const size_t referenceBlockSize = 1024;
+  const size_t numQueryBlocks = (querySet.n_cols + queryBlockSize - 1) /
+      queryBlockSize;
+
+  #pragma omp parallel for schedule(dynamic)
+  for (omp_size_t b = 0; b < (omp_size_t) numQueryBlocks; ++b)
+  {
+    const size_t queryBegin = b * queryBlockSize;
+    const size_t queryEnd = std::min(queryBegin + queryBlockSize,
+        (size_t) querySet.n_cols);
+
+    // Some kernels are not safe to evaluate concurrently, so each block uses
+    // its own copy.
+    KernelType threadKernel(metric.Kernel());
+
+    // The candidates of query point q are a min-heap held in the k positions
+    // starting at (q - queryBegin) * k.
+    const Candidate def = std::make_pair(-DBL_MAX, size_t() - 1);
+    std::vector<Candidate> candidates(k * (queryEnd - queryBegin), def);
+
+    arma::mat blockKernels;
+    for (size_t r = 0; r < referenceSet->n_cols; r += referenceBlockSize)
+    {
+      const size_t referenceEnd = std::min(r + referenceBlockSize,
+          (size_t) referenceSet->n_cols);
+      BatchKernel(threadKernel, referenceSet->cols(r, referenceEnd - 1),
+          querySet.cols(queryBegin, queryEnd - 1), blockKernels);
+
+      for (size_t q = 0; q < blockKernels.n_cols; ++q)
+      {
+        Candidate* pqueue = candidates.data() + q * k;
+        for (size_t i = 0; i < blockKernels.n_rows; ++i)
+        {
+          // Don't return the point as its own candidate.
+          if (sameSet && (queryBegin + q == r + i))
+            continue;
+
+          const double eval = blockKernels(i, q);
+          if (eval > pqueue[0].first)
+          {
+            std::pop_heap(pqueue, pqueue + k, CandidateCmp());
+            pqueue[k - 1] = std::make_pair(eval, r + i);
+            std::push_heap(pqueue, pqueue + k, CandidateCmp());
+          }
+        }
+      }
+    }
+
+    // Sorting each heap puts the largest kernel value first.
+    for (size_t q = 0; q < queryEnd - queryBegin; ++q)
+    {
+      Candidate* pqueue = candidates.data() + q * k;
+      std::sort_heap(pqueue, pqueue + k, CandidateCmp());
+      for (size_t j = 0; j < k; ++j)
+      {
+        indices(j, queryBegin + q) = pqueue[j].second;
+        kernels(j, queryBegin + q) = pqueue[j].first;
+      }
+    }
+  }
+}
+
 //! Serialize the model.
 template<typename KernelType,
          typename MatType,
@@ -16,6 +16,10 @@
 #include "fastmks.hpp"
 #include "fastmks_model.hpp"
 
+#ifdef HAS_OPENMP
+  #include <omp.h>
+#endif
+
 using namespace std;
 using namespace mlpack;
 using namespace mlpack::fastmks;
@@ -79,6 +83,8 @@ PARAM_INT_IN("k", "Number of maximum kernels to find.", "k", 0);
 PARAM_FLAG("naive", "If true, O(n^2) naive mode is used for computation.", "N");
 PARAM_FLAG("single", "If true, single-tree search is used (as opposed to "
     "dual-tree search.", "S");
+PARAM_INT_IN("threads", "Number of threads to use for naive and dual-tree "
+    "search.  If 0, the OpenMP default is used.", "T", 0);
 
 PARAM_MATRIX_OUT("kernels", "Output matrix of kernels.", "p");
 PARAM_UMATRIX_OUT("indices", "Output matrix of indices.", "i");
@@ -111,6 +117,20 @@ static void mlpackMain()
   // Naive mode overrides single mode.
   ReportIgnoredParam({{ "naive", true }}, "single");
 
+  // Sanity check on the number of threads.
+  RequireParamValue<int>("threads", [](int x) { return x >= 0; }, true,
+      "number of threads must be nonnegative");
+  if (CLI::GetParam<int>("threads") > 0)
+  {
+    #ifdef HAS_OPENMP
+      omp_set_num_threads(CLI::GetParam<int>("threads"));
+    #else
+      if (CLI::GetParam<int>("threads") > 1)
+        Log::Warn << PRINT_PARAM_STRING("threads") << " ignored because mlpack "
+            << "was compiled without OpenMP support." << endl;
+    #endif
+  }
+
   FastMKSModel model;
   arma::mat referenceData;
   if (CLI::HasParam("reference"))
@@ -92,7 +92,8 @@ class FastMKSModel
   int& KernelType() { return kernelType; }
 
   /**
-   * Search with a different query set.
+   * Search with a different query set.  Naive and dual-tree search use all
+   * available OpenMP threads (see omp_set_num_threads()).
    *
    * @param querySet Set to search with.
    * @param k Number of max-kernel candidates to search for.
@@ -110,7 +111,8 @@ class FastMKSModel
               const double base);
 
   /**
-   * Search with the reference set as the query set.
+   * Search with the reference set as the query set.  Naive and dual-tree
+   * search use all available OpenMP threads.
    *
    * @param k Number of max-kernel candidates to search for.
    * @param indices A matrix in which to store the indices of max-kernel
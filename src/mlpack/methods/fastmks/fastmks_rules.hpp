@@ -16,7 +16,7 @@
 #include <mlpack/core/kernels/kernel_traits.hpp>
 #include <mlpack/core/tree/cover_tree/cover_tree.hpp>
 #include <mlpack/core/tree/traversal_info.hpp>
-#include <boost/heap/priority_queue.hpp>
+#include "fastmks_batch_kernel.hpp"
 
 namespace mlpack {
 namespace fastmks {
@@ -48,6 +48,18 @@ class FastMKSRules
                const size_t k,
                KernelType& kernel);
 
+  /**
+   * Construct a FastMKSRules object that shares the datasets, the precomputed
+   * self-kernels and the candidate lists of the given object, but has its own
+   * traversal state and kernel.  This is used for parallel dual-tree search:
+   * each thread traverses a disjoint part of the query tree, so the candidates
+   * of each query point are only ever modified by one thread.
+   *
+   * @param other Rules object to share candidates with.
+   * @param kernel Kernel to run FastMKS with.
+   */
+  FastMKSRules(const FastMKSRules& other, KernelType& kernel);
+
   /**
    * Store the list of candidates for each query point in the given matrices.
    *
@@ -141,15 +153,13 @@ class FastMKSRules
     };
   };
 
-  //! Use a min heap to represent the list of candidate points.
-  //! We will use a boost::heap::priority_queue instead of a std::priority_queue
-  //! because we need to iterate over all the candidates and std::priority_queue
-  //! doesn't provide that interface.
-  typedef boost::heap::priority_queue<Candidate,
-      boost::heap::compare<CandidateCmp>> CandidateList;
-
-  //! Set of candidates for each point.
-  std::vector<CandidateList> candidates;
+  //! Storage for the candidates of every query point, if this object owns
+  //! them.
+  std::vector<Candidate> candidateStorage;
+  //! The candidates of every query point.  The candidates of query point i are
+  //! a min-heap (ordered with CandidateCmp) held in the k consecutive
+  //! positions starting at i * k, so the worst candidate is candidates[i * k].
+  Candidate* candidates;
 
   //! Number of points to search for.
   const size_t k;
@@ -35,15 +35,11 @@ FastMKSRules<KernelType, TreeType>::FastMKSRules(
     scores(0)
 {
   // Precompute each self-kernel.
-  queryKernels.set_size(querySet.n_cols);
-  for (size_t i = 0; i < querySet.n_cols; ++i)
-    queryKernels[i] = sqrt(kernel.Evaluate(querySet.col(i),
-                                           querySet.col(i)));
+  SelfKernels(kernel, querySet, queryKernels);
+  queryKernels = arma::sqrt(queryKernels);
 
-  referenceKernels.set_size(referenceSet.n_cols);
-  for (size_t i = 0; i < referenceSet.n_cols; ++i)
-    referenceKernels[i] = sqrt(kernel.Evaluate(referenceSet.col(i),
-                                               referenceSet.col(i)));
+  SelfKernels(kernel, referenceSet, referenceKernels);
+  referenceKernels = arma::sqrt(referenceKernels);
 
   // Set to invalid memory, so that the first node combination does not try to
   // dereference null pointers.
@@ -53,15 +49,33 @@ FastMKSRules<KernelType, TreeType>::FastMKSRules(
   // Let's build the list of candidate points for each query point.
   // It will be initialized with k candidates: (-DBL_MAX, size_t() - 1)
   // The list of candidates will be updated when visiting new points with the
-  // BaseCase() method.
+  // BaseCase() method.  A list of identical candidates is a valid heap.
   const Candidate def = std::make_pair(-DBL_MAX, size_t() - 1);
+  candidateStorage.assign(k * querySet.n_cols, def);
+  candidates = candidateStorage.data();
+}
 
-  CandidateList pqueue;
-  pqueue.reserve(k);
-  for (size_t i = 0; i < k; i++)
-    pqueue.push(def);
-  std::vector<CandidateList> tmp(querySet.n_cols, pqueue);
-  candidates.swap(tmp);
+template<typename KernelType, typename TreeType>
+FastMKSRules<KernelType, TreeType>::FastMKSRules(
+    const FastMKSRules& other,
+    KernelType& kernel) :
+    referenceSet(other.referenceSet),
+    querySet(other.querySet),
+    candidates(other.candidates),
+    k(other.k),
+    queryKernels(const_cast<double*>(other.queryKernels.memptr()),
+        other.queryKernels.n_elem, false, true),
+    referenceKernels(const_cast<double*>(other.referenceKernels.memptr()),
+        other.referenceKernels.n_elem, false, true),
+    kernel(kernel),
+    lastQueryIndex(-1),
+    lastReferenceIndex(-1),
+    lastKernel(0.0),
+    baseCases(0),
+    scores(0)
+{
+  traversalInfo.LastQueryNode() = (TreeType*) this;
+  traversalInfo.LastReferenceNode() = (TreeType*) this;
 }
 
 template<typename KernelType, typename TreeType>
@@ -74,12 +88,14 @@ void FastMKSRules<KernelType, TreeType>::GetResults(
 
   for (size_t i = 0; i < querySet.n_cols; i++)
   {
-    CandidateList& pqueue = candidates[i];
-    for (size_t j = 1; j <= k; j++)
+    // Sorting the heap with the min-heap comparator puts the largest kernel
+    // value first.
+    Candidate* pqueue = candidates + i * k;
+    std::sort_heap(pqueue, pqueue + k, CandidateCmp());
+    for (size_t j = 0; j < k; j++)
     {
-      indices(k - j, i) = pqueue.top().second;
-      products(k - j, i) = pqueue.top().first;
-      pqueue.pop();
+      indices(j, i) = pqueue[j].second;
+      products(j, i) = pqueue[j].first;
     }
   }
 }
@@ -129,7 +145,7 @@ double FastMKSRules<KernelType, TreeType>::Score(const size_t queryIndex,
                                                  TreeType& referenceNode)
 {
   // Compare with the current best.
-  const double bestKernel = candidates[queryIndex].top().first;
+  const double bestKernel = candidates[queryIndex * k].first;
 
   // See if we can perform a parent-child prune.
   const double furthestDist = referenceNode.FurthestDescendantDistance();
@@ -412,7 +428,7 @@ double FastMKSRules<KernelType, TreeType>::Rescore(const size_t queryIndex,
                                                    TreeType& /*referenceNode*/,
                                                    const double oldScore) const
 {
-  const double bestKernel = candidates[queryIndex].top().first;
+  const double bestKernel = candidates[queryIndex * k].first;
 
   return ((1.0 / oldScore) >= bestKernel) ? oldScore : DBL_MAX;
 }
@@ -459,11 +475,11 @@ double FastMKSRules<KernelType, TreeType>::CalculateBound(TreeType& queryNode)
   for (size_t i = 0; i < queryNode.NumPoints(); ++i)
   {
     const size_t point = queryNode.Point(i);
-    const CandidateList& candidatesPoints = candidates[point];
-    if (candidatesPoints.top().first < worstPointKernel)
-      worstPointKernel = candidatesPoints.top().first;
+    const Candidate* candidatesPoints = candidates + point * k;
+    if (candidatesPoints[0].first < worstPointKernel)
+      worstPointKernel = candidatesPoints[0].first;
 
-    if (candidatesPoints.top().first == -DBL_MAX)
+    if (candidatesPoints[0].first == -DBL_MAX)
       continue; // Avoid underflow.
 
     // This should be (queryDescendantDistance + centroidDistance) for any tree
@@ -478,11 +494,11 @@ double FastMKSRules<KernelType, TreeType>::CalculateBound(TreeType& queryNode)
     // where p_j^*(p_q) is the j'th kernel candidate for query point p_q and
     // k_j^*(p_q) is K(p_q, p_j^*(p_q)).
     double worstPointCandidateKernel = DBL_MAX;
-    typedef typename CandidateList::const_iterator iter;
-    for (iter it = candidatesPoints.begin(); it != candidatesPoints.end(); ++it)
+    for (size_t j = 0; j < k; ++j)
     {
-      const double candidateKernel = it->first - queryDescendantDistance *
-          referenceKernels[it->second];
+      const Candidate& candidate = candidatesPoints[j];
+      const double candidateKernel = candidate.first - queryDescendantDistance *
+          referenceKernels[candidate.second];
       if (candidateKernel < worstPointCandidateKernel)
         worstPointCandidateKernel = candidateKernel;
     }
@@ -529,12 +545,13 @@ inline void FastMKSRules<KernelType, TreeType>::InsertNeighbor(
     const size_t index,
     const double product)
 {
-  CandidateList& pqueue = candidates[queryIndex];
-  if (product > pqueue.top().first)
+  Candidate* pqueue = candidates + queryIndex * k;
+  if (product > pqueue[0].first)
   {
-    Candidate c = std::make_pair(product, index);
-    pqueue.pop();
-    pqueue.push(c);
+    // Replace the worst candidate.
+    std::pop_heap(pqueue, pqueue + k, CandidateCmp());
+    pqueue[k - 1] = std::make_pair(product, index);
+    std::push_heap(pqueue, pqueue + k, CandidateCmp());
   }
 }
 
@@ -0,0 +1,172 @@
+/**
+ * @file diagonal_gmm.cpp
+ *
+ * Implementation of the non-template DiagonalGMM methods.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "diagonal_gmm.hpp"
+#include <mlpack/core/math/log_add.hpp>
+
+namespace mlpack {
+namespace gmm {
+
+/**
+ * Create a GMM with the given number of Gaussians, each of which have the
+ * specified dimensionality.
+ */
+DiagonalGMM::DiagonalGMM(const size_t gaussians, const size_t dimensionality) :
+    gaussians(gaussians),
+    dimensionality(dimensionality),
+    dists(gaussians,
+          distribution::DiagonalGaussianDistribution(dimensionality)),
+    weights(gaussians)
+{
+  // Set equal weights.  Technically this model is still valid, but only barely.
+  weights.fill(1.0 / gaussians);
+}
+
+/**
+ * Return the probability of the given observation being from this GMM.
+ */
+double DiagonalGMM::Probability(const arma::vec& observation) const
+{
+  return exp(LogProbability(observation));
+}
+
+/**
+ * Return the log probability of the given observation being from this GMM.
+ */
+double DiagonalGMM::LogProbability(const arma::vec& observation) const
+{
+  // Sum the probability for each Gaussian in our mixture in log space, to avoid
+  // underflow in high dimensions.
+  arma::vec logProbs(gaussians);
+  for (size_t i = 0; i < gaussians; i++)
+    logProbs[i] = log(weights[i]) + dists[i].LogProbability(observation);
+
+  return math::AccuLog(logProbs);
+}
+
+/**
+ * Return the probability of the given observation being from the given
+ * component in the mixture.
+ */
+double DiagonalGMM::Probability(const arma::vec& observation,
+                                const size_t component) const
+{
+  // We are only considering one Gaussian component -- so we only need to call
+  // Probability() once.  We do consider the prior probability!
+  return weights[component] * dists[component].Probability(observation);
+}
+
+/**
+ * Return the probability of each of the given observations.
+ */
+void DiagonalGMM::Probability(const arma::mat& observations,
+                              arma::vec& probabilities) const
+{
+  LogProbability(observations, probabilities);
+  probabilities = arma::exp(probabilities);
+}
+
+/**
+ * Return the log probability of each of the given observations.
+ */
+void DiagonalGMM::LogProbability(const arma::mat& observations,
+                                 arma::vec& logProbabilities) const
+{
+  arma::mat logProbs;
+  ComponentLogProbabilities(observations, dists, weights, logProbs);
+
+  // Sum over the components of each point.
+  math::LogSumExp(logProbs, logProbabilities);
+}
+
+/**
+ * Return a randomly generated observation according to the probability
+ * distribution defined by this object.
+ */
+arma::vec DiagonalGMM::Random() const
+{
+  // Determine which Gaussian it will be coming from.
+  double gaussRand = math::Random();
+  size_t gaussian = 0;
+
+  double sumProb = 0;
+  for (size_t g = 0; g < gaussians; g++)
+  {
+    sumProb += weights(g);
+    if (gaussRand <= sumProb)
+    {
+      gaussian = g;
+      break;
+    }
+  }
+
+  return dists[gaussian].Random();
+}
+
+/**
+ * Classify the given observations as being from an individual component in
+ * this GMM.
+ */
+void DiagonalGMM::Classify(const arma::mat& observations,
+                           arma::Row<size_t>& labels) const
+{
+  // Evaluate every component on all the points at once, then take the most
+  // likely component for each point.
+  arma::mat logProbs;
+  ComponentLogProbabilities(observations, dists, weights, logProbs);
+
+  labels.set_size(observations.n_cols);
+  for (size_t i = 0; i < observations.n_cols; ++i)
+  {
+    arma::uword maxIndex;
+    logProbs.col(i).max(maxIndex);
+    labels[i] = maxIndex;
+  }
+}
+
+/**
+ * Get the log-likelihood of this data's fit to the model.
+ */
+double DiagonalGMM::LogLikelihood(
+    const arma::mat& data,
+    const std::vector<distribution::DiagonalGaussianDistribution>& distsL,
+    const arma::vec& weightsL) const
+{
+  // Work in log space, since the probabilities of high-dimensional points may
+  // underflow.
+  arma::mat logProbs;
+  ComponentLogProbabilities(data, distsL, weightsL, logProbs);
+
+  arma::vec logLikelihoods;
+  math::LogSumExp(logProbs, logLikelihoods);
+  return arma::accu(logLikelihoods);
+}
+
+/**
+ * Compute the weighted log probability of each point under each component.
+ */
+void DiagonalGMM::ComponentLogProbabilities(
+    const arma::mat& data,
+    const std::vector<distribution::DiagonalGaussianDistribution>& distsL,
+    const arma::vec& weightsL,
+    arma::mat& logProbabilities) const
+{
+  logProbabilities.set_size(gaussians, data.n_cols);
+
+  arma::vec componentLogProbs;
+  for (size_t i = 0; i < gaussians; i++)
+  {
+    distsL[i].LogProbability(data, componentLogProbs);
+    logProbabilities.row(i) = log(weightsL(i)) + trans(componentLogProbs);
+  }
+}
+
+} // namespace gmm
+} // namespace mlpack
@@ -76,6 +76,20 @@ class EigenvalueRatioConstraint
     covariance = eigenvectors * arma::diagmat(eigenvalues) * eigenvectors.t();
   }
 
+  /**
+   * Apply the eigenvalue ratio constraint to the given diagonal covariance,
+   * given as the vector of its diagonal elements.
+   */
+  void ApplyConstraint(arma::vec& diagCovariance) const
+  {
+    // The eigenvalues of a diagonal matrix are its diagonal elements.  Sort
+    // them in the same order that eig_sym() returns them in, and then force
+    // them to the ratios.
+    const arma::uvec eigvalOrder = arma::sort_index(diagCovariance);
+    const double firstEigval = diagCovariance[eigvalOrder[0]];
+    diagCovariance.elem(eigvalOrder) = firstEigval * ratios;
+  }
+
   //! Serialize the constraint.
   template<typename Archive>
   void serialize(Archive& ar, const unsigned int /* version */)
@@ -16,6 +16,7 @@
 
 #include <mlpack/prereqs.hpp>
 #include <mlpack/core/dists/gaussian_distribution.hpp>
+#include <mlpack/core/dists/diagonal_gaussian_distribution.hpp>
 
 // Default clustering mechanism.
 #include <mlpack/methods/kmeans/kmeans.hpp>
@@ -37,11 +38,25 @@ namespace gmm {
  *
  * This method should create 'clusters' clusters, and return the assignment of
  * each point to a cluster.
+ *
+ * The Distribution template parameter selects the type of each component;
+ * either distribution::GaussianDistribution (full covariance) or
+ * distribution::DiagonalGaussianDistribution (diagonal covariance) may be used.
+ * With the diagonal distribution, every step of the algorithm only touches the
+ * variances, so the cost of each iteration is linear in the dimensionality.
  */
 template<typename InitialClusteringType = kmeans::KMeans<>,
-         typename CovarianceConstraintPolicy = PositiveDefiniteConstraint>
+         typename CovarianceConstraintPolicy = PositiveDefiniteConstraint,
+         typename Distribution = distribution::GaussianDistribution>
 class EMFit
 {
+  static_assert(
+      std::is_same<Distribution, distribution::GaussianDistribution>::value ||
+      std::is_same<Distribution,
+          distribution::DiagonalGaussianDistribution>::value,
+      "The Distribution template parameter must be either GaussianDistribution "
+      "or DiagonalGaussianDistribution.");
+
  public:
   /**
    * Construct the EMFit object, optionally passing an InitialClusteringType
@@ -81,7 +96,7 @@ class EMFit
    *      clustering.
    */
   void Estimate(const arma::mat& observations,
-                std::vector<distribution::GaussianDistribution>& dists,
+                std::vector<Distribution>& dists,
                 arma::vec& weights,
                 const bool useInitialModel = false);
 
@@ -104,7 +119,7 @@ class EMFit
    */
   void Estimate(const arma::mat& observations,
                 const arma::vec& probabilities,
-                std::vector<distribution::GaussianDistribution>& dists,
+                std::vector<Distribution>& dists,
                 arma::vec& weights,
                 const bool useInitialModel = false);
 
@@ -144,9 +159,25 @@ class EMFit
    * @param weights Vector to store a priori weights in.
    */
   void InitialClustering(const arma::mat& observations,
-                         std::vector<distribution::GaussianDistribution>& dists,
+                         std::vector<Distribution>& dists,
                          arma::vec& weights);
 
+  /**
+   * Compute the conditional probability of each Gaussian given each
+   * observation (the E-step).  The probabilities are normalized in log space,
+   * so they do not underflow for high-dimensional observations.
+   *
+   * @param observations List of observations.
+   * @param dists Current Gaussians.
+   * @param weights Current a priori weights.
+   * @param condProb Matrix to store the probabilities in; it must already
+   *     have one row per observation and one column per Gaussian.
+   */
+  void ConditionalProbabilities(const arma::mat& observations,
+                                const std::vector<Distribution>& dists,
+                                const arma::vec& weights,
+                                arma::mat& condProb) const;
+
   /**
    * Calculate the log-likelihood of a model.  Yes, this is reimplemented in the
    * GMM code.  Intuition suggests that the log-likelihood is not the best way
@@ -158,10 +189,99 @@ class EMFit
    * @param weights Vector of a priori weights.
    */
   double LogLikelihood(const arma::mat& data,
-                       const std::vector<distribution::GaussianDistribution>&
-                           dists,
+                       const std::vector<Distribution>& dists,
                        const arma::vec& weights) const;
 
+  /**
+   * Compute the initial covariances of full-covariance Gaussians from the
+   * cluster assignments.  The means of the distributions must already be set.
+   *
+   * @param observations List of observations.
+   * @param assignments Cluster assignment of each observation.
+   * @param counts Number of observations in each cluster.
+   * @param dists Distributions to store covariances in.
+   */
+  void InitialCovariances(
+      const arma::mat& observations,
+      const arma::Row<size_t>& assignments,
+      const arma::vec& counts,
+      std::vector<distribution::GaussianDistribution>& dists);
+
+  /**
+   * Compute the initial variances of diagonal Gaussians from the cluster
+   * assignments.  The means of the distributions must already be set.
+   *
+   * @param observations List of observations.
+   * @param assignments Cluster assignment of each observation.
+   * @param counts Number of observations in each cluster.
+   * @param dists Distributions to store variances in.
+   */
+  void InitialCovariances(
+      const arma::mat& observations,
+      const arma::Row<size_t>& assignments,
+      const arma::vec& counts,
+      std::vector<distribution::DiagonalGaussianDistribution>& dists);
+
+  /**
+   * Compute the covariance of a full-covariance Gaussian from the centered
+   * observations and the weight of each observation, apply the constraint, and
+   * store it in the distribution.
+   *
+   * @param dist Distribution to update.
+   * @param diffs Observations, centered on the mean of the distribution.
+   * @param pointWeights Weight of each observation.
+   * @param weightSum Sum of the weights.
+   */
+  void UpdateCovariance(distribution::GaussianDistribution& dist,
+                        const arma::mat& diffs,
+                        const arma::vec& pointWeights,
+                        const double weightSum);
+
+  /**
+   * Compute the variances of a diagonal Gaussian from the centered
+   * observations and the weight of each observation, apply the constraint, and
+   * store them in the distribution.  This never forms the full covariance
+   * matrix.
+   *
+   * @param dist Distribution to update.
+   * @param diffs Observations, centered on the mean of the distribution.
+   * @param pointWeights Weight of each observation.
+   * @param weightSum Sum of the weights.
+   */
+  void UpdateCovariance(distribution::DiagonalGaussianDistribution& dist,
+                        const arma::mat& diffs,
+                        const arma::vec& pointWeights,
+                        const double weightSum);
+
+  //! Get the diagonal of the covariance of a full-covariance Gaussian.
+  static arma::vec DiagonalCovariance(
+      const distribution::GaussianDistribution& dist)
+  {
+    return dist.Covariance().diag();
+  }
+
+  //! Get the diagonal of the covariance of a diagonal Gaussian.
+  static arma::vec DiagonalCovariance(
+      const distribution::DiagonalGaussianDistribution& dist)
+  {
+    return dist.Covariance();
+  }
+
+  //! Set a full-covariance Gaussian to have the given diagonal covariance.
+  static void DiagonalCovariance(distribution::GaussianDistribution& dist,
+                                 const arma::vec& diagCovariance)
+  {
+    dist.Covariance(arma::diagmat(diagCovariance));
+  }
+
+  //! Set the diagonal covariance of a diagonal Gaussian.
+  static void DiagonalCovariance(
+      distribution::DiagonalGaussianDistribution& dist,
+      const arma::vec& diagCovariance)
+  {
+    dist.Covariance(diagCovariance);
+  }
+
   // Armadillo uses uword internally as an OpenMP index type, which crashes
   // Visual Studio.
   #ifndef _WIN32
@@ -177,7 +297,7 @@ class EMFit
    */
   void ArmadilloGMMWrapper(
       const arma::mat& observations,
-      std::vector<distribution::GaussianDistribution>& dists,
+      std::vector<Distribution>& dists,
       arma::vec& weights,
       const bool useInitialModel);
   #endif
@@ -17,12 +17,16 @@
 #include "em_fit.hpp"
 #include "diagonal_constraint.hpp"
 
+#include <mlpack/core/math/log_add.hpp>
+
 namespace mlpack {
 namespace gmm {
 
 //! Constructor.
-template<typename InitialClusteringType, typename CovarianceConstraintPolicy>
-EMFit<InitialClusteringType, CovarianceConstraintPolicy>::EMFit(
+template<typename InitialClusteringType,
+         typename CovarianceConstraintPolicy,
+         typename Distribution>
+EMFit<InitialClusteringType, CovarianceConstraintPolicy, Distribution>::EMFit(
     const size_t maxIterations,
     const double tolerance,
     InitialClusteringType clusterer,
@@ -33,12 +37,14 @@ EMFit<InitialClusteringType, CovarianceConstraintPolicy>::EMFit(
     constraint(constraint)
 { /* Nothing to do. */ }
 
-template<typename InitialClusteringType, typename CovarianceConstraintPolicy>
-void EMFit<InitialClusteringType, CovarianceConstraintPolicy>::Estimate(
-    const arma::mat& observations,
-    std::vector<distribution::GaussianDistribution>& dists,
-    arma::vec& weights,
-    const bool useInitialModel)
+template<typename InitialClusteringType,
+         typename CovarianceConstraintPolicy,
+         typename Distribution>
+void EMFit<InitialClusteringType, CovarianceConstraintPolicy, Distribution>::
+Estimate(const arma::mat& observations,
+         std::vector<Distribution>& dists,
+         arma::vec& weights,
+         const bool useInitialModel)
 {
   // Shortcut: if the user is using the DiagonalConstraint, then we will call
   // out to Armadillo.  But Armadillo uses uword internally as an OpenMP index
@@ -72,24 +78,7 @@ void EMFit<InitialClusteringType, CovarianceConstraintPolicy>::Estimate(
 
     // Calculate the conditional probabilities of choosing a particular
     // Gaussian given the observations and the present theta value.
-    for (size_t i = 0; i < dists.size(); i++)
-    {
-      // Store conditional probabilities into condProb vector for each
-      // Gaussian.  First we make an alias of the condProb vector.
-      arma::vec condProbAlias = condProb.unsafe_col(i);
-      dists[i].Probability(observations, condProbAlias);
-      condProbAlias *= weights[i];
-    }
-
-    // Normalize row-wise.
-    for (size_t i = 0; i < condProb.n_rows; i++)
-    {
-      // Avoid dividing by zero; if the probability for everything is 0, we
-      // don't want to make it NaN.
-      const double probSum = accu(condProb.row(i));
-      if (probSum != 0.0)
-        condProb.row(i) /= probSum;
-    }
+    ConditionalProbabilities(observations, dists, weights, condProb);
 
     // Store the sum of the probability of each state over all the observations.
     arma::vec probRowSums = trans(arma::sum(condProb, 0 /* columnwise */));
@@ -99,24 +88,16 @@ void EMFit<InitialClusteringType, CovarianceConstraintPolicy>::Estimate(
     for (size_t i = 0; i < dists.size(); i++)
     {
       // Don't update if there's no probability of the Gaussian having points.
-      if (probRowSums[i] != 0)
-        dists[i].Mean() = (observations * condProb.col(i)) / probRowSums[i];
+      if (probRowSums[i] == 0)
+        continue;
+
+      dists[i].Mean() = (observations * condProb.col(i)) / probRowSums[i];
 
       // Calculate the new value of the covariances using the updated
       // conditional probabilities and the updated means.
-      arma::mat tmp = observations - (dists[i].Mean() *
-          arma::ones<arma::rowvec>(observations.n_cols));
-      arma::mat tmpB = tmp % (arma::ones<arma::vec>(observations.n_rows) *
-          trans(condProb.col(i)));
-
-      // Don't update if there's no probability of the Gaussian having points.
-      if (probRowSums[i] != 0.0)
-      {
-        arma::mat covariance = (tmp * trans(tmpB)) / probRowSums[i];
-        // Apply covariance constraint.
-        constraint.ApplyConstraint(covariance);
-        dists[i].Covariance(std::move(covariance));
-      }
+      const arma::mat diffs = observations.each_col() - dists[i].Mean();
+      UpdateCovariance(dists[i], diffs, condProb.unsafe_col(i),
+          probRowSums[i]);
     }
 
     // Calculate the new values for omega using the updated conditional
@@ -129,15 +110,19 @@ void EMFit<InitialClusteringType, CovarianceConstraintPolicy>::Estimate(
 
     iteration++;
   }
+
+  Counter::Add("em_fit/iterations", iteration - 1);
 }
 
-template<typename InitialClusteringType, typename CovarianceConstraintPolicy>
-void EMFit<InitialClusteringType, CovarianceConstraintPolicy>::Estimate(
-    const arma::mat& observations,
-    const arma::vec& probabilities,
-    std::vector<distribution::GaussianDistribution>& dists,
-    arma::vec& weights,
-    const bool useInitialModel)
+template<typename InitialClusteringType,
+         typename CovarianceConstraintPolicy,
+         typename Distribution>
+void EMFit<InitialClusteringType, CovarianceConstraintPolicy, Distribution>::
+Estimate(const arma::mat& observations,
+         const arma::vec& probabilities,
+         std::vector<Distribution>& dists,
+         arma::vec& weights,
+         const bool useInitialModel)
 {
   if (!useInitialModel)
     InitialClustering(observations, dists, weights);
@@ -156,24 +141,7 @@ void EMFit<InitialClusteringType, CovarianceConstraintPolicy>::Estimate(
   {
     // Calculate the conditional probabilities of choosing a particular
     // Gaussian given the observations and the present theta value.
-    for (size_t i = 0; i < dists.size(); i++)
-    {
-      // Store conditional probabilities into condProb vector for each
-      // Gaussian.  First we make an alias of the condProb vector.
-      arma::vec condProbAlias = condProb.unsafe_col(i);
-      dists[i].Probability(observations, condProbAlias);
-      condProbAlias *= weights[i];
-    }
-
-    // Normalize row-wise.
-    for (size_t i = 0; i < condProb.n_rows; i++)
-    {
-      // Avoid dividing by zero; if the probability for everything is 0, we
-      // don't want to make it NaN.
-      const double probSum = accu(condProb.row(i));
-      if (probSum != 0.0)
-        condProb.row(i) /= probSum;
-    }
+    ConditionalProbabilities(observations, dists, weights, condProb);
 
     // This will store the sum of probabilities of each state over all the
     // observations.
@@ -187,24 +155,15 @@ void EMFit<InitialClusteringType, CovarianceConstraintPolicy>::Estimate(
       // conditional probability of each point being from Gaussian i
       // multiplied by the probability of the point being from this mixture
       // model.
-      probRowSums[i] = accu(condProb.col(i) % probabilities);
+      const arma::vec pointWeights = condProb.col(i) % probabilities;
+      probRowSums[i] = accu(pointWeights);
 
-      dists[i].Mean() = (observations * (condProb.col(i) % probabilities)) /
-        probRowSums[i];
+      dists[i].Mean() = (observations * pointWeights) / probRowSums[i];
 
       // Calculate the new value of the covariances using the updated
       // conditional probabilities and the updated means.
-      arma::mat tmp = observations - (dists[i].Mean() *
-          arma::ones<arma::rowvec>(observations.n_cols));
-      arma::mat tmpB = tmp % (arma::ones<arma::vec>(observations.n_rows) *
-          trans(condProb.col(i) % probabilities));
-
-      arma::mat cov = (tmp * trans(tmpB)) / probRowSums[i];
-
-      // Apply covariance constraint.
-      constraint.ApplyConstraint(cov);
-
-      dists[i].Covariance(std::move(cov));
+      const arma::mat diffs = observations.each_col() - dists[i].Mean();
+      UpdateCovariance(dists[i], diffs, pointWeights, probRowSums[i]);
     }
 
     // Calculate the new values for omega using the updated conditional
@@ -217,12 +176,49 @@ void EMFit<InitialClusteringType, CovarianceConstraintPolicy>::Estimate(
 
     iteration++;
   }
+
+  Counter::Add("em_fit/iterations", iteration - 1);
 }
 
-template<typename InitialClusteringType, typename CovarianceConstraintPolicy>
-void EMFit<InitialClusteringType, CovarianceConstraintPolicy>::
+template<typename InitialClusteringType,
+         typename CovarianceConstraintPolicy,
+         typename Distribution>
+void EMFit<InitialClusteringType, CovarianceConstraintPolicy, Distribution>::
+ConditionalProbabilities(const arma::mat& observations,
+                         const std::vector<Distribution>& dists,
+                         const arma::vec& weights,
+                         arma::mat& condProb) const
+{
+  // Store the log-probabilities of each weighted Gaussian into condProb.  In
+  // high dimensions the probabilities themselves underflow to 0.
+  for (size_t i = 0; i < dists.size(); i++)
+  {
+    // First we make an alias of the condProb vector.
+    arma::vec condProbAlias = condProb.unsafe_col(i);
+    dists[i].LogProbability(observations, condProbAlias);
+    condProbAlias += std::log(weights[i]);
+  }
+
+  // Normalize row-wise in log space; only the normalized probabilities are
+  // exponentiated.
+  for (size_t i = 0; i < condProb.n_rows; i++)
+  {
+    // Avoid dividing by zero; if the probability for everything is 0, we
+    // don't want to make it NaN.
+    const double logProbSum = math::AccuLog(condProb.row(i));
+    if (logProbSum == -std::numeric_limits<double>::infinity())
+      condProb.row(i).zeros();
+    else
+      condProb.row(i) = arma::exp(condProb.row(i) - logProbSum);
+  }
+}
+
+template<typename InitialClusteringType,
+         typename CovarianceConstraintPolicy,
+         typename Distribution>
+void EMFit<InitialClusteringType, CovarianceConstraintPolicy, Distribution>::
 InitialClustering(const arma::mat& observations,
-                  std::vector<distribution::GaussianDistribution>& dists,
+                  std::vector<Distribution>& dists,
                   arma::vec& weights)
 {
   // Assignments from clustering.
@@ -232,18 +228,13 @@ InitialClustering(const arma::mat& observations,
   clusterer.Cluster(observations, dists.size(), assignments);
 
   std::vector<arma::vec> means(dists.size());
-  std::vector<arma::mat> covs(dists.size());
 
-  // Now calculate the means, covariances, and weights.
+  // Now calculate the means and weights.
   weights.zeros();
   for (size_t i = 0; i < dists.size(); ++i)
-  {
     means[i].zeros(dists[i].Mean().n_elem);
-    covs[i].zeros(dists[i].Covariance().n_rows,
-                  dists[i].Covariance().n_cols);
-  }
 
-  // From the assignments, generate our means, covariances, and weights.
+  // From the assignments, generate our means and weights.
   for (size_t i = 0; i < observations.n_cols; ++i)
   {
     const size_t cluster = assignments[i];
@@ -251,74 +242,165 @@ InitialClustering(const arma::mat& observations,
     // Add this to the relevant mean.
     means[cluster] += observations.col(i);
 
-    // Add this to the relevant covariance.
-    covs[cluster] += observations.col(i) * trans(observations.col(i));
-
     // Now add one to the weights (we will normalize).
     weights[cluster]++;
   }
 
-  // Now normalize the mean and covariance.
+  // Now normalize the mean.
   for (size_t i = 0; i < dists.size(); ++i)
   {
     means[i] /= (weights[i] > 1) ? weights[i] : 1;
+    std::swap(dists[i].Mean(), means[i]);
+  }
+
+  // Compute the covariances around the new means.
+  InitialCovariances(observations, assignments, weights, dists);
+
+  // Finally, normalize weights.
+  weights /= accu(weights);
+}
+
+template<typename InitialClusteringType,
+         typename CovarianceConstraintPolicy,
+         typename Distribution>
+void EMFit<InitialClusteringType, CovarianceConstraintPolicy, Distribution>::
+InitialCovariances(const arma::mat& observations,
+                   const arma::Row<size_t>& assignments,
+                   const arma::vec& counts,
+                   std::vector<distribution::GaussianDistribution>& dists)
+{
+  std::vector<arma::mat> covs(dists.size());
+  for (size_t i = 0; i < dists.size(); ++i)
+  {
+    covs[i].zeros(dists[i].Covariance().n_rows,
+                  dists[i].Covariance().n_cols);
   }
 
   for (size_t i = 0; i < observations.n_cols; ++i)
   {
     const size_t cluster = assignments[i];
-    const arma::vec normObs = observations.col(i) - means[cluster];
+
+    // Add this to the relevant covariance.
+    covs[cluster] += observations.col(i) * trans(observations.col(i));
+
+    const arma::vec normObs = observations.col(i) - dists[cluster].Mean();
     covs[cluster] += normObs * normObs.t();
   }
 
   for (size_t i = 0; i < dists.size(); ++i)
   {
-    covs[i] /= (weights[i] > 1) ? weights[i] : 1;
+    covs[i] /= (counts[i] > 1) ? counts[i] : 1;
 
     // Apply constraints to covariance matrix.
     constraint.ApplyConstraint(covs[i]);
 
-    std::swap(dists[i].Mean(), means[i]);
     dists[i].Covariance(std::move(covs[i]));
   }
-
-  // Finally, normalize weights.
-  weights /= accu(weights);
 }
 
-template<typename InitialClusteringType, typename CovarianceConstraintPolicy>
-double EMFit<InitialClusteringType, CovarianceConstraintPolicy>::LogLikelihood(
+template<typename InitialClusteringType,
+         typename CovarianceConstraintPolicy,
+         typename Distribution>
+void EMFit<InitialClusteringType, CovarianceConstraintPolicy, Distribution>::
+InitialCovariances(
     const arma::mat& observations,
-    const std::vector<distribution::GaussianDistribution>& dists,
-    const arma::vec& weights) const
+    const arma::Row<size_t>& assignments,
+    const arma::vec& counts,
+    std::vector<distribution::DiagonalGaussianDistribution>& dists)
 {
-  double logLikelihood = 0;
+  std::vector<arma::vec> covs(dists.size());
+  for (size_t i = 0; i < dists.size(); ++i)
+    covs[i].zeros(dists[i].Mean().n_elem);
 
+  for (size_t i = 0; i < observations.n_cols; ++i)
+  {
+    const size_t cluster = assignments[i];
+    covs[cluster] += arma::square(observations.col(i) -
+        dists[cluster].Mean());
+  }
+
+  for (size_t i = 0; i < dists.size(); ++i)
+  {
+    covs[i] /= (counts[i] > 1) ? counts[i] : 1;
+
+    // Apply constraints to the variances.
+    constraint.ApplyConstraint(covs[i]);
+
+    dists[i].Covariance(std::move(covs[i]));
+  }
+}
+
+template<typename InitialClusteringType,
+         typename CovarianceConstraintPolicy,
+         typename Distribution>
+void EMFit<InitialClusteringType, CovarianceConstraintPolicy, Distribution>::
+UpdateCovariance(distribution::GaussianDistribution& dist,
+                 const arma::mat& diffs,
+                 const arma::vec& pointWeights,
+                 const double weightSum)
+{
+  const arma::mat weightedDiffs = diffs.each_row() % trans(pointWeights);
+  arma::mat covariance = (diffs * trans(weightedDiffs)) / weightSum;
+
+  // Apply covariance constraint.
+  constraint.ApplyConstraint(covariance);
+  dist.Covariance(std::move(covariance));
+}
+
+template<typename InitialClusteringType,
+         typename CovarianceConstraintPolicy,
+         typename Distribution>
+void EMFit<InitialClusteringType, CovarianceConstraintPolicy, Distribution>::
+UpdateCovariance(distribution::DiagonalGaussianDistribution& dist,
+                 const arma::mat& diffs,
+                 const arma::vec& pointWeights,
+                 const double weightSum)
+{
+  // Only the diagonal of (diffs * diag(pointWeights) * diffs^T) is needed.
+  arma::vec covariance = (arma::square(diffs) * pointWeights) / weightSum;
+
+  // Apply covariance constraint.
+  constraint.ApplyConstraint(covariance);
+  dist.Covariance(std::move(covariance));
+}
+
+template<typename InitialClusteringType,
+         typename CovarianceConstraintPolicy,
+         typename Distribution>
+double EMFit<InitialClusteringType, CovarianceConstraintPolicy, Distribution>::
+LogLikelihood(const arma::mat& observations,
+              const std::vector<Distribution>& dists,
+              const arma::vec& weights) const
+{
   arma::vec phis;
-  arma::mat likelihoods(dists.size(), observations.n_cols);
+  arma::mat logLikelihoods(dists.size(), observations.n_cols);
 
   for (size_t i = 0; i < dists.size(); ++i)
   {
-    dists[i].Probability(observations, phis);
-    likelihoods.row(i) = weights(i) * trans(phis);
+    dists[i].LogProbability(observations, phis);
+    logLikelihoods.row(i) = std::log(weights(i)) + trans(phis);
   }
-  // Now sum over every point.
+
+  // Now sum over every component in log space, so that the likelihood of a
+  // point does not underflow.
+  arma::vec pointLogLikelihoods;
+  math::LogSumExp(logLikelihoods, pointLogLikelihoods);
   for (size_t j = 0; j < observations.n_cols; ++j)
   {
-    if (accu(likelihoods.col(j)) == 0)
+    if (pointLogLikelihoods[j] == -std::numeric_limits<double>::infinity())
       Log::Info << "Likelihood of point " << j << " is 0!  It is probably an "
           << "outlier." << std::endl;
-    logLikelihood += log(accu(likelihoods.col(j)));
   }
 
-  return logLikelihood;
+  return arma::accu(pointLogLikelihoods);
 }
 
-template<typename InitialClusteringType, typename CovarianceConstraintPolicy>
+template<typename InitialClusteringType,
+         typename CovarianceConstraintPolicy,
+         typename Distribution>
 template<typename Archive>
-void EMFit<InitialClusteringType, CovarianceConstraintPolicy>::serialize(
-    Archive& ar,
-    const unsigned int /* version */)
+void EMFit<InitialClusteringType, CovarianceConstraintPolicy, Distribution>::
+serialize(Archive& ar, const unsigned int /* version */)
 {
   ar & BOOST_SERIALIZATION_NVP(maxIterations);
   ar & BOOST_SERIALIZATION_NVP(tolerance);
@@ -329,10 +411,12 @@ void EMFit<InitialClusteringType, CovarianceConstraintPolicy>::serialize(
 // Armadillo uses uword internally as an OpenMP index type, which crashes Visual
 // Studio.
 #ifndef _WIN32
-template<typename InitialClusteringType, typename CovarianceConstraintPolicy>
-void EMFit<InitialClusteringType, CovarianceConstraintPolicy>::
+template<typename InitialClusteringType,
+         typename CovarianceConstraintPolicy,
+         typename Distribution>
+void EMFit<InitialClusteringType, CovarianceConstraintPolicy, Distribution>::
 ArmadilloGMMWrapper(const arma::mat& observations,
-                    std::vector<distribution::GaussianDistribution>& dists,
+                    std::vector<Distribution>& dists,
                     arma::vec& weights,
                     const bool useInitialModel)
 {
@@ -361,7 +445,7 @@ ArmadilloGMMWrapper(const arma::mat& observations,
     for (size_t i = 0; i < dists.size(); ++i)
     {
       means.col(i) = dists[i].Mean();
-      covs.col(i) = dists[i].Covariance().diag();
+      covs.col(i) = DiagonalCovariance(dists[i]);
     }
 
     g.reset(observations.n_rows, dists.size());
@@ -383,7 +467,7 @@ ArmadilloGMMWrapper(const arma::mat& observations,
   for (size_t i = 0; i < dists.size(); ++i)
   {
     dists[i].Mean() = g.means.col(i);
-    dists[i].Covariance(std::move(arma::diagmat(g.dcovs.col(i))));
+    DiagonalCovariance(dists[i], g.dcovs.col(i));
   }
 }
 #endif
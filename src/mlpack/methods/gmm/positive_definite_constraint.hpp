@@ -62,6 +62,23 @@ class PositiveDefiniteConstraint
     }
   }
 
+  /**
+   * Apply the positive definiteness constraint to the given diagonal
+   * covariance, given as the vector of its diagonal elements.  The same
+   * conditions as for the full covariance are enforced.
+   *
+   * @param diagCovariance Diagonal elements of the covariance matrix.
+   */
+  static void ApplyConstraint(arma::vec& diagCovariance)
+  {
+    // The eigenvalues of a diagonal matrix are its diagonal elements, so we
+    // can project them directly.  Clamping has no effect if the matrix already
+    // satisfies the constraints.
+    const double maxEigval = diagCovariance.max();
+    const double minEigval = std::max(maxEigval / 1e5, 1e-50);
+    diagCovariance = arma::clamp(diagCovariance, minEigval, DBL_MAX);
+  }
+
   //! Serialize the constraint (which stores nothing, so, nothing to do).
   template<typename Archive>
   static void serialize(Archive& /* ar */, const unsigned int /* version */) { }
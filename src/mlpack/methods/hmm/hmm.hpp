@@ -164,6 +164,9 @@ class HMM
    * for training.
    * @endnote
    *
+   * If OpenMP is available, the expectation step of each iteration is run on
+   * several sequences in parallel.
+   *
    * @param dataSeq Vector of observation sequences.
    */
   void Train(const std::vector<arma::mat>& dataSeq);
@@ -207,7 +210,10 @@ class HMM
    * @param backwardProb Matrix in which the backward probabilities of each
    *    state at each time interval will be stored.
    * @param scales Vector in which the scaling factors at each time interval
-   *    will be stored.
+   *    (the marginal probability of each observation) will be stored.  They
+   *    are computed in log space, but a probability that does not fit into a
+   *    double is stored as 0 or infinity; the returned log-likelihood is
+   *    always computed in log space.
    * @return Log-likelihood of most likely state sequence.
    */
   double Estimate(const arma::mat& dataSeq,
@@ -259,6 +265,21 @@ class HMM
   double Predict(const arma::mat& dataSeq,
                  arma::Row<size_t>& stateSeq) const;
 
+  /**
+   * Compute the most probable hidden state sequence for each of the given data
+   * sequences, using the Viterbi algorithm.  If OpenMP is available, the
+   * sequences are processed in parallel.
+   *
+   * @param dataSeq Vector of observation sequences.
+   * @param stateSeq Vector in which the most probable state sequence of each
+   *    observation sequence will be stored.
+   * @param logLikelihoods Vector in which the log-likelihood of each most
+   *    probable state sequence will be stored.
+   */
+  void Predict(const std::vector<arma::mat>& dataSeq,
+               std::vector<arma::Row<size_t> >& stateSeq,
+               arma::vec& logLikelihoods) const;
+
   /**
    * Compute the log-likelihood of the given data sequence.
    *
@@ -267,6 +288,17 @@ class HMM
    */
   double LogLikelihood(const arma::mat& dataSeq) const;
 
+  /**
+   * Compute the log-likelihood of each of the given data sequences.  If OpenMP
+   * is available, the sequences are processed in parallel.
+   *
+   * @param dataSeq Vector of data sequences to evaluate the likelihood of.
+   * @param logLikelihoods Vector in which the log-likelihood of each sequence
+   *    will be stored.
+   */
+  void LogLikelihood(const std::vector<arma::mat>& dataSeq,
+                     arma::vec& logLikelihoods) const;
+
   /**
    * HMM filtering. Computes the k-step-ahead expected emission at each time
    * conditioned only on prior observations. That is
@@ -337,11 +369,12 @@ class HMM
    * states and columns equal to the number of observations.
    *
    * @param dataSeq Data sequence to compute probabilities for.
-   * @param scales Vector in which scaling factors will be saved.
+   * @param logScales Vector in which the log of the scaling factors (the
+   *    marginal probability of each observation) will be saved.
    * @param forwardProb Matrix in which forward probabilities will be saved.
    */
   void Forward(const arma::mat& dataSeq,
-               arma::vec& scales,
+               arma::vec& logScales,
                arma::mat& forwardProb) const;
 
   /**
@@ -352,13 +385,64 @@ class HMM
    * columns equal to the number of observations.
    *
    * @param dataSeq Data sequence to compute probabilities for.
-   * @param scales Vector of scaling factors.
+   * @param logScales Vector of the log of the scaling factors.
    * @param backwardProb Matrix in which backward probabilities will be saved.
    */
   void Backward(const arma::mat& dataSeq,
-                const arma::vec& scales,
+                const arma::vec& logScales,
                 arma::mat& backwardProb) const;
 
+  /**
+   * Compute the log-probability of each observation in the given data sequence
+   * under each emission distribution.  The returned matrix has rows equal to
+   * the number of hidden states and columns equal to the number of
+   * observations.
+   *
+   * @param dataSeq Data sequence to compute probabilities for.
+   * @param logProb Matrix in which log-probabilities will be saved.
+   */
+  void EmissionLogProbability(const arma::mat& dataSeq,
+                              arma::mat& logProb) const;
+
+  /**
+   * Compute the probability of each observation in the given data sequence
+   * under each emission distribution.  To avoid underflow, each column is
+   * divided by its largest probability; the log of that factor is stored in
+   * logEmissionScales.
+   *
+   * @param dataSeq Data sequence to compute probabilities for.
+   * @param emissionProb Matrix in which scaled probabilities will be saved.
+   * @param logEmissionScales Vector in which the log of the factor removed
+   *    from each observation will be saved.
+   */
+  void EmissionProbability(const arma::mat& dataSeq,
+                           arma::mat& emissionProb,
+                           arma::vec& logEmissionScales) const;
+
+  /**
+   * Run the Forward algorithm on the given (scaled) emission probabilities, as
+   * computed by EmissionProbability().
+   *
+   * @param emissionProb Scaled emission probabilities of each observation.
+   * @param scales Vector in which scaling factors will be saved.
+   * @param forwardProb Matrix in which forward probabilities will be saved.
+   */
+  void ForwardPass(const arma::mat& emissionProb,
+                   arma::vec& scales,
+                   arma::mat& forwardProb) const;
+
+  /**
+   * Run the Backward algorithm on the given (scaled) emission probabilities,
+   * using the scaling factors found by ForwardPass().
+   *
+   * @param emissionProb Scaled emission probabilities of each observation.
+   * @param scales Vector of scaling factors.
+   * @param backwardProb Matrix in which backward probabilities will be saved.
+   */
+  void BackwardPass(const arma::mat& emissionProb,
+                    const arma::vec& scales,
+                    arma::mat& backwardProb) const;
+
   //! Set of emission probability distributions; one for each state.
   std::vector<Distribution> emission;
 
@@ -17,9 +17,60 @@
 // Just in case...
 #include "hmm.hpp"
 
+#include <mlpack/core/util/sfinae_utility.hpp>
+
 namespace mlpack {
 namespace hmm {
 
+/**
+ * This gives us a HasBatchLogProbabilityCheck object that can be used to tell
+ * whether a distribution can compute the log-probabilities of a whole matrix
+ * of observations at once.
+ */
+HAS_MEM_FUNC(LogProbability, HasBatchLogProbabilityCheck);
+
+/**
+ * 'value' is true if the Distribution class has a member
+ * LogProbability(const arma::mat& observations, arma::vec& logProbabilities).
+ */
+template<typename Distribution>
+struct HasBatchLogProbability
+{
+  static const bool value = HasBatchLogProbabilityCheck<Distribution,
+      void(Distribution::*)(const arma::mat&, arma::vec&) const>::value;
+};
+
+//! Compute the log-probability of each observation with the distribution's
+//! own batch LogProbability() function.
+template<typename Distribution>
+void DistributionLogProbability(
+    const Distribution& distribution,
+    const arma::mat& observations,
+    arma::vec& logProbabilities,
+    const typename std::enable_if<
+        HasBatchLogProbability<Distribution>::value>::type* = 0)
+{
+  distribution.LogProbability(observations, logProbabilities);
+}
+
+//! Compute the log-probability of each observation one point at a time, for
+//! distributions that cannot evaluate a matrix of observations at once.
+template<typename Distribution>
+void DistributionLogProbability(
+    const Distribution& distribution,
+    const arma::mat& observations,
+    arma::vec& logProbabilities,
+    const typename std::enable_if<
+        !HasBatchLogProbability<Distribution>::value>::type* = 0)
+{
+  logProbabilities.set_size(observations.n_cols);
+  for (size_t i = 0; i < observations.n_cols; ++i)
+  {
+    logProbabilities[i] =
+        std::log(distribution.Probability(observations.unsafe_col(i)));
+  }
+}
+
 /**
  * Create the Hidden Markov Model with the given number of hidden states and the
  * given number of emission states.
@@ -109,6 +160,12 @@ void HMM<Distribution>::Train(const std::vector<arma::mat>& dataSeq)
       arma::vec(totalLength));
   arma::mat emissionList(dimensionality, totalLength);
 
+  // The offset of each sequence into emissionList and emissionProb, so that
+  // sequences can be processed in any order.
+  std::vector<size_t> offsets(dataSeq.size(), 0);
+  for (size_t seq = 1; seq < dataSeq.size(); seq++)
+    offsets[seq] = offsets[seq - 1] + dataSeq[seq - 1].n_cols;
+
   // This should be the Baum-Welch algorithm (EM for HMM estimation). This
   // follows the procedure outlined in Elliot, Aggoun, and Moore's book "Hidden
   // Markov Models: Estimation and Control", pp. 36-40.
@@ -123,49 +180,70 @@ void HMM<Distribution>::Train(const std::vector<arma::mat>& dataSeq)
     // Reset log likelihood.
     loglik = 0;
 
-    // Sum over time.
-    size_t sumTime = 0;
-
-    // Loop over each sequence.
-    for (size_t seq = 0; seq < dataSeq.size(); seq++)
+    // The E-step of each sequence is independent of the others, so sequences
+    // are processed in parallel.  Each thread accumulates its own expected
+    // counts, and these are combined once the thread is done.
+    #pragma omp parallel
     {
-      arma::mat stateProb;
-      arma::mat forward;
-      arma::mat backward;
-      arma::vec scales;
-
-      // Add the log-likelihood of this sequence.  This is the E-step.
-      loglik += Estimate(dataSeq[seq], stateProb, forward, backward, scales);
-
-      // Add to estimate of initial probability for state j.
-      for (size_t j = 0; j < transition.n_cols; ++j)
-        newInitial[j] += stateProb(j, 0);
-
-      // Now re-estimate the parameters.  This is the M-step.
-      //   pi_i = sum_d ((1 / P(seq[d])) sum_t (f(i, 0) b(i, 0))
-      //   T_ij = sum_d ((1 / P(seq[d])) sum_t (f(i, t) T_ij E_i(seq[d][t]) b(i,
-      //           t + 1)))
-      //   E_ij = sum_d ((1 / P(seq[d])) sum_{t | seq[d][t] = j} f(i, t) b(i, t)
-      // We store the new estimates in a different matrix.
-      for (size_t t = 0; t < dataSeq[seq].n_cols; ++t)
+      arma::vec threadInitial(transition.n_rows, arma::fill::zeros);
+      arma::mat threadTransition(transition.n_rows, transition.n_cols,
+          arma::fill::zeros);
+      double threadLoglik = 0;
+
+      #pragma omp for schedule(dynamic)
+      for (omp_size_t seq = 0; seq < (omp_size_t) dataSeq.size(); seq++)
       {
+        const size_t length = dataSeq[seq].n_cols;
+        const size_t offset = offsets[seq];
+
+        arma::mat seqEmissionProb;
+        arma::vec logEmissionScales;
+        arma::mat forward;
+        arma::mat backward;
+        arma::vec scales;
+
+        // Add the log-likelihood of this sequence.  This is the E-step.
+        EmissionProbability(dataSeq[seq], seqEmissionProb, logEmissionScales);
+        ForwardPass(seqEmissionProb, scales, forward);
+        BackwardPass(seqEmissionProb, scales, backward);
+        const arma::mat stateProb = forward % backward;
+        threadLoglik += accu(log(scales)) + accu(logEmissionScales);
+
+        // Add to estimate of initial probability for state j.
+        threadInitial += stateProb.col(0);
+
+        // Now re-estimate the parameters.  This is the M-step.
+        //   pi_i = sum_d ((1 / P(seq[d])) sum_t (f(i, 0) b(i, 0))
+        //   T_ij = sum_d ((1 / P(seq[d])) sum_t (f(i, t) T_ij E_i(seq[d][t])
+        //           b(i, t + 1)))
+        //   E_ij = sum_d ((1 / P(seq[d])) sum_{t | seq[d][t] = j} f(i, t)
+        //           b(i, t)
+        // The sum over t for T_ij is a single matrix product.  We postpone
+        // multiplication of the old T_ij until later.
+        if (length > 1)
+        {
+          arma::mat weightedBackward = backward.cols(1, length - 1) %
+              seqEmissionProb.cols(1, length - 1);
+          weightedBackward.each_row() /= trans(scales.subvec(1, length - 1));
+          threadTransition += weightedBackward *
+              trans(forward.cols(0, length - 2));
+        }
+
+        // Add to list of emission observations, for Distribution::Train().
+        // Each sequence writes to its own range, so no locking is needed.
+        emissionList.cols(offset, offset + length - 1) = dataSeq[seq];
         for (size_t j = 0; j < transition.n_cols; ++j)
         {
-          if (t < dataSeq[seq].n_cols - 1)
-          {
-            // Estimate of T_ij (probability of transition from state j to state
-            // i).  We postpone multiplication of the old T_ij until later.
-            for (size_t i = 0; i < transition.n_rows; i++)
-              newTransition(i, j) += forward(j, t) * backward(i, t + 1) *
-                  emission[i].Probability(dataSeq[seq].unsafe_col(t + 1)) /
-                  scales[t + 1];
-          }
-
-          // Add to list of emission observations, for Distribution::Train().
-          emissionList.col(sumTime) = dataSeq[seq].col(t);
-          emissionProb[j][sumTime] = stateProb(j, t);
+          emissionProb[j].subvec(offset, offset + length - 1) =
+              trans(stateProb.row(j));
         }
-        sumTime++;
+      }
+
+      #pragma omp critical
+      {
+        newInitial += threadInitial;
+        newTransition += threadTransition;
+        loglik += threadLoglik;
       }
     }
 
@@ -314,16 +392,30 @@ double HMM<Distribution>::Estimate(const arma::mat& dataSeq,
                                    arma::mat& backwardProb,
                                    arma::vec& scales) const
 {
+  // The emission probabilities are computed once and shared by both passes.
+  arma::mat emissionProb;
+  arma::vec logEmissionScales;
+  EmissionProbability(dataSeq, emissionProb, logEmissionScales);
+
   // First run the forward-backward algorithm.
-  Forward(dataSeq, scales, forwardProb);
-  Backward(dataSeq, scales, backwardProb);
+  ForwardPass(emissionProb, scales, forwardProb);
+  BackwardPass(emissionProb, scales, backwardProb);
 
   // Now assemble the state probability matrix based on the forward and backward
   // probabilities.
   stateProb = forwardProb % backwardProb;
 
-  // Finally assemble the log-likelihood and return it.
-  return accu(log(scales));
+  // Assemble the log-likelihood in log space, since the product of the scales
+  // may underflow for long or high-dimensional sequences.
+  const arma::vec logScales = log(scales) + logEmissionScales;
+
+  // Return the scales as the marginal probability of each observation.  The
+  // factors removed from the emission probabilities are folded in in log
+  // space, so the scales only leave the range of a double if the marginal
+  // probability itself does.
+  scales = arma::exp(logScales);
+
+  return accu(logScales);
 }
 
 /**
@@ -400,9 +492,8 @@ double HMM<Distribution>::Predict(const arma::mat& dataSeq,
                                   arma::Row<size_t>& stateSeq) const
 {
   // This is an implementation of the Viterbi algorithm for finding the most
-  // probable sequence of states to produce the observed data sequence.  We
-  // don't use log-likelihoods to save that little bit of time, but we'll
-  // calculate the log-likelihood at the end of it all.
+  // probable sequence of states to produce the observed data sequence.  All
+  // computation is done in log space.
   stateSeq.set_size(dataSeq.n_cols);
   arma::mat logStateProb(transition.n_rows, dataSeq.n_cols);
   arma::mat stateSeqBack(transition.n_rows, dataSeq.n_cols);
@@ -411,16 +502,17 @@ double HMM<Distribution>::Predict(const arma::mat& dataSeq,
   // will be using the rows of the transition matrix.
   arma::mat logTrans(log(trans(transition)));
 
+  // Compute the log-probability of every observation under every emission
+  // distribution up front.
+  arma::mat logEmission;
+  EmissionLogProbability(dataSeq, logEmission);
+
   // The calculation of the first state is slightly different; the probability
   // of the first state being state j is the maximum probability that the state
   // came to be j from another state.
-  logStateProb.col(0).zeros();
+  logStateProb.col(0) = log(initial) + logEmission.col(0);
   for (size_t state = 0; state < transition.n_rows; state++)
-  {
-    logStateProb(state, 0) = log(initial[state] *
-        emission[state].Probability(dataSeq.unsafe_col(0)));
     stateSeqBack(state, 0) = state;
-  }
 
   // Store the best first state.
   arma::uword index;
@@ -432,9 +524,8 @@ double HMM<Distribution>::Predict(const arma::mat& dataSeq,
     for (size_t j = 0; j < transition.n_rows; j++)
     {
       arma::vec prob = logStateProb.col(t - 1) + logTrans.col(j);
-      logStateProb(j, t) = prob.max(index) +
-          log(emission[j].Probability(dataSeq.unsafe_col(t)));
-        stateSeqBack(j, t) = index;
+      logStateProb(j, t) = prob.max(index) + logEmission(j, t);
+      stateSeqBack(j, t) = index;
     }
   }
 
@@ -448,19 +539,54 @@ double HMM<Distribution>::Predict(const arma::mat& dataSeq,
   return logStateProb(stateSeq(dataSeq.n_cols - 1), dataSeq.n_cols - 1);
 }
 
+/**
+ * Compute the most probable hidden state sequence for each of the given
+ * observation sequences, in parallel.
+ */
+template<typename Distribution>
+void HMM<Distribution>::Predict(const std::vector<arma::mat>& dataSeq,
+                                std::vector<arma::Row<size_t> >& stateSeq,
+                                arma::vec& logLikelihoods) const
+{
+  stateSeq.resize(dataSeq.size());
+  logLikelihoods.set_size(dataSeq.size());
+
+  #pragma omp parallel for schedule(dynamic)
+  for (omp_size_t i = 0; i < (omp_size_t) dataSeq.size(); ++i)
+    logLikelihoods[i] = Predict(dataSeq[i], stateSeq[i]);
+}
+
 /**
  * Compute the log-likelihood of the given data sequence.
  */
 template<typename Distribution>
 double HMM<Distribution>::LogLikelihood(const arma::mat& dataSeq) const
 {
+  arma::mat emissionProb;
+  arma::vec logEmissionScales;
+  EmissionProbability(dataSeq, emissionProb, logEmissionScales);
+
   arma::mat forward;
   arma::vec scales;
+  ForwardPass(emissionProb, scales, forward);
+
+  // The log-likelihood is the log of the scales for each time step, plus the
+  // log of the factors that were removed from the emission probabilities.
+  return accu(log(scales)) + accu(logEmissionScales);
+}
 
-  Forward(dataSeq, scales, forward);
+/**
+ * Compute the log-likelihood of each of the given data sequences, in parallel.
+ */
+template<typename Distribution>
+void HMM<Distribution>::LogLikelihood(const std::vector<arma::mat>& dataSeq,
+                                      arma::vec& logLikelihoods) const
+{
+  logLikelihoods.set_size(dataSeq.size());
 
-  // The log-likelihood is the log of the scales for each time step.
-  return accu(log(scales));
+  #pragma omp parallel for schedule(dynamic)
+  for (omp_size_t i = 0; i < (omp_size_t) dataSeq.size(); ++i)
+    logLikelihoods[i] = LogLikelihood(dataSeq[i]);
 }
 
 /**
@@ -473,8 +599,8 @@ void HMM<Distribution>::Filter(const arma::mat& dataSeq,
 {
   // First run the forward algorithm.
   arma::mat forwardProb;
-  arma::vec scales;
-  Forward(dataSeq, scales, forwardProb);
+  arma::vec logScales;
+  Forward(dataSeq, logScales, forwardProb);
 
   // Propagate state ahead.
   if (ahead != 0)
@@ -510,40 +636,115 @@ void HMM<Distribution>::Smooth(const arma::mat& dataSeq,
  */
 template<typename Distribution>
 void HMM<Distribution>::Forward(const arma::mat& dataSeq,
-                                arma::vec& scales,
+                                arma::vec& logScales,
                                 arma::mat& forwardProb) const
+{
+  arma::mat emissionProb;
+  arma::vec logEmissionScales;
+  EmissionProbability(dataSeq, emissionProb, logEmissionScales);
+
+  arma::vec scales;
+  ForwardPass(emissionProb, scales, forwardProb);
+
+  // Return the log of the marginal probability of each observation; the
+  // probability itself may not fit into a double.
+  logScales = log(scales) + logEmissionScales;
+}
+
+/**
+ * The Backward procedure (part of the Forward-Backward algorithm).
+ */
+template<typename Distribution>
+void HMM<Distribution>::Backward(const arma::mat& dataSeq,
+                                 const arma::vec& logScales,
+                                 arma::mat& backwardProb) const
+{
+  arma::mat emissionProb;
+  arma::vec logEmissionScales;
+  EmissionProbability(dataSeq, emissionProb, logEmissionScales);
+
+  // The given scales include the factors that were removed from the emission
+  // probabilities, so take them back out before leaving log space; the
+  // remaining scales are at most 1.
+  BackwardPass(emissionProb, arma::exp(logScales - logEmissionScales),
+      backwardProb);
+}
+
+/**
+ * Compute the log-probability of each observation under each emission
+ * distribution.
+ */
+template<typename Distribution>
+void HMM<Distribution>::EmissionLogProbability(const arma::mat& dataSeq,
+                                               arma::mat& logProb) const
+{
+  logProb.set_size(transition.n_rows, dataSeq.n_cols);
+
+  arma::vec stateLogProb;
+  for (size_t state = 0; state < transition.n_rows; state++)
+  {
+    DistributionLogProbability(emission[state], dataSeq, stateLogProb);
+    logProb.row(state) = trans(stateLogProb);
+  }
+}
+
+/**
+ * Compute the emission probabilities of each observation, scaled so that the
+ * largest probability of each observation is 1.
+ */
+template<typename Distribution>
+void HMM<Distribution>::EmissionProbability(const arma::mat& dataSeq,
+                                            arma::mat& emissionProb,
+                                            arma::vec& logEmissionScales) const
+{
+  EmissionLogProbability(dataSeq, emissionProb);
+
+  // Subtract the maximum log-probability of each observation before leaving
+  // log space, so that the emission probabilities of high-dimensional
+  // observations do not underflow.  If no state can emit an observation, its
+  // column is left as-is and will be all zeros.
+  logEmissionScales = trans(arma::max(emissionProb, 0));
+  logEmissionScales.elem(arma::find_nonfinite(logEmissionScales)).zeros();
+
+  emissionProb.each_row() -= trans(logEmissionScales);
+  emissionProb = arma::exp(emissionProb);
+}
+
+/**
+ * The forward pass of the Forward-Backward algorithm, given the emission
+ * probabilities of each observation.
+ */
+template<typename Distribution>
+void HMM<Distribution>::ForwardPass(const arma::mat& emissionProb,
+                                    arma::vec& scales,
+                                    arma::mat& forwardProb) const
 {
   // Our goal is to calculate the forward probabilities:
   //  P(X_k | o_{1:k}) for all possible states X_k, for each time point k.
-  forwardProb.zeros(transition.n_rows, dataSeq.n_cols);
-  scales.zeros(dataSeq.n_cols);
+  forwardProb.zeros(transition.n_rows, emissionProb.n_cols);
+  scales.zeros(emissionProb.n_cols);
 
   // The first entry in the forward algorithm uses the initial state
   // probabilities.  Note that MATLAB assumes that the starting state (at
   // t = -1) is state 0; this is not our assumption here.  To force that
   // behavior, you could append a single starting state to every single data
   // sequence and that should produce results in line with MATLAB.
-  for (size_t state = 0; state < transition.n_rows; state++)
-    forwardProb(state, 0) = initial(state) *
-        emission[state].Probability(dataSeq.unsafe_col(0));
+  forwardProb.col(0) = initial % emissionProb.col(0);
 
   // Then normalize the column.
   scales[0] = accu(forwardProb.col(0));
   if (scales[0] > 0.0)
     forwardProb.col(0) /= scales[0];
 
-  // Now compute the probabilities for each successive observation.
-  for (size_t t = 1; t < dataSeq.n_cols; t++)
+  // Now compute the probabilities for each successive observation.  The
+  // forward probability of state j at time t is the sum over all states of the
+  // probability of the previous state transitioning to the current state,
+  // multiplied by the probability of emitting the given observation; for all
+  // states at once, that is a matrix-vector product.
+  for (size_t t = 1; t < emissionProb.n_cols; t++)
   {
-    for (size_t j = 0; j < transition.n_rows; j++)
-    {
-      // The forward probability of state j at time t is the sum over all states
-      // of the probability of the previous state transitioning to the current
-      // state and emitting the given observation.
-      forwardProb(j, t) = accu(forwardProb.col(t - 1) %
-          trans(transition.row(j))) *
-          emission[j].Probability(dataSeq.unsafe_col(t));
-    }
+    forwardProb.col(t) = (transition * forwardProb.col(t - 1)) %
+        emissionProb.col(t);
 
     // Normalize probability.
     scales[t] = accu(forwardProb.col(t));
@@ -552,35 +753,35 @@ void HMM<Distribution>::Forward(const arma::mat& dataSeq,
   }
 }
 
+/**
+ * The backward pass of the Forward-Backward algorithm, given the emission
+ * probabilities of each observation.
+ */
 template<typename Distribution>
-void HMM<Distribution>::Backward(const arma::mat& dataSeq,
-                                 const arma::vec& scales,
-                                 arma::mat& backwardProb) const
+void HMM<Distribution>::BackwardPass(const arma::mat& emissionProb,
+                                     const arma::vec& scales,
+                                     arma::mat& backwardProb) const
 {
   // Our goal is to calculate the backward probabilities:
   //  P(X_k | o_{k + 1:T}) for all possible states X_k, for each time point k.
-  backwardProb.zeros(transition.n_rows, dataSeq.n_cols);
+  backwardProb.zeros(transition.n_rows, emissionProb.n_cols);
 
   // The last element probability is 1.
-  backwardProb.col(dataSeq.n_cols - 1).fill(1);
-
-  // Now step backwards through all other observations.
-  for (size_t t = dataSeq.n_cols - 2; t + 1 > 0; t--)
+  backwardProb.col(emissionProb.n_cols - 1).fill(1);
+
+  // Now step backwards through all other observations.  The backward
+  // probability of state j at time t is the sum over all states of the
+  // probability of the next state having been a transition from the current
+  // state multiplied by the probability of each of those states emitting the
+  // given observation.
+  for (size_t t = emissionProb.n_cols - 2; t + 1 > 0; t--)
   {
-    for (size_t j = 0; j < transition.n_rows; j++)
-    {
-      // The backward probability of state j at time t is the sum over all state
-      // of the probability of the next state having been a transition from the
-      // current state multiplied by the probability of each of those states
-      // emitting the given observation.
-      for (size_t state = 0; state < transition.n_rows; state++)
-        backwardProb(j, t) += transition(state, j) * backwardProb(state, t + 1)
-            * emission[state].Probability(dataSeq.unsafe_col(t + 1));
-
-      // Normalize by the weights from the forward algorithm.
-      if (scales[t + 1] > 0.0)
-        backwardProb(j, t) /= scales[t + 1];
-    }
+    backwardProb.col(t) = trans(transition) *
+        (backwardProb.col(t + 1) % emissionProb.col(t + 1));
+
+    // Normalize by the weights from the forward algorithm.
+    if (scales[t + 1] > 0.0)
+      backwardProb.col(t) /= scales[t + 1];
   }
 }
 
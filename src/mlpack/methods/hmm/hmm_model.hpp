@@ -9,6 +9,7 @@
 
 #include "hmm.hpp"
 #include <mlpack/methods/gmm/gmm.hpp>
+#include <mlpack/methods/gmm/diagonal_gmm.hpp>
 
 namespace mlpack {
 namespace hmm {
@@ -17,7 +18,8 @@ enum HMMType : char
 {
   DiscreteHMM = 0,
   GaussianHMM,
-  GaussianMixtureModelHMM
+  GaussianMixtureModelHMM,
+  DiagonalGaussianMixtureModelHMM
 };
 
 /**
@@ -34,6 +36,8 @@ class HMMModel
   HMM<distribution::GaussianDistribution>* gaussianHMM;
   //! Not used if type is not GaussianMixtureModelHMM.
   HMM<gmm::GMM>* gmmHMM;
+  //! Not used if type is not DiagonalGaussianMixtureModelHMM.
+  HMM<gmm::DiagonalGMM>* diagGMMHMM;
 
  public:
   //! Construct an uninitialized model.
@@ -41,7 +45,8 @@ class HMMModel
       type(HMMType::DiscreteHMM),
       discreteHMM(new HMM<distribution::DiscreteDistribution>()),
       gaussianHMM(NULL),
-      gmmHMM(NULL)
+      gmmHMM(NULL),
+      diagGMMHMM(NULL)
   {
     // Nothing to do.
   }
@@ -51,7 +56,8 @@ class HMMModel
       type(type),
       discreteHMM(NULL),
       gaussianHMM(NULL),
-      gmmHMM(NULL)
+      gmmHMM(NULL),
+      diagGMMHMM(NULL)
   {
     if (type == HMMType::DiscreteHMM)
       discreteHMM = new HMM<distribution::DiscreteDistribution>();
@@ -59,6 +65,8 @@ class HMMModel
       gaussianHMM = new HMM<distribution::GaussianDistribution>();
     else if (type == HMMType::GaussianMixtureModelHMM)
       gmmHMM = new HMM<gmm::GMM>();
+    else if (type == HMMType::DiagonalGaussianMixtureModelHMM)
+      diagGMMHMM = new HMM<gmm::DiagonalGMM>();
   }
 
   //! Copy another model.
@@ -66,7 +74,8 @@ class HMMModel
       type(other.type),
       discreteHMM(NULL),
       gaussianHMM(NULL),
-      gmmHMM(NULL)
+      gmmHMM(NULL),
+      diagGMMHMM(NULL)
   {
     if (type == HMMType::DiscreteHMM)
       discreteHMM =
@@ -76,6 +85,8 @@ class HMMModel
           new HMM<distribution::GaussianDistribution>(*other.gaussianHMM);
     else if (type == HMMType::GaussianMixtureModelHMM)
       gmmHMM = new HMM<gmm::GMM>(*other.gmmHMM);
+    else if (type == HMMType::DiagonalGaussianMixtureModelHMM)
+      diagGMMHMM = new HMM<gmm::DiagonalGMM>(*other.diagGMMHMM);
   }
 
   //! Take ownership of another model.
@@ -83,12 +94,14 @@ class HMMModel
       type(other.type),
       discreteHMM(other.discreteHMM),
       gaussianHMM(other.gaussianHMM),
-      gmmHMM(other.gmmHMM)
+      gmmHMM(other.gmmHMM),
+      diagGMMHMM(other.diagGMMHMM)
   {
     other.type = HMMType::DiscreteHMM;
     other.discreteHMM = new HMM<distribution::DiscreteDistribution>();
     other.gaussianHMM = NULL;
     other.gmmHMM = NULL;
+    other.diagGMMHMM = NULL;
   }
 
   //! Copy assignment operator.
@@ -97,10 +110,12 @@ class HMMModel
     delete discreteHMM;
     delete gaussianHMM;
     delete gmmHMM;
+    delete diagGMMHMM;
 
     discreteHMM = NULL;
     gaussianHMM = NULL;
     gmmHMM = NULL;
+    diagGMMHMM = NULL;
 
     type = other.type;
     if (type == HMMType::DiscreteHMM)
@@ -111,6 +126,8 @@ class HMMModel
           new HMM<distribution::GaussianDistribution>(*other.gaussianHMM);
     else if (type == HMMType::GaussianMixtureModelHMM)
       gmmHMM = new HMM<gmm::GMM>(*other.gmmHMM);
+    else if (type == HMMType::DiagonalGaussianMixtureModelHMM)
+      diagGMMHMM = new HMM<gmm::DiagonalGMM>(*other.diagGMMHMM);
 
     return *this;
   }
@@ -121,6 +138,7 @@ class HMMModel
     delete discreteHMM;
     delete gaussianHMM;
     delete gmmHMM;
+    delete diagGMMHMM;
   }
 
   /**
@@ -137,6 +155,8 @@ class HMMModel
       ActionType::Apply(*gaussianHMM, x);
     else if (type == HMMType::GaussianMixtureModelHMM)
       ActionType::Apply(*gmmHMM, x);
+    else if (type == HMMType::DiagonalGaussianMixtureModelHMM)
+      ActionType::Apply(*diagGMMHMM, x);
   }
 
   //! Serialize the model.
@@ -151,10 +171,12 @@ class HMMModel
       delete discreteHMM;
       delete gaussianHMM;
       delete gmmHMM;
+      delete diagGMMHMM;
 
       discreteHMM = NULL;
       gaussianHMM = NULL;
       gmmHMM = NULL;
+      diagGMMHMM = NULL;
     }
 
     if (type == HMMType::DiscreteHMM)
@@ -163,6 +185,8 @@ class HMMModel
       ar & BOOST_SERIALIZATION_NVP(gaussianHMM);
     else if (type == HMMType::GaussianMixtureModelHMM)
       ar & BOOST_SERIALIZATION_NVP(gmmHMM);
+    else if (type == HMMType::DiagonalGaussianMixtureModelHMM)
+      ar & BOOST_SERIALIZATION_NVP(diagGMMHMM);
   }
 };
 
@@ -303,12 +303,13 @@ class HMMRegression : public HMM<distribution::RegressionDistribution>
    *
    * @param predictors Vector of predictor sequences.
    * @param responses Vector of response sequences.
-   * @param scales Vector in which scaling factors will be saved.
+   * @param logScales Vector in which the log of the scaling factors will be
+   *    saved.
    * @param forwardProb Matrix in which forward probabilities will be saved.
    */
   void Forward(const arma::mat& predictors,
                const arma::vec& responses,
-               arma::vec& scales,
+               arma::vec& logScales,
                arma::mat& forwardProb) const;
 
   /**
@@ -320,12 +321,12 @@ class HMMRegression : public HMM<distribution::RegressionDistribution>
    *
    * @param predictors Vector of predictor sequences.
    * @param responses Vector of response sequences.
-   * @param scales Vector of scaling factors.
+   * @param logScales Vector of the log of the scaling factors.
    * @param backwardProb Matrix in which backward probabilities will be saved.
    */
   void Backward(const arma::mat& predictors,
                 const arma::vec& responses,
-                const arma::vec& scales,
+                const arma::vec& logScales,
                 arma::mat& backwardProb) const;
 };
 
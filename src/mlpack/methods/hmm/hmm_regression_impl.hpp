@@ -102,8 +102,8 @@ void HMMRegression::Filter(const arma::mat& predictors,
 {
   // First run the forward algorithm
   arma::mat forwardProb;
-  arma::vec scales;
-  Forward(predictors, responses, scales, forwardProb);
+  arma::vec logScales;
+  Forward(predictors, responses, logScales, forwardProb);
 
   // Propagate state, predictors ahead
   if (ahead != 0)
@@ -150,23 +150,23 @@ void HMMRegression::Smooth(const arma::mat& predictors,
  */
 void HMMRegression::Forward(const arma::mat& predictors,
                             const arma::vec& responses,
-                            arma::vec& scales,
+                            arma::vec& logScales,
                             arma::mat& forwardProb) const
 {
   arma::mat dataSeq;
   StackData(predictors, responses, dataSeq);
-  this->HMM::Forward(dataSeq, scales, forwardProb);
+  this->HMM::Forward(dataSeq, logScales, forwardProb);
 }
 
 
 void HMMRegression::Backward(const arma::mat& predictors,
                              const arma::vec& responses,
-                             const arma::vec& scales,
+                             const arma::vec& logScales,
                              arma::mat& backwardProb) const
 {
   arma::mat dataSeq;
   StackData(predictors, responses, dataSeq);
-  this->HMM::Backward(dataSeq, scales, backwardProb);
+  this->HMM::Backward(dataSeq, logScales, backwardProb);
 }
 
 void HMMRegression::StackData(const std::vector<arma::mat>& predictors,
@@ -29,7 +29,8 @@ using namespace std;
 
 PROGRAM_INFO("Hidden Markov Model (HMM) Training", "This program allows a "
     "Hidden Markov Model to be trained on labeled or unlabeled data.  It "
-    "support three types of HMMs: discrete HMMs, Gaussian HMMs, or GMM HMMs."
+    "support four types of HMMs: discrete HMMs, Gaussian HMMs, GMM HMMs, or "
+    "diagonal GMM HMMs, whose mixture components have diagonal covariance."
     "\n\n"
     "Either one input sequence can be specified (with --input_file), or, a "
     "file containing files in which input sequences can be found (when "
@@ -49,8 +50,8 @@ PROGRAM_INFO("Hidden Markov Model (HMM) Training", "This program allows a "
     "--model_file.");
 
 PARAM_STRING_IN_REQ("input_file", "File containing input observations.", "i");
-PARAM_STRING_IN("type", "Type of HMM: discrete | gaussian | gmm.", "t",
-    "gaussian");
+PARAM_STRING_IN("type", "Type of HMM: discrete | gaussian | gmm | diag_gmm.",
+    "t", "gaussian");
 
 PARAM_FLAG("batch", "If true, input_file (and if passed, labels_file) are "
     "expected to contain a list of files to use as input observation sequences "
@@ -58,7 +59,7 @@ PARAM_FLAG("batch", "If true, input_file (and if passed, labels_file) are "
 PARAM_INT_IN("states", "Number of hidden states in HMM (necessary, unless "
     "model_file is specified).", "n", 0);
 PARAM_INT_IN("gaussians", "Number of gaussians in each GMM (necessary when type"
-    " is 'gmm').", "g", 0);
+    " is 'gmm' or 'diag_gmm').", "g", 0);
 PARAM_MODEL_IN(HMMModel, "input_model", "Pre-existing HMM model to initialize "
     "training with.", "m");
 PARAM_STRING_IN("labels_file", "Optional file of hidden states, used for "
@@ -167,6 +168,40 @@ struct Init
     }
   }
 
+  //! Helper function to create diagonal GMM HMM.
+  static void Create(HMM<DiagonalGMM>& hmm,
+                     vector<mat>& trainSeq,
+                     size_t states,
+                     double tolerance)
+  {
+    // Find dimension of the data.
+    const size_t dimensionality = trainSeq[0].n_rows;
+    const int gaussians = CLI::GetParam<int>("gaussians");
+
+    if (gaussians == 0)
+    {
+      Log::Fatal << "Number of gaussians for each GMM must be specified "
+          << "when type = 'diag_gmm'!" << endl;
+    }
+
+    if (gaussians < 0)
+    {
+      Log::Fatal << "Invalid number of gaussians (" << gaussians << "); must "
+          << "be greater than or equal to 1." << endl;
+    }
+
+    // Create HMM object.
+    hmm = HMM<DiagonalGMM>(size_t(states), DiagonalGMM(size_t(gaussians),
+        dimensionality), tolerance);
+
+    // Issue a warning if the user didn't give labels.
+    if (!CLI::HasParam("labels_file"))
+    {
+      Log::Warn << "Unlabeled training of GMM HMMs is almost certainly not "
+          << "going to produce good results!" << endl;
+    }
+  }
+
   //! Helper function for discrete emission distributions.
   static void RandomInitialize(vector<DiscreteDistribution>& e)
   {
@@ -212,6 +247,28 @@ struct Init
       }
     }
   }
+
+  //! Helper function for diagonal GMM emission distributions.
+  static void RandomInitialize(vector<DiagonalGMM>& e)
+  {
+    for (size_t i = 0; i < e.size(); ++i)
+    {
+      // Random weights.
+      e[i].Weights().randu();
+      e[i].Weights() /= arma::accu(e[i].Weights());
+
+      // Random means and variances.
+      for (int g = 0; g < CLI::GetParam<int>("gaussians"); ++g)
+      {
+        const size_t dimensionality = e[i].Component(g).Mean().n_rows;
+        e[i].Component(g).Mean().randu();
+
+        // Generate random variances, bounded away from zero.
+        e[i].Component(g).Covariance(arma::randu<arma::vec>(dimensionality) +
+            1e-5);
+      }
+    }
+  }
 };
 
 // Because we don't know what the type of our HMM is, we need to write a
@@ -375,8 +432,8 @@ static void mlpackMain()
 
   if (!CLI::HasParam("input_model"))
   {
-    RequireParamInSet<string>("type", { "discrete", "gaussian", "gmm" }, true,
-        "unknown HMM type");
+    RequireParamInSet<string>("type", { "discrete", "gaussian", "gmm",
+        "diag_gmm" }, true, "unknown HMM type");
   }
 
   // Load the input data.
@@ -432,8 +489,10 @@ static void mlpackMain()
     typeId = HMMType::DiscreteHMM;
   else if (type == "gaussian")
     typeId = HMMType::GaussianHMM;
-  else
+  else if (type == "gmm")
     typeId = HMMType::GaussianMixtureModelHMM;
+  else
+    typeId = HMMType::DiagonalGaussianMixtureModelHMM;
 
   // If we have a model file, we can autodetect the type.
   HMMModel hmm(typeId);
@@ -261,6 +261,10 @@ Cluster(const MatType& data,
   }
   Log::Info << lloydStep.DistanceCalculations() << " distance calculations."
       << std::endl;
+
+  Counter::Add("kmeans/iterations", iteration);
+  Counter::Add("kmeans/distance_calculations",
+      lloydStep.DistanceCalculations());
 }
 
 /**
@@ -208,8 +208,11 @@ inline void MeanShift<UseKernel, KernelType, MatType>::Cluster(
 
   range::RangeSearch<> rangeSearcher(data);
   math::Range validRadius(0, radius);
-  std::vector<std::vector<size_t> > neighbors;
-  std::vector<std::vector<double> > distances;
+
+  // There is only one query point per search, so the results of each search
+  // are the entire neighbor and distance buffers of this object.  The buffers
+  // are reused between searches.
+  range::CSRResults results;
 
   // For each seed, perform mean shift algorithm.
   for (size_t i = 0; i < pSeeds->n_cols; ++i)
@@ -222,13 +225,13 @@ inline void MeanShift<UseKernel, KernelType, MatType>::Cluster(
       // Store new centroid in this.
       arma::colvec newCentroid = arma::zeros<arma::colvec>(pSeeds->n_rows);
 
-      rangeSearcher.Search(allCentroids.unsafe_col(i), validRadius,
-          neighbors, distances);
-      if (neighbors[0].size() <= 1)
+      rangeSearcher.Search(allCentroids.unsafe_col(i), validRadius, results);
+      if (results.Neighbors().size() <= 1)
         break;
 
       // Calculate new centroid.
-      if (!CalculateCentroid(data, neighbors[0], distances[0], newCentroid))
+      if (!CalculateCentroid(data, results.Neighbors(), results.Distances(),
+          newCentroid))
         newCentroid = allCentroids.unsafe_col(i);
 
       // If the mean shift vector is small enough, it has converged.
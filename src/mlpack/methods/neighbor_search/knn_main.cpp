@@ -53,7 +53,14 @@ PROGRAM_INFO("k-Nearest-Neighbors Search",
     "neighbors output matrix corresponds to the index of the point in the "
     "reference set which is the j'th nearest neighbor from the point in the "
     "query set with index i.  Row j and column i in the distances output matrix"
-    " corresponds to the distance between those two points.");
+    " corresponds to the distance between those two points."
+    "\n\n"
+    "A model given with " + PRINT_PARAM_STRING("input_model") + " can be "
+    "updated without rebuilding it: the points with the indices given in " +
+    PRINT_PARAM_STRING("delete") + " are removed from its reference set, and "
+    "then the points in " + PRINT_PARAM_STRING("insert") + " are added at the "
+    "end of the reference set.  The updated model is used for the search and "
+    "can be saved with " + PRINT_PARAM_STRING("output_model") + ".");
 
 // Define our input parameters that this program will take.
 PARAM_MATRIX_IN("reference", "Matrix containing the reference dataset.", "r");
@@ -70,6 +77,12 @@ PARAM_MODEL_IN(KNNModel, "input_model", "Pre-trained kNN model.", "m");
 PARAM_MODEL_OUT(KNNModel, "output_model", "If specified, the kNN model will be "
     "output here.", "M");
 
+// The reference set of an input model may be updated.
+PARAM_MATRIX_IN("insert", "Matrix of points to add to the reference set of the "
+    "input model.", "I");
+PARAM_UROW_IN("delete", "Indices of the points to remove from the reference "
+    "set of the input model (indices before any insertion or deletion).", "X");
+
 // The user may specify a query file of query points and a number of nearest
 // neighbors to search for.
 PARAM_MATRIX_IN("query", "Matrix containing query points (optional).", "q");
@@ -120,6 +133,9 @@ static void mlpackMain()
         << endl;
   }
 
+  ReportIgnoredParam({{ "input_model", false }}, "insert");
+  ReportIgnoredParam({{ "input_model", false }}, "delete");
+
   // The user should give something to do...
   RequireAtLeastOnePassed({ "k", "output_model" }, false,
       "no results will be saved");
@@ -259,6 +275,41 @@ static void mlpackMain()
         << endl;
   }
 
+  // Update the reference set of the model, if desired.
+  if (CLI::HasParam("input_model") && CLI::HasParam("delete"))
+  {
+    // Points are deleted from the highest index down, so that the indices of
+    // the points that are yet to be deleted do not change.
+    arma::Row<size_t> indices = arma::unique(
+        CLI::GetParam<arma::Row<size_t>>("delete"));
+    if (indices.n_elem > 0 && indices.max() >= knn.NumReferencePoints())
+    {
+      Log::Fatal << "Invalid index " << indices.max() << " in "
+          << PRINT_PARAM_STRING("delete") << "; the reference set has only "
+          << knn.NumReferencePoints() << " points." << endl;
+    }
+
+    for (size_t i = indices.n_elem; i > 0; --i)
+      knn.Delete(indices[i - 1]);
+    Log::Info << "Deleted " << indices.n_elem << " reference points." << endl;
+  }
+
+  if (CLI::HasParam("input_model") && CLI::HasParam("insert"))
+  {
+    arma::mat insertions = std::move(CLI::GetParam<arma::mat>("insert"));
+    if (insertions.n_rows != knn.Dataset().n_rows &&
+        knn.NumReferencePoints() > 0)
+    {
+      Log::Fatal << "Dimensionality of " << PRINT_PARAM_STRING("insert")
+          << " (" << insertions.n_rows << ") does not match the dimensionality "
+          << "of the reference set (" << knn.Dataset().n_rows << ")." << endl;
+    }
+
+    const size_t numInserted = insertions.n_cols;
+    knn.Insert(std::move(insertions));
+    Log::Info << "Inserted " << numInserted << " reference points." << endl;
+  }
+
   // Perform search, if desired.
   if (CLI::HasParam("k"))
   {
@@ -276,11 +327,11 @@ static void mlpackMain()
     // Sanity check on k value: must be greater than 0, must be less than the
     // number of reference points.  Since it is unsigned, we only test the upper
     // bound.
-    if (k > knn.Dataset().n_cols)
+    if (k > knn.NumReferencePoints())
     {
       Log::Fatal << "Invalid k: " << k << "; must be greater than 0 and less ";
       Log::Fatal << "than or equal to the number of reference points (";
-      Log::Fatal << knn.Dataset().n_cols << ")." << endl;
+      Log::Fatal << knn.NumReferencePoints() << ")." << endl;
     }
 
     // Now run the search.
@@ -30,9 +30,11 @@ namespace mlpack {
 // all-furthest-neighbors searches.
 namespace neighbor  {
 
-// Forward declaration.
+// Forward declarations.
 template<typename SortPolicy>
 class TrainVisitor;
+template<typename SortPolicy>
+class UpdateVisitor;
 
 //! NeighborSearchMode represents the different neighbor search modes available.
 enum NeighborSearchMode
@@ -317,7 +319,8 @@ class NeighborSearch
    * @param distances Matrix storing distances of neighbors for each query
    *      point.
    * @param sameSet Denotes whether or not the reference and query sets are the
-   *      same.
+   *      same.  This may not be true while there are insertions or deletions
+   *      that are not merged into the reference tree.
    */
   void Search(Tree& queryTree,
               const size_t k,
@@ -334,6 +337,9 @@ class NeighborSearch
    * where n is the number of points in the query dataset and k is the number of
    * neighbors being searched for.
    *
+   * If points were inserted or deleted since the reference tree was built,
+   * the tree is rebuilt first (see Rebuild()).
+   *
    * @param k Number of neighbors to search for.
    * @param neighbors Matrix storing lists of neighbors for each query point.
    * @param distances Matrix storing distances of neighbors for each query
@@ -343,6 +349,42 @@ class NeighborSearch
               arma::Mat<size_t>& neighbors,
               arma::mat& distances);
 
+  /**
+   * Add the given points to the reference set.  The reference tree is not
+   * modified: the new points are kept in a buffer that is searched by brute
+   * force alongside the tree, so the results of Search() stay exact.  The new
+   * points are given the indices following the last point of the reference
+   * set, exactly as if the model had been trained on the extended set.
+   *
+   * Once the insertions and deletions that are not merged into the tree
+   * outnumber RebuildRatio() times the number of points in the tree, the tree
+   * is rebuilt on the current reference set with Rebuild().  The cost of the
+   * rebuilds is therefore spread over many updates, and the buffer never holds
+   * more than a fixed fraction of the reference set.
+   *
+   * @param points Points to add to the reference set.
+   */
+  void Insert(const MatType& points);
+
+  /**
+   * Remove the point with the given index from the reference set.  The point is
+   * only marked as deleted and skipped during the search; the indices of all
+   * following points are decreased by one, exactly as if the model had been
+   * trained on the reference set without the point.  See Insert() for when the
+   * reference tree is rebuilt.
+   *
+   * @param index Index of the point to remove from the reference set.
+   */
+  void Delete(const size_t index);
+
+  /**
+   * Rebuild the reference tree on the current reference set, merging all
+   * insertions and deletions made since the last call to Train() or Rebuild().
+   * The tree is built with the default parameters of the tree type.  This does
+   * nothing if there are no pending insertions or deletions.
+   */
+  void Rebuild();
+
   /**
    * Calculate the average relative error (effective error) between the
    * distances calculated and the true distances provided.  The input matrices
@@ -392,9 +434,22 @@ class NeighborSearch
   //! Modify the relative error to be considered in approximate search.
   double& Epsilon() { return epsilon; }
 
-  //! Access the reference dataset.
+  //! Access the reference dataset.  This does not contain the insertions and
+  //! deletions that are not merged into the reference tree yet.
   const MatType& ReferenceSet() const { return *referenceSet; }
 
+  //! Get the number of points in the reference set, including the insertions
+  //! and deletions that are not merged into the reference tree yet.
+  size_t NumReferencePoints() const
+  {
+    return referenceSet->n_cols + insertedSet.n_cols - deletedIds.size();
+  }
+
+  //! Get the ratio of pending updates to tree size that triggers a rebuild.
+  double RebuildRatio() const { return rebuildRatio; }
+  //! Modify the ratio of pending updates to tree size that triggers a rebuild.
+  double& RebuildRatio() { return rebuildRatio; }
+
   //! Access the reference tree.
   const Tree& ReferenceTree() const { return *referenceTree; }
   //! Modify the reference tree.
@@ -402,7 +457,7 @@ class NeighborSearch
 
   //! Serialize the NeighborSearch model.
   template<typename Archive>
-  void serialize(Archive& ar, const unsigned int /* version */);
+  void serialize(Archive& ar, const unsigned int version);
 
  private:
   //! Permutations of reference points during tree building.
@@ -434,14 +489,106 @@ class NeighborSearch
   //! Search() without a query set.
   bool treeNeedsReset;
 
+  //! Points inserted since the reference tree was built.
+  MatType insertedSet;
+  //! Sorted ids of the deleted points.  The ids of the points in the tree are
+  //! their indices at the time the tree was built, and the id of column i of
+  //! insertedSet is referenceSet->n_cols + i.
+  std::vector<size_t> deletedIds;
+  //! The reference tree is rebuilt once the number of pending insertions and
+  //! deletions exceeds this ratio of the number of points in the tree.
+  double rebuildRatio;
+
+  //! Add the given points to the buffer, without rebuilding the tree.
+  void InsertPoints(const MatType& points);
+
+  //! Mark the given point as deleted, without rebuilding the tree.
+  void DeletePoint(const size_t index);
+
+  //! Return true if there are insertions or deletions not merged into the tree.
+  bool HasUpdates() const
+  {
+    return (insertedSet.n_cols > 0) || !deletedIds.empty();
+  }
+
+  //! Return true if there are enough pending updates to rebuild the tree.
+  bool NeedsRebuild() const
+  {
+    return (insertedSet.n_cols + deletedIds.size()) >
+        rebuildRatio * referenceSet->n_cols;
+  }
+
+  //! Assemble the current reference set (with all insertions and deletions),
+  //! in the order of the indices returned by Search().
+  void UpdatedReferenceSet(MatType& points) const;
+
+  //! Search the reference tree only, ignoring insertions and deletions.
+  void SearchTree(const MatType& querySet,
+                  const size_t k,
+                  arma::Mat<size_t>& neighbors,
+                  arma::mat& distances);
+
+  //! Search the reference tree only, ignoring insertions and deletions.
+  void SearchTree(Tree& queryTree,
+                  const size_t k,
+                  arma::Mat<size_t>& neighbors,
+                  arma::mat& distances,
+                  bool sameSet);
+
+  /**
+   * Combine the results of a search of the reference tree with the inserted
+   * points, which are searched by brute force, and drop the deleted points.
+   * The indices of the results are mapped to the current reference set.
+   *
+   * @param querySet Set of query points.
+   * @param k Number of neighbors to search for.
+   * @param treeNeighbors Neighbors found in the reference tree.
+   * @param treeDistances Distances of the neighbors found in the tree.
+   * @param neighbors Matrix to store the combined neighbors in.
+   * @param distances Matrix to store the combined distances in.
+   */
+  void MergeUpdates(const MatType& querySet,
+                    const size_t k,
+                    const arma::Mat<size_t>& treeNeighbors,
+                    const arma::mat& treeDistances,
+                    arma::Mat<size_t>& neighbors,
+                    arma::mat& distances);
+
   //! The NSModel class should have access to internal members.
   template<typename SortPol>
   friend class TrainVisitor;
+  template<typename SortPol>
+  friend class UpdateVisitor;
 }; // class NeighborSearch
 
 } // namespace neighbor
 } // namespace mlpack
 
+//! Set the serialization version of the NeighborSearch class.  This is
+//! BOOST_TEMPLATE_CLASS_VERSION() written out, since the template signature
+//! has too many commas to be passed to the macro.
+namespace boost {
+namespace serialization {
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename RuleType> class DualTreeTraversalType,
+         template<typename RuleType> class SingleTreeTraversalType>
+struct version<mlpack::neighbor::NeighborSearch<SortPolicy, MetricType,
+    MatType, TreeType, DualTreeTraversalType, SingleTreeTraversalType>>
+{
+  typedef mpl::int_<1> type;
+  typedef mpl::integral_c_tag tag;
+  BOOST_STATIC_CONSTANT(int, value = version::type::value);
+};
+
+} // namespace serialization
+} // namespace boost
+
 // Include implementation.
 #include "neighbor_search_impl.hpp"
 
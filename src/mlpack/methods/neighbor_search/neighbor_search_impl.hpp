@@ -70,7 +70,8 @@ SingleTreeTraversalType>::NeighborSearch(const MatType& referenceSetIn,
     metric(metric),
     baseCases(0),
     scores(0),
-    treeNeedsReset(false)
+    treeNeedsReset(false),
+    rebuildRatio(0.05)
 {
   if (epsilon < 0)
     throw std::invalid_argument("epsilon must be non-negative");
@@ -101,7 +102,8 @@ SingleTreeTraversalType>::NeighborSearch(MatType&& referenceSetIn,
     metric(metric),
     baseCases(0),
     scores(0),
-    treeNeedsReset(false)
+    treeNeedsReset(false),
+    rebuildRatio(0.05)
 {
   if (epsilon < 0)
     throw std::invalid_argument("epsilon must be non-negative");
@@ -130,7 +132,8 @@ SingleTreeTraversalType>::NeighborSearch(const Tree& referenceTree,
     metric(metric),
     baseCases(0),
     scores(0),
-    treeNeedsReset(false)
+    treeNeedsReset(false),
+    rebuildRatio(0.05)
 {
   if (epsilon < 0)
     throw std::invalid_argument("epsilon must be non-negative");
@@ -159,7 +162,8 @@ SingleTreeTraversalType>::NeighborSearch(Tree&& referenceTree,
     metric(metric),
     baseCases(0),
     scores(0),
-    treeNeedsReset(false)
+    treeNeedsReset(false),
+    rebuildRatio(0.05)
 {
   if (epsilon < 0)
     throw std::invalid_argument("epsilon must be non-negative");
@@ -187,7 +191,8 @@ SingleTreeTraversalType>::NeighborSearch(const NeighborSearchMode mode,
     metric(metric),
     baseCases(0),
     scores(0),
-    treeNeedsReset(false)
+    treeNeedsReset(false),
+    rebuildRatio(0.05)
 {
   if (epsilon < 0)
     throw std::invalid_argument("epsilon must be non-negative");
@@ -222,7 +227,10 @@ SingleTreeTraversalType>::NeighborSearch(const NeighborSearch& other) :
     metric(other.metric),
     baseCases(other.baseCases),
     scores(other.scores),
-    treeNeedsReset(false)
+    treeNeedsReset(false),
+    insertedSet(other.insertedSet),
+    deletedIds(other.deletedIds),
+    rebuildRatio(other.rebuildRatio)
 {
   // Nothing else to do.
 }
@@ -248,7 +256,10 @@ SingleTreeTraversalType>::NeighborSearch(NeighborSearch&& other) :
     metric(std::move(other.metric)),
     baseCases(other.baseCases),
     scores(other.scores),
-    treeNeedsReset(other.treeNeedsReset)
+    treeNeedsReset(other.treeNeedsReset),
+    insertedSet(std::move(other.insertedSet)),
+    deletedIds(std::move(other.deletedIds)),
+    rebuildRatio(other.rebuildRatio)
 {
   // Clear the other model.
   other.referenceSet = new MatType();
@@ -261,6 +272,9 @@ SingleTreeTraversalType>::NeighborSearch(NeighborSearch&& other) :
   other.baseCases = 0;
   other.scores = 0;
   other.treeNeedsReset = false;
+  other.insertedSet.reset();
+  other.deletedIds.clear();
+  other.rebuildRatio = 0.05;
 }
 
 // Copy operator.
@@ -303,6 +317,9 @@ NeighborSearch<SortPolicy,
   baseCases = other.baseCases;
   scores = other.scores;
   treeNeedsReset = false;
+  insertedSet = other.insertedSet;
+  deletedIds = other.deletedIds;
+  rebuildRatio = other.rebuildRatio;
 }
 
 // Move operator.
@@ -344,6 +361,9 @@ NeighborSearch<SortPolicy,
   baseCases = other.baseCases;
   scores = other.scores;
   treeNeedsReset = other.treeNeedsReset;
+  insertedSet = std::move(other.insertedSet);
+  deletedIds = std::move(other.deletedIds);
+  rebuildRatio = other.rebuildRatio;
 
   // Reset the other object.
   other.referenceSet = new MatType();
@@ -356,6 +376,9 @@ NeighborSearch<SortPolicy,
   other.baseCases = 0;
   other.scores = 0;
   other.treeNeedsReset = false;
+  other.insertedSet.reset();
+  other.deletedIds.clear();
+  other.rebuildRatio = 0.05;
 }
 
 // Clean memory.
@@ -388,6 +411,10 @@ void NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
 DualTreeTraversalType, SingleTreeTraversalType>::Train(
     const MatType& referenceSet)
 {
+  // Insertions and deletions made to the old reference set are discarded.
+  insertedSet.reset();
+  deletedIds.clear();
+
   // Clean up the old tree, if we built one.
   if (treeOwner && referenceTree)
   {
@@ -428,6 +455,10 @@ template<typename SortPolicy,
 void NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
 DualTreeTraversalType, SingleTreeTraversalType>::Train(MatType&& referenceSetIn)
 {
+  // Insertions and deletions made to the old reference set are discarded.
+  insertedSet.reset();
+  deletedIds.clear();
+
   // Clean up the old tree, if we built one.
   if (treeOwner && referenceTree)
   {
@@ -479,6 +510,10 @@ DualTreeTraversalType, SingleTreeTraversalType>::Train(
     throw std::invalid_argument("cannot train on given reference tree when "
         "naive search (without trees) is desired");
 
+  // Insertions and deletions made to the old reference set are discarded.
+  insertedSet.reset();
+  deletedIds.clear();
+
   if (treeOwner && this->referenceTree)
   {
     oldFromNewReferences.clear();
@@ -509,6 +544,10 @@ DualTreeTraversalType, SingleTreeTraversalType>::Train(Tree&& referenceTree)
     throw std::invalid_argument("cannot train on given reference tree when "
         "naive search (without trees) is desired");
 
+  // Insertions and deletions made to the old reference set are discarded.
+  insertedSet.reset();
+  deletedIds.clear();
+
   if (treeOwner && this->referenceTree)
   {
     oldFromNewReferences.clear();
@@ -543,14 +582,60 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
     arma::Mat<size_t>& neighbors,
     arma::mat& distances)
 {
-  if (k > referenceSet->n_cols)
+  if (k > NumReferencePoints())
   {
     std::stringstream ss;
     ss << "requested value of k (" << k << ") is greater than the number of "
-        << "points in the reference set (" << referenceSet->n_cols << ")";
+        << "points in the reference set (" << NumReferencePoints() << ")";
     throw std::invalid_argument(ss.str());
   }
 
+  if (!HasUpdates())
+  {
+    SearchTree(querySet, k, neighbors, distances);
+    return;
+  }
+
+  // The tree may return deleted points, so we ask it for enough neighbors that
+  // k of them are left after the deleted points are dropped.
+  const size_t treeSize = referenceSet->n_cols;
+  const size_t treeDeleted = std::lower_bound(deletedIds.begin(),
+      deletedIds.end(), treeSize) - deletedIds.begin();
+  const size_t treeK = std::min(k + treeDeleted, treeSize);
+
+  arma::Mat<size_t> treeNeighbors;
+  arma::mat treeDistances;
+  if (treeK > 0)
+  {
+    SearchTree(querySet, treeK, treeNeighbors, treeDistances);
+  }
+  else
+  {
+    treeNeighbors.set_size(0, querySet.n_cols);
+    treeDistances.set_size(0, querySet.n_cols);
+    baseCases = 0;
+    scores = 0;
+  }
+
+  MergeUpdates(querySet, k, treeNeighbors, treeDistances, neighbors,
+      distances);
+}
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename> class DualTreeTraversalType,
+         template<typename> class SingleTreeTraversalType>
+void NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
+DualTreeTraversalType, SingleTreeTraversalType>::SearchTree(
+    const MatType& querySet,
+    const size_t k,
+    arma::Mat<size_t>& neighbors,
+    arma::mat& distances)
+{
   Timer::Start("computing_neighbors");
 
   baseCases = 0;
@@ -615,6 +700,7 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
 
       scores += rules.Scores();
       baseCases += rules.BaseCases();
+      Counter::Add("neighbor_search/prunes", traverser.NumPrunes());
 
       Log::Info << rules.Scores() << " node combinations were scored."
           << std::endl;
@@ -643,6 +729,7 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
 
       scores += rules.Scores();
       baseCases += rules.BaseCases();
+      Counter::Add("neighbor_search/prunes", traverser.NumPrunes());
 
       Log::Info << rules.Scores() << " node combinations were scored."
           << std::endl;
@@ -668,6 +755,7 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
 
       scores += rules.Scores();
       baseCases += rules.BaseCases();
+      Counter::Add("neighbor_search/prunes", traverser.NumPrunes());
 
       Log::Info << rules.Scores() << " node combinations were scored."
           << std::endl;
@@ -681,6 +769,9 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
 
   Timer::Stop("computing_neighbors");
 
+  Counter::Add("neighbor_search/base_cases", baseCases);
+  Counter::Add("neighbor_search/scores", scores);
+
   // Map points back to original indices, if necessary.
   if (tree::TreeTraits<Tree>::RearrangesDataset)
   {
@@ -739,7 +830,7 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
       delete neighborPtr;
     }
   }
-} // Search()
+} // SearchTree()
 
 template<typename SortPolicy,
          typename MetricType,
@@ -757,11 +848,11 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
     arma::mat& distances,
     bool sameSet)
 {
-  if (k > referenceSet->n_cols)
+  if (k > NumReferencePoints())
   {
     std::stringstream ss;
     ss << "requested value of k (" << k << ") is greater than the number of "
-        << "points in the reference set (" << referenceSet->n_cols << ")";
+        << "points in the reference set (" << NumReferencePoints() << ")";
     throw std::invalid_argument(ss.str());
   }
 
@@ -770,6 +861,58 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
     throw std::invalid_argument("cannot call NeighborSearch::Search() with a "
         "query tree when naive or singleMode are set to true");
 
+  if (!HasUpdates())
+  {
+    SearchTree(queryTree, k, neighbors, distances, sameSet);
+    return;
+  }
+
+  if (sameSet)
+    throw std::invalid_argument("cannot call NeighborSearch::Search() with "
+        "sameSet = true while there are insertions or deletions that are not "
+        "merged into the reference tree; call Rebuild() first");
+
+  // See the other overload of Search().
+  const size_t treeSize = referenceSet->n_cols;
+  const size_t treeDeleted = std::lower_bound(deletedIds.begin(),
+      deletedIds.end(), treeSize) - deletedIds.begin();
+  const size_t treeK = std::min(k + treeDeleted, treeSize);
+
+  const MatType& querySet = queryTree.Dataset();
+  arma::Mat<size_t> treeNeighbors;
+  arma::mat treeDistances;
+  if (treeK > 0)
+  {
+    SearchTree(queryTree, treeK, treeNeighbors, treeDistances, false);
+  }
+  else
+  {
+    treeNeighbors.set_size(0, querySet.n_cols);
+    treeDistances.set_size(0, querySet.n_cols);
+    baseCases = 0;
+    scores = 0;
+  }
+
+  MergeUpdates(querySet, k, treeNeighbors, treeDistances, neighbors,
+      distances);
+}
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename> class DualTreeTraversalType,
+         template<typename> class SingleTreeTraversalType>
+void NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
+DualTreeTraversalType, SingleTreeTraversalType>::SearchTree(
+    Tree& queryTree,
+    const size_t k,
+    arma::Mat<size_t>& neighbors,
+    arma::mat& distances,
+    bool sameSet)
+{
   Timer::Start("computing_neighbors");
 
   baseCases = 0;
@@ -798,6 +941,7 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
 
   scores += rules.Scores();
   baseCases += rules.BaseCases();
+  Counter::Add("neighbor_search/prunes", traverser.NumPrunes());
 
   Log::Info << rules.Scores() << " node combinations were scored." << std::endl;
   Log::Info << rules.BaseCases() << " base cases were calculated." << std::endl;
@@ -809,6 +953,9 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
 
   Timer::Stop("computing_neighbors");
 
+  Counter::Add("neighbor_search/base_cases", baseCases);
+  Counter::Add("neighbor_search/scores", scores);
+
   // Do we need to map indices?
   if (!oldFromNewReferences.empty() &&
       tree::TreeTraits<Tree>::RearrangesDataset)
@@ -840,6 +987,10 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
     arma::Mat<size_t>& neighbors,
     arma::mat& distances)
 {
+  // The reference set is also the query set, so all pending insertions and
+  // deletions are merged into the tree first.
+  Rebuild();
+
   if (k > referenceSet->n_cols)
   {
     std::stringstream ss;
@@ -896,6 +1047,7 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
 
       scores += rules.Scores();
       baseCases += rules.BaseCases();
+      Counter::Add("neighbor_search/prunes", traverser.NumPrunes());
 
       Log::Info << rules.Scores() << " node combinations were scored."
           << std::endl;
@@ -944,6 +1096,7 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
 
       scores += rules.Scores();
       baseCases += rules.BaseCases();
+      Counter::Add("neighbor_search/prunes", traverser.NumPrunes());
 
       Log::Info << rules.Scores() << " node combinations were scored."
           << std::endl;
@@ -965,6 +1118,7 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
 
       scores += rules.Scores();
       baseCases += rules.BaseCases();
+      Counter::Add("neighbor_search/prunes", traverser.NumPrunes());
 
       Log::Info << rules.Scores() << " node combinations were scored."
           << std::endl;
@@ -978,6 +1132,9 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
 
   Timer::Stop("computing_neighbors");
 
+  Counter::Add("neighbor_search/base_cases", baseCases);
+  Counter::Add("neighbor_search/scores", scores);
+
   // Do we need to map the reference indices?
   if (!oldFromNewReferences.empty() &&
       tree::TreeTraits<Tree>::RearrangesDataset)
@@ -1002,6 +1159,250 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
   }
 }
 
+//! Add points to the reference set.
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename> class DualTreeTraversalType,
+         template<typename> class SingleTreeTraversalType>
+void NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
+DualTreeTraversalType, SingleTreeTraversalType>::Insert(const MatType& points)
+{
+  InsertPoints(points);
+  if (NeedsRebuild())
+    Rebuild();
+}
+
+//! Remove a point from the reference set.
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename> class DualTreeTraversalType,
+         template<typename> class SingleTreeTraversalType>
+void NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
+DualTreeTraversalType, SingleTreeTraversalType>::Delete(const size_t index)
+{
+  DeletePoint(index);
+  if (NeedsRebuild())
+    Rebuild();
+}
+
+//! Merge all pending insertions and deletions into the reference tree.
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename> class DualTreeTraversalType,
+         template<typename> class SingleTreeTraversalType>
+void NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
+DualTreeTraversalType, SingleTreeTraversalType>::Rebuild()
+{
+  if (!HasUpdates())
+    return;
+
+  MatType points;
+  UpdatedReferenceSet(points);
+  Train(std::move(points));
+}
+
+//! Add points to the buffer of inserted points.
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename> class DualTreeTraversalType,
+         template<typename> class SingleTreeTraversalType>
+void NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
+DualTreeTraversalType, SingleTreeTraversalType>::InsertPoints(const MatType& points)
+{
+  if (points.n_cols == 0)
+    return;
+
+  const size_t dimensionality = (referenceSet->n_cols > 0) ?
+      referenceSet->n_rows : insertedSet.n_rows;
+  if ((referenceSet->n_cols > 0 || insertedSet.n_cols > 0) &&
+      points.n_rows != dimensionality)
+  {
+    std::stringstream ss;
+    ss << "dimensionality of inserted points (" << points.n_rows << ") does "
+        << "not match dimensionality of reference set (" << dimensionality
+        << ")";
+    throw std::invalid_argument(ss.str());
+  }
+
+  if (insertedSet.n_cols == 0)
+    insertedSet = points;
+  else
+    insertedSet.insert_cols(insertedSet.n_cols, points);
+}
+
+//! Mark a point as deleted.
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename> class DualTreeTraversalType,
+         template<typename> class SingleTreeTraversalType>
+void NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
+DualTreeTraversalType, SingleTreeTraversalType>::DeletePoint(const size_t index)
+{
+  if (index >= NumReferencePoints())
+  {
+    std::stringstream ss;
+    ss << "cannot delete point " << index << "; there are only "
+        << NumReferencePoints() << " points in the reference set";
+    throw std::invalid_argument(ss.str());
+  }
+
+  // The index-th live id is found by skipping over the deleted ids that come
+  // before it.
+  size_t id = index;
+  for (size_t i = 0; i < deletedIds.size() && deletedIds[i] <= id; ++i)
+    ++id;
+
+  deletedIds.insert(std::upper_bound(deletedIds.begin(), deletedIds.end(), id),
+      id);
+}
+
+//! Assemble the current reference set.
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename> class DualTreeTraversalType,
+         template<typename> class SingleTreeTraversalType>
+void NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
+DualTreeTraversalType, SingleTreeTraversalType>::UpdatedReferenceSet(MatType& points) const
+{
+  const size_t treeSize = referenceSet->n_cols;
+  points.set_size((treeSize > 0) ? referenceSet->n_rows : insertedSet.n_rows,
+      NumReferencePoints());
+
+  // The index of a live point is its id minus the number of deleted ids
+  // before it.
+  for (size_t i = 0; i < treeSize + insertedSet.n_cols; ++i)
+  {
+    size_t id = i;
+    if (i < treeSize && !oldFromNewReferences.empty())
+      id = oldFromNewReferences[i];
+
+    const size_t numDeleted = std::lower_bound(deletedIds.begin(),
+        deletedIds.end(), id) - deletedIds.begin();
+    if (numDeleted < deletedIds.size() && deletedIds[numDeleted] == id)
+      continue;
+
+    if (i < treeSize)
+      points.col(id - numDeleted) = referenceSet->col(i);
+    else
+      points.col(id - numDeleted) = insertedSet.col(i - treeSize);
+  }
+}
+
+//! Combine the results of the tree search with the pending updates.
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename> class DualTreeTraversalType,
+         template<typename> class SingleTreeTraversalType>
+void NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
+DualTreeTraversalType, SingleTreeTraversalType>::MergeUpdates(
+    const MatType& querySet,
+    const size_t k,
+    const arma::Mat<size_t>& treeNeighbors,
+    const arma::mat& treeDistances,
+    arma::Mat<size_t>& neighbors,
+    arma::mat& distances)
+{
+  Timer::Start("computing_neighbors");
+
+  neighbors.set_size(k, querySet.n_cols);
+  distances.set_size(k, querySet.n_cols);
+
+  typedef std::pair<double, size_t> Candidate;
+  const size_t treeSize = referenceSet->n_cols;
+  size_t bufferBaseCases = 0;
+
+  #pragma omp parallel for schedule(dynamic) reduction(+:bufferBaseCases)
+  for (omp_size_t i = 0; i < (omp_size_t) querySet.n_cols; ++i)
+  {
+    // Some metrics are not safe to evaluate concurrently.
+    MetricType threadMetric(metric);
+
+    std::vector<Candidate> candidates;
+    candidates.reserve(treeNeighbors.n_rows + insertedSet.n_cols);
+
+    // Results of the tree search that were deleted, or that the tree could not
+    // fill (they have an invalid index), are dropped.
+    for (size_t j = 0; j < treeNeighbors.n_rows; ++j)
+    {
+      const size_t id = treeNeighbors(j, i);
+      if (id < treeSize &&
+          !std::binary_search(deletedIds.begin(), deletedIds.end(), id))
+        candidates.push_back(Candidate(treeDistances(j, i), id));
+    }
+
+    for (size_t j = 0; j < insertedSet.n_cols; ++j)
+    {
+      const size_t id = treeSize + j;
+      if (std::binary_search(deletedIds.begin(), deletedIds.end(), id))
+        continue;
+
+      candidates.push_back(Candidate(threadMetric.Evaluate(querySet.col(i),
+          insertedSet.col(j)), id));
+      ++bufferBaseCases;
+    }
+
+    // Ties are broken by id, so the results do not depend on the order in
+    // which the candidates were found.
+    const size_t numFound = std::min(k, candidates.size());
+    std::partial_sort(candidates.begin(), candidates.begin() + numFound,
+        candidates.end(), [](const Candidate& a, const Candidate& b)
+        {
+          if (a.first != b.first)
+            return SortPolicy::IsBetter(a.first, b.first);
+          return a.second < b.second;
+        });
+
+    for (size_t j = 0; j < k; ++j)
+    {
+      if (j < numFound)
+      {
+        const size_t id = candidates[j].second;
+        distances(j, i) = candidates[j].first;
+        neighbors(j, i) = id - (std::lower_bound(deletedIds.begin(),
+            deletedIds.end(), id) - deletedIds.begin());
+      }
+      else
+      {
+        distances(j, i) = SortPolicy::WorstDistance();
+        neighbors(j, i) = size_t() - 1;
+      }
+    }
+  }
+
+  baseCases += bufferBaseCases;
+  Counter::Add("neighbor_search/base_cases", bufferBaseCases);
+
+  Timer::Stop("computing_neighbors");
+}
+
 //! Calculate the average relative error.
 template<typename SortPolicy,
          typename MetricType,
@@ -1084,7 +1485,7 @@ template<typename Archive>
 void NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
 DualTreeTraversalType, SingleTreeTraversalType>::serialize(
     Archive& ar,
-    const unsigned int /* version */)
+    const unsigned int version)
 {
   // Serialize preferences for search.
   ar & BOOST_SERIALIZATION_NVP(searchMode);
@@ -1145,6 +1546,21 @@ DualTreeTraversalType, SingleTreeTraversalType>::serialize(
     }
   }
 
+  // Insertions and deletions that are not merged into the tree are only saved
+  // since version 1.
+  if (version > 0)
+  {
+    ar & BOOST_SERIALIZATION_NVP(insertedSet);
+    ar & BOOST_SERIALIZATION_NVP(deletedIds);
+    ar & BOOST_SERIALIZATION_NVP(rebuildRatio);
+  }
+  else if (Archive::is_loading::value)
+  {
+    insertedSet.reset();
+    deletedIds.clear();
+    rebuildRatio = 0.05;
+  }
+
   // Reset base cases and scores.
   if (Archive::is_loading::value)
   {
@@ -190,6 +190,56 @@ class TrainVisitor : public boost::static_visitor<void>
                const double rho);
 };
 
+/**
+ * UpdateVisitor inserts points into and deletes points from the reference set
+ * of the given NSType.  When the reference tree has to be rebuilt, it is
+ * rebuilt with TrainVisitor, so that the leafSize, tau and rho of the model are
+ * kept.
+ */
+template<typename SortPolicy>
+class UpdateVisitor : public boost::static_visitor<void>
+{
+ private:
+  //! The points to insert (may be empty).
+  const arma::mat& insertions;
+  //! The indices of the points to delete, in the order they are deleted.
+  const std::vector<size_t>& deletions;
+  //! If true, the reference tree is rebuilt after the updates.
+  const bool rebuild;
+  //! The leaf size, used only by BinarySpaceTree.
+  size_t leafSize;
+  //! Overlapping size (for spill trees).
+  const double tau;
+  //! Balance threshold (for spill trees).
+  const double rho;
+
+ public:
+  //! Update the reference set of the given NSType instance.
+  template<typename NSType>
+  void operator()(NSType* ns) const;
+
+  //! Construct the UpdateVisitor object with the given updates, and the
+  //! parameters to rebuild the reference tree with.
+  UpdateVisitor(const arma::mat& insertions,
+                const std::vector<size_t>& deletions,
+                const bool rebuild,
+                const size_t leafSize,
+                const double tau,
+                const double rho);
+};
+
+/**
+ * NumReferencePointsVisitor returns the number of points in the reference set
+ * of the given NSType, including the pending insertions and deletions.
+ */
+class NumReferencePointsVisitor : public boost::static_visitor<size_t>
+{
+ public:
+  //! Return the number of reference points.
+  template<typename NSType>
+  size_t operator()(NSType* ns) const;
+};
+
 /**
  * SearchModeVisitor exposes the SearchMode() method of the given NSType.
  */
@@ -352,9 +402,14 @@ class NSModel
   template<typename Archive>
   void serialize(Archive& ar, const unsigned int /* version */);
 
-  //! Expose the dataset.
+  //! Expose the dataset.  This does not contain the insertions and deletions
+  //! that are not merged into the reference tree yet.
   const arma::mat& Dataset() const;
 
+  //! Get the number of reference points, including the insertions and
+  //! deletions that are not merged into the reference tree yet.
+  size_t NumReferencePoints() const;
+
   //! Expose SearchMode.
   NeighborSearchMode SearchMode() const;
   NeighborSearchMode& SearchMode();
@@ -389,6 +444,23 @@ class NSModel
                   const NeighborSearchMode searchMode,
                   const double epsilon = 0);
 
+  /**
+   * Add the given points to the reference set, without rebuilding the whole
+   * model.  See NeighborSearch::Insert().  If a random basis is used, the
+   * points are projected onto it.
+   */
+  void Insert(arma::mat&& points);
+
+  /**
+   * Remove the point with the given index from the reference set, without
+   * rebuilding the whole model.  The indices of the following points are
+   * decreased by one.  See NeighborSearch::Delete().
+   */
+  void Delete(const size_t index);
+
+  //! Merge all pending insertions and deletions into the reference tree.
+  void Rebuild();
+
   //! Perform neighbor search.  The query set will be reordered.
   void Search(arma::mat&& querySet,
               const size_t k,
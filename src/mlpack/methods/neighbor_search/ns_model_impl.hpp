@@ -225,6 +225,54 @@ void TrainVisitor<SortPolicy>::TrainLeaf(NSType* ns) const
   }
 }
 
+//! Save the updates and the parameters to rebuild the tree with.
+template<typename SortPolicy>
+UpdateVisitor<SortPolicy>::UpdateVisitor(const arma::mat& insertions,
+                                         const std::vector<size_t>& deletions,
+                                         const bool rebuild,
+                                         const size_t leafSize,
+                                         const double tau,
+                                         const double rho) :
+    insertions(insertions),
+    deletions(deletions),
+    rebuild(rebuild),
+    leafSize(leafSize),
+    tau(tau),
+    rho(rho)
+{}
+
+//! Update the reference set of the given NSType instance.
+template<typename SortPolicy>
+template<typename NSType>
+void UpdateVisitor<SortPolicy>::operator()(NSType* ns) const
+{
+  if (!ns)
+    throw std::runtime_error("no neighbor search model initialized");
+
+  ns->InsertPoints(insertions);
+  for (size_t i = 0; i < deletions.size(); ++i)
+    ns->DeletePoint(deletions[i]);
+
+  // The tree is rebuilt here instead of in NeighborSearch, so that it is built
+  // with the parameters of the model.
+  if (ns->HasUpdates() && (rebuild || ns->NeedsRebuild()))
+  {
+    arma::mat referenceSet;
+    ns->UpdatedReferenceSet(referenceSet);
+    TrainVisitor<SortPolicy> tn(std::move(referenceSet), leafSize, tau, rho);
+    tn(ns);
+  }
+}
+
+//! Return the number of reference points.
+template<typename NSType>
+size_t NumReferencePointsVisitor::operator()(NSType* ns) const
+{
+  if (ns)
+    return ns->NumReferencePoints();
+  throw std::runtime_error("no neighbor search model initialized");
+}
+
 //! Return the search mode.
 template<typename NSType>
 NeighborSearchMode& SearchModeVisitor::operator()(NSType* ns) const
@@ -386,6 +434,13 @@ const arma::mat& NSModel<SortPolicy>::Dataset() const
   return boost::apply_visitor(ReferenceSetVisitor(), nSearch);
 }
 
+//! Get the number of reference points.
+template<typename SortPolicy>
+size_t NSModel<SortPolicy>::NumReferencePoints() const
+{
+  return boost::apply_visitor(NumReferencePointsVisitor(), nSearch);
+}
+
 //! Access the search mode.
 template<typename SortPolicy>
 NeighborSearchMode NSModel<SortPolicy>::SearchMode() const
@@ -526,6 +581,42 @@ void NSModel<SortPolicy>::BuildModel(arma::mat&& referenceSet,
   }
 }
 
+//! Add points to the reference set.
+template<typename SortPolicy>
+void NSModel<SortPolicy>::Insert(arma::mat&& points)
+{
+  // We may need to map the points randomly.
+  if (randomBasis)
+    points = q * points;
+
+  const std::vector<size_t> deletions;
+  UpdateVisitor<SortPolicy> update(points, deletions, false, leafSize, tau,
+      rho);
+  boost::apply_visitor(update, nSearch);
+}
+
+//! Remove a point from the reference set.
+template<typename SortPolicy>
+void NSModel<SortPolicy>::Delete(const size_t index)
+{
+  const arma::mat insertions;
+  const std::vector<size_t> deletions(1, index);
+  UpdateVisitor<SortPolicy> update(insertions, deletions, false, leafSize, tau,
+      rho);
+  boost::apply_visitor(update, nSearch);
+}
+
+//! Merge all pending insertions and deletions into the reference tree.
+template<typename SortPolicy>
+void NSModel<SortPolicy>::Rebuild()
+{
+  const arma::mat insertions;
+  const std::vector<size_t> deletions;
+  UpdateVisitor<SortPolicy> update(insertions, deletions, true, leafSize, tau,
+      rho);
+  boost::apply_visitor(update, nSearch);
+}
+
 //! Perform neighbor search.  The query set will be reordered.
 template<typename SortPolicy>
 void NSModel<SortPolicy>::Search(arma::mat&& querySet,
@@ -590,6 +681,10 @@ void NSModel<SortPolicy>::Search(const size_t k,
     Log::Info << "Maximum of " << Epsilon() * 100 << "% relative error."
         << std::endl;
 
+  // Pending insertions and deletions are merged first, so that the tree is
+  // rebuilt with the parameters of the model.
+  Rebuild();
+
   MonoSearchVisitor search(k, neighbors, distances);
   boost::apply_visitor(search, nSearch);
 }
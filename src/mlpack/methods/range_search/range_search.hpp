@@ -17,6 +17,7 @@
 #include <mlpack/core/metrics/lmetric.hpp>
 #include <mlpack/core/tree/binary_space_tree.hpp>
 #include "range_search_stat.hpp"
+#include "range_search_results.hpp"
 
 namespace mlpack {
 namespace range /** Range-search routines. */ {
@@ -224,6 +225,23 @@ class RangeSearch
               std::vector<std::vector<size_t>>& neighbors,
               std::vector<std::vector<double>>& distances);
 
+  /**
+   * Search for all reference points in the given range for each point in the
+   * query set, writing each result to the given results object as it is
+   * found.  This can be used to avoid storing the results in nested vectors;
+   * see CSRResults, CountResults, and CallbackResults in
+   * range_search_results.hpp.
+   *
+   * @tparam ResultsType Type of object to write results to.
+   * @param querySet Set of query points to search with.
+   * @param range Range of distances in which to search.
+   * @param results Object to write results to.
+   */
+  template<typename ResultsType>
+  void Search(const MatType& querySet,
+              const math::Range& range,
+              ResultsType& results);
+
   /**
    * Given a pre-built query tree, search for all reference points in the given
    * range for each point in the query set, returning the results in the
@@ -265,6 +283,30 @@ class RangeSearch
               std::vector<std::vector<size_t>>& neighbors,
               std::vector<std::vector<double>>& distances);
 
+  /**
+   * Given a pre-built query tree, search for all reference points in the given
+   * range for each point in the query set, writing each result to the given
+   * results object as it is found.  Query indices refer to the points in the
+   * query tree's dataset, unless oldFromNewQueries is given, in which case
+   * they are mapped to the original query indices.
+   *
+   * If either naive or singleMode are set to true, this will throw an
+   * invalid_argument exception; passing in a query tree implies dual-tree
+   * search.
+   *
+   * @tparam ResultsType Type of object to write results to.
+   * @param queryTree Tree built on query points.
+   * @param range Range of distances in which to search.
+   * @param results Object to write results to.
+   * @param oldFromNewQueries Mapping returned by the query tree constructor,
+   *      if any.
+   */
+  template<typename ResultsType>
+  void Search(Tree* queryTree,
+              const math::Range& range,
+              ResultsType& results,
+              const std::vector<size_t>* oldFromNewQueries = NULL);
+
   /**
    * Search for all points in the given range for each point in the reference
    * set (which was passed to the constructor), returning the results in the
@@ -299,6 +341,18 @@ class RangeSearch
               std::vector<std::vector<size_t>>& neighbors,
               std::vector<std::vector<double>>& distances);
 
+  /**
+   * Search for all points in the given range for each point in the reference
+   * set, writing each result to the given results object as it is found.
+   * This means that the query set and the reference set are the same.
+   *
+   * @tparam ResultsType Type of object to write results to.
+   * @param range Range of distances in which to search.
+   * @param results Object to write results to.
+   */
+  template<typename ResultsType>
+  void Search(const math::Range& range, ResultsType& results);
+
   //! Get whether single-tree search is being used.
   bool SingleMode() const { return singleMode; }
   //! Modify whether single-tree search is being used.
@@ -351,6 +405,30 @@ class RangeSearch
   //! The total number of scores during the last search.
   size_t scores;
 
+  /**
+   * Perform a dual-tree search of the given query tree against the reference
+   * tree.  If more than one OpenMP thread is available, the query tree is split
+   * into disjoint subtrees that are traversed in parallel, each writing its
+   * results into a thread-local buffer; the buffers are then merged into the
+   * results object in a fixed order.  This sets baseCases and scores.
+   *
+   * @param queryTree Tree built on the query points.
+   * @param querySet Dataset of the query tree.
+   * @param range Range of distances in which to search.
+   * @param results Object to write results to.
+   * @param sameSet Whether the query set and reference set are the same.
+   * @param queryMapping Mapping to original query indices, if any.
+   * @param referenceMapping Mapping to original reference indices, if any.
+   */
+  template<typename ResultsType>
+  void DualTreeSearch(Tree* queryTree,
+                      const MatType& querySet,
+                      const math::Range& range,
+                      ResultsType& results,
+                      const bool sameSet,
+                      const std::vector<size_t>* queryMapping,
+                      const std::vector<size_t>* referenceMapping);
+
   //! For access to mappings when building models.
   friend class TrainVisitor;
 };
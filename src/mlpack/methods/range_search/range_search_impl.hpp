@@ -18,29 +18,15 @@
 // The rules for traversal.
 #include "range_search_rules.hpp"
 
-namespace mlpack {
-namespace range {
+#include <mlpack/core/tree/build_tree.hpp>
+#include <mlpack/core/tree/split_query_tree.hpp>
 
-template<typename TreeType, typename MatType>
-TreeType* BuildTree(
-    MatType&& dataset,
-    std::vector<size_t>& oldFromNew,
-    const typename std::enable_if<
-        tree::TreeTraits<TreeType>::RearrangesDataset>::type* = 0)
-{
-  return new TreeType(std::forward<MatType>(dataset), oldFromNew);
-}
+#ifdef HAS_OPENMP
+  #include <omp.h>
+#endif
 
-//! Call the tree constructor that does not do mapping.
-template<typename TreeType, typename MatType>
-TreeType* BuildTree(
-    MatType&& dataset,
-    const std::vector<size_t>& /* oldFromNew */,
-    const typename std::enable_if<
-        !tree::TreeTraits<TreeType>::RearrangesDataset>::type* = 0)
-{
-  return new TreeType(std::forward<MatType>(dataset));
-}
+namespace mlpack {
+namespace range {
 
 template<typename MetricType,
          typename MatType,
@@ -52,7 +38,7 @@ RangeSearch<MetricType, MatType, TreeType>::RangeSearch(
     const bool naive,
     const bool singleMode,
     const MetricType metric) :
-    referenceTree(naive ? NULL : BuildTree<Tree>(referenceSetIn,
+    referenceTree(naive ? NULL : tree::BuildTree<Tree>(referenceSetIn,
         oldFromNewReferences)),
     referenceSet(naive ? &referenceSetIn : &referenceTree->Dataset()),
     treeOwner(!naive), // If in naive mode, we are not building any trees.
@@ -77,7 +63,7 @@ RangeSearch<MetricType, MatType, TreeType>::RangeSearch(
     const bool naive,
     const bool singleMode,
     const MetricType metric) :
-    referenceTree(naive ? NULL : BuildTree<Tree>(std::move(referenceSet),
+    referenceTree(naive ? NULL : tree::BuildTree<Tree>(std::move(referenceSet),
         oldFromNewReferences)),
     referenceSet(naive ? new MatType(std::move(referenceSet)) :
         &referenceTree->Dataset()),
@@ -136,7 +122,7 @@ RangeSearch<MetricType, MatType, TreeType>::RangeSearch(
   // Build the tree on the empty dataset, if necessary.
   if (!naive)
   {
-    referenceTree = BuildTree<Tree>(const_cast<MatType&>(*referenceSet),
+    referenceTree = tree::BuildTree<Tree>(const_cast<MatType&>(*referenceSet),
         oldFromNewReferences);
     treeOwner = true;
   }
@@ -184,7 +170,7 @@ RangeSearch<MetricType, MatType, TreeType>::RangeSearch(RangeSearch&& other) :
   // Clear other object.
   other.referenceSet = new MatType();
   other.referenceTree =
-      BuildTree<Tree>(const_cast<MatType&>(*other.referenceSet),
+      tree::BuildTree<Tree>(const_cast<MatType&>(*other.referenceSet),
       other.oldFromNewReferences);
   other.treeOwner = true;
   other.setOwner = true;
@@ -253,7 +239,7 @@ RangeSearch<MetricType, MatType, TreeType>::operator=(RangeSearch&& other)
   // Clean other model.
   other.referenceSet = new MatType();
   other.referenceTree =
-      BuildTree<Tree>(const_cast<MatType&>(*other.referenceSet),
+      tree::BuildTree<Tree>(const_cast<MatType&>(*other.referenceSet),
       other.oldFromNewReferences);
   other.treeOwner = true;
   other.setOwner = true;
@@ -293,7 +279,7 @@ void RangeSearch<MetricType, MatType, TreeType>::Train(
   // Rebuild the tree, if necessary.
   if (!naive)
   {
-    referenceTree = BuildTree<Tree>(const_cast<MatType&>(referenceSet),
+    referenceTree = tree::BuildTree<Tree>(const_cast<MatType&>(referenceSet),
         oldFromNewReferences);
     treeOwner = true;
   }
@@ -328,7 +314,7 @@ void RangeSearch<MetricType, MatType, TreeType>::Train(
   // We may need to rebuild the tree.
   if (!naive)
   {
-    referenceTree = BuildTree<Tree>(std::move(referenceSet),
+    referenceTree = tree::BuildTree<Tree>(std::move(referenceSet),
         oldFromNewReferences);
     treeOwner = true;
   }
@@ -386,6 +372,21 @@ void RangeSearch<MetricType, MatType, TreeType>::Search(
     const math::Range& range,
     std::vector<std::vector<size_t>>& neighbors,
     std::vector<std::vector<double>>& distances)
+{
+  NestedVectorResults results(neighbors, distances);
+  Search(querySet, range, results);
+}
+
+template<typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+template<typename ResultsType>
+void RangeSearch<MetricType, MatType, TreeType>::Search(
+    const MatType& querySet,
+    const math::Range& range,
+    ResultsType& results)
 {
   if (querySet.n_rows != referenceSet->n_rows)
   {
@@ -396,47 +397,30 @@ void RangeSearch<MetricType, MatType, TreeType>::Search(
     throw std::invalid_argument(oss.str());
   }
 
+  results.Reset(querySet.n_cols);
+
   // If there are no points, there is no search to be done.
   if (referenceSet->n_cols == 0)
+  {
+    results.Finalize();
     return;
+  }
 
   Timer::Start("range_search/computing_neighbors");
 
   // This will hold mappings for query points, if necessary.
   std::vector<size_t> oldFromNewQueries;
 
-  // If we have built the trees ourselves, then we will have to map all the
-  // indices back to their original indices when this computation is finished.
-  // To avoid extra copies, we will store the unmapped neighbors and distances
-  // in a separate object.
-  std::vector<std::vector<size_t>>* neighborPtr = &neighbors;
-  std::vector<std::vector<double>>* distancePtr = &distances;
-
-  // Mapping is only necessary if the tree rearranges points.
-  if (tree::TreeTraits<Tree>::RearrangesDataset)
-  {
-    // Query indices only need to be mapped if we are building the query tree
-    // ourselves.
-    if (!singleMode && !naive)
-    {
-      distancePtr = new std::vector<std::vector<double>>;
-      neighborPtr = new std::vector<std::vector<size_t>>;
-    }
-
-    // Reference indices only need to be mapped if we built the reference tree
-    // ourselves.
-    else if (treeOwner)
-      neighborPtr = new std::vector<std::vector<size_t>>;
-  }
-
-  // Resize each vector.
-  neighborPtr->clear(); // Just in case there was anything in it.
-  neighborPtr->resize(querySet.n_cols);
-  distancePtr->clear();
-  distancePtr->resize(querySet.n_cols);
+  // If we have built the trees ourselves, then the rules will have to map all
+  // the indices back to their original indices before they are written to the
+  // results.  Reference indices only need to be mapped if we built the
+  // reference tree ourselves, and only if the tree rearranges points.
+  const std::vector<size_t>* referenceMapping =
+      (treeOwner && tree::TreeTraits<Tree>::RearrangesDataset) ?
+      &oldFromNewReferences : NULL;
 
   // Create the helper object for the traversal.
-  typedef RangeSearchRules<MetricType, Tree> RuleType;
+  typedef RangeSearchRules<MetricType, Tree, ResultsType> RuleType;
 
   // Reset counts.
   baseCases = 0;
@@ -444,8 +428,7 @@ void RangeSearch<MetricType, MatType, TreeType>::Search(
 
   if (naive)
   {
-    RuleType rules(*referenceSet, querySet, range, *neighborPtr, *distancePtr,
-        metric);
+    RuleType rules(*referenceSet, querySet, range, results, metric);
 
     // The naive brute-force solution.
     for (size_t i = 0; i < querySet.n_cols; ++i)
@@ -457,8 +440,8 @@ void RangeSearch<MetricType, MatType, TreeType>::Search(
   else if (singleMode)
   {
     // Create the traverser.
-    RuleType rules(*referenceSet, querySet, range, *neighborPtr, *distancePtr,
-        metric);
+    RuleType rules(*referenceSet, querySet, range, results, metric, false,
+        NULL, referenceMapping);
     typename Tree::template SingleTreeTraverser<RuleType> traverser(rules);
 
     // Now have it traverse for each point.
@@ -467,97 +450,34 @@ void RangeSearch<MetricType, MatType, TreeType>::Search(
 
     baseCases += rules.BaseCases();
     scores += rules.Scores();
+    Counter::Add("range_search/prunes", traverser.NumPrunes());
   }
   else // Dual-tree recursion.
   {
     // Build the query tree.
     Timer::Stop("range_search/computing_neighbors");
     Timer::Start("range_search/tree_building");
-    Tree* queryTree = BuildTree<Tree>(querySet, oldFromNewQueries);
+    Tree* queryTree = tree::BuildTree<Tree>(querySet, oldFromNewQueries);
     Timer::Stop("range_search/tree_building");
     Timer::Start("range_search/computing_neighbors");
 
-    // Create the traverser.
-    RuleType rules(*referenceSet, queryTree->Dataset(), range, *neighborPtr,
-        *distancePtr, metric);
-    typename Tree::template DualTreeTraverser<RuleType> traverser(rules);
+    // Query indices only need to be mapped if the query tree rearranged them.
+    const std::vector<size_t>* queryMapping =
+        tree::TreeTraits<Tree>::RearrangesDataset ? &oldFromNewQueries : NULL;
 
-    traverser.Traverse(*queryTree, *referenceTree);
-
-    baseCases += rules.BaseCases();
-    scores += rules.Scores();
+    DualTreeSearch(queryTree, queryTree->Dataset(), range, results, false,
+        queryMapping, referenceMapping);
 
     // Clean up tree memory.
     delete queryTree;
   }
 
+  results.Finalize();
+
   Timer::Stop("range_search/computing_neighbors");
 
-  // Map points back to original indices, if necessary.
-  if (tree::TreeTraits<Tree>::RearrangesDataset)
-  {
-    if (!singleMode && !naive && treeOwner)
-    {
-      // We must map both query and reference indices.
-      neighbors.clear();
-      neighbors.resize(querySet.n_cols);
-      distances.clear();
-      distances.resize(querySet.n_cols);
-
-      for (size_t i = 0; i < distances.size(); i++)
-      {
-        // Map distances (copy a column).
-        const size_t queryMapping = oldFromNewQueries[i];
-        distances[queryMapping] = (*distancePtr)[i];
-
-        // Copy each neighbor individually, because we need to map it.
-        neighbors[queryMapping].resize(distances[queryMapping].size());
-        for (size_t j = 0; j < distances[queryMapping].size(); j++)
-          neighbors[queryMapping][j] =
-              oldFromNewReferences[(*neighborPtr)[i][j]];
-      }
-
-      // Finished with temporary objects.
-      delete neighborPtr;
-      delete distancePtr;
-    }
-    else if (!singleMode && !naive)
-    {
-      // We must map query indices only.
-      neighbors.clear();
-      neighbors.resize(querySet.n_cols);
-      distances.clear();
-      distances.resize(querySet.n_cols);
-
-      for (size_t i = 0; i < distances.size(); ++i)
-      {
-        // Map distances and neighbors (copy a column).
-        const size_t queryMapping = oldFromNewQueries[i];
-        distances[queryMapping] = (*distancePtr)[i];
-        neighbors[queryMapping] = (*neighborPtr)[i];
-      }
-
-      // Finished with temporary objects.
-      delete neighborPtr;
-      delete distancePtr;
-    }
-    else if (treeOwner)
-    {
-      // We must map reference indices only.
-      neighbors.clear();
-      neighbors.resize(querySet.n_cols);
-
-      for (size_t i = 0; i < neighbors.size(); i++)
-      {
-        neighbors[i].resize((*neighborPtr)[i].size());
-        for (size_t j = 0; j < neighbors[i].size(); j++)
-          neighbors[i][j] = oldFromNewReferences[(*neighborPtr)[i][j]];
-      }
-
-      // Finished with temporary object.
-      delete neighborPtr;
-    }
-  }
+  Counter::Add("range_search/base_cases", baseCases);
+  Counter::Add("range_search/scores", scores);
 }
 
 template<typename MetricType,
@@ -571,64 +491,56 @@ void RangeSearch<MetricType, MatType, TreeType>::Search(
     std::vector<std::vector<size_t>>& neighbors,
     std::vector<std::vector<double>>& distances)
 {
-  // If there are no points, there is no search to be done.
-  if (referenceSet->n_cols == 0)
-    return;
-
-  Timer::Start("range_search/computing_neighbors");
-
-  // Get a reference to the query set.
-  const MatType& querySet = queryTree->Dataset();
+  NestedVectorResults results(neighbors, distances);
+  Search(queryTree, range, results);
+}
 
+template<typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+template<typename ResultsType>
+void RangeSearch<MetricType, MatType, TreeType>::Search(
+    Tree* queryTree,
+    const math::Range& range,
+    ResultsType& results,
+    const std::vector<size_t>* oldFromNewQueries)
+{
   // Make sure we are in dual-tree mode.
   if (singleMode || naive)
     throw std::invalid_argument("cannot call RangeSearch::Search() with a "
         "query tree when naive or singleMode are set to true");
 
-  // We won't need to map query indices, but will we need to map distances?
-  std::vector<std::vector<size_t>>* neighborPtr = &neighbors;
-
-  if (treeOwner && tree::TreeTraits<Tree>::RearrangesDataset)
-    neighborPtr = new std::vector<std::vector<size_t>>;
-
-  // Resize each vector.
-  neighborPtr->clear(); // Just in case there was anything in it.
-  neighborPtr->resize(querySet.n_cols);
-  distances.clear();
-  distances.resize(querySet.n_cols);
+  // Get a reference to the query set.
+  const MatType& querySet = queryTree->Dataset();
 
-  // Create the helper object for the traversal.
-  typedef RangeSearchRules<MetricType, Tree> RuleType;
-  RuleType rules(*referenceSet, queryTree->Dataset(), range, *neighborPtr,
-      distances, metric);
+  results.Reset(querySet.n_cols);
 
-  // Create the traverser.
-  typename Tree::template DualTreeTraverser<RuleType> traverser(rules);
+  // If there are no points, there is no search to be done.
+  if (referenceSet->n_cols == 0)
+  {
+    results.Finalize();
+    return;
+  }
 
-  traverser.Traverse(*queryTree, *referenceTree);
+  Timer::Start("range_search/computing_neighbors");
 
-  Timer::Stop("range_search/computing_neighbors");
+  // We won't need to map query indices unless we were asked to, but will we
+  // need to map reference indices?
+  const std::vector<size_t>* referenceMapping =
+      (treeOwner && tree::TreeTraits<Tree>::RearrangesDataset) ?
+      &oldFromNewReferences : NULL;
 
-  baseCases = rules.BaseCases();
-  scores = rules.Scores();
+  DualTreeSearch(queryTree, querySet, range, results, false,
+      oldFromNewQueries, referenceMapping);
 
-  // Do we need to map indices?
-  if (treeOwner && tree::TreeTraits<Tree>::RearrangesDataset)
-  {
-    // We must map reference indices only.
-    neighbors.clear();
-    neighbors.resize(querySet.n_cols);
+  results.Finalize();
 
-    for (size_t i = 0; i < neighbors.size(); i++)
-    {
-      neighbors[i].resize((*neighborPtr)[i].size());
-      for (size_t j = 0; j < neighbors[i].size(); j++)
-        neighbors[i][j] = oldFromNewReferences[(*neighborPtr)[i][j]];
-    }
+  Timer::Stop("range_search/computing_neighbors");
 
-    // Finished with temporary object.
-    delete neighborPtr;
-  }
+  Counter::Add("range_search/base_cases", baseCases);
+  Counter::Add("range_search/scores", scores);
 }
 
 template<typename MetricType,
@@ -641,36 +553,45 @@ void RangeSearch<MetricType, MatType, TreeType>::Search(
     std::vector<std::vector<size_t>>& neighbors,
     std::vector<std::vector<double>>& distances)
 {
+  NestedVectorResults results(neighbors, distances);
+  Search(range, results);
+}
+
+template<typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+template<typename ResultsType>
+void RangeSearch<MetricType, MatType, TreeType>::Search(
+    const math::Range& range,
+    ResultsType& results)
+{
+  results.Reset(referenceSet->n_cols);
+
   // If there are no points, there is no search to be done.
   if (referenceSet->n_cols == 0)
+  {
+    results.Finalize();
     return;
+  }
 
   Timer::Start("range_search/computing_neighbors");
 
-  // Here, we will use the query set as the reference set.
-  std::vector<std::vector<size_t>>* neighborPtr = &neighbors;
-  std::vector<std::vector<double>>* distancePtr = &distances;
-
-  if (tree::TreeTraits<Tree>::RearrangesDataset && treeOwner)
-  {
-    // We will always need to rearrange in this case.
-    distancePtr = new std::vector<std::vector<double>>;
-    neighborPtr = new std::vector<std::vector<size_t>>;
-  }
-
-  // Resize each vector.
-  neighborPtr->clear(); // Just in case there was anything in it.
-  neighborPtr->resize(referenceSet->n_cols);
-  distancePtr->clear();
-  distancePtr->resize(referenceSet->n_cols);
+  // Here, we will use the query set as the reference set, so if we need to map
+  // indices, both query and reference indices must be mapped.
+  const std::vector<size_t>* mapping =
+      (treeOwner && tree::TreeTraits<Tree>::RearrangesDataset) ?
+      &oldFromNewReferences : NULL;
 
   // Create the helper object for the traversal.
-  typedef RangeSearchRules<MetricType, Tree> RuleType;
-  RuleType rules(*referenceSet, *referenceSet, range, *neighborPtr,
-      *distancePtr, metric, true /* don't return the query in the results */);
+  typedef RangeSearchRules<MetricType, Tree, ResultsType> RuleType;
 
   if (naive)
   {
+    RuleType rules(*referenceSet, *referenceSet, range, results, metric,
+        true /* don't return the query in the results */, mapping, mapping);
+
     // The naive brute-force solution.
     for (size_t i = 0; i < referenceSet->n_cols; ++i)
       for (size_t j = 0; j < referenceSet->n_cols; ++j)
@@ -681,6 +602,9 @@ void RangeSearch<MetricType, MatType, TreeType>::Search(
   }
   else if (singleMode)
   {
+    RuleType rules(*referenceSet, *referenceSet, range, results, metric,
+        true /* don't return the query in the results */, mapping, mapping);
+
     // Create the traverser.
     typename Tree::template SingleTreeTraverser<RuleType> traverser(rules);
 
@@ -690,46 +614,99 @@ void RangeSearch<MetricType, MatType, TreeType>::Search(
 
     baseCases = rules.BaseCases();
     scores = rules.Scores();
+    Counter::Add("range_search/prunes", traverser.NumPrunes());
   }
   else // Dual-tree recursion.
   {
-    // Create the traverser.
+    DualTreeSearch(referenceTree, *referenceSet, range, results,
+        true /* don't return the query in the results */, mapping, mapping);
+  }
+
+  results.Finalize();
+
+  Timer::Stop("range_search/computing_neighbors");
+
+  Counter::Add("range_search/base_cases", baseCases);
+  Counter::Add("range_search/scores", scores);
+}
+
+template<typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+template<typename ResultsType>
+void RangeSearch<MetricType, MatType, TreeType>::DualTreeSearch(
+    Tree* queryTree,
+    const MatType& querySet,
+    const math::Range& range,
+    ResultsType& results,
+    const bool sameSet,
+    const std::vector<size_t>* queryMapping,
+    const std::vector<size_t>* referenceMapping)
+{
+  #ifdef HAS_OPENMP
+    const size_t numThreads = omp_get_max_threads();
+  #else
+    const size_t numThreads = 1;
+  #endif
+
+  // Split the query tree into several times more subtrees than there are
+  // threads, so that the work is balanced even though some subtrees are much
+  // more expensive than others.
+  std::vector<Tree*> subtrees;
+  if (numThreads > 1)
+    tree::SplitQueryTree(*queryTree, 4 * numThreads, subtrees);
+
+  if (subtrees.size() <= 1)
+  {
+    typedef RangeSearchRules<MetricType, Tree, ResultsType> RuleType;
+    RuleType rules(*referenceSet, querySet, range, results, metric, sameSet,
+        queryMapping, referenceMapping);
     typename Tree::template DualTreeTraverser<RuleType> traverser(rules);
 
-    traverser.Traverse(*referenceTree, *referenceTree);
+    traverser.Traverse(*queryTree, *referenceTree);
 
     baseCases = rules.BaseCases();
     scores = rules.Scores();
+    Counter::Add("range_search/prunes", traverser.NumPrunes());
+    return;
   }
 
-  Timer::Stop("range_search/computing_neighbors");
-
-  // Do we need to map the reference indices?
-  if (treeOwner && tree::TreeTraits<Tree>::RearrangesDataset)
+  // Each query point is held in exactly one subtree, so the traversals are
+  // independent.  Each one writes its results into its own buffer, and the
+  // buffers are passed to the results object in the order of the subtrees
+  // afterwards, so the results do not depend on the thread schedule.
+  typedef BufferedResults<ResultsType> BufferType;
+  typedef RangeSearchRules<MetricType, Tree, BufferType> RuleType;
+  std::vector<BufferType> buffers(subtrees.size());
+
+  size_t totalBaseCases = 0;
+  size_t totalScores = 0;
+  size_t totalPrunes = 0;
+
+  #pragma omp parallel for schedule(dynamic) \
+      reduction(+:totalBaseCases, totalScores, totalPrunes)
+  for (omp_size_t i = 0; i < (omp_size_t) subtrees.size(); ++i)
   {
-    neighbors.clear();
-    neighbors.resize(referenceSet->n_cols);
-    distances.clear();
-    distances.resize(referenceSet->n_cols);
+    MetricType threadMetric(metric);
+    RuleType rules(*referenceSet, querySet, range, buffers[i], threadMetric,
+        sameSet, queryMapping, referenceMapping);
+    typename Tree::template DualTreeTraverser<RuleType> traverser(rules);
 
-    for (size_t i = 0; i < distances.size(); i++)
-    {
-      // Map distances (copy a column).
-      const size_t refMapping = oldFromNewReferences[i];
-      distances[refMapping] = (*distancePtr)[i];
-
-      // Copy each neighbor individually, because we need to map it.
-      neighbors[refMapping].resize(distances[refMapping].size());
-      for (size_t j = 0; j < distances[refMapping].size(); j++)
-      {
-        neighbors[refMapping][j] = oldFromNewReferences[(*neighborPtr)[i][j]];
-      }
-    }
+    traverser.Traverse(*subtrees[i], *referenceTree);
 
-    // Finished with temporary objects.
-    delete neighborPtr;
-    delete distancePtr;
+    totalBaseCases += rules.BaseCases();
+    totalScores += rules.Scores();
+    totalPrunes += traverser.NumPrunes();
   }
+
+  for (size_t i = 0; i < buffers.size(); ++i)
+    buffers[i].Flush(results);
+
+  baseCases = totalBaseCases;
+  scores = totalScores;
+  Counter::Add("range_search/prunes", totalPrunes);
 }
 
 template<typename MetricType,
@@ -20,6 +20,10 @@
 #include "range_search.hpp"
 #include "rs_model.hpp"
 
+#ifdef HAS_OPENMP
+  #include <omp.h>
+#endif
+
 using namespace std;
 using namespace mlpack;
 using namespace mlpack::range;
@@ -90,6 +94,8 @@ PARAM_INT_IN("seed", "Random seed (if 0, std::time(NULL) is used).", "s", 0);
 PARAM_FLAG("naive", "If true, O(n^2) naive mode is used for computation.", "N");
 PARAM_FLAG("single_mode", "If true, single-tree search is used (as opposed to "
     "dual-tree search).", "S");
+PARAM_INT_IN("threads", "Number of threads to use for dual-tree search.  If 0, "
+    "the OpenMP default is used.", "T", 0);
 
 static void mlpackMain()
 {
@@ -135,6 +141,20 @@ static void mlpackMain()
   RequireParamValue<int>("leaf_size", [](int x) { return x > 0; }, true,
       "leaf size must be greater than 0");
 
+  // Sanity check on the number of threads.
+  RequireParamValue<int>("threads", [](int x) { return x >= 0; }, true,
+      "number of threads must be nonnegative");
+  if (CLI::GetParam<int>("threads") > 0)
+  {
+    #ifdef HAS_OPENMP
+      omp_set_num_threads(CLI::GetParam<int>("threads"));
+    #else
+      if (CLI::GetParam<int>("threads") > 1)
+        Log::Warn << PRINT_PARAM_STRING("threads") << " ignored because mlpack "
+            << "was compiled without OpenMP support." << endl;
+    #endif
+  }
+
   // We either have to load the reference data, or we have to load the model.
   RSModel rs;
   const bool naive = CLI::HasParam("naive");
@@ -230,14 +250,14 @@ static void mlpackMain()
       Log::Warn << PRINT_PARAM_STRING("single_mode") << " ignored because "
           << PRINT_PARAM_STRING("naive") << " is present." << endl;
 
-    // Now run the search.
-    vector<vector<size_t>> neighbors;
-    vector<vector<double>> distances;
+    // Now run the search.  The results are stored in flat arrays, to avoid
+    // one allocation per query point.
+    CSRResults results;
 
     if (CLI::HasParam("query"))
-      rs.Search(std::move(queryData), r, neighbors, distances);
+      rs.Search(std::move(queryData), r, results);
     else
-      rs.Search(r, neighbors, distances);
+      rs.Search(r, results);
 
     Log::Info << "Search complete." << endl;
 
@@ -254,15 +274,16 @@ static void mlpackMain()
       else
       {
         // Loop over each point.
-        for (size_t i = 0; i < distances.size(); ++i)
+        for (size_t i = 0; i < results.NumQueries(); ++i)
         {
           // Store the distances of each point.  We may have 0 points to store,
           // so we must account for that possibility.
-          for (size_t j = 0; j + 1 < distances[i].size(); ++j)
-            distancesStr << distances[i][j] << ", ";
+          const size_t numNeighbors = results.NumNeighbors(i);
+          for (size_t j = 0; j + 1 < numNeighbors; ++j)
+            distancesStr << results.Distance(i, j) << ", ";
 
-          if (distances[i].size() > 0)
-            distancesStr << distances[i][distances[i].size() - 1];
+          if (numNeighbors > 0)
+            distancesStr << results.Distance(i, numNeighbors - 1);
 
           distancesStr << endl;
         }
@@ -283,15 +304,16 @@ static void mlpackMain()
       else
       {
         // Loop over each point.
-        for (size_t i = 0; i < neighbors.size(); ++i)
+        for (size_t i = 0; i < results.NumQueries(); ++i)
         {
           // Store the neighbors of each point.  We may have 0 points to store,
           // so we must account for that possibility.
-          for (size_t j = 0; j + 1 < neighbors[i].size(); ++j)
-            neighborsStr << neighbors[i][j] << ", ";
+          const size_t numNeighbors = results.NumNeighbors(i);
+          for (size_t j = 0; j + 1 < numNeighbors; ++j)
+            neighborsStr << results.Neighbor(i, j) << ", ";
 
-          if (neighbors[i].size() > 0)
-            neighborsStr << neighbors[i][neighbors[i].size() - 1];
+          if (numNeighbors > 0)
+            neighborsStr << results.Neighbor(i, numNeighbors - 1);
 
           neighborsStr << endl;
         }
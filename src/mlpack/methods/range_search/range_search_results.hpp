@@ -0,0 +1,373 @@
+/**
+ * @file range_search_results.hpp
+ *
+ * Result sinks for range search.  RangeSearch::Search() can write its results
+ * into any class that satisfies the ResultsType API below, so that callers can
+ * choose how (and whether) the results are stored.
+ *
+ * A ResultsType class must provide:
+ *
+ * - static const bool NeedsDistances: if false, the rules may skip computing
+ *   the distances of points that are known to be in range, and will pass 0 as
+ *   the distance to Insert().
+ *
+ * - void Reset(const size_t numQueries): prepare for a new search with the
+ *   given number of query points.
+ *
+ * - void Reserve(const size_t queryIndex, const size_t count): hint that at
+ *   least count more results for the given query point are about to be added.
+ *
+ * - void Insert(const size_t queryIndex, const size_t referenceIndex,
+ *   const double distance): add a single result.
+ *
+ * - void Finalize(): called once after the search is done.
+ *
+ * Indices passed to Insert() are always in terms of the original (unmapped)
+ * query and reference sets.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_RANGE_SEARCH_RANGE_SEARCH_RESULTS_HPP
+#define MLPACK_METHODS_RANGE_SEARCH_RANGE_SEARCH_RESULTS_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace range {
+
+/**
+ * Store the results of a range search as one vector of neighbors and one
+ * vector of distances for each query point.  This is the format used by the
+ * overloads of RangeSearch::Search() that take
+ * std::vector<std::vector<size_t>> and std::vector<std::vector<double>>.
+ */
+class NestedVectorResults
+{
+ public:
+  //! The distance of each result is stored.
+  static const bool NeedsDistances = true;
+
+  /**
+   * Store the results in the given objects.
+   *
+   * @param neighbors Object which will hold the list of neighbors for each
+   *      query point.
+   * @param distances Object which will hold the list of distances for each
+   *      query point.
+   */
+  NestedVectorResults(std::vector<std::vector<size_t>>& neighbors,
+                      std::vector<std::vector<double>>& distances) :
+      neighbors(neighbors),
+      distances(distances)
+  { }
+
+  //! Clear the results and prepare for the given number of query points.
+  void Reset(const size_t numQueries)
+  {
+    neighbors.clear();
+    neighbors.resize(numQueries);
+    distances.clear();
+    distances.resize(numQueries);
+  }
+
+  //! Reserve space for count more results for the given query point.
+  void Reserve(const size_t queryIndex, const size_t count)
+  {
+    neighbors[queryIndex].reserve(neighbors[queryIndex].size() + count);
+    distances[queryIndex].reserve(distances[queryIndex].size() + count);
+  }
+
+  //! Add a result.
+  void Insert(const size_t queryIndex,
+              const size_t referenceIndex,
+              const double distance)
+  {
+    neighbors[queryIndex].push_back(referenceIndex);
+    distances[queryIndex].push_back(distance);
+  }
+
+  //! Nothing to do after the search.
+  void Finalize() { }
+
+ private:
+  //! The neighbors of each query point.
+  std::vector<std::vector<size_t>>& neighbors;
+  //! The distances of each query point.
+  std::vector<std::vector<double>>& distances;
+};
+
+/**
+ * Store the results of a range search in compressed sparse row (CSR) format:
+ * the neighbors and distances of all query points are held in two flat arrays,
+ * and the results of query point i are in the positions
+ * [Offsets()[i], Offsets()[i + 1]) of those arrays.  This avoids one small
+ * allocation per query point, and the buffers are reused if the same object is
+ * passed to several searches.
+ *
+ * The results of each query point are not sorted in any particular order.
+ */
+class CSRResults
+{
+ public:
+  //! The distance of each result is stored.
+  static const bool NeedsDistances = true;
+
+  //! Create an empty set of results.
+  CSRResults() : offsets(1, 0) { }
+
+  //! Clear the results and prepare for the given number of query points.
+  void Reset(const size_t numQueries)
+  {
+    offsets.assign(numQueries + 1, 0);
+    queries.clear();
+    neighbors.clear();
+    distances.clear();
+  }
+
+  //! Results are appended to flat buffers, so there is nothing to reserve.
+  void Reserve(const size_t /* queryIndex */, const size_t /* count */) { }
+
+  //! Add a result.
+  void Insert(const size_t queryIndex,
+              const size_t referenceIndex,
+              const double distance)
+  {
+    queries.push_back(queryIndex);
+    neighbors.push_back(referenceIndex);
+    distances.push_back(distance);
+  }
+
+  //! Group the results by query point.
+  void Finalize();
+
+  //! Get the number of query points.
+  size_t NumQueries() const { return offsets.size() - 1; }
+  //! Get the number of results for the given query point.
+  size_t NumNeighbors(const size_t queryIndex) const
+  {
+    return offsets[queryIndex + 1] - offsets[queryIndex];
+  }
+
+  //! Get the j'th neighbor of the given query point.
+  size_t Neighbor(const size_t queryIndex, const size_t j) const
+  {
+    return neighbors[offsets[queryIndex] + j];
+  }
+  //! Get the distance to the j'th neighbor of the given query point.
+  double Distance(const size_t queryIndex, const size_t j) const
+  {
+    return distances[offsets[queryIndex] + j];
+  }
+
+  //! Get the offset of the results of each query point (plus one past the end).
+  const std::vector<size_t>& Offsets() const { return offsets; }
+  //! Get the neighbors of all query points.
+  const std::vector<size_t>& Neighbors() const { return neighbors; }
+  //! Get the distances of all query points.
+  const std::vector<double>& Distances() const { return distances; }
+
+ private:
+  //! The offset of the results of each query point.
+  std::vector<size_t> offsets;
+  //! The query point of each result, before Finalize() is called.
+  std::vector<size_t> queries;
+  //! The neighbors of all query points.
+  std::vector<size_t> neighbors;
+  //! The distances of all query points.
+  std::vector<double> distances;
+};
+
+inline void CSRResults::Finalize()
+{
+  // Count the number of results of each query point, and turn the counts into
+  // offsets.
+  for (size_t i = 0; i < queries.size(); ++i)
+    ++offsets[queries[i] + 1];
+  for (size_t i = 1; i < offsets.size(); ++i)
+    offsets[i] += offsets[i - 1];
+
+  // Naive and single-tree search generate the results one query point at a
+  // time, so they are usually already grouped.
+  if (!std::is_sorted(queries.begin(), queries.end()))
+  {
+    std::vector<size_t> position(offsets.begin(), offsets.end() - 1);
+    std::vector<size_t> sortedNeighbors(neighbors.size());
+    std::vector<double> sortedDistances(distances.size());
+    for (size_t i = 0; i < queries.size(); ++i)
+    {
+      const size_t p = position[queries[i]]++;
+      sortedNeighbors[p] = neighbors[i];
+      sortedDistances[p] = distances[i];
+    }
+
+    neighbors.swap(sortedNeighbors);
+    distances.swap(sortedDistances);
+  }
+
+  queries.clear();
+}
+
+/**
+ * Only count the number of reference points in range of each query point.  No
+ * neighbors are stored, and the distances of points that are known to be in
+ * range are not computed.
+ */
+class CountResults
+{
+ public:
+  //! Distances are not needed.
+  static const bool NeedsDistances = false;
+
+  //! Clear the counts and prepare for the given number of query points.
+  void Reset(const size_t numQueries) { counts.zeros(numQueries); }
+
+  //! Nothing is stored, so there is nothing to reserve.
+  void Reserve(const size_t /* queryIndex */, const size_t /* count */) { }
+
+  //! Count a result.
+  void Insert(const size_t queryIndex,
+              const size_t /* referenceIndex */,
+              const double /* distance */)
+  {
+    ++counts[queryIndex];
+  }
+
+  //! Nothing to do after the search.
+  void Finalize() { }
+
+  //! Get the number of results of each query point.
+  const arma::Col<size_t>& Counts() const { return counts; }
+  //! Modify the number of results of each query point.
+  arma::Col<size_t>& Counts() { return counts; }
+
+ private:
+  //! The number of results of each query point.
+  arma::Col<size_t> counts;
+};
+
+/**
+ * Pass each result of a range search to the given function as soon as it is
+ * found, without storing anything.  The function is called as
+ * function(queryIndex, referenceIndex, distance).  Results for different query
+ * points may be interleaved, and the same object is used for the whole search.
+ *
+ * @tparam FunctionType Type of the function or functor to call.
+ */
+template<typename FunctionType>
+class CallbackResults
+{
+ public:
+  //! The function is given the distance of each result.
+  static const bool NeedsDistances = true;
+
+  /**
+   * Call the given function for each result.
+   *
+   * @param function Function to call.
+   */
+  CallbackResults(FunctionType function) : function(function) { }
+
+  //! Nothing to do before the search.
+  void Reset(const size_t /* numQueries */) { }
+
+  //! Nothing is stored, so there is nothing to reserve.
+  void Reserve(const size_t /* queryIndex */, const size_t /* count */) { }
+
+  //! Pass a result to the function.
+  void Insert(const size_t queryIndex,
+              const size_t referenceIndex,
+              const double distance)
+  {
+    function(queryIndex, referenceIndex, distance);
+  }
+
+  //! Nothing to do after the search.
+  void Finalize() { }
+
+  //! Get the function.
+  const FunctionType& Function() const { return function; }
+  //! Modify the function.
+  FunctionType& Function() { return function; }
+
+ private:
+  //! The function to call for each result.
+  FunctionType function;
+};
+
+/**
+ * Hold results in a flat buffer until they are passed on to another results
+ * object with Flush().  This is used by the parallel dual-tree search: each
+ * subtree of the query tree writes to its own buffer, and the buffers are
+ * flushed one after another when the search is done.
+ *
+ * @tparam ResultsType Type of the results object the buffer is flushed to.
+ */
+template<typename ResultsType>
+class BufferedResults
+{
+ public:
+  //! Distances are needed if the final results object needs them.
+  static const bool NeedsDistances = ResultsType::NeedsDistances;
+
+  //! Clear the buffer.
+  void Reset(const size_t /* numQueries */)
+  {
+    queries.clear();
+    neighbors.clear();
+    distances.clear();
+  }
+
+  //! Results are appended to flat buffers, so there is nothing to reserve.
+  void Reserve(const size_t /* queryIndex */, const size_t /* count */) { }
+
+  //! Add a result to the buffer.
+  void Insert(const size_t queryIndex,
+              const size_t referenceIndex,
+              const double distance)
+  {
+    queries.push_back(queryIndex);
+    neighbors.push_back(referenceIndex);
+    distances.push_back(distance);
+  }
+
+  //! Nothing to do after the search.
+  void Finalize() { }
+
+  //! Pass every buffered result to the given results object, in the order
+  //! they were inserted, and clear the buffer.
+  void Flush(ResultsType& results)
+  {
+    for (size_t i = 0; i < queries.size(); ++i)
+      results.Insert(queries[i], neighbors[i], distances[i]);
+
+    Reset(0);
+  }
+
+ private:
+  //! The query point of each result.
+  std::vector<size_t> queries;
+  //! The reference point of each result.
+  std::vector<size_t> neighbors;
+  //! The distance of each result.
+  std::vector<double> distances;
+};
+
+/**
+ * Create a CallbackResults object for the given function; this is convenient
+ * when the function is a lambda.
+ *
+ * @param function Function to call for each result.
+ */
+template<typename FunctionType>
+CallbackResults<FunctionType> MakeCallbackResults(FunctionType function)
+{
+  return CallbackResults<FunctionType>(function);
+}
+
+} // namespace range
+} // namespace mlpack
+
+#endif
@@ -14,6 +14,8 @@
 
 #include <mlpack/core/tree/traversal_info.hpp>
 
+#include "range_search_results.hpp"
+
 namespace mlpack {
 namespace range {
 
@@ -23,8 +25,12 @@ namespace range {
  *
  * @tparam MetricType The metric to use for computation.
  * @tparam TreeType The tree type to use; must adhere to the TreeType API.
+ * @tparam ResultsType The class that results are written to; see
+ *     range_search_results.hpp.
  */
-template<typename MetricType, typename TreeType>
+template<typename MetricType,
+         typename TreeType,
+         typename ResultsType = NestedVectorResults>
 class RangeSearchRules
 {
  public:
@@ -35,19 +41,24 @@ class RangeSearchRules
    * @param referenceSet Set of reference data.
    * @param querySet Set of query data.
    * @param range Range to search for.
-   * @param neighbors Vector to store resulting neighbors in.
-   * @param distances Vector to store resulting distances in.
+   * @param results Object to write results to.
    * @param metric Instantiated metric.
    * @param sameSet If true, the query and reference set are taken to be the
    *      same, and a query point will not return itself in the results.
+   * @param oldFromNewQueries If not NULL, the mapping used to convert query
+   *      indices to their original indices before they are given to results.
+   * @param oldFromNewReferences If not NULL, the mapping used to convert
+   *      reference indices to their original indices before they are given to
+   *      results.
    */
   RangeSearchRules(const arma::mat& referenceSet,
                    const arma::mat& querySet,
                    const math::Range& range,
-                   std::vector<std::vector<size_t> >& neighbors,
-                   std::vector<std::vector<double> >& distances,
+                   ResultsType& results,
                    MetricType& metric,
-                   const bool sameSet = false);
+                   const bool sameSet = false,
+                   const std::vector<size_t>* oldFromNewQueries = NULL,
+                   const std::vector<size_t>* oldFromNewReferences = NULL);
 
   /**
    * Compute the base case between the given query point and reference point.
@@ -127,11 +138,13 @@ class RangeSearchRules
   //! The range of distances for which we are searching.
   const math::Range& range;
 
-  //! The vector the resultant neighbor indices should be stored in.
-  std::vector<std::vector<size_t> >& neighbors;
+  //! The object the results are written to.
+  ResultsType& results;
 
-  //! The vector the resultant neighbor distances should be stored in.
-  std::vector<std::vector<double> >& distances;
+  //! Mapping of query indices, or NULL if they do not need to be mapped.
+  const std::vector<size_t>* oldFromNewQueries;
+  //! Mapping of reference indices, or NULL if they do not need to be mapped.
+  const std::vector<size_t>* oldFromNewReferences;
 
   //! The instantiated metric.
   MetricType& metric;
@@ -150,6 +163,20 @@ class RangeSearchRules
   void AddResult(const size_t queryIndex,
                  TreeType& referenceNode);
 
+  //! Map the given query index to its original index.
+  size_t OriginalQueryIndex(const size_t queryIndex) const
+  {
+    return (oldFromNewQueries == NULL) ? queryIndex :
+        (*oldFromNewQueries)[queryIndex];
+  }
+
+  //! Map the given reference index to its original index.
+  size_t OriginalReferenceIndex(const size_t referenceIndex) const
+  {
+    return (oldFromNewReferences == NULL) ? referenceIndex :
+        (*oldFromNewReferences)[referenceIndex];
+  }
+
   TraversalInfoType traversalInfo;
 
   //! The number of base cases.
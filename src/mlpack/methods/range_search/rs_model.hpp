@@ -36,16 +36,17 @@ using RSType = RangeSearch<metric::EuclideanDistance, arma::mat, TreeType>;
 /**
  * MonoSearchVisitor executes a monochromatic range search on the given
  * RSType. Range Search is performed on the reference set itself, no querySet.
+ *
+ * @tparam ResultsType Type of object to write results to.
  */
+template<typename ResultsType>
 class MonoSearchVisitor : public  boost::static_visitor<void>
 {
  private:
   //! The range to search for.
   const math::Range& range;
-  //! Output neighbors.
-  std::vector<std::vector<size_t>>& neighbors;
-  //! Output distances.
-  std::vector<std::vector<double>>& distances;
+  //! Output results.
+  ResultsType& results;
 
  public:
   //! Perform monochromatic search with the given RangeSearch object.
@@ -54,11 +55,9 @@ class MonoSearchVisitor : public  boost::static_visitor<void>
 
   //! Construct the MonoSearchVisitor with the given parameters.
   MonoSearchVisitor(const math::Range& range,
-                    std::vector<std::vector<size_t>>& neighbors,
-                    std::vector<std::vector<double>>& distances):
+                    ResultsType& results):
       range(range),
-      neighbors(neighbors),
-      distances(distances)
+      results(results)
   {};
 };
 
@@ -67,7 +66,10 @@ class MonoSearchVisitor : public  boost::static_visitor<void>
  * We use template specialization to differentiate those tree types that
  * accept leafSize as a parameter. In these cases, before doing range search,
  * a query tree with proper leafSize is built from the querySet.
+ *
+ * @tparam ResultsType Type of object to write results to.
  */
+template<typename ResultsType>
 class BiSearchVisitor : public boost::static_visitor<void>
 {
  private:
@@ -75,10 +77,8 @@ class BiSearchVisitor : public boost::static_visitor<void>
   const arma::mat& querySet;
   //! Range to search neighbours for.
   const math::Range& range;
-  //! The result vector for neighbors.
-  std::vector<std::vector<size_t>>& neighbors;
-  //! The result vector for distances.
-  std::vector<std::vector<double>>& distances;
+  //! Output results.
+  ResultsType& results;
   //! The number of points in a leaf (for BinarySpaceTrees).
   const size_t leafSize;
 
@@ -111,8 +111,7 @@ class BiSearchVisitor : public boost::static_visitor<void>
   //! Construct the BiSearchVisitor.
   BiSearchVisitor(const arma::mat& querySet,
                   const math::Range& range,
-                  std::vector<std::vector<size_t>>& neighbors,
-                  std::vector<std::vector<double>>& distances,
+                  ResultsType& results,
                   const size_t leafSize);
 };
 
@@ -365,6 +364,21 @@ class RSModel
               std::vector<std::vector<size_t>>& neighbors,
               std::vector<std::vector<double>>& distances);
 
+  /**
+   * Perform range search, writing each result to the given results object.
+   * This takes possession of the query set, so the query set will not be
+   * usable after the search.  For more information on the results objects,
+   * see range_search_results.hpp.
+   *
+   * @param querySet Set of query points.
+   * @param range Range to search for.
+   * @param results Object to write results to.
+   */
+  template<typename ResultsType>
+  void Search(arma::mat&& querySet,
+              const math::Range& range,
+              ResultsType& results);
+
   /**
    * Perform monochromatic range search, with the reference set as the query
    * set.  For more information on the output format, see
@@ -378,6 +392,16 @@ class RSModel
               std::vector<std::vector<size_t>>& neighbors,
               std::vector<std::vector<double>>& distances);
 
+  /**
+   * Perform monochromatic range search, with the reference set as the query
+   * set, writing each result to the given results object.
+   *
+   * @param range Range to search for.
+   * @param results Object to write results to.
+   */
+  template<typename ResultsType>
+  void Search(const math::Range& range, ResultsType& results);
+
  private:
   /**
    * Return a string representing the name of the tree.  This is used for
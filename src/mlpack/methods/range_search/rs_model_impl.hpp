@@ -200,6 +200,16 @@ inline void RSModel::Search(arma::mat&& querySet,
                             const math::Range& range,
                             std::vector<std::vector<size_t>>& neighbors,
                             std::vector<std::vector<double>>& distances)
+{
+  NestedVectorResults results(neighbors, distances);
+  Search(std::move(querySet), range, results);
+}
+
+// Perform range search, writing to the given results object.
+template<typename ResultsType>
+void RSModel::Search(arma::mat&& querySet,
+                     const math::Range& range,
+                     ResultsType& results)
 {
   // We may need to map the query set randomly.
   if (randomBasis)
@@ -215,8 +225,7 @@ inline void RSModel::Search(arma::mat&& querySet,
     Log::Info << "brute-force (naive) search..." << std::endl;
 
 
-  BiSearchVisitor search(querySet, range, neighbors, distances,
-      leafSize);
+  BiSearchVisitor<ResultsType> search(querySet, range, results, leafSize);
   boost::apply_visitor(search, rSearch);
 }
 
@@ -224,6 +233,15 @@ inline void RSModel::Search(arma::mat&& querySet,
 inline void RSModel::Search(const math::Range& range,
                             std::vector<std::vector<size_t>>& neighbors,
                             std::vector<std::vector<double>>& distances)
+{
+  NestedVectorResults results(neighbors, distances);
+  Search(range, results);
+}
+
+// Perform range search (monochromatic case), writing to the given results
+// object.
+template<typename ResultsType>
+void RSModel::Search(const math::Range& range, ResultsType& results)
 {
   Log::Info << "Search for points in the range [" << range.Lo() << ", "
       << range.Hi() << "] with ";
@@ -234,7 +252,7 @@ inline void RSModel::Search(const math::Range& range,
   else
     Log::Info << "brute-force (naive) search..." << std::endl;
 
-  MonoSearchVisitor search(range, neighbors, distances);
+  MonoSearchVisitor<ResultsType> search(range, results);
   boost::apply_visitor(search, rSearch);
 }
 
@@ -283,40 +301,42 @@ inline void RSModel::CleanMemory()
 }
 
 //! Monochromatic range search on the given RSType instance.
+template<typename ResultsType>
 template<typename RSType>
-void MonoSearchVisitor::operator()(RSType* rs) const
+void MonoSearchVisitor<ResultsType>::operator()(RSType* rs) const
 {
   if (rs)
-    return rs->Search(range, neighbors, distances);
+    return rs->Search(range, results);
   throw std::runtime_error("no range search model initialized");
 }
 
 //! Save parameters for bichromatic range search.
-BiSearchVisitor::BiSearchVisitor(const arma::mat& querySet,
-                                 const math::Range& range,
-                                 std::vector<std::vector<size_t>>& neighbors,
-                                 std::vector<std::vector<double>>& distances,
-                                 const size_t leafSize):
+template<typename ResultsType>
+BiSearchVisitor<ResultsType>::BiSearchVisitor(const arma::mat& querySet,
+                                              const math::Range& range,
+                                              ResultsType& results,
+                                              const size_t leafSize):
     querySet(querySet),
     range(range),
-    neighbors(neighbors),
-    distances(distances),
+    results(results),
     leafSize(leafSize)
 {}
 
 //! Default Bichromatic range search on the given RSType instance.
+template<typename ResultsType>
 template<template<typename TreeMetricType,
                   typename TreeStatType,
                   typename TreeMatType> class TreeType>
-void BiSearchVisitor::operator()(RSTypeT<TreeType>* rs) const
+void BiSearchVisitor<ResultsType>::operator()(RSTypeT<TreeType>* rs) const
 {
   if (rs)
-    return rs->Search(querySet, range, neighbors, distances);
+    return rs->Search(querySet, range, results);
   throw std::runtime_error("no range search model initialized");
 }
 
 //! Bichromatic range search on the given RSType specialized for KDTrees.
-void BiSearchVisitor::operator()(RSTypeT<tree::KDTree>* rs) const
+template<typename ResultsType>
+void BiSearchVisitor<ResultsType>::operator()(RSTypeT<tree::KDTree>* rs) const
 {
   if (rs)
     return SearchLeaf(rs);
@@ -324,7 +344,9 @@ void BiSearchVisitor::operator()(RSTypeT<tree::KDTree>* rs) const
 }
 
 //! Bichromatic range search on the given RSType specialized for BallTrees.
-void BiSearchVisitor::operator()(RSTypeT<tree::BallTree>* rs) const
+template<typename ResultsType>
+void BiSearchVisitor<ResultsType>::operator()(RSTypeT<tree::BallTree>* rs)
+    const
 {
   if (rs)
     return SearchLeaf(rs);
@@ -332,7 +354,8 @@ void BiSearchVisitor::operator()(RSTypeT<tree::BallTree>* rs) const
 }
 
 //! Bichromatic range search specialized for Ocrees.
-void BiSearchVisitor::operator()(RSTypeT<tree::Octree>* rs) const
+template<typename ResultsType>
+void BiSearchVisitor<ResultsType>::operator()(RSTypeT<tree::Octree>* rs) const
 {
   if (rs)
     return SearchLeaf(rs);
@@ -340,8 +363,9 @@ void BiSearchVisitor::operator()(RSTypeT<tree::Octree>* rs) const
 }
 
 //! Bichromatic range search on the given RSType considering the leafSize.
+template<typename ResultsType>
 template<typename RSType>
-void BiSearchVisitor::SearchLeaf(RSType* rs) const
+void BiSearchVisitor<ResultsType>::SearchLeaf(RSType* rs) const
 {
   if (!rs->Naive() && !rs->SingleMode())
   {
@@ -354,21 +378,11 @@ void BiSearchVisitor::SearchLeaf(RSType* rs) const
     Log::Info << "Tree built." << std::endl;
     Timer::Stop("tree_building");
 
-    std::vector<std::vector<size_t>> neighborsOut;
-    std::vector<std::vector<double>> distancesOut;
-    rs->Search(&queryTree, range, neighborsOut, distancesOut);
-
-    // Remap the query points.
-    neighbors.resize(queryTree.Dataset().n_cols);
-    distances.resize(queryTree.Dataset().n_cols);
-    for (size_t i = 0; i < queryTree.Dataset().n_cols; ++i)
-    {
-      neighbors[oldFromNewQueries[i]] = neighborsOut[i];
-      distances[oldFromNewQueries[i]] = distancesOut[i];
-    }
+    // The query points are remapped as the results are found.
+    rs->Search(&queryTree, range, results, &oldFromNewQueries);
   }
   else
-    rs->Search(querySet, range, neighbors, distances);
+    rs->Search(querySet, range, results);
 }
 
 //! Save parameters for Train.
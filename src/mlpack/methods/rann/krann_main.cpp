@@ -18,6 +18,10 @@
 #include "ra_model.hpp"
 #include <mlpack/methods/neighbor_search/unmap.hpp>
 
+#ifdef HAS_OPENMP
+  #include <omp.h>
+#endif
+
 using namespace std;
 using namespace mlpack;
 using namespace mlpack::neighbor;
@@ -95,6 +99,9 @@ PARAM_FLAG("first_leaf_exact", "The flag to trigger sampling only after "
            "exactly exploring the first leaf.", "X");
 PARAM_INT_IN("single_sample_limit", "The limit on the maximum number of "
     "samples (and hence the largest node you can approximate).", "z", 20);
+PARAM_INT_IN("threads", "Number of threads to use for the search.  If 0, the "
+    "OpenMP default is used.  The results for a given seed do not depend on "
+    "the number of threads, except for dual-tree search.", "", 0);
 
 static void mlpackMain()
 {
@@ -129,6 +136,20 @@ static void mlpackMain()
   // Naive mode overrides single mode.
   ReportIgnoredParam({{ "naive", true }}, "single_mode");
 
+  // Sanity check on the number of threads.
+  RequireParamValue<int>("threads", [](int x) { return x >= 0; }, true,
+      "number of threads must be nonnegative");
+  if (CLI::GetParam<int>("threads") > 0)
+  {
+    #ifdef HAS_OPENMP
+      omp_set_num_threads(CLI::GetParam<int>("threads"));
+    #else
+      if (CLI::GetParam<int>("threads") > 1)
+        Log::Warn << PRINT_PARAM_STRING("threads") << " ignored because mlpack "
+            << "was compiled without OpenMP support." << endl;
+    #endif
+  }
+
   // Sanity check on leaf size.
   const int lsInt = CLI::GetParam<int>("leaf_size");
   RequireParamValue<int>("leaf_size", [](int x) { return x > 0; }, true,
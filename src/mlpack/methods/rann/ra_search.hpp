@@ -456,6 +456,26 @@ class RASearch
   //! Instantiation of kernel.
   MetricType metric;
 
+  /**
+   * Split the given number of query points into blocks of a fixed size, and
+   * call search(threadRules, begin, end) for each block in parallel, where
+   * threadRules shares the candidates of the given rules object but has its
+   * own metric and random number generator.  Returns the number of distance
+   * computations.
+   */
+  template<typename RuleType, typename SearchType>
+  size_t BlockSearch(RuleType& rules,
+                     const size_t numQueries,
+                     const SearchType& search);
+
+  /**
+   * Perform dual-tree search with the given query tree and rules object.  If
+   * several threads are available, disjoint subtrees of the query tree are
+   * traversed in parallel.  Returns the number of distance computations.
+   */
+  template<typename RuleType>
+  size_t DualTreeSearch(Tree& queryTree, RuleType& rules);
+
   //! For access to mappings when building models.
   template<typename SortPol>
   friend class TrainVisitor;
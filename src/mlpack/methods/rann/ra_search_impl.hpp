@@ -15,37 +15,18 @@
 
 #include <mlpack/prereqs.hpp>
 
+#include <mlpack/core/tree/build_tree.hpp>
+#include <mlpack/core/tree/split_query_tree.hpp>
+
 #include "ra_search_rules.hpp"
 
+#ifdef HAS_OPENMP
+  #include <omp.h>
+#endif
+
 namespace mlpack {
 namespace neighbor {
 
-namespace aux {
-
-//! Call the tree constructor that does mapping.
-template<typename TreeType, typename MatType>
-TreeType* BuildTree(
-    MatType&& dataset,
-    std::vector<size_t>& oldFromNew,
-    typename std::enable_if<
-        tree::TreeTraits<TreeType>::RearrangesDataset>::type* = 0)
-{
-  return new TreeType(std::forward<MatType>(dataset), oldFromNew);
-}
-
-//! Call the tree constructor that does not do mapping.
-template<typename TreeType, typename MatType>
-TreeType* BuildTree(
-    MatType&& dataset,
-    const std::vector<size_t>& /* oldFromNew */,
-    const typename std::enable_if<
-        !tree::TreeTraits<TreeType>::RearrangesDataset>::type* = 0)
-{
-  return new TreeType(std::forward<MatType>(dataset));
-}
-
-} // namespace aux
-
 // Construct the object.
 template<typename SortPolicy,
          typename MetricType,
@@ -63,7 +44,7 @@ RASearch(const MatType& referenceSetIn,
          const bool firstLeafExact,
          const size_t singleSampleLimit,
          const MetricType metric) :
-    referenceTree(naive ? NULL : aux::BuildTree<Tree>(
+    referenceTree(naive ? NULL : tree::BuildTree<Tree>(
         const_cast<MatType&>(referenceSetIn), oldFromNewReferences)),
     referenceSet(naive ? &referenceSetIn : &referenceTree->Dataset()),
     treeOwner(!naive),
@@ -97,7 +78,7 @@ RASearch(MatType&& referenceSetIn,
          const bool firstLeafExact,
          const size_t singleSampleLimit,
          const MetricType metric) :
-    referenceTree(naive ? NULL : aux::BuildTree<Tree>(
+    referenceTree(naive ? NULL : tree::BuildTree<Tree>(
         std::move(referenceSetIn), oldFromNewReferences)),
     referenceSet(naive ? new MatType(std::move(referenceSetIn)) :
         &referenceTree->Dataset()),
@@ -178,7 +159,7 @@ RASearch(const bool naive,
   // Build the tree on the empty dataset, if necessary.
   if (!naive)
   {
-    referenceTree = aux::BuildTree<Tree>(*referenceSet, oldFromNewReferences);
+    referenceTree = tree::BuildTree<Tree>(*referenceSet, oldFromNewReferences);
     treeOwner = true;
   }
 }
@@ -219,7 +200,7 @@ void RASearch<SortPolicy, MetricType, MatType, TreeType>::Train(
   // We may need to rebuild the tree.
   if (!naive)
   {
-    referenceTree = aux::BuildTree<Tree>(referenceSet, oldFromNewReferences);
+    referenceTree = tree::BuildTree<Tree>(referenceSet, oldFromNewReferences);
     treeOwner = true;
   }
   else
@@ -255,7 +236,7 @@ void RASearch<SortPolicy, MetricType, MatType, TreeType>::Train(
   // We may need to rebuild the tree.
   if (!naive)
   {
-    referenceTree = aux::BuildTree<Tree>(std::move(referenceSet),
+    referenceTree = tree::BuildTree<Tree>(std::move(referenceSet),
         oldFromNewReferences);
     treeOwner = true;
   }
@@ -363,7 +344,9 @@ Search(const MatType& querySet,
 
   if (naive)
   {
-    RuleType rules(*referenceSet, querySet, k, metric, tau, alpha, naive,
+    // The sampling of each query point is done below, in parallel, instead of
+    // in the RASearchRules constructor.
+    RuleType rules(*referenceSet, querySet, k, metric, tau, alpha, false,
         sampleAtLeaves, firstLeafExact, singleSampleLimit, false);
 
     // Find how many samples from the reference set we need and sample uniformly
@@ -374,11 +357,17 @@ Search(const MatType& querySet,
     math::ObtainDistinctSamples(0, referenceSet->n_cols, numSamples,
         distinctSamples);
 
-    // Run the base case on each combination of query point and sampled
-    // reference point.
-    for (size_t i = 0; i < querySet.n_cols; ++i)
-      for (size_t j = 0; j < distinctSamples.n_elem; ++j)
-        rules.BaseCase(i, (size_t) distinctSamples[j]);
+    // Sample for each query point, and run the base case on each combination
+    // of query point and sampled reference point.
+    BlockSearch(rules, querySet.n_cols, [&](RuleType& threadRules,
+        const size_t begin, const size_t end)
+    {
+      for (size_t i = begin; i < end; ++i)
+      {
+        threadRules.Sample(i);
+        threadRules.BaseCases(i, distinctSamples);
+      }
+    });
 
     rules.GetResults(*neighborPtr, *distancePtr);
   }
@@ -393,17 +382,21 @@ Search(const MatType& querySet,
     {
       Log::Info << "Performing single-tree traversal..." << std::endl;
 
-      // Create the traverser.
-      typename Tree::template SingleTreeTraverser<RuleType> traverser(rules);
+      const size_t distComputations = BlockSearch(rules, querySet.n_cols,
+          [&](RuleType& threadRules, const size_t begin, const size_t end)
+      {
+        // Create the traverser.
+        typename Tree::template SingleTreeTraverser<RuleType>
+            traverser(threadRules);
 
-      // Now have it traverse for each point.
-      for (size_t i = 0; i < querySet.n_cols; ++i)
-        traverser.Traverse(i, *referenceTree);
+        // Now have it traverse for each point.
+        for (size_t i = begin; i < end; ++i)
+          traverser.Traverse(i, *referenceTree);
+      });
 
       Log::Info << "Single-tree traversal complete." << std::endl;
       Log::Info << "Average number of distance calculations per query point: "
-          << (rules.NumDistComputations() / querySet.n_cols) << "."
-          << std::endl;
+          << (distComputations / querySet.n_cols) << "." << std::endl;
     }
 
     rules.GetResults(*neighborPtr, *distancePtr);
@@ -415,23 +408,22 @@ Search(const MatType& querySet,
     // Build the query tree.
     Timer::Stop("computing_neighbors");
     Timer::Start("tree_building");
-    Tree* queryTree = aux::BuildTree<Tree>(const_cast<MatType&>(querySet),
+    Tree* queryTree = tree::BuildTree<Tree>(const_cast<MatType&>(querySet),
         oldFromNewQueries);
     Timer::Stop("tree_building");
     Timer::Start("computing_neighbors");
 
     RuleType rules(*referenceSet, queryTree->Dataset(), k, metric, tau, alpha,
         naive, sampleAtLeaves, firstLeafExact, singleSampleLimit, false);
-    typename Tree::template DualTreeTraverser<RuleType> traverser(rules);
 
     Log::Info << "Query statistic pre-search: "
         << queryTree->Stat().NumSamplesMade() << std::endl;
 
-    traverser.Traverse(*queryTree, *referenceTree);
+    const size_t distComputations = DualTreeSearch(*queryTree, rules);
 
     Log::Info << "Dual-tree traversal complete." << std::endl;
     Log::Info << "Average number of distance calculations per query point: "
-        << (rules.NumDistComputations() / querySet.n_cols) << "." << std::endl;
+        << (distComputations / querySet.n_cols) << "." << std::endl;
 
     rules.GetResults(*neighborPtr, *distancePtr);
 
@@ -536,9 +528,7 @@ void RASearch<SortPolicy, MetricType, MatType, TreeType>::Search(
   RuleType rules(*referenceSet, queryTree->Dataset(), k, metric, tau, alpha,
       naive, sampleAtLeaves, firstLeafExact, singleSampleLimit, false);
 
-  // Create the traverser.
-  typename Tree::template DualTreeTraverser<RuleType> traverser(rules);
-  traverser.Traverse(*queryTree, *referenceTree);
+  DualTreeSearch(*queryTree, rules);
 
   rules.GetResults(*neighborPtr, distances);
 
@@ -589,39 +579,39 @@ void RASearch<SortPolicy, MetricType, MatType, TreeType>::Search(
 
   // Create the helper object for the tree traversal.
   typedef RASearchRules<SortPolicy, MetricType, Tree> RuleType;
-  RuleType rules(*referenceSet, *referenceSet, k, metric, tau, alpha, naive,
+  // In naive mode every point is compared with every other point below, so
+  // the sampling done by the RASearchRules constructor is not needed.
+  RuleType rules(*referenceSet, *referenceSet, k, metric, tau, alpha, false,
       sampleAtLeaves, firstLeafExact, singleSampleLimit, true /* same sets */);
 
   if (naive)
   {
-    // Find how many samples from the reference set we need and sample uniformly
-    // from the reference set without replacement.
-    const size_t numSamples = RAUtil::MinimumSamplesReqd(referenceSet->n_cols,
-        k, tau, alpha);
-    arma::uvec distinctSamples;
-    math::ObtainDistinctSamples(0, referenceSet->n_cols, numSamples,
-        distinctSamples);
-
     // The naive brute-force solution.
-    for (size_t i = 0; i < referenceSet->n_cols; ++i)
-      for (size_t j = 0; j < referenceSet->n_cols; ++j)
-        rules.BaseCase(i, j);
+    BlockSearch(rules, referenceSet->n_cols, [&](RuleType& threadRules,
+        const size_t begin, const size_t end)
+    {
+      for (size_t i = begin; i < end; ++i)
+        for (size_t j = 0; j < referenceSet->n_cols; ++j)
+          threadRules.BaseCase(i, j);
+    });
   }
   else if (singleMode)
   {
-    // Create the traverser.
-    typename Tree::template SingleTreeTraverser<RuleType> traverser(rules);
+    BlockSearch(rules, referenceSet->n_cols, [&](RuleType& threadRules,
+        const size_t begin, const size_t end)
+    {
+      // Create the traverser.
+      typename Tree::template SingleTreeTraverser<RuleType>
+          traverser(threadRules);
 
-    // Now have it traverse for each point.
-    for (size_t i = 0; i < referenceSet->n_cols; ++i)
-      traverser.Traverse(i, *referenceTree);
+      // Now have it traverse for each point.
+      for (size_t i = begin; i < end; ++i)
+        traverser.Traverse(i, *referenceTree);
+    });
   }
   else
   {
-    // Create the traverser.
-    typename Tree::template DualTreeTraverser<RuleType> traverser(rules);
-
-    traverser.Traverse(*referenceTree, *referenceTree);
+    DualTreeSearch(*referenceTree, rules);
   }
 
   rules.GetResults(*neighborPtr, *distancePtr);
@@ -651,6 +641,95 @@ void RASearch<SortPolicy, MetricType, MatType, TreeType>::Search(
   }
 }
 
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+template<typename RuleType, typename SearchType>
+size_t RASearch<SortPolicy, MetricType, MatType, TreeType>::BlockSearch(
+    RuleType& rules,
+    const size_t numQueries,
+    const SearchType& search)
+{
+  // The blocks have a fixed size and each has its own random seed, so the
+  // samples do not depend on the number of threads or on the schedule.
+  const size_t blockSize = 64;
+  const size_t numBlocks = (numQueries + blockSize - 1) / blockSize;
+  const uint32_t seed = math::randGen();
+
+  size_t distComputations = 0;
+
+  #pragma omp parallel for schedule(dynamic) reduction(+:distComputations)
+  for (omp_size_t b = 0; b < (omp_size_t) numBlocks; ++b)
+  {
+    MetricType threadMetric(metric);
+    RuleType threadRules(rules, threadMetric, seed + (uint32_t) b);
+
+    const size_t begin = (size_t) b * blockSize;
+    search(threadRules, begin, std::min(begin + blockSize, numQueries));
+
+    distComputations += threadRules.NumDistComputations();
+  }
+
+  return distComputations;
+}
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+template<typename RuleType>
+size_t RASearch<SortPolicy, MetricType, MatType, TreeType>::DualTreeSearch(
+    Tree& queryTree,
+    RuleType& rules)
+{
+  #ifdef HAS_OPENMP
+    const size_t numThreads = omp_get_max_threads();
+  #else
+    const size_t numThreads = 1;
+  #endif
+
+  // Split the query tree into several times more subtrees than there are
+  // threads, so that the work is balanced even though some subtrees are much
+  // more expensive than others.
+  std::vector<Tree*> subtrees;
+  if (numThreads > 1)
+    tree::SplitQueryTree(queryTree, 4 * numThreads, subtrees);
+
+  if (subtrees.size() <= 1)
+  {
+    typename Tree::template DualTreeTraverser<RuleType> traverser(rules);
+    traverser.Traverse(queryTree, *referenceTree);
+
+    return rules.NumDistComputations();
+  }
+
+  // Each query point is held in exactly one subtree, so each thread only
+  // modifies the candidates and the statistics of its own query points.  Only
+  // the statistics of the query tree are modified, so this also holds when the
+  // query tree is the reference tree.
+  const uint32_t seed = math::randGen();
+  size_t distComputations = 0;
+
+  #pragma omp parallel for schedule(dynamic) reduction(+:distComputations)
+  for (omp_size_t i = 0; i < (omp_size_t) subtrees.size(); ++i)
+  {
+    MetricType threadMetric(metric);
+    RuleType threadRules(rules, threadMetric, seed + (uint32_t) i);
+    typename Tree::template DualTreeTraverser<RuleType> traverser(threadRules);
+
+    traverser.Traverse(*subtrees[i], *referenceTree);
+
+    distComputations += threadRules.NumDistComputations();
+  }
+
+  return distComputations;
+}
+
 template<typename SortPolicy,
          typename MetricType,
          typename MatType,
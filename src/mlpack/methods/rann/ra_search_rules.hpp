@@ -15,8 +15,10 @@
 #define MLPACK_METHODS_RANN_RA_SEARCH_RULES_HPP
 
 #include <mlpack/core/tree/traversal_info.hpp>
+#include <mlpack/core/metrics/lmetric.hpp>
 
 #include <queue>
+#include <random>
 
 namespace mlpack {
 namespace neighbor {
@@ -66,6 +68,23 @@ class RASearchRules
                 const size_t singleSampleLimit = 20,
                 const bool sameSet = false);
 
+  /**
+   * Construct a RASearchRules object that shares the datasets, the parameters,
+   * the candidate lists and the sample counts of the given object, but has its
+   * own metric, traversal state and random number generator.  This is used
+   * for parallel search: each thread searches for a disjoint set of query
+   * points, so the candidates and sample counts of each query point are only
+   * ever modified by one thread.  Giving each object its own seed keeps the
+   * samples reproducible no matter how the work is scheduled.
+   *
+   * @param other Rules object to share candidates with.
+   * @param metric Instantiated metric.
+   * @param seed Seed for the random number generator of this object.
+   */
+  RASearchRules(const RASearchRules& other,
+                MetricType& metric,
+                const uint32_t seed);
+
   /**
    * Store the list of candidates for each query point in the given matrices.
    *
@@ -84,6 +103,24 @@ class RASearchRules
    */
   double BaseCase(const size_t queryIndex, const size_t referenceIndex);
 
+  /**
+   * Run the base case between the given query point and each of the given
+   * reference points.  The distances are computed together, which for the L1
+   * and L2 metrics is done with vectorized operations.
+   *
+   * @param queryIndex Index of query point.
+   * @param referenceIndices Indices of reference points.
+   */
+  void BaseCases(const size_t queryIndex, const arma::uvec& referenceIndices);
+
+  /**
+   * Sample enough points from the whole reference set for the given query
+   * point, as naive rank-approximate search does.
+   *
+   * @param queryIndex Index of query point.
+   */
+  void Sample(const size_t queryIndex);
+
   /**
    * Get the score for recursion order.  A low score indicates priority for
    * recursion, while DBL_MAX indicates that the node should not be recursed
@@ -263,8 +300,11 @@ class RASearchRules
   typedef std::priority_queue<Candidate, std::vector<Candidate>, CandidateCmp>
       CandidateList;
 
+  //! Storage for the candidate neighbors of each point, if this object owns
+  //! them.
+  std::vector<CandidateList> candidateStorage;
   //! Set of candidate neighbors for each point.
-  std::vector<CandidateList> candidates;
+  CandidateList* candidates;
 
   //! Number of neighbors to search for.
   const size_t k;
@@ -298,6 +338,9 @@ class RASearchRules
 
   TraversalInfoType traversalInfo;
 
+  //! The random number generator used for sampling.
+  std::mt19937 rng;
+
   /**
    * Helper function to insert a point into the list of candidate points.
    *
@@ -309,6 +352,47 @@ class RASearchRules
                       const size_t neighbor,
                       const double distance);
 
+  /**
+   * Sample the given number of distinct points uniformly from [0,
+   * hiExclusive), with the random number generator of this object.  This is
+   * the same as math::ObtainDistinctSamples().
+   */
+  void ObtainDistinctSamples(const size_t hiExclusive,
+                             const size_t maxNumSamples,
+                             arma::uvec& distinctSamples);
+
+  /**
+   * Approximate the given reference node for the given query point by
+   * sampling the given number of its descendants.  The samples are counted by
+   * the base cases, so no book-keeping is required by the caller.
+   */
+  void SampleNode(const size_t queryIndex,
+                  TreeType& referenceNode,
+                  const size_t numSamples);
+
+  //! Compute the distances between a point and several points, one at a time.
+  template<typename MetricT>
+  static void BatchDistances(MetricT& metric,
+                             const arma::vec& query,
+                             arma::mat& references,
+                             arma::rowvec& distances);
+
+  //! Compute the L1 distances between a point and several points at once.
+  //! The references are overwritten.
+  template<bool TakeRoot>
+  static void BatchDistances(metric::LMetric<1, TakeRoot>& metric,
+                             const arma::vec& query,
+                             arma::mat& references,
+                             arma::rowvec& distances);
+
+  //! Compute the L2 distances between a point and several points at once.
+  //! The references are overwritten.
+  template<bool TakeRoot>
+  static void BatchDistances(metric::LMetric<2, TakeRoot>& metric,
+                             const arma::vec& query,
+                             arma::mat& references,
+                             arma::rowvec& distances);
+
   /**
    * Perform actual scoring for single-tree case.
    */
@@ -38,7 +38,8 @@ RASearchRules(const arma::mat& referenceSet,
     sampleAtLeaves(sampleAtLeaves),
     firstLeafExact(firstLeafExact),
     singleSampleLimit(singleSampleLimit),
-    sameSet(sameSet)
+    sameSet(sameSet),
+    rng(math::randGen())
 {
   // Validate tau to make sure that the rank approximation is greater than the
   // number of neighbors requested.
@@ -80,23 +81,43 @@ RASearchRules(const arma::mat& referenceSet,
   std::vector<Candidate> vect(k, def);
   CandidateList pqueue(CandidateCmp(), std::move(vect));
 
-  candidates.reserve(querySet.n_cols);
+  candidateStorage.reserve(querySet.n_cols);
   for (size_t i = 0; i < querySet.n_cols; i++)
-    candidates.push_back(pqueue);
+    candidateStorage.push_back(pqueue);
+  candidates = candidateStorage.data();
 
   if (naive) // No tree traversal; just do naive sampling here.
   {
     // Sample enough points.
-    arma::uvec distinctSamples;
     for (size_t i = 0; i < querySet.n_cols; ++i)
-    {
-      math::ObtainDistinctSamples(0, n, numSamplesReqd, distinctSamples);
-      for (size_t j = 0; j < distinctSamples.n_elem; j++)
-        BaseCase(i, (size_t) distinctSamples[j]);
-    }
+      Sample(i);
   }
 }
 
+template<typename SortPolicy, typename MetricType, typename TreeType>
+RASearchRules<SortPolicy, MetricType, TreeType>::
+RASearchRules(const RASearchRules& other,
+              MetricType& metric,
+              const uint32_t seed) :
+    referenceSet(other.referenceSet),
+    querySet(other.querySet),
+    candidates(other.candidates),
+    k(other.k),
+    metric(metric),
+    sampleAtLeaves(other.sampleAtLeaves),
+    firstLeafExact(other.firstLeafExact),
+    singleSampleLimit(other.singleSampleLimit),
+    numSamplesReqd(other.numSamplesReqd),
+    numSamplesMade(const_cast<size_t*>(other.numSamplesMade.memptr()),
+        other.numSamplesMade.n_elem, false, true),
+    samplingRatio(other.samplingRatio),
+    numDistComputations(0),
+    sameSet(other.sameSet),
+    rng(seed)
+{
+  // Nothing to do.
+}
+
 template<typename SortPolicy, typename MetricType, typename TreeType>
 void RASearchRules<SortPolicy, MetricType, TreeType>::GetResults(
     arma::Mat<size_t>& neighbors,
@@ -140,6 +161,122 @@ double RASearchRules<SortPolicy, MetricType, TreeType>::BaseCase(
   return distance;
 }
 
+template<typename SortPolicy, typename MetricType, typename TreeType>
+void RASearchRules<SortPolicy, MetricType, TreeType>::BaseCases(
+    const size_t queryIndex,
+    const arma::uvec& referenceIndices)
+{
+  arma::mat references = referenceSet.cols(referenceIndices);
+  arma::rowvec distances;
+  BatchDistances(metric, querySet.unsafe_col(queryIndex), references,
+      distances);
+
+  for (size_t i = 0; i < referenceIndices.n_elem; ++i)
+  {
+    // If the datasets are the same, then this search is only using one
+    // dataset and we should not return identical points.
+    const size_t referenceIndex = referenceIndices[i];
+    if (sameSet && (queryIndex == referenceIndex))
+      continue;
+
+    InsertNeighbor(queryIndex, referenceIndex, distances[i]);
+  }
+
+  // Count everything but the query point itself, as BaseCase() does.
+  const size_t numBaseCases = (sameSet && arma::any(referenceIndices ==
+      queryIndex)) ? referenceIndices.n_elem - 1 : referenceIndices.n_elem;
+  numSamplesMade[queryIndex] += numBaseCases;
+  numDistComputations += numBaseCases;
+}
+
+template<typename SortPolicy, typename MetricType, typename TreeType>
+void RASearchRules<SortPolicy, MetricType, TreeType>::Sample(
+    const size_t queryIndex)
+{
+  arma::uvec distinctSamples;
+  ObtainDistinctSamples(referenceSet.n_cols, numSamplesReqd, distinctSamples);
+  BaseCases(queryIndex, distinctSamples);
+}
+
+template<typename SortPolicy, typename MetricType, typename TreeType>
+void RASearchRules<SortPolicy, MetricType, TreeType>::ObtainDistinctSamples(
+    const size_t hiExclusive,
+    const size_t maxNumSamples,
+    arma::uvec& distinctSamples)
+{
+  if (hiExclusive > maxNumSamples)
+  {
+    std::uniform_real_distribution<double> uniform;
+    arma::Col<size_t> samples;
+    samples.zeros(hiExclusive);
+
+    for (size_t i = 0; i < maxNumSamples; i++)
+      samples[(size_t) std::floor((double) hiExclusive * uniform(rng))]++;
+
+    distinctSamples = arma::find(samples > 0);
+  }
+  else
+  {
+    distinctSamples.set_size(hiExclusive);
+    for (size_t i = 0; i < hiExclusive; i++)
+      distinctSamples[i] = i;
+  }
+}
+
+template<typename SortPolicy, typename MetricType, typename TreeType>
+void RASearchRules<SortPolicy, MetricType, TreeType>::SampleNode(
+    const size_t queryIndex,
+    TreeType& referenceNode,
+    const size_t numSamples)
+{
+  arma::uvec distinctSamples;
+  ObtainDistinctSamples(referenceNode.NumDescendants(), numSamples,
+      distinctSamples);
+  for (size_t i = 0; i < distinctSamples.n_elem; ++i)
+    distinctSamples[i] = referenceNode.Descendant(distinctSamples[i]);
+
+  BaseCases(queryIndex, distinctSamples);
+}
+
+template<typename SortPolicy, typename MetricType, typename TreeType>
+template<typename MetricT>
+void RASearchRules<SortPolicy, MetricType, TreeType>::BatchDistances(
+    MetricT& metric,
+    const arma::vec& query,
+    arma::mat& references,
+    arma::rowvec& distances)
+{
+  distances.set_size(references.n_cols);
+  for (size_t i = 0; i < references.n_cols; ++i)
+    distances[i] = metric.Evaluate(query, references.unsafe_col(i));
+}
+
+template<typename SortPolicy, typename MetricType, typename TreeType>
+template<bool TakeRoot>
+void RASearchRules<SortPolicy, MetricType, TreeType>::BatchDistances(
+    metric::LMetric<1, TakeRoot>& /* metric */,
+    const arma::vec& query,
+    arma::mat& references,
+    arma::rowvec& distances)
+{
+  references.each_col() -= query;
+  distances = arma::sum(arma::abs(references), 0);
+}
+
+template<typename SortPolicy, typename MetricType, typename TreeType>
+template<bool TakeRoot>
+void RASearchRules<SortPolicy, MetricType, TreeType>::BatchDistances(
+    metric::LMetric<2, TakeRoot>& /* metric */,
+    const arma::vec& query,
+    arma::mat& references,
+    arma::rowvec& distances)
+{
+  references.each_col() -= query;
+  distances = arma::sum(arma::square(references), 0);
+  if (TakeRoot)
+    distances = arma::sqrt(distances);
+}
+
 template<typename SortPolicy, typename MetricType, typename TreeType>
 inline double RASearchRules<SortPolicy, MetricType, TreeType>::Score(
     const size_t queryIndex,
@@ -203,13 +340,7 @@ inline double RASearchRules<SortPolicy, MetricType, TreeType>::Score(
         {
           // Then samplesReqd <= singleSampleLimit.
           // Hence, approximate the node by sampling enough number of points.
-          arma::uvec distinctSamples;
-          math::ObtainDistinctSamples(0, referenceNode.NumDescendants(),
-              samplesReqd, distinctSamples);
-          for (size_t i = 0; i < distinctSamples.n_elem; i++)
-            // The counting of the samples are done in the 'BaseCase' function
-            // so no book-keeping is required here.
-            BaseCase(queryIndex, referenceNode.Descendant(distinctSamples[i]));
+          SampleNode(queryIndex, referenceNode, samplesReqd);
 
           // Node approximated, so we can prune it.
           return DBL_MAX;
@@ -219,14 +350,7 @@ inline double RASearchRules<SortPolicy, MetricType, TreeType>::Score(
           if (sampleAtLeaves) // If allowed to sample at leaves.
           {
             // Approximate node by sampling enough number of points.
-            arma::uvec distinctSamples;
-            math::ObtainDistinctSamples(0, referenceNode.NumDescendants(),
-                samplesReqd, distinctSamples);
-            for (size_t i = 0; i < distinctSamples.n_elem; i++)
-              // The counting of the samples are done in the 'BaseCase' function
-              // so no book-keeping is required here.
-              BaseCase(queryIndex,
-                  referenceNode.Descendant(distinctSamples[i]));
+            SampleNode(queryIndex, referenceNode, samplesReqd);
 
             // (Leaf) node approximated, so we can prune it.
             return DBL_MAX;
@@ -307,13 +431,7 @@ Rescore(const size_t queryIndex,
       {
         // Then, samplesReqd <= singleSampleLimit.  Hence, approximate the node
         // by sampling enough number of points.
-        arma::uvec distinctSamples;
-        math::ObtainDistinctSamples(0, referenceNode.NumDescendants(),
-            samplesReqd, distinctSamples);
-        for (size_t i = 0; i < distinctSamples.n_elem; i++)
-          // The counting of the samples are done in the 'BaseCase' function so
-          // no book-keeping is required here.
-          BaseCase(queryIndex, referenceNode.Descendant(distinctSamples[i]));
+        SampleNode(queryIndex, referenceNode, samplesReqd);
 
         // Node approximated, so we can prune it.
         return DBL_MAX;
@@ -323,13 +441,7 @@ Rescore(const size_t queryIndex,
         if (sampleAtLeaves)
         {
           // Approximate node by sampling enough points.
-          arma::uvec distinctSamples;
-          math::ObtainDistinctSamples(0, referenceNode.NumDescendants(),
-              samplesReqd, distinctSamples);
-          for (size_t i = 0; i < distinctSamples.n_elem; i++)
-            // The counting of the samples are done in the 'BaseCase' function
-            // so no book-keeping is required here.
-            BaseCase(queryIndex, referenceNode.Descendant(distinctSamples[i]));
+          SampleNode(queryIndex, referenceNode, samplesReqd);
 
           // (Leaf) node approximated, so we can prune it.
           return DBL_MAX;
@@ -507,18 +619,8 @@ inline double RASearchRules<SortPolicy, MetricType, TreeType>::Score(
         {
           // Then samplesReqd <= singleSampleLimit.  Hence, approximate node by
           // sampling enough number of points for every query in the query node.
-          arma::uvec distinctSamples;
           for (size_t i = 0; i < queryNode.NumDescendants(); ++i)
-          {
-            const size_t queryIndex = queryNode.Descendant(i);
-            math::ObtainDistinctSamples(0, referenceNode.NumDescendants(),
-                samplesReqd, distinctSamples);
-            for (size_t j = 0; j < distinctSamples.n_elem; j++)
-              // The counting of the samples are done in the 'BaseCase' function
-              // so no book-keeping is required here.
-              BaseCase(queryIndex,
-                  referenceNode.Descendant(distinctSamples[j]));
-          }
+            SampleNode(queryNode.Descendant(i), referenceNode, samplesReqd);
 
           // Update the number of samples made for the queryNode and also update
           // the number of sample made for the child nodes.
@@ -537,18 +639,8 @@ inline double RASearchRules<SortPolicy, MetricType, TreeType>::Score(
           {
             // Approximate node by sampling enough number of points for every
             // query in the query node.
-            arma::uvec distinctSamples;
             for (size_t i = 0; i < queryNode.NumDescendants(); ++i)
-            {
-              const size_t queryIndex = queryNode.Descendant(i);
-              math::ObtainDistinctSamples(0, referenceNode.NumDescendants(),
-                  samplesReqd, distinctSamples);
-              for (size_t j = 0; j < distinctSamples.n_elem; j++)
-                // The counting of the samples are done in the 'BaseCase'
-                // function so no book-keeping is required here.
-                BaseCase(queryIndex,
-                    referenceNode.Descendant(distinctSamples[j]));
-            }
+              SampleNode(queryNode.Descendant(i), referenceNode, samplesReqd);
 
             // Update the number of samples made for the queryNode and also
             // update the number of sample made for the child nodes.
@@ -712,17 +804,8 @@ Rescore(TreeType& queryNode,
       {
         // then samplesReqd <= singleSampleLimit.  Hence, approximate the node
         // by sampling enough points for every query in the query node.
-        arma::uvec distinctSamples;
         for (size_t i = 0; i < queryNode.NumDescendants(); ++i)
-        {
-          const size_t queryIndex = queryNode.Descendant(i);
-          math::ObtainDistinctSamples(0, referenceNode.NumDescendants(),
-              samplesReqd, distinctSamples);
-          for (size_t j = 0; j < distinctSamples.n_elem; j++)
-            // The counting of the samples are done in the 'BaseCase'
-            // function so no book-keeping is required here.
-            BaseCase(queryIndex, referenceNode.Descendant(distinctSamples[j]));
-        }
+          SampleNode(queryNode.Descendant(i), referenceNode, samplesReqd);
 
         // Update the number of samples made for the query node and also update
         // the number of samples made for the child nodes.
@@ -741,18 +824,8 @@ Rescore(TreeType& queryNode,
         {
           // Approximate node by sampling enough points for every query in the
           // query node.
-          arma::uvec distinctSamples;
           for (size_t i = 0; i < queryNode.NumDescendants(); ++i)
-          {
-            const size_t queryIndex = queryNode.Descendant(i);
-            math::ObtainDistinctSamples(0, referenceNode.NumDescendants(),
-                samplesReqd, distinctSamples);
-            for (size_t j = 0; j < distinctSamples.n_elem; j++)
-              // The counting of the samples are done in BaseCase() so no
-              // book-keeping is required here.
-              BaseCase(queryIndex,
-                  referenceNode.Descendant(distinctSamples[j]));
-          }
+            SampleNode(queryNode.Descendant(i), referenceNode, samplesReqd);
 
           // Update the number of samples made for the query node and also
           // update the number of samples made for the child nodes.
@@ -15,6 +15,7 @@
 
 #include <mlpack/prereqs.hpp>
 #include "queue"
+#include "target_parameters.hpp"
 
 namespace mlpack {
 namespace rl {
@@ -68,10 +69,12 @@ void AsyncLearning<
   NetworkType learningNetwork = std::move(this->learningNetwork);
   if (learningNetwork.Parameters().is_empty())
     learningNetwork.ResetParameters();
-  NetworkType targetNetwork = learningNetwork;
-  size_t totalSteps = 0;
+  // The workers keep local target networks and copy the shared target
+  // parameters when a new version is published.
+  TargetParameters targetParameters(learningNetwork.Parameters());
+  std::atomic<size_t> totalSteps(0);
   PolicyType policy = this->policy;
-  bool stop = false;
+  std::atomic<bool> stop(false);
 
   // Set up worker pool, worker 0 will be deterministic for evaluation.
   std::vector<WorkerType> workers;
@@ -96,7 +99,7 @@ void AsyncLearning<
   Log::Debug << numThreads << " threads will be used in total." << std::endl;
 
   #pragma omp parallel for shared(stop, workers, tasks, learningNetwork, \
-      targetNetwork, totalSteps, policy)
+      targetParameters, totalSteps, policy)
   for (omp_size_t i = 0; i < numThreads; ++i)
   {
     #pragma omp critical
@@ -129,7 +132,7 @@ void AsyncLearning<
       // Get corresponding worker.
       WorkerType& worker = workers[task];
       double episodeReturn;
-      if (worker.Step(learningNetwork, targetNetwork, totalSteps,
+      if (worker.Step(learningNetwork, targetParameters, totalSteps,
           policy, episodeReturn) && !task)
       {
         stop = measure(episodeReturn);
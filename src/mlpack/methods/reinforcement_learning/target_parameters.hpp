@@ -0,0 +1,110 @@
+/**
+ * @file target_parameters.hpp
+ *
+ * This file is the definition of TargetParameters class, which shares the
+ * parameters of the target network between asynchronous workers.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_RL_TARGET_PARAMETERS_HPP
+#define MLPACK_METHODS_RL_TARGET_PARAMETERS_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#include <atomic>
+
+namespace mlpack {
+namespace rl {
+
+/**
+ * Double-buffered parameters of the target network.  A sync writes the
+ * learning network parameters into the buffer that is not published and then
+ * publishes it, so the workers can copy the published parameters into their
+ * local target networks without a lock while the next sync is written.
+ *
+ * The version works like a sequence lock: it is odd while a sync is written
+ * and half of it is the number of completed syncs.  A worker that copies a
+ * buffer checks the version again afterwards and copies again if a later sync
+ * may have started to overwrite that buffer.
+ */
+class TargetParameters
+{
+ public:
+  /**
+   * Create the buffers with the given initial parameters.
+   *
+   * @param parameters The initial parameters of the target network.
+   */
+  TargetParameters(const arma::mat& parameters) : version(0)
+  {
+    buffers[0] = parameters;
+    buffers[1] = parameters;
+  }
+
+  /**
+   * Publish a copy of the given parameters.  If another worker is publishing
+   * at the same time, nothing is published; both workers publish the
+   * parameters of the same learning network, so the other copy is as recent.
+   *
+   * @param parameters The parameters of the learning network.
+   * @return Whether the parameters were published.
+   */
+  bool Publish(const arma::mat& parameters)
+  {
+    size_t current = version.load(std::memory_order_relaxed);
+    if ((current % 2 == 1) || !version.compare_exchange_strong(current,
+        current + 1, std::memory_order_acquire, std::memory_order_relaxed))
+      return false;
+
+    // Only this worker writes until the version is even again.
+    std::atomic_thread_fence(std::memory_order_release);
+    buffers[(current / 2 + 1) % 2] = parameters;
+    version.store(current + 2, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * Copy the published parameters if they changed since the given version.
+   *
+   * @param parameters The parameters of the local target network.
+   * @param localVersion The version of the local parameters; it is updated.
+   * @return Whether the parameters were copied.
+   */
+  bool Load(arma::mat& parameters, size_t& localVersion) const
+  {
+    while (true)
+    {
+      const size_t current = version.load(std::memory_order_acquire);
+      const size_t published = current / 2;
+      if (published == localVersion)
+        return false;
+
+      parameters = buffers[published % 2];
+
+      // The copied buffer is only written again by the second sync after it,
+      // which starts when the version reaches 2 * published + 3.
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (version.load(std::memory_order_relaxed) < 2 * published + 3)
+      {
+        localVersion = published;
+        return true;
+      }
+    }
+  }
+
+ private:
+  //! The two parameter buffers.
+  arma::mat buffers[2];
+
+  //! Twice the number of syncs, plus one while a sync is written;
+  //! buffers[(version / 2) % 2] is published.
+  std::atomic<size_t> version;
+};
+
+} // namespace rl
+} // namespace mlpack
+
+#endif
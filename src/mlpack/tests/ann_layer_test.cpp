@@ -899,6 +899,237 @@ BOOST_AUTO_TEST_CASE(GradientFastLSTMLayerTest)
   BOOST_REQUIRE_LE(CheckGradient(function), 0.2);
 }
 
+/**
+ * FastLSTM layer numerically gradient test with more than one sequence per
+ * batch.
+ */
+BOOST_AUTO_TEST_CASE(GradientFastLSTMLayerBatchTest)
+{
+  // Fast LSTM function gradient instantiation.
+  struct GradientFunction
+  {
+    GradientFunction()
+    {
+      input = arma::randu(5, 4);
+      target = arma::ones(5, 4);
+      const size_t rho = 5;
+
+      model = new RNN<NegativeLogLikelihood<> >(input, target, rho);
+      model->Add<IdentityLayer<> >();
+      model->Add<Linear<> >(1, 10);
+      model->Add<FastLSTM<> >(10, 3, rho);
+      model->Add<LogSoftMax<> >();
+    }
+
+    ~GradientFunction()
+    {
+      delete model;
+    }
+
+    double Gradient(arma::mat& gradient) const
+    {
+      double error = model->Evaluate(model->Parameters(), 0, 4);
+      model->Gradient(model->Parameters(), 0, gradient, 4);
+      return error;
+    }
+
+    arma::mat& Parameters() { return model->Parameters(); }
+
+    RNN<NegativeLogLikelihood<> >* model;
+    arma::mat input, target;
+  } function;
+
+  // See GradientFastLSTMLayerTest for the threshold.
+  BOOST_REQUIRE_LE(CheckGradient(function), 0.2);
+}
+
+/**
+ * FastPeepholeLSTM layer numerically gradient test.
+ */
+BOOST_AUTO_TEST_CASE(GradientFastPeepholeLSTMLayerTest)
+{
+  // FastPeepholeLSTM function gradient instantiation.
+  struct GradientFunction
+  {
+    GradientFunction()
+    {
+      input = arma::randu(5, 1);
+      target = arma::mat("1; 1; 1; 1; 1");
+      const size_t rho = 5;
+
+      model = new RNN<NegativeLogLikelihood<> >(input, target, rho);
+      model->Add<IdentityLayer<> >();
+      model->Add<Linear<> >(1, 10);
+      model->Add<FastPeepholeLSTM<> >(10, 3, rho);
+      model->Add<LogSoftMax<> >();
+    }
+
+    ~GradientFunction()
+    {
+      delete model;
+    }
+
+    double Gradient(arma::mat& gradient) const
+    {
+      double error = model->Evaluate(model->Parameters(), 0, 1);
+      model->Gradient(model->Parameters(), 0, gradient, 1);
+      return error;
+    }
+
+    arma::mat& Parameters() { return model->Parameters(); }
+
+    RNN<NegativeLogLikelihood<> >* model;
+    arma::mat input, target;
+  } function;
+
+  BOOST_REQUIRE_LE(CheckGradient(function), 1e-4);
+}
+
+/**
+ * FastPeepholeLSTM layer numerically gradient test with more than one
+ * sequence per batch.
+ */
+BOOST_AUTO_TEST_CASE(GradientFastPeepholeLSTMLayerBatchTest)
+{
+  // FastPeepholeLSTM function gradient instantiation.
+  struct GradientFunction
+  {
+    GradientFunction()
+    {
+      input = arma::randu(5, 4);
+      target = arma::ones(5, 4);
+      const size_t rho = 5;
+
+      model = new RNN<NegativeLogLikelihood<> >(input, target, rho);
+      model->Add<IdentityLayer<> >();
+      model->Add<Linear<> >(1, 10);
+      model->Add<FastPeepholeLSTM<> >(10, 3, rho);
+      model->Add<LogSoftMax<> >();
+    }
+
+    ~GradientFunction()
+    {
+      delete model;
+    }
+
+    double Gradient(arma::mat& gradient) const
+    {
+      double error = model->Evaluate(model->Parameters(), 0, 4);
+      model->Gradient(model->Parameters(), 0, gradient, 4);
+      return error;
+    }
+
+    arma::mat& Parameters() { return model->Parameters(); }
+
+    RNN<NegativeLogLikelihood<> >* model;
+    arma::mat input, target;
+  } function;
+
+  BOOST_REQUIRE_LE(CheckGradient(function), 1e-4);
+}
+
+/**
+ * Convert the parameters of an LSTM layer to the parameter layout of the
+ * FastPeepholeLSTM layer.
+ */
+arma::mat LSTMToFastPeepholeLSTMParameters(const arma::mat& parameters,
+                                           const size_t inSize,
+                                           const size_t outSize)
+{
+  arma::mat converted(parameters.n_elem, 1);
+  arma::mat weight(converted.memptr(), 4 * outSize, inSize, false, true);
+  arma::mat bias(converted.memptr() + weight.n_elem, 4 * outSize, 1, false,
+      true);
+  arma::mat outputWeight(converted.memptr() + weight.n_elem + bias.n_elem,
+      4 * outSize, outSize, false, true);
+  arma::mat peephole(converted.memptr() + weight.n_elem + bias.n_elem +
+      outputWeight.n_elem, 3 * outSize, 1, false, true);
+
+  // The LSTM layer orders the gates as output gate, forget gate, input gate and
+  // hidden state; FastPeepholeLSTM as input gate, output gate, forget gate and
+  // hidden state.
+  const size_t block[4] = { 1, 2, 0, 3 };
+
+  size_t offset = 0;
+  for (size_t i = 0; i < 4; ++i)
+  {
+    weight.rows(block[i] * outSize, (block[i] + 1) * outSize - 1) =
+        arma::reshape(parameters.rows(offset, offset + outSize * inSize - 1),
+        outSize, inSize);
+    offset += outSize * inSize;
+    bias.rows(block[i] * outSize, (block[i] + 1) * outSize - 1) =
+        parameters.rows(offset, offset + outSize - 1);
+    offset += outSize;
+  }
+
+  for (size_t i = 0; i < 4; ++i)
+  {
+    outputWeight.rows(block[i] * outSize, (block[i] + 1) * outSize - 1) =
+        arma::reshape(parameters.rows(offset, offset + outSize * outSize - 1),
+        outSize, outSize);
+    offset += outSize * outSize;
+  }
+
+  for (size_t i = 0; i < 3; ++i)
+  {
+    peephole.rows(block[i] * outSize, (block[i] + 1) * outSize - 1) =
+        parameters.rows(offset, offset + outSize - 1);
+    offset += outSize;
+  }
+
+  return converted;
+}
+
+/**
+ * Make sure that the FastPeepholeLSTM layer computes the same output and
+ * gradient as the LSTM layer.
+ */
+BOOST_AUTO_TEST_CASE(FastPeepholeLSTMLayerMatchesLSTMTest)
+{
+  arma::mat input = arma::randu(5, 1);
+  arma::mat target = arma::mat("1; 1; 1; 1; 1");
+  const size_t rho = 5;
+
+  RNN<NegativeLogLikelihood<> > model(input, target, rho);
+  model.Add<IdentityLayer<> >();
+  model.Add<Linear<> >(1, 10);
+  model.Add<LSTM<> >(10, 3, rho);
+  model.Add<LogSoftMax<> >();
+
+  RNN<NegativeLogLikelihood<> > fusedModel(input, target, rho);
+  fusedModel.Add<IdentityLayer<> >();
+  fusedModel.Add<Linear<> >(1, 10);
+  fusedModel.Add<FastPeepholeLSTM<> >(10, 3, rho);
+  fusedModel.Add<LogSoftMax<> >();
+
+  model.ResetParameters();
+  fusedModel.ResetParameters();
+
+  // The parameters of the Linear layer come first.
+  const size_t linearSize = 20;
+  const size_t lstmSize = model.Parameters().n_elem - linearSize;
+  fusedModel.Parameters().rows(0, linearSize - 1) =
+      model.Parameters().rows(0, linearSize - 1);
+  fusedModel.Parameters().rows(linearSize, linearSize + lstmSize - 1) =
+      LSTMToFastPeepholeLSTMParameters(model.Parameters().rows(linearSize,
+      linearSize + lstmSize - 1), 10, 3);
+
+  const double error = model.Evaluate(model.Parameters(), 0, 1);
+  const double fusedError = fusedModel.Evaluate(fusedModel.Parameters(), 0,
+      1);
+  BOOST_REQUIRE_CLOSE(error, fusedError, 1e-5);
+
+  arma::mat gradient, fusedGradient;
+  model.Gradient(model.Parameters(), 0, gradient, 1);
+  fusedModel.Gradient(fusedModel.Parameters(), 0, fusedGradient, 1);
+
+  arma::mat expectedGradient = gradient;
+  expectedGradient.rows(linearSize, linearSize + lstmSize - 1) =
+      LSTMToFastPeepholeLSTMParameters(gradient.rows(linearSize,
+      linearSize + lstmSize - 1), 10, 3);
+  CheckMatrices(fusedGradient, expectedGradient, 1e-3);
+}
+
 /**
  * Check if the gradients computed by GRU cell are close enough to the
  * approximation of the gradients.
@@ -996,6 +1227,129 @@ BOOST_AUTO_TEST_CASE(ForwardGRULayerTest)
   BOOST_REQUIRE_LE(arma::as_scalar(arma::trans(output) * expectedOutput), 1e-2);
 }
 
+/**
+ * FastGRU layer numerically gradient test.
+ */
+BOOST_AUTO_TEST_CASE(GradientFastGRULayerTest)
+{
+  // FastGRU function gradient instantiation.
+  struct GradientFunction
+  {
+    GradientFunction()
+    {
+      input = arma::randu(5, 1);
+      target = arma::mat("1; 1; 1; 1; 1");
+      const size_t rho = 5;
+
+      model = new RNN<NegativeLogLikelihood<> >(input, target, rho);
+      model->Add<IdentityLayer<> >();
+      model->Add<Linear<> >(1, 10);
+      model->Add<FastGRU<> >(10, 3, rho);
+      model->Add<LogSoftMax<> >();
+    }
+
+    ~GradientFunction()
+    {
+      delete model;
+    }
+
+    double Gradient(arma::mat& gradient) const
+    {
+      double error = model->Evaluate(model->Parameters(), 0, 1);
+      model->Gradient(model->Parameters(), 0, gradient, 1);
+      return error;
+    }
+
+    arma::mat& Parameters() { return model->Parameters(); }
+
+    RNN<NegativeLogLikelihood<> >* model;
+    arma::mat input, target;
+  } function;
+
+  BOOST_REQUIRE_LE(CheckGradient(function), 1e-4);
+}
+
+/**
+ * FastGRU layer numerically gradient test with more than one sequence per
+ * batch.
+ */
+BOOST_AUTO_TEST_CASE(GradientFastGRULayerBatchTest)
+{
+  // FastGRU function gradient instantiation.
+  struct GradientFunction
+  {
+    GradientFunction()
+    {
+      input = arma::randu(5, 4);
+      target = arma::ones(5, 4);
+      const size_t rho = 5;
+
+      model = new RNN<NegativeLogLikelihood<> >(input, target, rho);
+      model->Add<IdentityLayer<> >();
+      model->Add<Linear<> >(1, 10);
+      model->Add<FastGRU<> >(10, 3, rho);
+      model->Add<LogSoftMax<> >();
+    }
+
+    ~GradientFunction()
+    {
+      delete model;
+    }
+
+    double Gradient(arma::mat& gradient) const
+    {
+      double error = model->Evaluate(model->Parameters(), 0, 4);
+      model->Gradient(model->Parameters(), 0, gradient, 4);
+      return error;
+    }
+
+    arma::mat& Parameters() { return model->Parameters(); }
+
+    RNN<NegativeLogLikelihood<> >* model;
+    arma::mat input, target;
+  } function;
+
+  BOOST_REQUIRE_LE(CheckGradient(function), 1e-4);
+}
+
+/**
+ * Make sure that the FastGRU layer computes the same output and gradient as the
+ * GRU layer; both layers use the same parameter layout.
+ */
+BOOST_AUTO_TEST_CASE(FastGRULayerMatchesGRUTest)
+{
+  arma::mat input = arma::randu(5, 1);
+  arma::mat target = arma::mat("1; 1; 1; 1; 1");
+  const size_t rho = 5;
+
+  RNN<NegativeLogLikelihood<> > model(input, target, rho);
+  model.Add<IdentityLayer<> >();
+  model.Add<Linear<> >(1, 10);
+  model.Add<GRU<> >(10, 3, rho);
+  model.Add<LogSoftMax<> >();
+
+  RNN<NegativeLogLikelihood<> > fusedModel(input, target, rho);
+  fusedModel.Add<IdentityLayer<> >();
+  fusedModel.Add<Linear<> >(1, 10);
+  fusedModel.Add<FastGRU<> >(10, 3, rho);
+  fusedModel.Add<LogSoftMax<> >();
+
+  model.ResetParameters();
+  fusedModel.ResetParameters();
+  BOOST_REQUIRE_EQUAL(fusedModel.Parameters().n_elem,
+      model.Parameters().n_elem);
+  fusedModel.Parameters() = model.Parameters();
+
+  const double error = model.Evaluate(model.Parameters(), 0, 1);
+  const double fusedError = fusedModel.Evaluate(fusedModel.Parameters(), 0,
+      1);
+  BOOST_REQUIRE_CLOSE(error, fusedError, 1e-5);
+
+  arma::mat gradient, fusedGradient;
+  model.Gradient(model.Parameters(), 0, gradient, 1);
+  fusedModel.Gradient(fusedModel.Parameters(), 0, fusedGradient, 1);
+  CheckMatrices(fusedGradient, gradient, 1e-3);
+}
 
 /**
  * Simple concat module test.
@@ -1122,6 +1476,43 @@ BOOST_AUTO_TEST_CASE(SimpleLookupLayerTest)
   BOOST_REQUIRE_CLOSE(arma::accu(gradient), arma::accu(error), 1e-3);
 }
 
+/**
+ * Make sure that the Lookup gradient accumulates the error of repeated tokens
+ * and only clears the columns of the last call.
+ */
+BOOST_AUTO_TEST_CASE(LookupRepeatedTokenGradientTest)
+{
+  arma::mat input, gradient;
+  Lookup<> module(10, 5);
+  module.Parameters().randu();
+
+  input = arma::mat("2; 2; 4");
+  arma::mat error = arma::randu(5, 3);
+  module.Gradient(std::move(input), std::move(error), std::move(gradient));
+
+  BOOST_REQUIRE_EQUAL(gradient.n_rows, 5);
+  BOOST_REQUIRE_EQUAL(gradient.n_cols, 10);
+  BOOST_REQUIRE_EQUAL(module.GradientColumns().n_elem, 2);
+  BOOST_REQUIRE_EQUAL(module.GradientColumns()[0], 1);
+  BOOST_REQUIRE_EQUAL(module.GradientColumns()[1], 3);
+  for (size_t i = 0; i < 5; ++i)
+  {
+    BOOST_REQUIRE_CLOSE(gradient(i, 1), error(i, 0) + error(i, 1), 1e-5);
+    BOOST_REQUIRE_CLOSE(gradient(i, 3), error(i, 2), 1e-5);
+  }
+  BOOST_REQUIRE_CLOSE(arma::accu(gradient), arma::accu(error), 1e-5);
+
+  // A second call on the same gradient must not keep the old columns.
+  input = arma::mat("1");
+  error = arma::randu(5, 1);
+  module.Gradient(std::move(input), std::move(error), std::move(gradient));
+
+  BOOST_REQUIRE_EQUAL(module.GradientColumns().n_elem, 1);
+  BOOST_REQUIRE_EQUAL(module.GradientColumns()[0], 0);
+  CheckMatrices(gradient.col(0), error.col(0));
+  BOOST_REQUIRE_CLOSE(arma::accu(gradient), arma::accu(error), 1e-5);
+}
+
 /**
  * Simple LogSoftMax module test.
  */
@@ -1223,4 +1614,217 @@ BOOST_AUTO_TEST_CASE(SimpleMeanSquaredErrorLayerTest)
   BOOST_REQUIRE_EQUAL(output.n_elem, 1);
 }
 
+/**
+ * Run a small network of single-precision layers and compare the outputs and
+ * gradients with the same network in double precision.
+ */
+BOOST_AUTO_TEST_CASE(SinglePrecisionLayerTest)
+{
+  arma::mat input = arma::randu<arma::mat>(10, 4);
+  arma::mat target("1 2 3 1");
+
+  Linear<> linear(10, 6);
+  SigmoidLayer<> sigmoid;
+  Linear<> outputLinear(6, 3);
+  LogSoftMax<> logSoftMax;
+  NegativeLogLikelihood<> nll;
+  linear.Parameters().randn();
+  linear.Reset();
+  outputLinear.Parameters().randn();
+  outputLinear.Reset();
+
+  Linear<arma::fmat, arma::fmat> linearFloat(10, 6);
+  SigmoidLayer<LogisticFunction, arma::fmat, arma::fmat> sigmoidFloat;
+  Linear<arma::fmat, arma::fmat> outputLinearFloat(6, 3);
+  LogSoftMax<arma::fmat, arma::fmat> logSoftMaxFloat;
+  NegativeLogLikelihood<arma::fmat, arma::fmat> nllFloat;
+  linearFloat.Parameters() =
+      arma::conv_to<arma::fmat>::from(linear.Parameters());
+  linearFloat.Reset();
+  outputLinearFloat.Parameters() =
+      arma::conv_to<arma::fmat>::from(outputLinear.Parameters());
+  outputLinearFloat.Reset();
+
+  // Forward pass.
+  arma::mat hidden, activation, output, logProbabilities;
+  linear.Forward(std::move(input), std::move(hidden));
+  sigmoid.Forward(std::move(hidden), std::move(activation));
+  outputLinear.Forward(std::move(activation), std::move(output));
+  logSoftMax.Forward(std::move(output), std::move(logProbabilities));
+  const double loss = nll.Forward(std::move(logProbabilities),
+      std::move(target));
+
+  arma::fmat inputFloat = arma::conv_to<arma::fmat>::from(input);
+  arma::fmat targetFloat = arma::conv_to<arma::fmat>::from(target);
+  arma::fmat hiddenFloat, activationFloat, outputFloat, logProbabilitiesFloat;
+  linearFloat.Forward(std::move(inputFloat), std::move(hiddenFloat));
+  sigmoidFloat.Forward(std::move(hiddenFloat), std::move(activationFloat));
+  outputLinearFloat.Forward(std::move(activationFloat),
+      std::move(outputFloat));
+  logSoftMaxFloat.Forward(std::move(outputFloat),
+      std::move(logProbabilitiesFloat));
+  const double lossFloat = nllFloat.Forward(std::move(logProbabilitiesFloat),
+      std::move(targetFloat));
+
+  BOOST_REQUIRE_CLOSE(loss, lossFloat, 1e-3);
+  CheckMatrices(logProbabilities,
+      arma::conv_to<arma::mat>::from(logProbabilitiesFloat), 1e-4);
+
+  // Backward pass and gradients.
+  arma::mat error, outputError, activationError, hiddenError, gradient;
+  nll.Backward(std::move(logProbabilities), std::move(target),
+      std::move(error));
+  logSoftMax.Backward(std::move(logProbabilities), std::move(error),
+      std::move(outputError));
+  outputLinear.Backward(std::move(activation), std::move(outputError),
+      std::move(activationError));
+  sigmoid.Backward(std::move(activation), std::move(activationError),
+      std::move(hiddenError));
+  gradient.set_size(linear.Parameters().n_elem, 1);
+  linear.Gradient(std::move(input), std::move(hiddenError),
+      std::move(gradient));
+
+  arma::fmat errorFloat, outputErrorFloat, activationErrorFloat,
+      hiddenErrorFloat, gradientFloat;
+  nllFloat.Backward(std::move(logProbabilitiesFloat), std::move(targetFloat),
+      std::move(errorFloat));
+  logSoftMaxFloat.Backward(std::move(logProbabilitiesFloat),
+      std::move(errorFloat), std::move(outputErrorFloat));
+  outputLinearFloat.Backward(std::move(activationFloat),
+      std::move(outputErrorFloat), std::move(activationErrorFloat));
+  sigmoidFloat.Backward(std::move(activationFloat),
+      std::move(activationErrorFloat), std::move(hiddenErrorFloat));
+  gradientFloat.set_size(linearFloat.Parameters().n_elem, 1);
+  linearFloat.Gradient(std::move(inputFloat), std::move(hiddenErrorFloat),
+      std::move(gradientFloat));
+
+  CheckMatrices(gradient, arma::conv_to<arma::mat>::from(gradientFloat),
+      1e-3);
+}
+
+/**
+ * The pooling configurations of the tests below, on 7x6 inputs: kW, kH, dW,
+ * dH, whether to use floor rounding, and the expected output width and height.
+ * They cover the 2x2 case, overlapping 3x3 windows, different strides in both
+ * directions and, with ceil rounding, a last window that is clipped at the
+ * border and strides larger than the windows, where a last window that would
+ * start past the input is dropped.  With ceil rounding the windows are one
+ * element smaller in both directions.
+ */
+static const size_t poolingConfigs[5][7] = {
+    { 2, 2, 2, 2, 1, 3, 3 },
+    { 3, 3, 1, 1, 1, 5, 4 },
+    { 3, 2, 2, 1, 1, 3, 5 },
+    { 3, 5, 2, 3, 0, 3, 2 },
+    { 2, 2, 4, 3, 0, 2, 2 } };
+
+/**
+ * Compare the MaxPooling layer with a window-by-window computation for each of
+ * the pooling configurations, on a batch of two points.
+ */
+BOOST_AUTO_TEST_CASE(SimpleMaxPoolingLayerTest)
+{
+  for (size_t p = 0; p < 5; ++p)
+  {
+    const size_t* config = poolingConfigs[p];
+    const size_t kW = config[0], kH = config[1], dW = config[2],
+        dH = config[3], offset = config[4] ? 0 : 1;
+    const size_t outWidth = config[5], outHeight = config[6];
+
+    arma::mat input = arma::randu<arma::mat>(2 * 7 * 6, 2);
+    arma::mat output, deterministicOutput, delta;
+    arma::cube inputCube(input.memptr(), 7, 6, 4);
+
+    MaxPooling<> module(kW, kH, dW, dH, config[4]);
+    module.InputWidth() = 7;
+    module.InputHeight() = 6;
+
+    module.Deterministic() = true;
+    module.Forward(std::move(input), std::move(deterministicOutput));
+    module.Deterministic() = false;
+    module.Forward(std::move(input), std::move(output));
+    CheckMatrices(output, deterministicOutput);
+
+    BOOST_REQUIRE_EQUAL(module.OutputWidth(), outWidth);
+    BOOST_REQUIRE_EQUAL(module.OutputHeight(), outHeight);
+    BOOST_REQUIRE_EQUAL(output.n_elem, outWidth * outHeight * 4);
+    arma::cube outputCube(output.memptr(), outWidth, outHeight, 4);
+    for (size_t s = 0; s < 4; ++s)
+    {
+      for (size_t j = 0; j < outHeight; ++j)
+      {
+        for (size_t i = 0; i < outWidth; ++i)
+        {
+          const size_t lastRow = std::min(i * dW + kW - offset, (size_t) 7);
+          const size_t lastCol = std::min(j * dH + kH - offset, (size_t) 6);
+          BOOST_REQUIRE_EQUAL(outputCube(i, j, s), inputCube.slice(s).submat(
+              i * dW, j * dH, lastRow - 1, lastCol - 1).max());
+        }
+      }
+    }
+
+    // The error of each window goes to its maximum.
+    arma::mat error = arma::ones(output.n_elem, 1);
+    module.Backward(std::move(input), std::move(error), std::move(delta));
+    BOOST_REQUIRE_EQUAL(delta.n_elem, input.n_elem);
+    BOOST_REQUIRE_CLOSE(arma::accu(delta), output.n_elem, 1e-5);
+    for (size_t i = 0; i < delta.n_elem; ++i)
+    {
+      if (delta[i] != 0)
+        BOOST_REQUIRE(arma::any(arma::vectorise(output) == input[i]));
+    }
+  }
+}
+
+/**
+ * Compare the MeanPooling layer with the means of the windows for each of the
+ * pooling configurations, and make sure that its backward pass is the
+ * transpose of its (linear) forward pass.
+ */
+BOOST_AUTO_TEST_CASE(SimpleMeanPoolingLayerTest)
+{
+  for (size_t p = 0; p < 5; ++p)
+  {
+    const size_t* config = poolingConfigs[p];
+    const size_t kW = config[0], kH = config[1], dW = config[2],
+        dH = config[3], offset = config[4] ? 0 : 1;
+    const size_t outWidth = config[5], outHeight = config[6];
+
+    arma::mat input = arma::randu<arma::mat>(2 * 7 * 6, 2);
+    arma::mat output, delta;
+    arma::cube inputCube(input.memptr(), 7, 6, 4);
+
+    MeanPooling<> module(kW, kH, dW, dH, config[4]);
+    module.InputWidth() = 7;
+    module.InputHeight() = 6;
+    module.Forward(std::move(input), std::move(output));
+
+    BOOST_REQUIRE_EQUAL(module.OutputWidth(), outWidth);
+    BOOST_REQUIRE_EQUAL(module.OutputHeight(), outHeight);
+    BOOST_REQUIRE_EQUAL(output.n_elem, outWidth * outHeight * 4);
+    arma::cube outputCube(output.memptr(), outWidth, outHeight, 4);
+    for (size_t s = 0; s < 4; ++s)
+    {
+      for (size_t j = 0; j < outHeight; ++j)
+      {
+        for (size_t i = 0; i < outWidth; ++i)
+        {
+          // A clipped window is averaged over its remaining elements.
+          const size_t lastRow = std::min(i * dW + kW - offset, (size_t) 7);
+          const size_t lastCol = std::min(j * dH + kH - offset, (size_t) 6);
+          BOOST_REQUIRE_CLOSE(outputCube(i, j, s), arma::mean(arma::vectorise(
+              inputCube.slice(s).submat(i * dW, j * dH, lastRow - 1,
+              lastCol - 1))), 1e-5);
+        }
+      }
+    }
+
+    arma::mat error = arma::randu<arma::mat>(output.n_elem, 1);
+    module.Backward(std::move(input), std::move(error), std::move(delta));
+    BOOST_REQUIRE_EQUAL(delta.n_elem, input.n_elem);
+    BOOST_REQUIRE_CLOSE(arma::dot(arma::vectorise(output), error),
+        arma::dot(arma::vectorise(input), delta), 1e-5);
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -19,6 +19,7 @@
 #include <mlpack/core/optimizers/adam/adam_update.hpp>
 #include <mlpack/methods/reinforcement_learning/policy/greedy_policy.hpp>
 #include <mlpack/methods/reinforcement_learning/policy/aggregated_policy.hpp>
+#include <mlpack/methods/reinforcement_learning/target_parameters.hpp>
 #include <mlpack/methods/reinforcement_learning/training_config.hpp>
 
 #include <boost/test/unit_test.hpp>
@@ -217,4 +218,79 @@ BOOST_AUTO_TEST_CASE(NStepQLearningTest)
   Log::Debug << "Total test episodes: " << testEpisodes << std::endl;
 }
 
+/**
+ * Make sure that the target parameters are only copied when a new version is
+ * published, and that the published copy is not changed by later updates.
+ */
+BOOST_AUTO_TEST_CASE(TargetParametersTest)
+{
+  arma::mat parameters = arma::randu<arma::mat>(10, 1);
+  TargetParameters targetParameters(parameters);
+
+  arma::mat localParameters = parameters;
+  size_t localVersion = 0;
+  BOOST_REQUIRE(!targetParameters.Load(localParameters, localVersion));
+
+  const arma::mat published = parameters + 1;
+  BOOST_REQUIRE(targetParameters.Publish(published));
+  parameters += 2;
+
+  BOOST_REQUIRE(targetParameters.Load(localParameters, localVersion));
+  BOOST_REQUIRE_EQUAL(localVersion, 1);
+  CheckMatrices(localParameters, published);
+  BOOST_REQUIRE(!targetParameters.Load(localParameters, localVersion));
+
+  // The next version is written into the other buffer.
+  BOOST_REQUIRE(targetParameters.Publish(parameters));
+  BOOST_REQUIRE(targetParameters.Load(localParameters, localVersion));
+  BOOST_REQUIRE_EQUAL(localVersion, 2);
+  CheckMatrices(localParameters, parameters);
+}
+
+/**
+ * Make sure that the workers never load a partially written copy while the
+ * target parameters are published.
+ */
+BOOST_AUTO_TEST_CASE(TargetParametersConcurrentTest)
+{
+  const size_t syncs = 1000;
+  TargetParameters targetParameters(arma::zeros<arma::mat>(1000, 1));
+
+  #ifdef HAS_OPENMP
+    const size_t prevNumThreads = omp_get_max_threads();
+    omp_set_num_threads(4);
+  #endif
+
+  // The first thread publishes copies whose elements all equal the number of
+  // the sync; the others load until they saw the last sync.
+  size_t inconsistent = 0;
+  #pragma omp parallel for schedule(static) reduction(+:inconsistent)
+  for (omp_size_t i = 0; i < 4; ++i)
+  {
+    if (i == 0)
+    {
+      for (size_t j = 1; j <= syncs; ++j)
+        targetParameters.Publish(arma::mat(1000, 1).fill(j));
+    }
+    else
+    {
+      arma::mat localParameters;
+      size_t localVersion = 0;
+      while (localVersion != syncs)
+      {
+        if (targetParameters.Load(localParameters, localVersion) &&
+            (arma::any(localParameters.col(0) != localParameters(0)) ||
+            (size_t) localParameters(0) != localVersion))
+          ++inconsistent;
+      }
+    }
+  }
+
+  #ifdef HAS_OPENMP
+    omp_set_num_threads(prevNumThreads);
+  #endif
+
+  BOOST_REQUIRE_EQUAL(inconsistent, 0);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -349,6 +349,97 @@ BOOST_AUTO_TEST_CASE(TestComputeValue)
   BOOST_REQUIRE_CLOSE(0.0, testDTree.ComputeValue(q4), 1e-10);
 }
 
+/**
+ * Make sure that the batch density estimates match ComputeValue().
+ */
+BOOST_AUTO_TEST_CASE(TestComputeValues)
+{
+  arma::mat testData(3, 5);
+
+  testData << 4 << 5 << 7 << 3 << 5 << arma::endr
+           << 5 << 0 << 1 << 7 << 1 << arma::endr
+           << 5 << 6 << 7 << 1 << 8 << arma::endr;
+
+  arma::mat queries(3, 4);
+  queries << 4 << 5 << 5 << 2 << arma::endr
+          << 2 << 0.25 << 3 << 3 << arma::endr
+          << 2 << 6 << 7 << 3 << arma::endr;
+
+  arma::Col<size_t> oTest(5);
+  oTest << 0 << 1 << 2 << 3 << 4;
+
+  DTree<arma::mat> testDTree(testData);
+  double alpha = testDTree.Grow(testData, oTest, false, 2, 1);
+
+  arma::rowvec values;
+  testDTree.ComputeValues(queries, values);
+
+  BOOST_REQUIRE_EQUAL(values.n_elem, 4);
+  for (size_t i = 0; i < queries.n_cols; ++i)
+  {
+    const arma::vec query = queries.col(i);
+    BOOST_REQUIRE_EQUAL(values[i], testDTree.ComputeValue(query));
+  }
+
+  // The estimates should still match after pruning.
+  testDTree.PruneAndUpdate(alpha, testData.n_cols, false);
+  testDTree.ComputeValues(queries, values);
+
+  for (size_t i = 0; i < queries.n_cols; ++i)
+  {
+    const arma::vec query = queries.col(i);
+    BOOST_REQUIRE_EQUAL(values[i], testDTree.ComputeValue(query));
+  }
+}
+
+/**
+ * The grown tree should not depend on the number of threads.
+ */
+BOOST_AUTO_TEST_CASE(TestGrowThreadCount)
+{
+  const arma::mat dataset = arma::randu<arma::mat>(4, 3000);
+  const arma::mat queries = arma::randu<arma::mat>(4, 500);
+
+  #ifdef HAS_OPENMP
+    const size_t prevNumThreads = omp_get_max_threads();
+  #endif
+
+  arma::mat data[2];
+  arma::Col<size_t> oldFromNew[2];
+  double alpha[2];
+  size_t leaves[2];
+  arma::rowvec values[2];
+  for (size_t run = 0; run < 2; ++run)
+  {
+    #ifdef HAS_OPENMP
+      omp_set_num_threads(run == 0 ? 1 : 4);
+    #endif
+
+    data[run] = dataset;
+    oldFromNew[run].set_size(dataset.n_cols);
+    for (size_t i = 0; i < dataset.n_cols; ++i)
+      oldFromNew[run][i] = i;
+
+    DTree<arma::mat> tree(data[run]);
+    alpha[run] = tree.Grow(data[run], oldFromNew[run], false, 10, 5);
+    leaves[run] = tree.SubtreeLeaves();
+    tree.ComputeValues(queries, values[run]);
+  }
+
+  #ifdef HAS_OPENMP
+    omp_set_num_threads(prevNumThreads);
+  #endif
+
+  BOOST_REQUIRE_EQUAL(alpha[0], alpha[1]);
+  BOOST_REQUIRE_EQUAL(leaves[0], leaves[1]);
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+    BOOST_REQUIRE_EQUAL(oldFromNew[0][i], oldFromNew[1][i]);
+  for (size_t i = 0; i < data[0].n_elem; ++i)
+    BOOST_REQUIRE_EQUAL(data[0][i], data[1][i]);
+  for (size_t i = 0; i < queries.n_cols; ++i)
+    BOOST_REQUIRE_EQUAL(values[0][i], values[1][i]);
+}
+
 BOOST_AUTO_TEST_CASE(TestVariableImportance)
 {
   arma::mat testData(3, 5);
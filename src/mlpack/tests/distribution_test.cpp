@@ -6,6 +6,7 @@
  * Tests for the classes:
  *  * mlpack::distribution::DiscreteDistribution
  *  * mlpack::distribution::GaussianDistribution
+ *  * mlpack::distribution::DiagonalGaussianDistribution
  *  * mlpack::distribution::GammaDistribution
  *
  * mlpack is free software; you may redistribute it and/or modify it under the
@@ -580,6 +581,111 @@ BOOST_AUTO_TEST_CASE(GaussianDistributionTrainWithTwoDistProbabilitiesTest)
   BOOST_REQUIRE_CLOSE(guDist.Covariance()[0], cov1[0], 5);
 }
 
+/******************************************/
+/** Diagonal Gaussian Distribution Tests **/
+/******************************************/
+
+/**
+ * Make sure diagonal Gaussian distributions are initialized to the correct
+ * dimensionality.
+ */
+BOOST_AUTO_TEST_CASE(DiagonalGaussianDistributionDimensionalityConstructor)
+{
+  DiagonalGaussianDistribution d(4);
+
+  BOOST_REQUIRE_EQUAL(d.Mean().n_elem, 4);
+  BOOST_REQUIRE_EQUAL(d.Covariance().n_elem, 4);
+  BOOST_REQUIRE_EQUAL(d.Dimensionality(), 4);
+}
+
+/**
+ * Make sure the log probability of a diagonal Gaussian matches the log
+ * probability of a full Gaussian with the same diagonal covariance, for single
+ * points and for batches of points.
+ */
+BOOST_AUTO_TEST_CASE(DiagonalGaussianDistributionProbabilityTest)
+{
+  arma::vec mean("5 6 3 3 2");
+  arma::vec variances("6 7 4 7 6");
+
+  DiagonalGaussianDistribution d(mean, variances);
+  GaussianDistribution g(mean, arma::diagmat(variances));
+
+  arma::mat points = "0 3 2 2 3 4;"
+                     "1 2 2 1 0 0;"
+                     "2 3 0 5 5 6;"
+                     "3 7 8 0 1 1;"
+                     "4 8 1 1 0 0;";
+
+  arma::vec diagPhis, phis;
+  d.LogProbability(points, diagPhis);
+  g.LogProbability(points, phis);
+
+  BOOST_REQUIRE_EQUAL(diagPhis.n_elem, 6);
+  for (size_t i = 0; i < points.n_cols; ++i)
+  {
+    BOOST_REQUIRE_CLOSE(diagPhis[i], phis[i], 1e-5);
+    BOOST_REQUIRE_CLOSE(d.LogProbability(points.col(i)), phis[i], 1e-5);
+    BOOST_REQUIRE_CLOSE(d.Probability(points.col(i)),
+        g.Probability(points.col(i)), 1e-5);
+  }
+}
+
+/**
+ * Make sure random observations follow the diagonal Gaussian distribution.
+ */
+BOOST_AUTO_TEST_CASE(DiagonalGaussianDistributionRandomTest)
+{
+  arma::vec mean("1.0 2.25");
+  arma::vec variances("0.85 1.45");
+
+  DiagonalGaussianDistribution d(mean, variances);
+
+  arma::mat obs(2, 5000);
+  for (size_t i = 0; i < 5000; i++)
+    obs.col(i) = d.Random();
+
+  arma::vec obsMean = arma::mean(obs, 1);
+  arma::vec obsVar = arma::var(obs, 0, 1);
+
+  // 10% tolerance because this can be noisy.
+  BOOST_REQUIRE_CLOSE(obsMean[0], mean[0], 10.0);
+  BOOST_REQUIRE_CLOSE(obsMean[1], mean[1], 10.0);
+  BOOST_REQUIRE_CLOSE(obsVar[0], variances[0], 10.0);
+  BOOST_REQUIRE_CLOSE(obsVar[1], variances[1], 10.0);
+}
+
+/**
+ * Make sure that weighted training of a diagonal Gaussian gives the same mean
+ * and variances as the diagonal of a full Gaussian trained on the same data.
+ */
+BOOST_AUTO_TEST_CASE(DiagonalGaussianDistributionTrainWithProbabilitiesTest)
+{
+  arma::mat observations = arma::randn<arma::mat>(4, 1000);
+  observations.row(2) *= 3.0;
+  observations.row(3) += 2.0;
+  const arma::vec probabilities = arma::randu<arma::vec>(1000);
+
+  DiagonalGaussianDistribution d;
+  d.Train(observations, probabilities);
+
+  GaussianDistribution g;
+  g.Train(observations, probabilities);
+
+  BOOST_REQUIRE_EQUAL(d.Dimensionality(), 4);
+  for (size_t i = 0; i < 4; ++i)
+  {
+    BOOST_REQUIRE_CLOSE(d.Mean()[i], g.Mean()[i], 1e-5);
+    BOOST_REQUIRE_CLOSE(d.Covariance()[i], g.Covariance()(i, i), 1e-5);
+  }
+
+  // Unweighted training should give the sample variance.
+  d.Train(observations);
+  const arma::vec sampleVar = arma::var(observations, 0, 1);
+  for (size_t i = 0; i < 4; ++i)
+    BOOST_REQUIRE_CLOSE(d.Covariance()[i], sampleVar[i], 1e-5);
+}
+
 /******************************/
 /** Gamma Distribution Tests **/
 /******************************/
@@ -1082,4 +1082,112 @@ BOOST_AUTO_TEST_CASE(CopyAssignmentTest)
   }
 }
 
+/**
+ * Make sure that batch kernel evaluation gives the same results as evaluating
+ * the kernel one pair at a time.
+ */
+template<typename KernelType>
+void CheckBatchKernel(KernelType& kernel,
+                      const arma::mat& referenceData,
+                      const arma::mat& queryData)
+{
+  arma::mat kernels;
+  BatchKernel(kernel, referenceData, queryData, kernels);
+
+  BOOST_REQUIRE_EQUAL(kernels.n_rows, referenceData.n_cols);
+  BOOST_REQUIRE_EQUAL(kernels.n_cols, queryData.n_cols);
+  for (size_t q = 0; q < queryData.n_cols; ++q)
+  {
+    for (size_t r = 0; r < referenceData.n_cols; ++r)
+    {
+      const double eval = kernel.Evaluate(queryData.col(q),
+          referenceData.col(r));
+      if (std::abs(eval) < 1e-8)
+        BOOST_REQUIRE_SMALL(kernels(r, q), 1e-8);
+      else
+        BOOST_REQUIRE_CLOSE(kernels(r, q), eval, 1e-5);
+    }
+  }
+
+  arma::vec selfKernels;
+  SelfKernels(kernel, referenceData, selfKernels);
+
+  BOOST_REQUIRE_EQUAL(selfKernels.n_elem, referenceData.n_cols);
+  for (size_t i = 0; i < referenceData.n_cols; ++i)
+  {
+    BOOST_REQUIRE_CLOSE(selfKernels[i], kernel.Evaluate(referenceData.col(i),
+        referenceData.col(i)), 1e-5);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(BatchKernelTest)
+{
+  arma::mat referenceData = arma::randu<arma::mat>(10, 150);
+  arma::mat queryData = arma::randu<arma::mat>(10, 70);
+
+  LinearKernel lk;
+  CheckBatchKernel(lk, referenceData, queryData);
+  PolynomialKernel pk(3.0, 0.5);
+  CheckBatchKernel(pk, referenceData, queryData);
+  CosineDistance cd;
+  CheckBatchKernel(cd, referenceData, queryData);
+  GaussianKernel gk(0.8);
+  CheckBatchKernel(gk, referenceData, queryData);
+  EpanechnikovKernel ek(1.5);
+  CheckBatchKernel(ek, referenceData, queryData);
+  TriangularKernel tk(1.5);
+  CheckBatchKernel(tk, referenceData, queryData);
+  HyperbolicTangentKernel htk(0.3, 0.1);
+  CheckBatchKernel(htk, referenceData, queryData);
+}
+
+/**
+ * Make sure that naive and dual-tree search give the same results when they
+ * are run with several threads.
+ */
+BOOST_AUTO_TEST_CASE(ParallelDualTreeVsNaive)
+{
+  arma::mat referenceData;
+  referenceData.randn(5, 1500);
+  arma::mat queryData;
+  queryData.randn(5, 700);
+  PolynomialKernel pk(2.0, 1.0);
+
+  #ifdef HAS_OPENMP
+    const size_t prevNumThreads = omp_get_max_threads();
+    omp_set_num_threads(4);
+  #endif
+
+  FastMKS<PolynomialKernel> naive(referenceData, pk, false, true);
+  FastMKS<PolynomialKernel> tree(referenceData, pk);
+
+  for (size_t mono = 0; mono < 2; ++mono)
+  {
+    arma::Mat<size_t> naiveIndices, treeIndices;
+    arma::mat naiveKernels, treeKernels;
+    if (mono == 0)
+    {
+      naive.Search(queryData, 5, naiveIndices, naiveKernels);
+      tree.Search(queryData, 5, treeIndices, treeKernels);
+    }
+    else
+    {
+      naive.Search(5, naiveIndices, naiveKernels);
+      tree.Search(5, treeIndices, treeKernels);
+    }
+
+    BOOST_REQUIRE_EQUAL(treeIndices.n_rows, naiveIndices.n_rows);
+    BOOST_REQUIRE_EQUAL(treeIndices.n_cols, naiveIndices.n_cols);
+    for (size_t i = 0; i < treeIndices.n_elem; ++i)
+    {
+      BOOST_REQUIRE_EQUAL(treeIndices[i], naiveIndices[i]);
+      BOOST_REQUIRE_CLOSE(treeKernels[i], naiveKernels[i], 1e-5);
+    }
+  }
+
+  #ifdef HAS_OPENMP
+    omp_set_num_threads(prevNumThreads);
+  #endif
+}
+
 BOOST_AUTO_TEST_SUITE_END();
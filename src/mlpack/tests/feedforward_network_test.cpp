@@ -12,10 +12,14 @@
  */
 #include <mlpack/core.hpp>
 
+#include <mlpack/core/optimizers/adam/adam.hpp>
 #include <mlpack/core/optimizers/rmsprop/rmsprop.hpp>
+#include <mlpack/core/optimizers/sgd/sgd.hpp>
 #include <mlpack/core/optimizers/sgd/update_policies/vanilla_update.hpp>
 #include <mlpack/methods/ann/layer/layer.hpp>
 #include <mlpack/methods/ann/ffn.hpp>
+#include <mlpack/methods/ann/inference_ffn.hpp>
+#include <mlpack/methods/ann/static_ffn.hpp>
 
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
@@ -501,6 +505,355 @@ BOOST_AUTO_TEST_CASE(FFNMiscTest)
   movedModel = std::move(copiedModel);
 }
 
+/**
+ * Make sure that the layers of a copied network use the parameters of the
+ * copy.
+ */
+BOOST_AUTO_TEST_CASE(FFNCopyParametersTest)
+{
+  FFN<MeanSquaredError<> > model;
+  model.Add<Linear<> >(2, 3);
+  model.Add<SigmoidLayer<> >();
+  model.ResetParameters();
+
+  arma::mat input = arma::randu<arma::mat>(2, 5);
+  arma::mat output, copiedOutput;
+  model.Predict(input, output);
+
+  FFN<MeanSquaredError<> > copiedModel(model);
+  copiedModel.Predict(input, copiedOutput);
+  CheckMatrices(output, copiedOutput);
+
+  // Changing the parameters of the copy leaves the original network alone.
+  copiedModel.Parameters().zeros();
+  copiedModel.Predict(input, copiedOutput);
+  CheckMatrices(copiedOutput, arma::mat(3, 5).fill(0.5));
+
+  arma::mat originalOutput;
+  model.Predict(input, originalOutput);
+  CheckMatrices(output, originalOutput);
+
+  // The network has only 9 parameters, so Armadillo keeps them in the local
+  // memory of the matrix, which is copied by the swap of the assignment and by
+  // a move.
+  FFN<MeanSquaredError<> > assignedModel;
+  assignedModel.Add<Linear<> >(4, 4);
+  assignedModel = model;
+  arma::mat assignedOutput;
+  assignedModel.Predict(input, assignedOutput);
+  CheckMatrices(output, assignedOutput);
+
+  assignedModel.Parameters().zeros();
+  assignedModel.Predict(input, assignedOutput);
+  CheckMatrices(assignedOutput, arma::mat(3, 5).fill(0.5));
+
+  FFN<MeanSquaredError<> > movedModel(std::move(copiedModel));
+  movedModel.Parameters() = model.Parameters();
+  arma::mat movedOutput;
+  movedModel.Predict(input, movedOutput);
+  CheckMatrices(output, movedOutput);
+}
+
+/**
+ * Make sure that the sparse gradient of a network with a Lookup layer matches
+ * the dense gradient, and that LazyAdam leaves unused embeddings untouched.
+ */
+BOOST_AUTO_TEST_CASE(SparseGradientTest)
+{
+  // Only the first five of the ten tokens are used.
+  arma::mat predictors(1, 50), responses(1, 50);
+  for (size_t i = 0; i < predictors.n_cols; ++i)
+  {
+    predictors(i) = (i % 5) + 1;
+    responses(i) = (i % 5 < 2) ? 1 : 2;
+  }
+
+  FFN<NegativeLogLikelihood<> > model;
+  model.Add<Lookup<> >(10, 4);
+  model.Add<Linear<> >(4, 2);
+  model.Add<LogSoftMax<> >();
+
+  // A step size of zero only sets the data of the model.
+  StandardSGD sgd(0.0, 1, 1);
+  model.Train(predictors, responses, sgd);
+  const arma::mat parameters = model.Parameters();
+
+  // The embedding of token i is stored in the parameters [4 * (i - 1),
+  // 4 * i).
+  arma::mat denseGradient;
+  arma::sp_mat sparseGradient;
+  for (size_t begin = 0; begin < predictors.n_cols; begin += 10)
+  {
+    model.Gradient(model.Parameters(), begin, denseGradient, 10);
+    model.Gradient(model.Parameters(), begin, sparseGradient, 10);
+
+    CheckMatrices(denseGradient, arma::mat(sparseGradient));
+    for (arma::sp_mat::const_iterator it = sparseGradient.begin();
+         it != sparseGradient.end(); ++it)
+      BOOST_REQUIRE(it.row() < 20 || it.row() >= 40);
+  }
+
+  LazyAdam opt(0.01, 10, 0.9, 0.999, 1e-8, 500, -1);
+  model.Train(predictors, responses, opt);
+
+  CheckMatrices(model.Parameters().rows(20, 39), parameters.rows(20, 39));
+  BOOST_REQUIRE_GT(arma::accu(arma::abs(model.Parameters().rows(0, 19) -
+      parameters.rows(0, 19))), 0.0);
+}
+
+/**
+ * Make sure that training with several worker networks takes the same steps as
+ * training with a single network, for dense and sparse gradients, and that the
+ * trained network predicts in deterministic mode.
+ */
+BOOST_AUTO_TEST_CASE(DataParallelTrainingTest)
+{
+  arma::mat predictors = arma::randu<arma::mat>(5, 200);
+  arma::mat responses(1, 200);
+  for (size_t i = 0; i < predictors.n_cols; ++i)
+    responses(i) = (arma::accu(predictors.col(i)) > 2.5) ? 2 : 1;
+
+  arma::mat parameters[2], predictions[2];
+  for (size_t i = 0; i < 2; ++i)
+  {
+    FFN<NegativeLogLikelihood<> > model;
+    model.Add<Linear<> >(5, 8);
+    model.Add<SigmoidLayer<> >();
+    model.Add<Linear<> >(8, 2);
+    model.Add<LogSoftMax<> >();
+    model.Workers() = (i == 0) ? 1 : 4;
+
+    // Use the same initial parameters for both models.
+    math::RandomSeed(1);
+    StandardSGD sgd(0.01, 10, 400, -1, false);
+    model.Train(predictors, responses, sgd);
+    parameters[i] = model.Parameters();
+    model.Predict(predictors, predictions[i]);
+  }
+
+  CheckMatrices(parameters[0], parameters[1], 1e-5);
+  CheckMatrices(predictions[0], predictions[1], 1e-5);
+
+  // The sparse gradient of a Lookup layer is split across the workers too.
+  arma::mat tokens(1, 200);
+  for (size_t i = 0; i < tokens.n_cols; ++i)
+    tokens(i) = (i % 5) + 1;
+
+  for (size_t i = 0; i < 2; ++i)
+  {
+    FFN<NegativeLogLikelihood<> > model;
+    model.Add<Lookup<> >(10, 4);
+    model.Add<Linear<> >(4, 2);
+    model.Add<LogSoftMax<> >();
+    model.Workers() = (i == 0) ? 1 : 4;
+
+    math::RandomSeed(1);
+    LazyAdam opt(0.01, 10, 0.9, 0.999, 1e-8, 400, -1, false);
+    model.Train(tokens, responses, opt);
+    parameters[i] = model.Parameters();
+  }
+
+  CheckMatrices(parameters[0], parameters[1], 1e-5);
+
+  // The layers taken from the workers were trained in training mode; the
+  // predictions of the trained network must not use dropout.
+  FFN<NegativeLogLikelihood<> > model;
+  model.Add<Linear<> >(5, 8);
+  model.Add<Dropout<> >(0.5);
+  model.Add<Linear<> >(8, 2);
+  model.Add<LogSoftMax<> >();
+  model.Workers() = 4;
+
+  StandardSGD sgd(0.01, 10, 400, -1, false);
+  model.Train(predictors, responses, sgd);
+  model.Predict(predictors, predictions[0]);
+  model.Predict(predictors, predictions[1]);
+  CheckMatrices(predictions[0], predictions[1]);
+}
+
+/**
+ * Make sure that a StaticFFN with the parameters of an FFN with the same layers
+ * makes the same predictions and computes the same gradient.
+ */
+BOOST_AUTO_TEST_CASE(StaticFFNTest)
+{
+  arma::mat predictors = arma::randu<arma::mat>(5, 50);
+  arma::mat responses(1, 50);
+  for (size_t i = 0; i < predictors.n_cols; ++i)
+    responses(i) = (arma::accu(predictors.col(i)) > 2.5) ? 2 : 1;
+
+  FFN<NegativeLogLikelihood<> > model;
+  model.Add<Linear<> >(5, 8);
+  model.Add<SigmoidLayer<> >();
+  model.Add<Linear<> >(8, 2);
+  model.Add<LogSoftMax<> >();
+
+  StaticFFN<NegativeLogLikelihood<>, RandomInitialization, Linear<>,
+      SigmoidLayer<>, Linear<>, LogSoftMax<> > staticModel(Linear<>(5, 8),
+      SigmoidLayer<>(), Linear<>(8, 2), LogSoftMax<>());
+
+  // A step size of zero only sets the data of the models; the data is not
+  // shuffled, so both models see the same batches.
+  StandardSGD sgd(0.0, 1, 1, -1, false);
+  model.Train(predictors, responses, sgd);
+  staticModel.Parameters() = model.Parameters();
+  staticModel.Train(predictors, responses, sgd);
+
+  arma::mat predictions, staticPredictions;
+  model.Predict(predictors, predictions);
+  staticModel.Predict(predictors, staticPredictions);
+  CheckMatrices(predictions, staticPredictions);
+
+  arma::mat gradient, staticGradient;
+  model.Gradient(model.Parameters(), 10, gradient, 20);
+  staticModel.Gradient(staticModel.Parameters(), 10, staticGradient, 20);
+  CheckMatrices(gradient, staticGradient);
+
+  // Parameters that do not fit the layers are rejected.
+  staticModel.Parameters() = arma::zeros<arma::mat>(10, 1);
+  BOOST_REQUIRE_THROW(staticModel.Predict(predictors, staticPredictions),
+      std::invalid_argument);
+
+  // The size is also checked once the layers are bound to the parameters.
+  staticModel.Parameters() = model.Parameters();
+  staticModel.Predict(predictors, staticPredictions);
+  CheckMatrices(predictions, staticPredictions);
+  staticModel.Parameters().resize(model.Parameters().n_elem - 1, 1);
+  BOOST_REQUIRE_THROW(staticModel.Predict(predictors, staticPredictions),
+      std::invalid_argument);
+}
+
+/**
+ * Make sure that a single-precision StaticFFN computes the gradient of the
+ * double-precision network with the same parameters.
+ */
+BOOST_AUTO_TEST_CASE(SinglePrecisionStaticFFNTest)
+{
+  arma::mat predictors = arma::randu<arma::mat>(5, 50);
+  arma::mat responses(1, 50);
+  for (size_t i = 0; i < predictors.n_cols; ++i)
+    responses(i) = (arma::accu(predictors.col(i)) > 2.5) ? 2 : 1;
+
+  StaticFFN<NegativeLogLikelihood<>, RandomInitialization, Linear<>,
+      SigmoidLayer<>, Linear<>, LogSoftMax<> > model(Linear<>(5, 8),
+      SigmoidLayer<>(), Linear<>(8, 2), LogSoftMax<>());
+
+  StaticFFN<NegativeLogLikelihood<arma::fmat, arma::fmat>,
+      RandomInitialization, Linear<arma::fmat, arma::fmat>,
+      SigmoidLayer<LogisticFunction, arma::fmat, arma::fmat>,
+      Linear<arma::fmat, arma::fmat>, LogSoftMax<arma::fmat, arma::fmat> >
+      floatModel(Linear<arma::fmat, arma::fmat>(5, 8),
+      SigmoidLayer<LogisticFunction, arma::fmat, arma::fmat>(),
+      Linear<arma::fmat, arma::fmat>(8, 2),
+      LogSoftMax<arma::fmat, arma::fmat>());
+
+  StandardSGD sgd(0.0, 1, 1, -1, false);
+  model.Train(predictors, responses, sgd);
+  floatModel.Parameters() = model.Parameters();
+  floatModel.Train(arma::conv_to<arma::fmat>::from(predictors),
+      arma::conv_to<arma::fmat>::from(responses), sgd);
+
+  // The optimizer sees double-precision parameters and gradients.
+  arma::mat gradient, floatGradient;
+  model.Gradient(model.Parameters(), 0, gradient, 50);
+  floatModel.Gradient(floatModel.Parameters(), 0, floatGradient, 50);
+  CheckMatrices(gradient, floatGradient, 1e-1);
+
+  // Training in single precision updates the double-precision parameters.
+  StandardSGD trainSgd(0.01, 10, 200, -1);
+  floatModel.Train(arma::conv_to<arma::fmat>::from(predictors),
+      arma::conv_to<arma::fmat>::from(responses), trainSgd);
+  BOOST_REQUIRE_GT(arma::accu(arma::abs(floatModel.Parameters() -
+      model.Parameters())), 0.0);
+}
+
+/**
+ * Make sure that a serialized StaticFFN makes the same predictions.
+ */
+BOOST_AUTO_TEST_CASE(StaticFFNSerializationTest)
+{
+  arma::mat predictors = arma::randu<arma::mat>(5, 50);
+  arma::mat responses(1, 50);
+  for (size_t i = 0; i < predictors.n_cols; ++i)
+    responses(i) = (arma::accu(predictors.col(i)) > 2.5) ? 2 : 1;
+
+  typedef StaticFFN<NegativeLogLikelihood<>, RandomInitialization, Linear<>,
+      ReLULayer<>, Dropout<>, Linear<>, LogSoftMax<> > NetworkType;
+
+  NetworkType model(Linear<>(5, 8), ReLULayer<>(), Dropout<>(),
+      Linear<>(8, 2), LogSoftMax<>());
+  NetworkType xmlModel(Linear<>(5, 8), ReLULayer<>(), Dropout<>(),
+      Linear<>(8, 2), LogSoftMax<>());
+  NetworkType textModel(xmlModel), binaryModel(xmlModel);
+
+  StandardSGD sgd(0.01, 10, 500, -1);
+  model.Train(predictors, responses, sgd);
+
+  // Serialize into other models.
+  SerializeObjectAll(model, xmlModel, textModel, binaryModel);
+
+  arma::mat predictions, xmlPredictions, textPredictions, binaryPredictions;
+  model.Predict(predictors, predictions);
+  xmlModel.Predict(predictors, xmlPredictions);
+  textModel.Predict(predictors, textPredictions);
+  binaryModel.Predict(predictors, binaryPredictions);
+
+  CheckMatrices(predictions, xmlPredictions, textPredictions,
+      binaryPredictions);
+}
+
+/**
+ * Make sure that an exported InferenceFFN folds the layers and makes the same
+ * predictions as the trained network, also after serialization.
+ */
+BOOST_AUTO_TEST_CASE(InferenceFFNTest)
+{
+  arma::mat predictors = arma::randu<arma::mat>(5, 100);
+  arma::mat responses(1, 100);
+  for (size_t i = 0; i < predictors.n_cols; ++i)
+    responses(i) = (arma::accu(predictors.col(i)) > 2.5) ? 2 : 1;
+
+  FFN<NegativeLogLikelihood<> > model;
+  model.Add<MultiplyConstant<> >(2.0);
+  model.Add<Linear<> >(5, 8);
+  model.Add<MultiplyConstant<> >(0.5);
+  model.Add<SigmoidLayer<> >();
+  model.Add<Dropout<> >();
+  model.Add<Linear<> >(8, 2);
+  model.Add<LogSoftMax<> >();
+
+  StandardSGD sgd(0.01, 10, 500, -1);
+  model.Train(predictors, responses, sgd);
+
+  // The scales are folded into the Linear layers, and the activations into
+  // the Linear layers in front of them.
+  InferenceFFN inferenceModel(model);
+  BOOST_REQUIRE_EQUAL(inferenceModel.NumLayers(), 2);
+
+  arma::mat predictions, inferencePredictions;
+  model.Predict(predictors, predictions);
+  inferenceModel.Predict(predictors, inferencePredictions);
+  CheckMatrices(predictions, inferencePredictions);
+
+  InferenceFFN xmlModel, textModel, binaryModel;
+  SerializeObjectAll(inferenceModel, xmlModel, textModel, binaryModel);
+
+  arma::mat xmlPredictions, textPredictions, binaryPredictions;
+  xmlModel.Predict(predictors, xmlPredictions);
+  textModel.Predict(predictors, textPredictions);
+  binaryModel.Predict(predictors, binaryPredictions);
+  CheckMatrices(predictions, xmlPredictions, textPredictions,
+      binaryPredictions);
+
+  // Layers that can't be folded are rejected.
+  FFN<NegativeLogLikelihood<> > unsupportedModel;
+  unsupportedModel.Add<Linear<> >(5, 2);
+  unsupportedModel.Add<PReLU<> >();
+  unsupportedModel.ResetParameters();
+  BOOST_REQUIRE_THROW(InferenceFFN(unsupportedModel).NumLayers(),
+      std::invalid_argument);
+}
+
 /**
  * Test that serialization works ok.
  */
@@ -567,4 +920,141 @@ BOOST_AUTO_TEST_CASE(SerializationTest)
       binaryPredictions);
 }
 
+/**
+ * The layer types of the variant before the FastGRU and FastPeepholeLSTM layers
+ * were added.  A layer is stored by its index in the variant, so this list
+ * fixes the indices that models saved by earlier versions refer to.
+ */
+using BaselineLayerTypes = boost::variant<
+    Add<arma::mat, arma::mat>*,
+    AddMerge<arma::mat, arma::mat>*,
+    BaseLayer<LogisticFunction, arma::mat, arma::mat>*,
+    BaseLayer<IdentityFunction, arma::mat, arma::mat>*,
+    BaseLayer<TanhFunction, arma::mat, arma::mat>*,
+    BaseLayer<RectifierFunction, arma::mat, arma::mat>*,
+    Concat<arma::mat, arma::mat>*,
+    ConcatPerformance<NegativeLogLikelihood<arma::mat, arma::mat>,
+                      arma::mat, arma::mat>*,
+    Constant<arma::mat, arma::mat>*,
+    Convolution<NaiveConvolution<ValidConvolution>,
+                NaiveConvolution<FullConvolution>,
+                NaiveConvolution<ValidConvolution>, arma::mat, arma::mat>*,
+    CrossEntropyError<arma::mat, arma::mat>*,
+    DropConnect<arma::mat, arma::mat>*,
+    Dropout<arma::mat, arma::mat>*,
+    ELU<arma::mat, arma::mat>*,
+    Glimpse<arma::mat, arma::mat>*,
+    HardTanH<arma::mat, arma::mat>*,
+    Join<arma::mat, arma::mat>*,
+    LeakyReLU<arma::mat, arma::mat>*,
+    Linear<arma::mat, arma::mat>*,
+    LinearNoBias<arma::mat, arma::mat>*,
+    LogSoftMax<arma::mat, arma::mat>*,
+    Lookup<arma::mat, arma::mat>*,
+    LSTM<arma::mat, arma::mat>*,
+    GRU<arma::mat, arma::mat>*,
+    FastLSTM<arma::mat, arma::mat>*,
+    MaxPooling<arma::mat, arma::mat>*,
+    MeanPooling<arma::mat, arma::mat>*,
+    MeanSquaredError<arma::mat, arma::mat>*,
+    MultiplyConstant<arma::mat, arma::mat>*,
+    NegativeLogLikelihood<arma::mat, arma::mat>*,
+    PReLU<arma::mat, arma::mat>*,
+    Recurrent<arma::mat, arma::mat>*,
+    RecurrentAttention<arma::mat, arma::mat>*,
+    ReinforceNormal<arma::mat, arma::mat>*,
+    Select<arma::mat, arma::mat>*,
+    Sequential<arma::mat, arma::mat>*,
+    VRClassReward<arma::mat, arma::mat>*
+>;
+
+/**
+ * A stand-in for an FFN saved by an earlier version: it writes the same archive
+ * as FFN::serialize(), but with the earlier layer types.
+ */
+struct BaselineFFN
+{
+  ~BaselineFFN()
+  {
+    std::for_each(network.begin(), network.end(),
+        boost::apply_visitor(DeleteVisitor()));
+  }
+
+  template<typename Archive>
+  void serialize(Archive& ar, const unsigned int /* version */)
+  {
+    ar & BOOST_SERIALIZATION_NVP(parameter);
+    ar & BOOST_SERIALIZATION_NVP(width);
+    ar & BOOST_SERIALIZATION_NVP(height);
+    ar & BOOST_SERIALIZATION_NVP(currentInput);
+    ar & BOOST_SERIALIZATION_NVP(network);
+  }
+
+  arma::mat parameter;
+  size_t width;
+  size_t height;
+  arma::mat currentInput;
+  std::vector<BaselineLayerTypes> network;
+};
+
+/**
+ * Save the given stand-in model with the given archive type, and load it into
+ * an FFN.
+ */
+template<typename IArchiveType, typename OArchiveType, typename ModelType>
+void LoadBaselineModel(BaselineFFN& baseline, ModelType& model)
+{
+  std::stringstream stream;
+  {
+    OArchiveType o(stream);
+    o << boost::serialization::make_nvp("model", baseline);
+  }
+
+  IArchiveType i(stream);
+  i >> boost::serialization::make_nvp("model", model);
+}
+
+/**
+ * A model saved before the FastGRU and FastPeepholeLSTM layers were added,
+ * with layers that come after FastLSTM in the variant, should still load as
+ * the same network.
+ */
+BOOST_AUTO_TEST_CASE(LoadBaselineLayerTypesTest)
+{
+  FFN<MeanSquaredError<> > model;
+  model.Add<Linear<> >(4, 3);
+  model.Add<PReLU<> >();
+  model.Add<MultiplyConstant<> >(2.0);
+  model.Add<Linear<> >(3, 2);
+
+  arma::mat input = arma::randu<arma::mat>(4, 10);
+  arma::mat predictions;
+  model.Predict(input, predictions);
+
+  BaselineFFN baseline;
+  baseline.parameter = model.Parameters();
+  baseline.width = 0;
+  baseline.height = 0;
+  baseline.network.push_back(new Linear<>(4, 3));
+  baseline.network.push_back(new PReLU<>());
+  baseline.network.push_back(new MultiplyConstant<>(2.0));
+  baseline.network.push_back(new Linear<>(3, 2));
+
+  FFN<MeanSquaredError<> > xmlModel, textModel, binaryModel;
+  LoadBaselineModel<boost::archive::xml_iarchive,
+      boost::archive::xml_oarchive>(baseline, xmlModel);
+  LoadBaselineModel<boost::archive::text_iarchive,
+      boost::archive::text_oarchive>(baseline, textModel);
+  LoadBaselineModel<boost::archive::binary_iarchive,
+      boost::archive::binary_oarchive>(baseline, binaryModel);
+
+  arma::mat xmlPredictions, textPredictions, binaryPredictions;
+  xmlModel.Predict(input, xmlPredictions);
+  textModel.Predict(input, textPredictions);
+  binaryModel.Predict(input, binaryPredictions);
+
+  CheckMatrices(predictions, xmlPredictions, textPredictions,
+      binaryPredictions);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
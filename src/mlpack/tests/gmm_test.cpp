@@ -13,6 +13,7 @@
 #include <mlpack/core.hpp>
 
 #include <mlpack/methods/gmm/gmm.hpp>
+#include <mlpack/methods/gmm/diagonal_gmm.hpp>
 
 #include <mlpack/methods/gmm/no_constraint.hpp>
 #include <mlpack/methods/gmm/positive_definite_constraint.hpp>
@@ -21,6 +22,7 @@
 
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
+#include "serialization.hpp"
 
 using namespace mlpack;
 using namespace mlpack::gmm;
@@ -857,4 +859,187 @@ BOOST_AUTO_TEST_CASE(DiagonalGMMTrainTest)
   }
 }
 
+/**
+ * Make sure a DiagonalGMM (with DiagonalGaussianDistribution components) can
+ * recover a mixture of diagonal Gaussians.
+ */
+BOOST_AUTO_TEST_CASE(DiagonalGaussianGMMTrainTest)
+{
+  distribution::DiagonalGaussianDistribution d1("0.0 1.0 0.0",
+      "1.0 0.8 1.0");
+  distribution::DiagonalGaussianDistribution d2("2.0 -1.0 5.0",
+      "3.0 1.2 1.3");
+  distribution::DiagonalGaussianDistribution d3("0.0 5.0 -3.0",
+      "2.0 0.3 1.0");
+
+  arma::mat points(3, 5000);
+  for (size_t i = 0; i < 5000; i++)
+  {
+    double randValue = math::Random();
+
+    if (randValue <= 0.20) // p(d1) = 0.20
+      points.col(i) = d1.Random();
+    else if (randValue <= 0.50) // p(d2) = 0.30
+      points.col(i) = d2.Random();
+    else // p(d3) = 0.50
+      points.col(i) = d3.Random();
+  }
+
+  // Now train the model.  3 dimensions, 3 components.
+  DiagonalGMM g(3, 3);
+  g.Train(points, 5);
+
+  arma::uvec sortedIndices = sort_index(g.Weights());
+
+  const distribution::DiagonalGaussianDistribution* trueDists[3] =
+      { &d1, &d2, &d3 };
+  const double trueWeights[3] = { 0.2, 0.3, 0.5 };
+  for (size_t k = 0; k < 3; ++k)
+  {
+    const distribution::DiagonalGaussianDistribution& est =
+        g.Component(sortedIndices[k]);
+
+    BOOST_REQUIRE_SMALL(g.Weights()[sortedIndices[k]] - trueWeights[k], 0.1);
+    BOOST_REQUIRE_EQUAL(est.Covariance().n_elem, 3);
+
+    for (size_t i = 0; i < 3; i++)
+    {
+      BOOST_REQUIRE_SMALL(est.Mean()[i] - trueDists[k]->Mean()[i], 0.4);
+      BOOST_REQUIRE_SMALL(est.Covariance()[i] -
+          trueDists[k]->Covariance()[i], 0.5);
+    }
+  }
+
+  // The batch probabilities must agree with the single-point probabilities,
+  // and classification must pick the most likely component.
+  arma::vec probabilities;
+  g.Probability(points, probabilities);
+  arma::Row<size_t> labels;
+  g.Classify(points, labels);
+  for (size_t i = 0; i < 50; ++i)
+  {
+    BOOST_REQUIRE_CLOSE(probabilities[i], g.Probability(points.col(i)), 1e-5);
+    for (size_t k = 0; k < 3; ++k)
+    {
+      BOOST_REQUIRE_LE(g.Probability(points.col(i), k),
+          g.Probability(points.col(i), labels[i]) * (1 + 1e-10));
+    }
+  }
+}
+
+/**
+ * Make sure that EM with diagonal Gaussians gives the same model as EM with
+ * full Gaussians that are constrained to be diagonal, when started from the
+ * same initial model.
+ */
+BOOST_AUTO_TEST_CASE(DiagonalGaussianEMFitMatchesConstrainedEMFitTest)
+{
+  arma::mat points = arma::randn<arma::mat>(4, 500);
+  points.cols(250, 499).each_col() += arma::vec("3.0 -2.0 1.0 4.0");
+
+  // Initial models.
+  GMM full(2, 4);
+  DiagonalGMM diag(2, 4);
+  for (size_t i = 0; i < 2; ++i)
+  {
+    full.Component(i).Mean() = points.col(i * 250);
+    diag.Component(i).Mean() = points.col(i * 250);
+  }
+
+  typedef kmeans::KMeans<> KMeansType;
+  EMFit<KMeansType, PositiveDefiniteConstraint> fullFitter(30, 1e-10);
+  EMFit<KMeansType, PositiveDefiniteConstraint,
+      distribution::DiagonalGaussianDistribution> diagFitter(30, 1e-10);
+
+  // Run one EM step at a time, and project the full covariances back onto the
+  // diagonal after each step.
+  fullFitter.MaxIterations() = 2;
+  diagFitter.MaxIterations() = 2;
+  for (size_t iter = 0; iter < 10; ++iter)
+  {
+    full.Train(points, 1, true, fullFitter);
+    diag.Train(points, 1, true, diagFitter);
+
+    for (size_t i = 0; i < 2; ++i)
+    {
+      arma::mat c = arma::diagmat(full.Component(i).Covariance());
+      full.Component(i).Covariance(std::move(c));
+    }
+  }
+
+  for (size_t i = 0; i < 2; ++i)
+  {
+    BOOST_REQUIRE_CLOSE(full.Weights()[i], diag.Weights()[i], 1e-3);
+    for (size_t j = 0; j < 4; ++j)
+    {
+      BOOST_REQUIRE_CLOSE(full.Component(i).Mean()[j],
+          diag.Component(i).Mean()[j], 1e-3);
+    }
+  }
+}
+
+/**
+ * Make sure EM works for high-dimensional data, where the density of every
+ * point underflows to 0 outside of log space.
+ */
+BOOST_AUTO_TEST_CASE(DiagonalGMMHighDimensionalTrainTest)
+{
+  // With 500 dimensions and a variance of 4 the log-density of a point is
+  // about -1000.
+  const size_t dims = 500;
+  arma::mat points = 2.0 * arma::randn<arma::mat>(dims, 1000);
+  points.cols(500, 999) += 3.0;
+
+  arma::vec logProbabilities;
+  distribution::DiagonalGaussianDistribution(arma::zeros<arma::vec>(dims),
+      4.0 * arma::ones<arma::vec>(dims)).LogProbability(points,
+      logProbabilities);
+  BOOST_REQUIRE_LT(logProbabilities.max(), -700.0);
+
+  DiagonalGMM g(2, dims);
+  const double logLikelihood = g.Train(points, 1);
+  BOOST_REQUIRE(std::isfinite(logLikelihood));
+
+  const size_t first = (arma::mean(g.Component(0).Mean()) < 1.5) ? 0 : 1;
+  const size_t second = 1 - first;
+  BOOST_REQUIRE_CLOSE(g.Weights()[first], 0.5, 1.0);
+  BOOST_REQUIRE_CLOSE(g.Weights()[second], 0.5, 1.0);
+  BOOST_REQUIRE_SMALL(arma::mean(g.Component(first).Mean()), 0.1);
+  BOOST_REQUIRE_CLOSE(arma::mean(g.Component(second).Mean()), 3.0, 3.0);
+  BOOST_REQUIRE_CLOSE(arma::mean(g.Component(first).Covariance()), 4.0, 5.0);
+  BOOST_REQUIRE_CLOSE(arma::mean(g.Component(second).Covariance()), 4.0,
+      5.0);
+
+  // The EM fit must agree with the log-likelihood of the trained model.
+  arma::vec pointLogLikelihoods;
+  g.LogProbability(points, pointLogLikelihoods);
+  BOOST_REQUIRE(pointLogLikelihoods.is_finite());
+  BOOST_REQUIRE_CLOSE(arma::accu(pointLogLikelihoods), logLikelihood, 1e-5);
+}
+
+/**
+ * Make sure a DiagonalGMM can be saved and loaded.
+ */
+BOOST_AUTO_TEST_CASE(DiagonalGMMLoadSaveTest)
+{
+  DiagonalGMM gmm(5, 4);
+  gmm.Weights().randu();
+  gmm.Weights() /= arma::accu(gmm.Weights());
+
+  for (size_t i = 0; i < gmm.Gaussians(); ++i)
+  {
+    gmm.Component(i).Mean().randu();
+    gmm.Component(i).Covariance(arma::randu<arma::vec>(4) + 0.5);
+  }
+
+  DiagonalGMM xmlGmm, textGmm, binaryGmm;
+  SerializeObjectAll(gmm, xmlGmm, textGmm, binaryGmm);
+
+  arma::vec point = arma::randu<arma::vec>(4);
+  const double p = gmm.Probability(point);
+  BOOST_REQUIRE_CLOSE(xmlGmm.Probability(point), p, 1e-5);
+  BOOST_REQUIRE_CLOSE(textGmm.Probability(point), p, 1e-5);
+  BOOST_REQUIRE_CLOSE(binaryGmm.Probability(point), p, 1e-5);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -11,6 +11,7 @@
 #include <mlpack/core.hpp>
 #include <mlpack/methods/hmm/hmm.hpp>
 #include <mlpack/methods/gmm/gmm.hpp>
+#include <mlpack/methods/gmm/diagonal_gmm.hpp>
 
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
@@ -536,6 +537,99 @@ BOOST_AUTO_TEST_CASE(DiscreteHMMLogLikelihoodTest)
       -24.51556128368, 1e-5);
 }
 
+/**
+ * Make sure that the batch versions of Predict() and LogLikelihood() give the
+ * same results as calling the single-sequence versions one at a time.
+ */
+BOOST_AUTO_TEST_CASE(DiscreteHMMBatchPredictTest)
+{
+  arma::vec initial("0.5 0.2 0.3");
+  arma::mat transition("0.5 0.0 0.1;"
+                       "0.2 0.6 0.2;"
+                       "0.3 0.4 0.7");
+  std::vector<DiscreteDistribution> emission(3);
+  emission[0].Probabilities() = "0.75 0.25 0.00 0.00";
+  emission[1].Probabilities() = "0.00 0.25 0.25 0.50";
+  emission[2].Probabilities() = "0.10 0.40 0.40 0.10";
+
+  HMM<DiscreteDistribution> hmm(initial, transition, emission);
+
+  std::vector<arma::mat> sequences(20);
+  std::vector<arma::Row<size_t> > unusedStates(20);
+  for (size_t i = 0; i < sequences.size(); ++i)
+    hmm.Generate(5 + 3 * i, sequences[i], unusedStates[i]);
+
+  std::vector<arma::Row<size_t> > batchStates;
+  arma::vec batchPredictLikelihoods;
+  hmm.Predict(sequences, batchStates, batchPredictLikelihoods);
+
+  arma::vec batchLikelihoods;
+  hmm.LogLikelihood(sequences, batchLikelihoods);
+
+  BOOST_REQUIRE_EQUAL(batchStates.size(), sequences.size());
+  BOOST_REQUIRE_EQUAL(batchPredictLikelihoods.n_elem, sequences.size());
+  BOOST_REQUIRE_EQUAL(batchLikelihoods.n_elem, sequences.size());
+  for (size_t i = 0; i < sequences.size(); ++i)
+  {
+    arma::Row<size_t> states;
+    const double predictLikelihood = hmm.Predict(sequences[i], states);
+
+    BOOST_REQUIRE_EQUAL(batchStates[i].n_elem, states.n_elem);
+    for (size_t t = 0; t < states.n_elem; ++t)
+      BOOST_REQUIRE_EQUAL(batchStates[i][t], states[t]);
+
+    BOOST_REQUIRE_CLOSE(batchPredictLikelihoods[i], predictLikelihood, 1e-5);
+    BOOST_REQUIRE_CLOSE(batchLikelihoods[i], hmm.LogLikelihood(sequences[i]),
+        1e-5);
+  }
+}
+
+/**
+ * Make sure that the log-likelihood of a sequence of high-dimensional
+ * observations does not underflow, even though the probability of each
+ * individual observation is far too small to represent.
+ */
+BOOST_AUTO_TEST_CASE(GaussianHMMHighDimensionalLogLikelihoodTest)
+{
+  const size_t dimensionality = 1000;
+  GaussianDistribution g1(arma::vec(dimensionality, arma::fill::zeros),
+      arma::eye<arma::mat>(dimensionality, dimensionality));
+  GaussianDistribution g2(arma::vec(dimensionality, arma::fill::ones),
+      arma::eye<arma::mat>(dimensionality, dimensionality));
+
+  arma::vec initial("0.5 0.5");
+  arma::mat transition("0.9 0.1; 0.1 0.9");
+  std::vector<GaussianDistribution> emission;
+  emission.push_back(g1);
+  emission.push_back(g2);
+
+  HMM<GaussianDistribution> hmm(initial, transition, emission);
+
+  arma::mat observations;
+  arma::Row<size_t> states;
+  hmm.Generate(10, observations, states);
+
+  // Each observation has a log-probability of roughly -1400, so the
+  // log-likelihood of the sequence must be computed without leaving log space.
+  const double logLikelihood = hmm.LogLikelihood(observations);
+  BOOST_REQUIRE(std::isfinite(logLikelihood));
+  BOOST_REQUIRE_LT(logLikelihood, -10000.0);
+
+  // The state probabilities from the forward-backward algorithm should still
+  // be valid, and the log-likelihood should match.
+  arma::mat stateProb;
+  BOOST_REQUIRE_CLOSE(hmm.Estimate(observations, stateProb), logLikelihood,
+      1e-5);
+  for (size_t t = 0; t < observations.n_cols; ++t)
+    BOOST_REQUIRE_CLOSE(arma::accu(stateProb.col(t)), 1.0, 1e-5);
+
+  // The Viterbi path should follow the generating states.
+  arma::Row<size_t> predictedStates;
+  hmm.Predict(observations, predictedStates);
+  for (size_t t = 0; t < observations.n_cols; ++t)
+    BOOST_REQUIRE_EQUAL(predictedStates[t], states[t]);
+}
+
 /**
  * A simple test to make sure HMMs with Gaussian output distributions work.
  */
@@ -997,6 +1091,112 @@ BOOST_AUTO_TEST_CASE(GMMHMMLabeledTrainingTest)
       Covariance()(1, 1) - gmms[1].Component(1).Covariance()(1, 1), 0.3);
 }
 
+/**
+ * Make sure that an HMM with diagonal Gaussian emissions can be trained with
+ * labeled data, and that it recovers the hidden states afterwards.
+ */
+BOOST_AUTO_TEST_CASE(DiagonalGaussianHMMLabeledTrainTest)
+{
+  std::vector<DiagonalGaussianDistribution> emissions(2);
+  emissions[0] = DiagonalGaussianDistribution("0.0 0.0 0.0", "1.0 0.5 2.0");
+  emissions[1] = DiagonalGaussianDistribution("6.0 -4.0 5.0", "0.5 1.5 1.0");
+
+  arma::mat transMat("0.70 0.20;"
+                     "0.30 0.80");
+
+  HMM<DiagonalGaussianDistribution> trueHMM(arma::vec("1.0 0.0"), transMat,
+      emissions);
+
+  std::vector<arma::mat> observations(5);
+  std::vector<arma::Row<size_t>> states(5);
+  for (size_t i = 0; i < 5; ++i)
+    trueHMM.Generate(2000, observations[i], states[i]);
+
+  HMM<DiagonalGaussianDistribution> hmm(2, DiagonalGaussianDistribution(3));
+  hmm.Train(observations, states);
+
+  for (size_t i = 0; i < 2; ++i)
+  {
+    for (size_t j = 0; j < 2; ++j)
+      BOOST_REQUIRE_SMALL(hmm.Transition()(i, j) - transMat(i, j), 0.03);
+
+    for (size_t j = 0; j < 3; ++j)
+    {
+      BOOST_REQUIRE_SMALL(hmm.Emission()[i].Mean()[j] -
+          emissions[i].Mean()[j], 0.15);
+      BOOST_REQUIRE_SMALL(hmm.Emission()[i].Covariance()[j] -
+          emissions[i].Covariance()[j], 0.2);
+    }
+  }
+
+  // The states are well-separated, so Viterbi should recover nearly all of
+  // them.
+  arma::Row<size_t> predictedStates;
+  hmm.Predict(observations[0], predictedStates);
+  const size_t correct = arma::accu(predictedStates == states[0]);
+  BOOST_REQUIRE_GE(correct, 1980);
+}
+
+/**
+ * Make sure that an HMM with diagonal GMM emissions can be trained with labeled
+ * data.
+ */
+BOOST_AUTO_TEST_CASE(DiagonalGMMHMMLabeledTrainTest)
+{
+  std::vector<DiagonalGMM> gmms(2, DiagonalGMM(2, 2));
+  gmms[0].Weights() = arma::vec("0.3 0.7");
+  gmms[0].Component(0) = DiagonalGaussianDistribution("4.25 3.10",
+      "1.00 0.89");
+  gmms[0].Component(1) = DiagonalGaussianDistribution("7.10 5.01",
+      "1.00 1.01");
+
+  gmms[1].Weights() = arma::vec("0.20 0.80");
+  gmms[1].Component(0) = DiagonalGaussianDistribution("-3.00 -6.12",
+      "1.00 1.00");
+  gmms[1].Component(1) = DiagonalGaussianDistribution("-4.25 -2.12",
+      "1.50 1.20");
+
+  arma::mat transMat("0.40 0.60;"
+                     "0.60 0.40");
+
+  HMM<DiagonalGMM> trueHMM(arma::vec("1.0 0.0"), transMat, gmms);
+
+  std::vector<arma::mat> observations(5);
+  std::vector<arma::Row<size_t>> states(5);
+  for (size_t i = 0; i < 5; ++i)
+    trueHMM.Generate(2500, observations[i], states[i]);
+
+  HMM<DiagonalGMM> hmm(2, DiagonalGMM(2, 2));
+  hmm.Train(observations, states);
+
+  BOOST_REQUIRE_CLOSE(hmm.Initial()[0], 1.0, 0.01);
+  BOOST_REQUIRE_SMALL(hmm.Initial()[1], 0.01);
+
+  for (size_t i = 0; i < 2; ++i)
+  {
+    for (size_t j = 0; j < 2; ++j)
+      BOOST_REQUIRE_SMALL(hmm.Transition()(i, j) - transMat(i, j), 0.03);
+
+    // We have to sort each GMM for comparison.
+    arma::uvec sortedIndices = sort_index(hmm.Emission()[i].Weights());
+    for (size_t c = 0; c < 2; ++c)
+    {
+      const DiagonalGaussianDistribution& est =
+          hmm.Emission()[i].Component(sortedIndices[c]);
+
+      BOOST_REQUIRE_SMALL(hmm.Emission()[i].Weights()[sortedIndices[c]] -
+          gmms[i].Weights()[c], 0.08);
+      for (size_t j = 0; j < 2; ++j)
+      {
+        BOOST_REQUIRE_SMALL(est.Mean()[j] - gmms[i].Component(c).Mean()[j],
+            0.15);
+        BOOST_REQUIRE_SMALL(est.Covariance()[j] -
+            gmms[i].Component(c).Covariance()[j], 0.3);
+      }
+    }
+  }
+}
+
 /**
  * Test saving and loading of GMM HMMs
  */
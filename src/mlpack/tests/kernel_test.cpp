@@ -19,6 +19,7 @@
 #include <mlpack/core/kernels/polynomial_kernel.hpp>
 #include <mlpack/core/kernels/spherical_kernel.hpp>
 #include <mlpack/core/kernels/pspectrum_string_kernel.hpp>
+#include <mlpack/core/metrics/ip_metric.hpp>
 #include <mlpack/core/metrics/lmetric.hpp>
 #include <mlpack/core/metrics/mahalanobis_distance.hpp>
 
@@ -244,6 +245,31 @@ BOOST_AUTO_TEST_CASE(CosineDistanceRandomTest)
   BOOST_REQUIRE_CLOSE(CosineDistance::Evaluate(b, a), 0.1385349024, 1e-5);
 }
 
+/**
+ * Make sure that copying an IPMetric copies the kernel only if the metric owns
+ * it.
+ */
+BOOST_AUTO_TEST_CASE(IPMetricCopyTest)
+{
+  arma::vec a = "0.1 0.2 0.3 0.4 0.5";
+  arma::vec b = "1.2 1.0 0.8 -0.3 -0.5";
+
+  IPMetric<GaussianKernel> metric;
+  metric.Kernel().Bandwidth(2.0);
+  IPMetric<GaussianKernel> copy(metric);
+  BOOST_REQUIRE_NE(&copy.Kernel(), &metric.Kernel());
+  BOOST_REQUIRE_CLOSE(copy.Kernel().Bandwidth(), 2.0, 1e-5);
+  BOOST_REQUIRE_CLOSE(copy.Evaluate(a, b), metric.Evaluate(a, b), 1e-5);
+
+  GaussianKernel kernel(3.0);
+  IPMetric<GaussianKernel> sharedMetric(kernel);
+  IPMetric<GaussianKernel> sharedCopy(sharedMetric);
+  BOOST_REQUIRE_EQUAL(&sharedCopy.Kernel(), &kernel);
+
+  copy = sharedMetric;
+  BOOST_REQUIRE_EQUAL(&copy.Kernel(), &kernel);
+}
+
 /**
  * Linear Kernel test.
  */
@@ -270,6 +270,222 @@ BOOST_AUTO_TEST_CASE(TrainTreeTest)
   }
 }
 
+/**
+ * Test that dual-tree search with a packed tree gives the same results as
+ * search with a tree whose nodes are allocated separately.
+ */
+BOOST_AUTO_TEST_CASE(PackedTreeTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(5, 1000);
+  KNN baseline(dataset);
+
+  arma::Mat<size_t> baselineNeighbors;
+  arma::mat baselineDistances;
+  baseline.Search(5, baselineNeighbors, baselineDistances);
+
+  const NodeLayout layouts[] = { BREADTH_FIRST_LAYOUT, VAN_EMDE_BOAS_LAYOUT };
+  for (size_t l = 0; l < 2; ++l)
+  {
+    std::vector<size_t> oldFromNewReferences;
+    KNN::Tree tree(dataset, oldFromNewReferences);
+    tree.PackNodes(layouts[l]);
+
+    KNN knn(std::move(tree));
+    arma::Mat<size_t> neighbors;
+    arma::mat distances;
+    knn.Search(5, neighbors, distances);
+
+    BOOST_REQUIRE_EQUAL(knn.ReferenceTree().Layout(), layouts[l]);
+    BOOST_REQUIRE_EQUAL(neighbors.n_rows, baselineNeighbors.n_rows);
+    BOOST_REQUIRE_EQUAL(neighbors.n_cols, baselineNeighbors.n_cols);
+
+    // We have to unmap the results.
+    for (size_t i = 0; i < distances.n_cols; ++i)
+    {
+      const size_t point = oldFromNewReferences[i];
+      for (size_t j = 0; j < distances.n_rows; ++j)
+      {
+        BOOST_REQUIRE_EQUAL(oldFromNewReferences[neighbors(j, i)],
+            baselineNeighbors(j, point));
+        if (std::abs(baselineDistances(j, point)) < 1e-5)
+          BOOST_REQUIRE_SMALL(distances(j, i), 1e-5);
+        else
+          BOOST_REQUIRE_CLOSE(distances(j, i), baselineDistances(j, point),
+              1e-5);
+      }
+    }
+  }
+}
+
+/**
+ * Check that the results of the given model match the results of a naive search
+ * on the given reference set.
+ */
+template<typename ModelType>
+void CheckUpdatedResults(ModelType& model,
+                         const arma::mat& referenceSet,
+                         const arma::mat& querySet)
+{
+  KNN naive(referenceSet, NAIVE_MODE);
+  arma::Mat<size_t> baselineNeighbors, neighbors;
+  arma::mat baselineDistances, distances;
+  naive.Search(querySet, 5, baselineNeighbors, baselineDistances);
+  model.Search(querySet, 5, neighbors, distances);
+
+  BOOST_REQUIRE_EQUAL(neighbors.n_rows, baselineNeighbors.n_rows);
+  BOOST_REQUIRE_EQUAL(neighbors.n_cols, baselineNeighbors.n_cols);
+  for (size_t i = 0; i < neighbors.n_elem; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(neighbors[i], baselineNeighbors[i]);
+    BOOST_REQUIRE_CLOSE(distances[i], baselineDistances[i], 1e-5);
+  }
+}
+
+/**
+ * Insert points into and delete points from the reference set, and make sure
+ * the results are the same as the results of a model trained on the updated
+ * reference set, both before and after the tree is rebuilt.
+ */
+BOOST_AUTO_TEST_CASE(InsertDeleteTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(5, 1000);
+  arma::mat insertions = arma::randu<arma::mat>(5, 50);
+  arma::mat querySet = arma::randu<arma::mat>(5, 100);
+
+  const NeighborSearchMode modes[] = { NAIVE_MODE, SINGLE_TREE_MODE,
+      DUAL_TREE_MODE, GREEDY_SINGLE_TREE_MODE };
+  for (size_t m = 0; m < 4; ++m)
+  {
+    KNN knn(dataset, modes[m]);
+    knn.RebuildRatio() = 1.0; // Don't rebuild automatically.
+
+    // Keep an updated copy of the reference set to compare with.
+    arma::mat current = arma::join_rows(dataset, insertions);
+    knn.Insert(insertions);
+
+    // Delete a point of the tree, an inserted point, and the first and last
+    // points.
+    const size_t deletions[] = { 500, 1020, 0, 1046, 499 };
+    for (size_t i = 0; i < 5; ++i)
+    {
+      knn.Delete(deletions[i]);
+      current.shed_col(deletions[i]);
+    }
+
+    BOOST_REQUIRE_EQUAL(knn.NumReferencePoints(), current.n_cols);
+    BOOST_REQUIRE_EQUAL(knn.ReferenceSet().n_cols, 1000);
+
+    // The greedy search is approximate, so we only check the exact searches.
+    if (modes[m] != GREEDY_SINGLE_TREE_MODE)
+      CheckUpdatedResults(knn, current, querySet);
+
+    knn.Rebuild();
+    BOOST_REQUIRE_EQUAL(knn.ReferenceSet().n_cols, current.n_cols);
+    if (modes[m] != GREEDY_SINGLE_TREE_MODE)
+      CheckUpdatedResults(knn, current, querySet);
+  }
+}
+
+/**
+ * Make sure that the tree is rebuilt once enough updates are pending, and that
+ * the results stay correct over many updates.
+ */
+BOOST_AUTO_TEST_CASE(InsertDeleteRebuildTest)
+{
+  arma::mat current = arma::randu<arma::mat>(3, 200);
+  arma::mat querySet = arma::randu<arma::mat>(3, 50);
+
+  KNN knn(current);
+  knn.RebuildRatio() = 0.05;
+
+  // The tree is rebuilt when the 11th point is inserted (11 > 0.05 * 200), and
+  // again when the 22nd point is inserted (11 > 0.05 * 211).
+  for (size_t i = 0; i < 30; ++i)
+  {
+    arma::mat point = arma::randu<arma::mat>(3, 1);
+    knn.Insert(point);
+    current.insert_cols(current.n_cols, point);
+  }
+
+  BOOST_REQUIRE_EQUAL(knn.ReferenceSet().n_cols, 222);
+  BOOST_REQUIRE_EQUAL(knn.NumReferencePoints(), 230);
+  CheckUpdatedResults(knn, current, querySet);
+
+  for (size_t i = 0; i < 40; ++i)
+  {
+    arma::mat point = arma::randu<arma::mat>(3, 1);
+    knn.Insert(point);
+    current.insert_cols(current.n_cols, point);
+
+    const size_t index = math::RandInt(current.n_cols);
+    knn.Delete(index);
+    current.shed_col(index);
+
+    BOOST_REQUIRE_EQUAL(knn.NumReferencePoints(), current.n_cols);
+    CheckUpdatedResults(knn, current, querySet);
+  }
+
+  // A copy of the model keeps the pending updates.
+  KNN copy(knn);
+  BOOST_REQUIRE_EQUAL(copy.NumReferencePoints(), current.n_cols);
+  CheckUpdatedResults(copy, current, querySet);
+  copy.Rebuild();
+  BOOST_REQUIRE_EQUAL(copy.ReferenceSet().n_cols, current.n_cols);
+  CheckUpdatedResults(copy, current, querySet);
+}
+
+/**
+ * Make sure that monochromatic search merges the pending updates.
+ */
+BOOST_AUTO_TEST_CASE(InsertDeleteMonochromaticTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(5, 500);
+  arma::mat insertions = arma::randu<arma::mat>(5, 20);
+
+  KNN knn(dataset);
+  knn.RebuildRatio() = 1.0;
+  knn.Insert(insertions);
+  knn.Delete(3);
+
+  arma::mat current = arma::join_rows(dataset, insertions);
+  current.shed_col(3);
+  KNN naive(current, NAIVE_MODE);
+
+  arma::Mat<size_t> neighbors, baselineNeighbors;
+  arma::mat distances, baselineDistances;
+  knn.Search(3, neighbors, distances);
+  naive.Search(3, baselineNeighbors, baselineDistances);
+
+  BOOST_REQUIRE_EQUAL(knn.ReferenceSet().n_cols, current.n_cols);
+  for (size_t i = 0; i < neighbors.n_elem; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(neighbors[i], baselineNeighbors[i]);
+    BOOST_REQUIRE_CLOSE(distances[i], baselineDistances[i], 1e-5);
+  }
+}
+
+/**
+ * Make sure invalid updates throw exceptions.
+ */
+BOOST_AUTO_TEST_CASE(InvalidUpdatesTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(5, 100);
+  KNN knn(dataset);
+  knn.RebuildRatio() = 1.0;
+
+  BOOST_REQUIRE_THROW(knn.Delete(100), std::invalid_argument);
+  BOOST_REQUIRE_THROW(knn.Insert(arma::randu<arma::mat>(4, 10)),
+      std::invalid_argument);
+
+  knn.Delete(99);
+  BOOST_REQUIRE_THROW(knn.Delete(99), std::invalid_argument);
+
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  BOOST_REQUIRE_THROW(knn.Search(dataset, 100, neighbors, distances),
+      std::invalid_argument);
+}
+
 /**
  * Test that training with a tree throws an exception when in naive mode.
  */
@@ -1143,6 +1359,63 @@ BOOST_AUTO_TEST_CASE(KNNModelTest)
   }
 }
 
+/**
+ * Make sure that NSModel can be updated, and that the results match a naive
+ * search on the updated reference set.
+ */
+BOOST_AUTO_TEST_CASE(KNNModelUpdateTest)
+{
+  typedef NSModel<NearestNeighborSort> KNNModel;
+
+  arma::mat referenceData = arma::randu<arma::mat>(10, 200);
+  arma::mat insertions = arma::randu<arma::mat>(10, 5);
+  arma::mat queryData = arma::randu<arma::mat>(10, 50);
+
+  arma::mat current = arma::join_rows(referenceData, insertions);
+  current.shed_col(150);
+  current.shed_col(7);
+
+  const KNNModel::TreeTypes treeTypes[] = {
+      KNNModel::TreeTypes::KD_TREE, KNNModel::TreeTypes::COVER_TREE,
+      KNNModel::TreeTypes::R_TREE, KNNModel::TreeTypes::BALL_TREE,
+      KNNModel::TreeTypes::OCTREE };
+  for (size_t t = 0; t < 5; ++t)
+  {
+    for (size_t j = 0; j < 3; ++j)
+    {
+      const NeighborSearchMode mode = (j == 0) ? DUAL_TREE_MODE :
+          ((j == 1) ? SINGLE_TREE_MODE : NAIVE_MODE);
+      KNNModel model(treeTypes[t], false);
+      arma::mat referenceCopy(referenceData);
+      model.BuildModel(std::move(referenceCopy), 20, mode);
+
+      arma::mat insertionsCopy(insertions);
+      model.Insert(std::move(insertionsCopy));
+      model.Delete(150);
+      model.Delete(7);
+      BOOST_REQUIRE_EQUAL(model.NumReferencePoints(), current.n_cols);
+
+      arma::mat queryCopy(queryData);
+      KNN naive(current, NAIVE_MODE);
+      arma::Mat<size_t> neighbors, baselineNeighbors;
+      arma::mat distances, baselineDistances;
+      model.Search(std::move(queryCopy), 3, neighbors, distances);
+      naive.Search(queryData, 3, baselineNeighbors, baselineDistances);
+
+      for (size_t i = 0; i < neighbors.n_elem; ++i)
+      {
+        BOOST_REQUIRE_EQUAL(neighbors[i], baselineNeighbors[i]);
+        BOOST_REQUIRE_CLOSE(distances[i], baselineDistances[i], 1e-5);
+      }
+
+      // The leaf size of the model is kept when the tree is rebuilt.
+      model.Rebuild();
+      BOOST_REQUIRE_EQUAL(model.Dataset().n_cols, current.n_cols);
+      BOOST_REQUIRE_EQUAL(model.LeafSize(), 20);
+    }
+  }
+}
+
 BOOST_AUTO_TEST_CASE(KNNModelMonochromaticTest)
 {
   // Ensure that we can build an NSModel<NearestNeighborSearch> and get correct
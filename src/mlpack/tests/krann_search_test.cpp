@@ -715,4 +715,109 @@ BOOST_AUTO_TEST_CASE(RAModelTest)
   }
 }
 
+/**
+ * Make sure that the batched base cases give the same candidates as the
+ * pairwise base cases, for metrics with and without a batched implementation.
+ */
+template<typename MetricType>
+void CheckBaseCases(const arma::mat& refData, const arma::mat& queryData)
+{
+  typedef typename RASearch<NearestNeighborSort, MetricType>::Tree TreeType;
+  typedef RASearchRules<NearestNeighborSort, MetricType, TreeType> RuleType;
+
+  MetricType metric;
+  RuleType pairRules(refData, queryData, 5, metric);
+  RuleType batchRules(refData, queryData, 5, metric);
+
+  arma::uvec referenceIndices;
+  for (size_t i = 0; i < queryData.n_cols; ++i)
+  {
+    math::ObtainDistinctSamples(0, refData.n_cols, 50, referenceIndices);
+    for (size_t j = 0; j < referenceIndices.n_elem; ++j)
+      pairRules.BaseCase(i, referenceIndices[j]);
+    batchRules.BaseCases(i, referenceIndices);
+  }
+
+  BOOST_REQUIRE_EQUAL(batchRules.NumDistComputations(),
+      pairRules.NumDistComputations());
+  BOOST_REQUIRE_EQUAL(batchRules.NumEffectiveSamples(),
+      pairRules.NumEffectiveSamples());
+
+  arma::Mat<size_t> pairNeighbors, batchNeighbors;
+  arma::mat pairDistances, batchDistances;
+  pairRules.GetResults(pairNeighbors, pairDistances);
+  batchRules.GetResults(batchNeighbors, batchDistances);
+
+  for (size_t i = 0; i < pairNeighbors.n_elem; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(batchNeighbors[i], pairNeighbors[i]);
+    BOOST_REQUIRE_CLOSE(batchDistances[i], pairDistances[i], 1e-5);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(BatchBaseCasesTest)
+{
+  arma::mat refData;
+  arma::mat queryData;
+
+  data::Load("rann_test_r_3_900.csv", refData, true);
+  data::Load("rann_test_q_3_100.csv", queryData, true);
+
+  CheckBaseCases<EuclideanDistance>(refData, queryData);
+  CheckBaseCases<SquaredEuclideanDistance>(refData, queryData);
+  CheckBaseCases<ManhattanDistance>(refData, queryData);
+  CheckBaseCases<ChebyshevDistance>(refData, queryData);
+}
+
+/**
+ * Naive and single-tree search should give the same results for the same
+ * random seed, no matter how many threads are used.
+ */
+BOOST_AUTO_TEST_CASE(ReproducibleSearchTest)
+{
+  arma::mat refData;
+  arma::mat queryData;
+
+  data::Load("rann_test_r_3_900.csv", refData, true);
+  data::Load("rann_test_q_3_100.csv", queryData, true);
+
+  #ifdef HAS_OPENMP
+    const size_t prevNumThreads = omp_get_max_threads();
+  #endif
+
+  for (size_t mode = 0; mode < 2; ++mode)
+  {
+    RASearch<> rann(refData, (mode == 0), (mode == 1), 5.0);
+
+    for (size_t mono = 0; mono < 2; ++mono)
+    {
+      arma::Mat<size_t> neighbors[2];
+      arma::mat distances[2];
+      for (size_t run = 0; run < 2; ++run)
+      {
+        #ifdef HAS_OPENMP
+          omp_set_num_threads(run == 0 ? 1 : 4);
+        #endif
+
+        math::RandomSeed(1234);
+        if (mono == 0)
+          rann.Search(queryData, 3, neighbors[run], distances[run]);
+        else
+          rann.Search(3, neighbors[run], distances[run]);
+      }
+
+      BOOST_REQUIRE_EQUAL(neighbors[0].n_elem, neighbors[1].n_elem);
+      for (size_t i = 0; i < neighbors[0].n_elem; ++i)
+      {
+        BOOST_REQUIRE_EQUAL(neighbors[0][i], neighbors[1][i]);
+        BOOST_REQUIRE_EQUAL(distances[0][i], distances[1][i]);
+      }
+    }
+  }
+
+  #ifdef HAS_OPENMP
+    omp_set_num_threads(prevNumThreads);
+  #endif
+}
+
 BOOST_AUTO_TEST_SUITE_END();
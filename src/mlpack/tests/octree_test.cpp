@@ -346,4 +346,62 @@ BOOST_AUTO_TEST_CASE(SerializationTest)
   delete textTree;
 }
 
+/**
+ * Make sure that two trees have exactly the same structure.
+ */
+template<typename TreeType>
+void CheckSameTree(TreeType& a, TreeType& b)
+{
+  BOOST_REQUIRE_EQUAL(a.NumDescendants(), b.NumDescendants());
+  if (a.NumDescendants() > 0)
+    BOOST_REQUIRE_EQUAL(a.Descendant(0), b.Descendant(0));
+  BOOST_REQUIRE_EQUAL(a.NumChildren(), b.NumChildren());
+  BOOST_REQUIRE_EQUAL(a.ParentDistance(), b.ParentDistance());
+
+  for (size_t i = 0; i < a.NumChildren(); ++i)
+    CheckSameTree(a.Child(i), b.Child(i));
+}
+
+/**
+ * Make sure that an octree built with several threads is exactly the same as
+ * one built with one thread.
+ */
+BOOST_AUTO_TEST_CASE(ParallelConstructionTest)
+{
+  arma::mat dataset(3, 60000, arma::fill::randu);
+
+  #ifdef HAS_OPENMP
+    const size_t prevNumThreads = omp_get_max_threads();
+    omp_set_num_threads(1);
+  #endif
+
+  std::vector<size_t> serialOldFromNew;
+  Octree<> serialTree(dataset, serialOldFromNew);
+
+  #ifdef HAS_OPENMP
+    omp_set_num_threads(4);
+  #endif
+
+  std::vector<size_t> oldFromNew;
+  Octree<> tree(dataset, oldFromNew);
+  Octree<> noMappingTree(dataset);
+
+  #ifdef HAS_OPENMP
+    omp_set_num_threads(prevNumThreads);
+  #endif
+
+  BOOST_REQUIRE_EQUAL(oldFromNew.size(), serialOldFromNew.size());
+  for (size_t i = 0; i < oldFromNew.size(); ++i)
+  {
+    BOOST_REQUIRE_EQUAL(oldFromNew[i], serialOldFromNew[i]);
+    BOOST_REQUIRE_EQUAL(arma::norm(tree.Dataset().col(i) -
+        dataset.col(oldFromNew[i])), 0.0);
+    BOOST_REQUIRE_EQUAL(arma::norm(noMappingTree.Dataset().col(i) -
+        serialTree.Dataset().col(i)), 0.0);
+  }
+
+  CheckSameTree(tree, serialTree);
+  CheckSameTree(noMappingTree, serialTree);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
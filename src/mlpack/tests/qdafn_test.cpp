@@ -187,6 +187,42 @@ BOOST_AUTO_TEST_CASE(SerializationTest)
   }
 }
 
+/**
+ * Make sure that when more than one furthest neighbor is requested, the results
+ * are sorted by decreasing distance and the reported distances are the true
+ * distances to the reported neighbors.
+ */
+BOOST_AUTO_TEST_CASE(QDAFNMultipleNeighborsTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(5, 500);
+  arma::mat querySet = arma::randu<arma::mat>(5, 300);
+
+  QDAFN<> model(dataset, 10, 30);
+
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  model.Search(querySet, 5, neighbors, distances);
+
+  BOOST_REQUIRE_EQUAL(neighbors.n_rows, 5);
+  BOOST_REQUIRE_EQUAL(neighbors.n_cols, 300);
+  BOOST_REQUIRE_EQUAL(distances.n_rows, 5);
+  BOOST_REQUIRE_EQUAL(distances.n_cols, 300);
+
+  for (size_t i = 0; i < querySet.n_cols; ++i)
+  {
+    for (size_t j = 0; j < 5; ++j)
+    {
+      BOOST_REQUIRE_LT(neighbors(j, i), dataset.n_cols);
+      const double trueDistance = metric::EuclideanDistance::Evaluate(
+          querySet.col(i), dataset.col(neighbors(j, i)));
+      BOOST_REQUIRE_CLOSE(distances(j, i), trueDistance, 1e-5);
+
+      if (j > 0)
+        BOOST_REQUIRE_GE(distances(j - 1, i), distances(j, i));
+    }
+  }
+}
+
 // Make sure QDAFN works with sparse data.
 BOOST_AUTO_TEST_CASE(SparseTest)
 {
@@ -1696,4 +1696,253 @@ BOOST_AUTO_TEST_CASE(MoveOperatorNaiveTest)
   }
 }
 
+// Make sure that the given CSR results match the given nested vector results.
+void CheckCSRResults(const CSRResults& results,
+                     const vector<vector<size_t>>& neighbors,
+                     const vector<vector<double>>& distances)
+{
+  BOOST_REQUIRE_EQUAL(results.NumQueries(), neighbors.size());
+
+  vector<vector<size_t>> csrNeighbors(results.NumQueries());
+  vector<vector<double>> csrDistances(results.NumQueries());
+  for (size_t i = 0; i < results.NumQueries(); ++i)
+  {
+    for (size_t j = 0; j < results.NumNeighbors(i); ++j)
+    {
+      csrNeighbors[i].push_back(results.Neighbor(i, j));
+      csrDistances[i].push_back(results.Distance(i, j));
+    }
+  }
+
+  vector<vector<pair<double, size_t>>> sorted, csrSorted;
+  SortResults(neighbors, distances, sorted);
+  SortResults(csrNeighbors, csrDistances, csrSorted);
+
+  for (size_t i = 0; i < sorted.size(); ++i)
+  {
+    BOOST_REQUIRE_EQUAL(csrSorted[i].size(), sorted[i].size());
+    for (size_t j = 0; j < sorted[i].size(); ++j)
+    {
+      BOOST_REQUIRE_EQUAL(csrSorted[i][j].second, sorted[i][j].second);
+      BOOST_REQUIRE_CLOSE(csrSorted[i][j].first, sorted[i][j].first, 1e-5);
+    }
+  }
+}
+
+/**
+ * Make sure that CSR results are the same as nested vector results, for naive,
+ * single-tree, and dual-tree search, with and without a query set.
+ */
+BOOST_AUTO_TEST_CASE(CSRResultsTest)
+{
+  arma::mat referenceData = arma::randu<arma::mat>(5, 500);
+  arma::mat queryData = arma::randu<arma::mat>(5, 200);
+  const math::Range range(0.2, 0.5);
+
+  for (size_t mode = 0; mode < 3; ++mode)
+  {
+    RangeSearch<> rs(referenceData, mode == 0, mode == 1);
+
+    vector<vector<size_t>> neighbors;
+    vector<vector<double>> distances;
+    CSRResults results;
+
+    rs.Search(queryData, range, neighbors, distances);
+    rs.Search(queryData, range, results);
+    CheckCSRResults(results, neighbors, distances);
+
+    // Reuse the same results object for a monochromatic search.
+    rs.Search(range, neighbors, distances);
+    rs.Search(range, results);
+    CheckCSRResults(results, neighbors, distances);
+  }
+}
+
+/**
+ * Make sure that CSR results from an RSModel (which may build its own query
+ * tree) are the same as nested vector results.
+ */
+BOOST_AUTO_TEST_CASE(RSModelCSRResultsTest)
+{
+  arma::mat referenceData = arma::randu<arma::mat>(5, 500);
+  arma::mat queryData = arma::randu<arma::mat>(5, 200);
+  const math::Range range(0.2, 0.5);
+
+  RSModel::TreeTypes treeTypes[] = { RSModel::TreeTypes::KD_TREE,
+      RSModel::TreeTypes::COVER_TREE, RSModel::TreeTypes::OCTREE };
+  for (size_t i = 0; i < 3; ++i)
+  {
+    RSModel model(treeTypes[i]);
+    arma::mat referenceCopy(referenceData);
+    model.BuildModel(std::move(referenceCopy), 5, false, false);
+
+    vector<vector<size_t>> neighbors;
+    vector<vector<double>> distances;
+    CSRResults results;
+
+    arma::mat queryCopy(queryData);
+    model.Search(std::move(queryCopy), range, neighbors, distances);
+    queryCopy = queryData;
+    model.Search(std::move(queryCopy), range, results);
+    CheckCSRResults(results, neighbors, distances);
+  }
+}
+
+/**
+ * Make sure that count-only results give the number of neighbors of each
+ * point.
+ */
+BOOST_AUTO_TEST_CASE(CountResultsTest)
+{
+  arma::mat referenceData = arma::randu<arma::mat>(5, 500);
+  arma::mat queryData = arma::randu<arma::mat>(5, 200);
+  const math::Range range(0.0, 0.4);
+
+  for (size_t mode = 0; mode < 3; ++mode)
+  {
+    RangeSearch<> rs(referenceData, mode == 0, mode == 1);
+
+    vector<vector<size_t>> neighbors;
+    vector<vector<double>> distances;
+    CountResults results;
+
+    rs.Search(queryData, range, neighbors, distances);
+    rs.Search(queryData, range, results);
+    BOOST_REQUIRE_EQUAL(results.Counts().n_elem, neighbors.size());
+    for (size_t i = 0; i < neighbors.size(); ++i)
+      BOOST_REQUIRE_EQUAL(results.Counts()[i], neighbors[i].size());
+
+    rs.Search(range, neighbors, distances);
+    rs.Search(range, results);
+    BOOST_REQUIRE_EQUAL(results.Counts().n_elem, neighbors.size());
+    for (size_t i = 0; i < neighbors.size(); ++i)
+      BOOST_REQUIRE_EQUAL(results.Counts()[i], neighbors[i].size());
+  }
+}
+
+/**
+ * Make sure that a callback is given every result, with original indices.
+ */
+BOOST_AUTO_TEST_CASE(CallbackResultsTest)
+{
+  arma::mat referenceData = arma::randu<arma::mat>(5, 500);
+  arma::mat queryData = arma::randu<arma::mat>(5, 200);
+  const math::Range range(0.2, 0.5);
+
+  RangeSearch<> rs(referenceData);
+
+  vector<vector<size_t>> neighbors;
+  vector<vector<double>> distances;
+  rs.Search(queryData, range, neighbors, distances);
+
+  vector<vector<size_t>> callbackNeighbors(queryData.n_cols);
+  vector<vector<double>> callbackDistances(queryData.n_cols);
+  auto results = MakeCallbackResults(
+      [&](const size_t queryIndex,
+          const size_t referenceIndex,
+          const double distance)
+      {
+        callbackNeighbors[queryIndex].push_back(referenceIndex);
+        callbackDistances[queryIndex].push_back(distance);
+
+        // The indices must refer to the original datasets.
+        BOOST_REQUIRE_CLOSE(distance, EuclideanDistance::Evaluate(
+            queryData.col(queryIndex), referenceData.col(referenceIndex)),
+            1e-5);
+      });
+  rs.Search(queryData, range, results);
+
+  vector<vector<pair<double, size_t>>> sorted, callbackSorted;
+  SortResults(neighbors, distances, sorted);
+  SortResults(callbackNeighbors, callbackDistances, callbackSorted);
+
+  for (size_t i = 0; i < sorted.size(); ++i)
+  {
+    BOOST_REQUIRE_EQUAL(callbackSorted[i].size(), sorted[i].size());
+    for (size_t j = 0; j < sorted[i].size(); ++j)
+      BOOST_REQUIRE_EQUAL(callbackSorted[i][j].second, sorted[i][j].second);
+  }
+}
+
+/**
+ * Run a dual-tree search with several threads and make sure the results match
+ * naive search, for both bichromatic and monochromatic search.
+ */
+template<typename RSType>
+void CheckParallelDualTreeSearch(const arma::mat& referenceData,
+                                 const arma::mat& queryData,
+                                 const math::Range& range)
+{
+  RangeSearch<> naive(referenceData, true);
+  RSType rs(referenceData);
+
+  #ifdef HAS_OPENMP
+    const size_t prevNumThreads = omp_get_max_threads();
+    omp_set_num_threads(4);
+  #endif
+
+  for (size_t mono = 0; mono < 2; ++mono)
+  {
+    vector<vector<size_t>> naiveNeighbors, neighbors;
+    vector<vector<double>> naiveDistances, distances;
+    if (mono == 0)
+    {
+      naive.Search(queryData, range, naiveNeighbors, naiveDistances);
+      rs.Search(queryData, range, neighbors, distances);
+    }
+    else
+    {
+      naive.Search(range, naiveNeighbors, naiveDistances);
+      rs.Search(range, neighbors, distances);
+    }
+
+    // The results given to a CSRResults object must be the same.
+    CSRResults results;
+    if (mono == 0)
+      rs.Search(queryData, range, results);
+    else
+      rs.Search(range, results);
+    CheckCSRResults(results, neighbors, distances);
+
+    vector<vector<pair<double, size_t>>> naiveSorted, sorted;
+    SortResults(naiveNeighbors, naiveDistances, naiveSorted);
+    SortResults(neighbors, distances, sorted);
+
+    BOOST_REQUIRE_EQUAL(sorted.size(), naiveSorted.size());
+    for (size_t i = 0; i < sorted.size(); ++i)
+    {
+      BOOST_REQUIRE_EQUAL(sorted[i].size(), naiveSorted[i].size());
+      for (size_t j = 0; j < sorted[i].size(); ++j)
+      {
+        BOOST_REQUIRE_EQUAL(sorted[i][j].second, naiveSorted[i][j].second);
+        BOOST_REQUIRE_CLOSE(sorted[i][j].first, naiveSorted[i][j].first,
+            1e-5);
+      }
+    }
+  }
+
+  #ifdef HAS_OPENMP
+    omp_set_num_threads(prevNumThreads);
+  #endif
+}
+
+/**
+ * Make sure that multithreaded dual-tree search gives the right results with
+ * several types of trees.
+ */
+BOOST_AUTO_TEST_CASE(ParallelDualTreeSearchTest)
+{
+  arma::mat referenceData = arma::randu<arma::mat>(3, 1000);
+  arma::mat queryData = arma::randu<arma::mat>(3, 800);
+  const math::Range range(0.05, 0.2);
+
+  CheckParallelDualTreeSearch<RangeSearch<>>(referenceData, queryData, range);
+  CheckParallelDualTreeSearch<RangeSearch<EuclideanDistance, arma::mat,
+      StandardCoverTree>>(referenceData, queryData, range);
+  CheckParallelDualTreeSearch<RangeSearch<EuclideanDistance, arma::mat,
+      RTree>>(referenceData, queryData, range);
+  CheckParallelDualTreeSearch<RangeSearch<EuclideanDistance, arma::mat,
+      Octree>>(referenceData, queryData, range);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
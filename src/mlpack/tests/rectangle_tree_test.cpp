@@ -1384,4 +1384,161 @@ BOOST_AUTO_TEST_CASE(RectangleTreeMoveDatasetTest)
   BOOST_REQUIRE_EQUAL(tree.Dataset().n_cols, 1000);
 }
 
+/**
+ * Bulk-load a tree of the given type with the given packing policy, check its
+ * structure, and compare nearest neighbor search on it with naive search.
+ */
+template<template<typename, typename, typename> class TreeType,
+         typename PackingType>
+void CheckBulkLoadedTree(const arma::mat& dataset)
+{
+  typedef TreeType<EuclideanDistance, NeighborSearchStat<NearestNeighborSort>,
+      arma::mat> Tree;
+  Tree tree(dataset, PackingType(), 20, 6, 5, 2);
+
+  BOOST_REQUIRE_EQUAL(tree.NumDescendants(), dataset.n_cols);
+
+  CheckContainment(tree);
+  CheckExactContainment(tree);
+  CheckHierarchy(tree);
+  CheckNumDescendants(tree);
+  CheckFills(tree);
+  BOOST_REQUIRE_EQUAL(GetMinLevel(tree), GetMaxLevel(tree));
+  BOOST_REQUIRE_EQUAL(tree.TreeDepth(), GetMinLevel(tree));
+
+  // Every point should be in exactly one leaf.
+  std::vector<size_t> counts(dataset.n_cols, 0);
+  std::vector<const Tree*> nodes(1, &tree);
+  while (!nodes.empty())
+  {
+    const Tree* node = nodes.back();
+    nodes.pop_back();
+    for (size_t i = 0; i < node->NumPoints(); ++i)
+      ++counts[node->Point(i)];
+    for (size_t i = 0; i < node->NumChildren(); ++i)
+      nodes.push_back(&node->Child(i));
+  }
+  for (size_t i = 0; i < counts.size(); ++i)
+    BOOST_REQUIRE_EQUAL(counts[i], 1);
+
+  NeighborSearch<NearestNeighborSort, metric::LMetric<2, true>, arma::mat,
+      TreeType> knn1(std::move(tree), DUAL_TREE_MODE);
+  arma::Mat<size_t> neighbors1;
+  arma::mat distances1;
+  knn1.Search(5, neighbors1, distances1);
+
+  KNN knn2(dataset, NAIVE_MODE);
+  arma::Mat<size_t> neighbors2;
+  arma::mat distances2;
+  knn2.Search(5, neighbors2, distances2);
+
+  for (size_t i = 0; i < neighbors1.size(); i++)
+  {
+    BOOST_REQUIRE_EQUAL(neighbors1[i], neighbors2[i]);
+    BOOST_REQUIRE_EQUAL(distances1[i], distances2[i]);
+  }
+}
+
+// Make sure that bulk-loaded trees are valid and give correct search results.
+BOOST_AUTO_TEST_CASE(BulkLoadTest)
+{
+  arma::mat dataset;
+  dataset.randu(8, 1000); // 1000 points in 8 dimensions.
+
+  CheckBulkLoadedTree<RTree, STRPacking>(dataset);
+  CheckBulkLoadedTree<RStarTree, STRPacking>(dataset);
+  CheckBulkLoadedTree<XTree, STRPacking>(dataset);
+  CheckBulkLoadedTree<RTree, HilbertPacking>(dataset);
+  CheckBulkLoadedTree<HilbertRTree, HilbertPacking>(dataset);
+
+  // Make sure small datasets, where the root is a leaf, work too.
+  CheckBulkLoadedTree<RTree, STRPacking>(dataset.cols(0, 14));
+  CheckBulkLoadedTree<HilbertRTree, HilbertPacking>(dataset.cols(0, 14));
+}
+
+// A bulk-loaded Hilbert R tree should keep its points in Hilbert order, and the
+// Hilbert values it stores should match its points.
+BOOST_AUTO_TEST_CASE(HilbertRTreeBulkLoadOrderingTest)
+{
+  arma::mat dataset;
+  dataset.randu(8, 1000); // 1000 points in 8 dimensions.
+
+  typedef HilbertRTree<EuclideanDistance,
+      NeighborSearchStat<NearestNeighborSort>, arma::mat> TreeType;
+  TreeType hilbertRTree(dataset, HilbertPacking(), 20, 6, 5, 2);
+
+  CheckHilbertOrdering(hilbertRTree);
+  CheckDiscreteHilbertValueSync(hilbertRTree);
+}
+
+// Points can be inserted into and deleted from a bulk-loaded tree.
+BOOST_AUTO_TEST_CASE(BulkLoadDynamicTest)
+{
+  const int numIter = 50;
+  arma::mat dataset;
+  dataset.randu(8, 1000); // 1000 points in 8 dimensions.
+
+  typedef RStarTree<EuclideanDistance, NeighborSearchStat<NearestNeighborSort>,
+      arma::mat> TreeType;
+  TreeType tree(dataset, STRPacking(), 20, 6, 5, 2);
+
+  typedef HilbertRTree<EuclideanDistance,
+      NeighborSearchStat<NearestNeighborSort>, arma::mat> HilbertTreeType;
+  HilbertTreeType hilbertTree(dataset, HilbertPacking(), 20, 6, 5, 2);
+
+  // Add numIter new points to the datasets of both trees.
+  tree.Dataset().reshape(8, 1000 + numIter);
+  hilbertTree.Dataset().reshape(8, 1000 + numIter);
+  dataset.reshape(8, 1000 + numIter);
+  arma::mat tmpData;
+  tmpData.randu(8, numIter);
+  for (int i = 0; i < numIter; i++)
+  {
+    tree.Dataset().col(1000 + i) = tmpData.col(i);
+    hilbertTree.Dataset().col(1000 + i) = tmpData.col(i);
+    dataset.col(1000 + i) = tmpData.col(i);
+    tree.InsertPoint(1000 + i);
+    hilbertTree.InsertPoint(1000 + i);
+  }
+
+  // Delete numIter of the original points from the R* tree.
+  for (int i = 0; i < numIter; i++)
+    BOOST_REQUIRE(tree.DeletePoint(i));
+
+  BOOST_REQUIRE_EQUAL(tree.NumDescendants(), 1000);
+  CheckContainment(tree);
+  CheckExactContainment(tree);
+  CheckHierarchy(tree);
+  CheckNumDescendants(tree);
+
+  BOOST_REQUIRE_EQUAL(hilbertTree.NumDescendants(), 1000 + numIter);
+  CheckContainment(hilbertTree);
+  CheckExactContainment(hilbertTree);
+  CheckHierarchy(hilbertTree);
+  CheckNumDescendants(hilbertTree);
+  CheckHilbertOrdering(hilbertTree);
+
+  // Compare search on the R* tree with naive search on the remaining points.
+  arma::mat querySet;
+  querySet.randu(8, 100);
+
+  NeighborSearch<NearestNeighborSort, metric::LMetric<2, true>, arma::mat,
+      RStarTree> knn1(std::move(tree), SINGLE_TREE_MODE);
+  arma::Mat<size_t> neighbors1;
+  arma::mat distances1;
+  knn1.Search(querySet, 5, neighbors1, distances1);
+
+  arma::mat remaining = dataset.cols(numIter, 1000 + numIter - 1);
+  KNN knn2(remaining, NAIVE_MODE);
+  arma::Mat<size_t> neighbors2;
+  arma::mat distances2;
+  knn2.Search(querySet, 5, neighbors2, distances2);
+
+  for (size_t i = 0; i < neighbors1.size(); i++)
+  {
+    BOOST_REQUIRE_EQUAL(neighbors1[i], neighbors2[i] + numIter);
+    BOOST_REQUIRE_EQUAL(distances1[i], distances2[i]);
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END();
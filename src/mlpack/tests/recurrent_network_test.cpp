@@ -821,6 +821,73 @@ BOOST_AUTO_TEST_CASE(GRUBatchSizeTest)
   BatchSizeTest<GRU<>>();
 }
 
+/**
+ * Predict the same sequences with different batch sizes and make sure the
+ * results are the same.
+ */
+template<typename RecurrentLayerType>
+void BatchPredictTest()
+{
+  const size_t rho = 10;
+
+  // Generate 22 (2 * 11) noisy sines. A single sine contains rho
+  // points/features.
+  arma::mat input, labelsTemp;
+  GenerateNoisySines(input, labelsTemp, rho, 11);
+
+  arma::mat labels = arma::zeros<arma::mat>(rho, labelsTemp.n_cols);
+  for (size_t i = 0; i < labelsTemp.n_cols; ++i)
+  {
+    const int value = arma::as_scalar(arma::find(
+        arma::max(labelsTemp.col(i)) == labelsTemp.col(i), 1)) + 1;
+    labels.col(i).fill(value);
+  }
+
+  RNN<> model(rho);
+  model.Add<Linear<>>(1, 10);
+  model.Add<SigmoidLayer<>>();
+  model.Add<RecurrentLayerType>(10, 10);
+  model.Add<SigmoidLayer<>>();
+  model.Add<Linear<>>(10, 10);
+  model.Add<SigmoidLayer<>>();
+
+  StandardSGD opt(0.1, 2, 2 * input.n_cols, -100);
+  model.Train(input, labels, opt);
+
+  arma::mat prediction, batchPrediction;
+  model.Predict(input, prediction, 1);
+
+  model.Predict(input, batchPrediction, 5);
+  CheckMatrices(prediction, batchPrediction, 1e-5);
+
+  model.Predict(input, batchPrediction);
+  CheckMatrices(prediction, batchPrediction, 1e-5);
+}
+
+/**
+ * Ensure batched prediction with LSTMs gives the same results.
+ */
+BOOST_AUTO_TEST_CASE(LSTMBatchPredictTest)
+{
+  BatchPredictTest<LSTM<>>();
+}
+
+/**
+ * Ensure batched prediction with fast LSTMs gives the same results.
+ */
+BOOST_AUTO_TEST_CASE(FastLSTMBatchPredictTest)
+{
+  BatchPredictTest<FastLSTM<>>();
+}
+
+/**
+ * Ensure batched prediction with GRUs gives the same results.
+ */
+BOOST_AUTO_TEST_CASE(GRUBatchPredictTest)
+{
+  BatchPredictTest<GRU<>>();
+}
+
 /**
  * Make sure the RNN can be properly serialized.
  */
@@ -538,6 +538,39 @@ BOOST_AUTO_TEST_CASE(BinarySpaceTreeOverwriteTest)
   CheckTrees(tree, xmlTree, textTree, binaryTree);
 }
 
+/**
+ * Make sure that a packed tree is packed again when it is loaded, also when it
+ * is loaded into a packed tree.
+ */
+BOOST_AUTO_TEST_CASE(PackedBinarySpaceTreeTest)
+{
+  arma::mat data;
+  data.randu(3, 100);
+  typedef KDTree<EuclideanDistance, EmptyStatistic, arma::mat> TreeType;
+  TreeType tree(data);
+  tree.PackNodes(VAN_EMDE_BOAS_LAYOUT);
+
+  arma::mat otherData;
+  otherData.randu(5, 50);
+  TreeType xmlTree(otherData);
+  xmlTree.PackNodes(BREADTH_FIRST_LAYOUT);
+  TreeType textTree(xmlTree);
+  TreeType binaryTree(otherData);
+
+  SerializeObjectAll(tree, xmlTree, textTree, binaryTree);
+
+  CheckTrees(tree, xmlTree, textTree, binaryTree);
+  BOOST_REQUIRE_EQUAL(xmlTree.Layout(), VAN_EMDE_BOAS_LAYOUT);
+  BOOST_REQUIRE_EQUAL(textTree.Layout(), VAN_EMDE_BOAS_LAYOUT);
+  BOOST_REQUIRE_EQUAL(binaryTree.Layout(), VAN_EMDE_BOAS_LAYOUT);
+
+  // The descendants are stored one after the other.
+  std::vector<TreeType*> nodes;
+  LayoutNodes(binaryTree, VAN_EMDE_BOAS_LAYOUT, nodes);
+  for (size_t i = 2; i < nodes.size(); ++i)
+    BOOST_REQUIRE_EQUAL(nodes[i], nodes[i - 1] + 1);
+}
+
 BOOST_AUTO_TEST_CASE(CoverTreeTest)
 {
   arma::mat data;
@@ -754,6 +787,45 @@ BOOST_AUTO_TEST_CASE(RectangleTreeOverwriteTest)
   }
 }
 
+// Make sure bulk-loaded rectangle trees can be serialized.
+BOOST_AUTO_TEST_CASE(RectangleTreeBulkLoadTest)
+{
+  arma::mat data;
+  data.randu(3, 1000);
+  typedef RStarTree<EuclideanDistance, EmptyStatistic, arma::mat> TreeType;
+  TreeType tree(data, STRPacking());
+
+  TreeType* xmlTree;
+  TreeType* textTree;
+  TreeType* binaryTree;
+
+  SerializePointerObjectAll(&tree, xmlTree, textTree, binaryTree);
+
+  CheckTrees(tree, *xmlTree, *textTree, *binaryTree);
+
+  delete xmlTree;
+  delete textTree;
+  delete binaryTree;
+
+  typedef HilbertRTree<EuclideanDistance, EmptyStatistic, arma::mat>
+      HilbertTreeType;
+  HilbertTreeType hilbertTree(data, HilbertPacking());
+
+  HilbertTreeType* xmlHilbertTree;
+  HilbertTreeType* textHilbertTree;
+  HilbertTreeType* binaryHilbertTree;
+
+  SerializePointerObjectAll(&hilbertTree, xmlHilbertTree, textHilbertTree,
+      binaryHilbertTree);
+
+  CheckTrees(hilbertTree, *xmlHilbertTree, *textHilbertTree,
+      *binaryHilbertTree);
+
+  delete xmlHilbertTree;
+  delete textHilbertTree;
+  delete binaryHilbertTree;
+}
+
 BOOST_AUTO_TEST_CASE(PerceptronTest)
 {
   // Create a perceptron.  Train it randomly.  Then check that it hasn't
@@ -833,6 +905,45 @@ BOOST_AUTO_TEST_CASE(KNNTest)
   CheckMatrices(neighbors, xmlNeighbors, textNeighbors, binaryNeighbors);
 }
 
+/**
+ * Make sure that insertions and deletions that are not merged into the
+ * reference tree are serialized with the model.
+ */
+BOOST_AUTO_TEST_CASE(KNNUpdatesTest)
+{
+  using neighbor::KNN;
+  arma::mat dataset = arma::randu<arma::mat>(5, 2000);
+
+  KNN knn(dataset, DUAL_TREE_MODE);
+  knn.RebuildRatio() = 1.0;
+  knn.Insert(arma::randu<arma::mat>(5, 100));
+  knn.Delete(10);
+  knn.Delete(2050);
+
+  KNN knnXml, knnText, knnBinary;
+
+  SerializeObjectAll(knn, knnXml, knnText, knnBinary);
+
+  BOOST_REQUIRE_EQUAL(knnXml.NumReferencePoints(), 2098);
+  BOOST_REQUIRE_EQUAL(knnText.NumReferencePoints(), 2098);
+  BOOST_REQUIRE_EQUAL(knnBinary.NumReferencePoints(), 2098);
+  BOOST_REQUIRE_EQUAL(knnXml.RebuildRatio(), 1.0);
+
+  // Now run nearest neighbor and make sure the results are the same.
+  arma::mat querySet = arma::randu<arma::mat>(5, 1000);
+
+  arma::mat distances, xmlDistances, textDistances, binaryDistances;
+  arma::Mat<size_t> neighbors, xmlNeighbors, textNeighbors, binaryNeighbors;
+
+  knn.Search(querySet, 5, neighbors, distances);
+  knnXml.Search(querySet, 5, xmlNeighbors, xmlDistances);
+  knnText.Search(querySet, 5, textNeighbors, textDistances);
+  knnBinary.Search(querySet, 5, binaryNeighbors, binaryDistances);
+
+  CheckMatrices(distances, xmlDistances, textDistances, binaryDistances);
+  CheckMatrices(neighbors, xmlNeighbors, textNeighbors, binaryNeighbors);
+}
+
 BOOST_AUTO_TEST_CASE(SoftmaxRegressionTest)
 {
   using regression::SoftmaxRegression;
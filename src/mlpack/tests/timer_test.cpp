@@ -147,4 +147,227 @@ BOOST_AUTO_TEST_CASE(DisabledTimingTest)
   BOOST_REQUIRE(Timer::Get("test_timer") == std::chrono::microseconds(0));
 }
 
+/**
+ * A registered timer should accumulate over several runs and be reported under
+ * its name, together with the named timer of the same name.
+ */
+BOOST_AUTO_TEST_CASE(HandleTimerTest)
+{
+  Timer::ResetAll();
+  Timer::EnableTiming();
+
+  const TimerHandle handle = Timer::Register("handle_timer");
+  BOOST_REQUIRE_EQUAL(Timer::Register("handle_timer").Id(), handle.Id());
+
+  for (size_t i = 0; i < 2; ++i)
+  {
+    Timer::Start(handle);
+    BOOST_REQUIRE(Timer::Running(handle));
+    #ifdef _WIN32
+    Sleep(10);
+    #else
+    usleep(10000);
+    #endif
+    Timer::Stop(handle);
+    BOOST_REQUIRE(!Timer::Running(handle));
+  }
+
+  BOOST_REQUIRE_GE(Timer::Get("handle_timer").count(), 20000);
+
+  // The named timer adds to the same total.
+  Timer::Start("handle_timer");
+  #ifdef _WIN32
+  Sleep(10);
+  #else
+  usleep(10000);
+  #endif
+  Timer::Stop("handle_timer");
+
+  BOOST_REQUIRE_GE(Timer::Get("handle_timer").count(), 30000);
+
+  // Starting twice or stopping twice throws, as with named timers.
+  Timer::Start(handle);
+  BOOST_REQUIRE_THROW(Timer::Start(handle), std::runtime_error);
+  Timer::Stop(handle);
+  BOOST_REQUIRE_THROW(Timer::Stop(handle), std::runtime_error);
+  BOOST_REQUIRE_THROW(Timer::Start(TimerHandle()), std::invalid_argument);
+
+  Timer::ResetAll();
+  BOOST_REQUIRE(Timer::Get("handle_timer") == std::chrono::microseconds(0));
+  Timer::DisableTiming();
+}
+
+/**
+ * The times of a registered timer on several threads should be added up, also
+ * after the threads have exited.
+ */
+BOOST_AUTO_TEST_CASE(MultithreadHandleTimerTest)
+{
+  Timer::ResetAll();
+  Timer::EnableTiming();
+
+  const TimerHandle handle = Timer::Register("thread_handle_timer");
+  std::thread threads[3];
+  for (size_t i = 0; i < 3; ++i)
+  {
+    threads[i] = std::thread([handle]()
+        {
+          ScopedTimer timer(handle);
+
+          #ifdef _WIN32
+          Sleep(20);
+          #else
+          int restarts = 0;
+          // Catch occasional EINTR failures.
+          while (usleep(20000) != 0 && restarts < 3)
+            ++restarts;
+          #endif
+        });
+  }
+
+  for (size_t i = 0; i < 3; ++i)
+    threads[i].join();
+
+  BOOST_REQUIRE(Timer::Get("thread_handle_timer") >
+      std::chrono::microseconds(50000));
+
+  Timer::ResetAll();
+  Timer::DisableTiming();
+}
+
+/**
+ * Resetting the timers while another thread holds a registered timer should
+ * clear its time so far, and only count the time after the reset.
+ */
+BOOST_AUTO_TEST_CASE(ResetWithLiveThreadHandleTimerTest)
+{
+  Timer::ResetAll();
+  Timer::EnableTiming();
+
+  const TimerHandle handle = Timer::Register("reset_handle_timer");
+  std::atomic<int> stage(0);
+  std::thread thread([handle, &stage]()
+      {
+        for (size_t i = 0; i < 2; ++i)
+        {
+          {
+            ScopedTimer timer(handle);
+            #ifdef _WIN32
+            Sleep(20);
+            #else
+            int restarts = 0;
+            // Catch occasional EINTR failures.
+            while (usleep(20000) != 0 && restarts < 3)
+              ++restarts;
+            #endif
+          }
+
+          // Wait until the main thread has checked the time and reset it.
+          stage = 2 * i + 1;
+          while (stage != 2 * (int) i + 2)
+            std::this_thread::yield();
+        }
+      });
+
+  while (stage != 1)
+    std::this_thread::yield();
+  BOOST_REQUIRE(Timer::Get("reset_handle_timer") >=
+      std::chrono::microseconds(15000));
+
+  Timer::ResetAll();
+  BOOST_REQUIRE(Timer::Get("reset_handle_timer") ==
+      std::chrono::microseconds(0));
+  stage = 2;
+
+  while (stage != 3)
+    std::this_thread::yield();
+  const std::chrono::microseconds afterReset =
+      Timer::Get("reset_handle_timer");
+  stage = 4;
+  thread.join();
+
+  // Only the second interval is counted, also after the thread has exited.
+  BOOST_REQUIRE(afterReset >= std::chrono::microseconds(15000));
+  BOOST_REQUIRE(Timer::Get("reset_handle_timer") == afterReset);
+
+  Timer::ResetAll();
+  Timer::DisableTiming();
+}
+
+/**
+ * A registered timer should not measure anything while timing is disabled.
+ */
+BOOST_AUTO_TEST_CASE(DisabledHandleTimingTest)
+{
+  Timer::DisableTiming();
+
+  const TimerHandle handle = Timer::Register("disabled_handle_timer");
+  {
+    ScopedTimer timer(handle);
+    BOOST_REQUIRE(!Timer::Running(handle));
+  }
+
+  BOOST_REQUIRE(Timer::Get("disabled_handle_timer") ==
+      std::chrono::microseconds(0));
+}
+
+/**
+ * Counters should sum everything that is added to them, until they are reset.
+ */
+BOOST_AUTO_TEST_CASE(CounterTest)
+{
+  Timer::EnableTiming();
+  Counter::ResetAll();
+
+  Counter::Add("test_counter");
+  Counter::Add("test_counter", 10);
+  Counter::Add("other_test_counter", 3);
+
+  BOOST_REQUIRE_EQUAL(Counter::Get("test_counter"), 11);
+  BOOST_REQUIRE_EQUAL(Counter::Get("other_test_counter"), 3);
+  BOOST_REQUIRE_EQUAL(Counter::Get("unknown_test_counter"), 0);
+
+  std::map<std::string, size_t> counters =
+      CLI::GetSingleton().counters.GetAllCounters();
+  BOOST_REQUIRE_EQUAL(counters.size(), 2);
+  BOOST_REQUIRE_EQUAL(counters["test_counter"], 11);
+
+  Counter::ResetAll();
+  BOOST_REQUIRE_EQUAL(Counter::Get("test_counter"), 0);
+  BOOST_REQUIRE(CLI::GetSingleton().counters.GetAllCounters().empty());
+
+  Timer::DisableTiming();
+}
+
+/**
+ * Counters should be able to be added to from several threads.
+ */
+BOOST_AUTO_TEST_CASE(MultithreadCounterTest)
+{
+  Timer::EnableTiming();
+  Counter::ResetAll();
+
+  #pragma omp parallel for
+  for (omp_size_t i = 0; i < 1000; ++i)
+    Counter::Add("thread_counter", 2);
+
+  BOOST_REQUIRE_EQUAL(Counter::Get("thread_counter"), 2000);
+
+  Counter::ResetAll();
+  Timer::DisableTiming();
+}
+
+/**
+ * Nothing should be counted while timing is disabled.
+ */
+BOOST_AUTO_TEST_CASE(DisabledCounterTest)
+{
+  Timer::DisableTiming();
+  Counter::ResetAll();
+
+  Counter::Add("disabled_counter", 5);
+
+  BOOST_REQUIRE_EQUAL(Counter::Get("disabled_counter"), 0);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
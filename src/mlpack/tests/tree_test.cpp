@@ -12,6 +12,8 @@
 #include <mlpack/core/tree/bounds.hpp>
 #include <mlpack/core/tree/binary_space_tree.hpp>
 #include <mlpack/core/metrics/lmetric.hpp>
+#include <mlpack/core/metrics/ip_metric.hpp>
+#include <mlpack/core/kernels/gaussian_kernel.hpp>
 #include <mlpack/core/tree/cover_tree/cover_tree.hpp>
 #include <mlpack/core/tree/rectangle_tree.hpp>
 
@@ -21,6 +23,10 @@
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
 
+#ifdef HAS_OPENMP
+  #include <omp.h>
+#endif
+
 using namespace mlpack;
 using namespace mlpack::math;
 using namespace mlpack::tree;
@@ -2011,6 +2017,88 @@ BOOST_AUTO_TEST_CASE(CoverTreeAlternateMetricTest)
   // in our implementation.
 }
 
+template<typename TreeType>
+void CheckSameCoverTree(const TreeType& a, const TreeType& b)
+{
+  BOOST_REQUIRE_EQUAL(a.Point(), b.Point());
+  BOOST_REQUIRE_EQUAL(a.Scale(), b.Scale());
+  BOOST_REQUIRE_EQUAL(a.NumChildren(), b.NumChildren());
+  BOOST_REQUIRE_EQUAL(a.NumDescendants(), b.NumDescendants());
+  BOOST_REQUIRE_EQUAL(a.ParentDistance(), b.ParentDistance());
+  BOOST_REQUIRE_EQUAL(a.FurthestDescendantDistance(),
+      b.FurthestDescendantDistance());
+
+  for (size_t i = 0; i < a.NumChildren(); ++i)
+    CheckSameCoverTree(a.Child(i), b.Child(i));
+}
+
+/**
+ * The distances near the top of the tree are computed in parallel; make sure
+ * that the tree does not depend on the number of threads.
+ */
+BOOST_AUTO_TEST_CASE(CoverTreeThreadCountTest)
+{
+  arma::mat dataset;
+  dataset.randu(5, 5000);
+
+  typedef StandardCoverTree<EuclideanDistance, EmptyStatistic, arma::mat>
+      TreeType;
+
+  #ifdef HAS_OPENMP
+    const size_t prevNumThreads = omp_get_max_threads();
+    omp_set_num_threads(1);
+  #endif
+
+  TreeType tree1(dataset);
+
+  #ifdef HAS_OPENMP
+    omp_set_num_threads(4);
+  #endif
+
+  TreeType tree4(dataset);
+
+  #ifdef HAS_OPENMP
+    omp_set_num_threads(prevNumThreads);
+  #endif
+
+  BOOST_REQUIRE_EQUAL(tree1.DistanceComps(), tree4.DistanceComps());
+  CheckSameCoverTree(tree1, tree4);
+}
+
+/**
+ * Each thread evaluates the distances with its own copy of the metric; make
+ * sure that this works for a metric that owns state, and that the tree still
+ * does not depend on the number of threads.
+ */
+BOOST_AUTO_TEST_CASE(CoverTreeThreadCountKernelMetricTest)
+{
+  arma::mat dataset;
+  dataset.randu(5, 5000);
+
+  typedef StandardCoverTree<IPMetric<kernel::GaussianKernel>, EmptyStatistic,
+      arma::mat> TreeType;
+
+  #ifdef HAS_OPENMP
+    const size_t prevNumThreads = omp_get_max_threads();
+    omp_set_num_threads(1);
+  #endif
+
+  TreeType tree1(dataset);
+
+  #ifdef HAS_OPENMP
+    omp_set_num_threads(4);
+  #endif
+
+  TreeType tree4(dataset);
+
+  #ifdef HAS_OPENMP
+    omp_set_num_threads(prevNumThreads);
+  #endif
+
+  BOOST_REQUIRE_EQUAL(tree1.DistanceComps(), tree4.DistanceComps());
+  CheckSameCoverTree(tree1, tree4);
+}
+
 /**
  * Make sure copy constructor works for the cover tree.
  */
@@ -2252,4 +2340,185 @@ BOOST_AUTO_TEST_CASE(CoverTreeDescendantTest)
   CheckDescendants(&tree);
 }
 
+/**
+ * Make sure that two trees have exactly the same structure.
+ */
+template<typename TreeType>
+void CheckSameTree(TreeType& a, TreeType& b)
+{
+  BOOST_REQUIRE_EQUAL(a.Begin(), b.Begin());
+  BOOST_REQUIRE_EQUAL(a.Count(), b.Count());
+  BOOST_REQUIRE_EQUAL(a.NumChildren(), b.NumChildren());
+  BOOST_REQUIRE_EQUAL(a.ParentDistance(), b.ParentDistance());
+  BOOST_REQUIRE_EQUAL(a.FurthestDescendantDistance(),
+      b.FurthestDescendantDistance());
+
+  for (size_t i = 0; i < a.NumChildren(); ++i)
+    CheckSameTree(a.Child(i), b.Child(i));
+}
+
+/**
+ * Make sure that a tree built with several threads is exactly the same as a
+ * tree built with one thread, for both split policies that are built in
+ * parallel.  The dataset is large enough that the root is also partitioned in
+ * parallel.
+ */
+template<typename TreeType>
+void CheckParallelConstruction(const arma::mat& dataset)
+{
+  #ifdef HAS_OPENMP
+    const size_t prevNumThreads = omp_get_max_threads();
+    omp_set_num_threads(1);
+  #endif
+
+  std::vector<size_t> serialOldFromNew, serialNewFromOld;
+  TreeType serialTree(dataset, serialOldFromNew, serialNewFromOld);
+  TreeType serialNoMappingTree(dataset);
+
+  #ifdef HAS_OPENMP
+    omp_set_num_threads(4);
+  #endif
+
+  std::vector<size_t> oldFromNew, newFromOld;
+  TreeType tree(dataset, oldFromNew, newFromOld);
+  TreeType noMappingTree(dataset);
+
+  #ifdef HAS_OPENMP
+    omp_set_num_threads(prevNumThreads);
+  #endif
+
+  BOOST_REQUIRE_EQUAL(oldFromNew.size(), serialOldFromNew.size());
+  for (size_t i = 0; i < oldFromNew.size(); ++i)
+  {
+    BOOST_REQUIRE_EQUAL(oldFromNew[i], serialOldFromNew[i]);
+    BOOST_REQUIRE_EQUAL(newFromOld[i], serialNewFromOld[i]);
+  }
+
+  // The mappings have to match the reordered dataset.
+  for (size_t i = 0; i < oldFromNew.size(); ++i)
+  {
+    BOOST_REQUIRE_EQUAL(arma::norm(tree.Dataset().col(i) -
+        dataset.col(oldFromNew[i])), 0.0);
+    BOOST_REQUIRE_EQUAL(arma::norm(noMappingTree.Dataset().col(i) -
+        serialNoMappingTree.Dataset().col(i)), 0.0);
+  }
+
+  CheckSameTree(tree, serialTree);
+  CheckSameTree(noMappingTree, serialNoMappingTree);
+}
+
+BOOST_AUTO_TEST_CASE(ParallelBinarySpaceTreeConstructionTest)
+{
+  arma::mat dataset(4, 60000, arma::fill::randu);
+
+  CheckParallelConstruction<KDTree<EuclideanDistance, EmptyStatistic,
+      arma::mat>>(dataset);
+  CheckParallelConstruction<MeanSplitBallTree<EuclideanDistance,
+      EmptyStatistic, arma::mat>>(dataset);
+}
+
+/**
+ * Make sure that the descendants of a packed tree are stored one after the
+ * other in the order of the layout, and that the links between the nodes are
+ * right.
+ */
+template<typename TreeType>
+void CheckPackedTree(TreeType& tree, const NodeLayout layout)
+{
+  BOOST_REQUIRE_EQUAL(tree.Layout(), layout);
+
+  std::vector<TreeType*> nodes;
+  LayoutNodes(tree, layout, nodes);
+  for (size_t i = 1; i < nodes.size(); ++i)
+  {
+    if (i > 1)
+      BOOST_REQUIRE_EQUAL(nodes[i], nodes[i - 1] + 1);
+
+    TreeType* parent = nodes[i]->Parent();
+    BOOST_REQUIRE((parent->Left() == nodes[i]) ||
+        (parent->Right() == nodes[i]));
+    BOOST_REQUIRE_EQUAL(&nodes[i]->Dataset(), &tree.Dataset());
+  }
+}
+
+/**
+ * Pack the nodes of a tree in each layout and make sure the tree is otherwise
+ * unchanged, also after copying and moving it.
+ */
+BOOST_AUTO_TEST_CASE(BinarySpaceTreePackNodesTest)
+{
+  typedef KDTree<EuclideanDistance, EmptyStatistic, arma::mat> TreeType;
+  arma::mat dataset(3, 1000, arma::fill::randu);
+
+  TreeType tree(dataset);
+  TreeType original(tree);
+
+  tree.PackNodes(BREADTH_FIRST_LAYOUT);
+  CheckPackedTree(tree, BREADTH_FIRST_LAYOUT);
+  CheckSameTree(tree, original);
+
+  tree.PackNodes(VAN_EMDE_BOAS_LAYOUT);
+  CheckPackedTree(tree, VAN_EMDE_BOAS_LAYOUT);
+  CheckSameTree(tree, original);
+
+  // Copies and moved trees keep the layout.
+  TreeType copy(tree);
+  CheckPackedTree(copy, VAN_EMDE_BOAS_LAYOUT);
+  CheckSameTree(copy, original);
+
+  TreeType moved(std::move(copy));
+  CheckPackedTree(moved, VAN_EMDE_BOAS_LAYOUT);
+  CheckSameTree(moved, original);
+
+  // Go back to separately allocated nodes.
+  tree.PackNodes(SEPARATE_LAYOUT);
+  BOOST_REQUIRE_EQUAL(tree.Layout(), SEPARATE_LAYOUT);
+  CheckSameTree(tree, original);
+
+  // Only the root can be packed.
+  BOOST_REQUIRE_THROW(moved.Left()->PackNodes(), std::invalid_argument);
+}
+
+/**
+ * Check the van Emde Boas order of a complete tree with five levels: the top
+ * two levels come first, followed by each of the four subtrees of three levels
+ * below them, and each of those is split the same way.
+ */
+BOOST_AUTO_TEST_CASE(VanEmdeBoasLayoutTest)
+{
+  typedef KDTree<EuclideanDistance, EmptyStatistic, arma::mat> TreeType;
+  arma::mat dataset(1, 16);
+  for (size_t i = 0; i < 16; ++i)
+    dataset[i] = i;
+
+  TreeType tree(dataset, 1);
+
+  std::vector<TreeType*> nodes;
+  LayoutNodes(tree, VAN_EMDE_BOAS_LAYOUT, nodes);
+  BOOST_REQUIRE_EQUAL(nodes.size(), 31);
+
+  // The top tree.
+  BOOST_REQUIRE_EQUAL(nodes[0]->Begin(), 0);
+  BOOST_REQUIRE_EQUAL(nodes[0]->Count(), 16);
+  BOOST_REQUIRE_EQUAL(nodes[1]->Begin(), 0);
+  BOOST_REQUIRE_EQUAL(nodes[1]->Count(), 8);
+  BOOST_REQUIRE_EQUAL(nodes[2]->Begin(), 8);
+  BOOST_REQUIRE_EQUAL(nodes[2]->Count(), 8);
+
+  // The four bottom trees.
+  const size_t offsets[] = { 0, 0, 0, 1, 2, 2, 3 };
+  const size_t counts[] = { 4, 2, 1, 1, 2, 1, 1 };
+  for (size_t t = 0; t < 4; ++t)
+  {
+    for (size_t i = 0; i < 7; ++i)
+    {
+      BOOST_REQUIRE_EQUAL(nodes[3 + 7 * t + i]->Begin(), 4 * t + offsets[i]);
+      BOOST_REQUIRE_EQUAL(nodes[3 + 7 * t + i]->Count(), counts[i]);
+    }
+  }
+
+  tree.PackNodes(VAN_EMDE_BOAS_LAYOUT);
+  CheckPackedTree(tree, VAN_EMDE_BOAS_LAYOUT);
+}
+
 BOOST_AUTO_TEST_SUITE_END();